@@ -0,0 +1,286 @@
+#include "burst.h"
+#include "capture.h"
+#include "config.h"
+#include "memorygovernor.h"
+#include "utils.h"
+#include <mmsystem.h>
+#include <stdio.h>
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <vector>
+
+#pragma comment(lib, "winmm.lib")
+
+namespace ScreenCapture {
+
+static std::thread g_burstThread;
+static std::atomic<bool> g_burstStop(false);
+static std::atomic<bool> g_burstRunning(false);
+
+// Debug logging helper
+static void DebugLog(const wchar_t* format, ...) {
+    FILE* f = _wfopen(L"debug_burst.txt", L"a");
+    if (f) {
+        SYSTEMTIME st;
+        GetLocalTime(&st);
+        fwprintf(f, L"[%02d:%02d:%02d.%03d] ", st.wHour, st.wMinute, st.wSecond, st.wMilliseconds);
+        
+        va_list args;
+        va_start(args, format);
+        vfwprintf(f, format, args);
+        va_end(args);
+        
+        fwprintf(f, L"\n");
+        fclose(f);
+    }
+}
+
+// One preallocated ring slot: pooled frame plus a DIB view for BitBlt.
+// The slot is free again once the ring holds the only reference.
+struct BurstSlot {
+    FrameRef frame;
+    HBITMAP hBitmap;
+};
+
+struct BurstFrame {
+    FrameRef frame;
+    int index;
+    double timeMs;      // Capture start, relative to burst start
+    double latenessMs;  // How far past its scheduled tick the capture began
+    double captureMs;
+};
+
+static double ElapsedMs(const LARGE_INTEGER& start, const LARGE_INTEGER& freq) {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return (double)(now.QuadPart - start.QuadPart) * 1000.0 / (double)freq.QuadPart;
+}
+
+static void WaitUntil(double deadlineMs, const LARGE_INTEGER& start, const LARGE_INTEGER& freq) {
+    // Coarse Sleep (1ms resolution under timeBeginPeriod) then a short spin
+    for (;;) {
+        double remaining = deadlineMs - ElapsedMs(start, freq);
+        if (remaining <= 0) return;
+        if (remaining > 2.0) {
+            Sleep((DWORD)(remaining - 1.0));
+        } else {
+            Sleep(0);
+        }
+    }
+}
+
+static bool IsBurstKeyHeld() {
+    // PrintScreen itself is often not reported by GetAsyncKeyState, so the
+    // burst lasts as long as both modifiers stay down
+    return (GetAsyncKeyState(VK_CONTROL) & 0x8000) && (GetAsyncKeyState(VK_SHIFT) & 0x8000);
+}
+
+static EncodeJob MakeBurstJob(const BurstFrame& frame, const std::wstring& baseName) {
+    wchar_t suffix[32];
+    swprintf_s(suffix, L"_%04d.png", frame.index);
+    std::wstring filename = baseName + suffix;
+    
+    EncodeJob job;  // No merge key: burst frames are never merged
+    FrameRef pixels = frame.frame;
+    job.run = [pixels, filename](const EncodeOptions& options) {
+        return SaveFrameToPNG(pixels, filename, options);
+    };
+    return job;
+}
+
+static void BurstThread(Config config, RECT area, std::wstring baseName) {
+    int width = area.right - area.left;
+    int height = area.bottom - area.top;
+    DebugLog(L"=== Burst start: %dx%d @ %d fps, ring=%d, encodeDuring=%d ===",
+        width, height, config.burstFps, config.burstRingFrames, config.burstEncodeDuring);
+    
+    timeBeginPeriod(1);
+    HDC hdcScreen = GetDC(NULL);
+    HDC hdcMem = hdcScreen ? CreateCompatibleDC(hdcScreen) : NULL;
+    
+    // Ring size from a byte budget: RingFrames full-screen frames are
+    // gigabytes on large desktops. The budget also stays inside what the
+    // memory ceiling has left; two slots are the minimum to capture at all.
+    MemoryGovernor& governor = MemoryGovernor::Instance();
+    governor.SetCeiling(config.memoryCeiling);
+    size_t frameBytes = (size_t)width * height * 4;
+    size_t budget = config.burstRingBytes;
+    MemoryGovernorStats memory = governor.GetStats();
+    if (memory.ceiling) {
+        size_t headroom = memory.ceiling > memory.inUse ? memory.ceiling - memory.inUse : 0;
+        if (headroom < budget) budget = headroom;
+    }
+    int slots = config.burstRingFrames;
+    if (frameBytes && budget / frameBytes < (size_t)slots) {
+        slots = budget / frameBytes < 2 ? 2 : (int)(budget / frameBytes);
+        DebugLog(L"  Ring clamped: %d of %d slots (%zuKB per frame, budget %zuKB, ceiling %zuKB, in use %zuKB)",
+            slots, config.burstRingFrames, frameBytes / 1024, budget / 1024, memory.ceiling / 1024, memory.inUse / 1024);
+    }
+    
+    // Preallocate the whole ring up front so capture never allocates
+    std::vector<BurstSlot> ring;
+    if (hdcMem) {
+        for (int i = 0; i < slots; i++) {
+            BurstSlot slot;
+            slot.frame = FramePool::Instance().Acquire(width, height);
+            slot.hBitmap = CreateFrameDIB(hdcScreen, slot.frame);
+            if (!slot.hBitmap) break;
+            ring.push_back(slot);
+        }
+    }
+    MemoryCharge ringCharge = governor.Charge(MemoryStage::Burst, ring.size() * frameBytes);
+    DebugLog(L"  Ring ready: %zu slots, %zuKB", ring.size(), ring.size() * frameBytes / 1024);
+    
+    LARGE_INTEGER freq, start;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+    
+    const double periodMs = 1000.0 / config.burstFps;
+    const double maxMs = config.burstMaxSeconds * 1000.0;
+    std::deque<BurstFrame> pending;  // Captured, not yet handed to the encoder
+    std::vector<BurstFrame> timeline;
+    int droppedLate = 0;
+    int droppedRingFull = 0;
+    int captured = 0;
+    double maxCaptureMs = 0;
+    
+    HBITMAP hOldBitmap = NULL;
+    if (!ring.empty()) {
+        hOldBitmap = (HBITMAP)SelectObject(hdcMem, ring[0].hBitmap);
+    }
+    
+    for (long long tick = 0; !ring.empty() && !g_burstStop; tick++) {
+        // Fixed schedule from the burst start: no accumulated drift
+        double deadline = tick * periodMs;
+        if (deadline > maxMs) break;
+        if (tick > 0 && !IsBurstKeyHeld()) break;
+        
+        WaitUntil(deadline, start, freq);
+        
+        // Ticks that passed entirely while the previous capture ran are dropped
+        double now = ElapsedMs(start, freq);
+        long long behind = (long long)((now - deadline) / periodMs);
+        if (behind > 0) {
+            droppedLate += (int)behind;
+            tick += behind;
+            deadline = tick * periodMs;
+        }
+        
+        BurstSlot* slot = nullptr;
+        for (BurstSlot& candidate : ring) {
+            if (candidate.frame.use_count() == 1) {
+                slot = &candidate;
+                break;
+            }
+        }
+        
+        if (!slot) {
+            droppedRingFull++;
+        } else {
+            BurstFrame frame;
+            frame.frame = slot->frame;
+            frame.index = captured;
+            frame.timeMs = ElapsedMs(start, freq);
+            frame.latenessMs = frame.timeMs - deadline;
+            
+            SelectObject(hdcMem, slot->hBitmap);
+            BitBlt(hdcMem, 0, 0, width, height, hdcScreen, area.left, area.top, SRCCOPY | CAPTUREBLT);
+            GdiFlush();
+            
+            frame.captureMs = ElapsedMs(start, freq) - frame.timeMs;
+            if (frame.captureMs > maxCaptureMs) maxCaptureMs = frame.captureMs;
+            
+            pending.push_back(frame);
+            BurstFrame entry = frame;
+            entry.frame = nullptr;
+            timeline.push_back(entry);
+            captured++;
+        }
+        
+        // Encode alongside the burst only while the pool has idle slots, so
+        // the capture loop itself never waits on the encoder
+        if (config.burstEncodeDuring) {
+            while (!pending.empty()) {
+                EncodeJob job = MakeBurstJob(pending.front(), baseName);
+                if (!GetEncodePool().TrySubmit(job)) break;
+                pending.pop_front();
+            }
+        }
+    }
+    
+    double totalMs = ElapsedMs(start, freq);
+    
+    if (hdcMem && hOldBitmap) {
+        SelectObject(hdcMem, hOldBitmap);
+    }
+    
+    // The ring DIBs were only GDI views; queued jobs keep the pooled pixels
+    for (BurstSlot& slot : ring) {
+        DeleteObject(slot.hBitmap);
+    }
+    ring.clear();
+    if (hdcMem) DeleteDC(hdcMem);
+    if (hdcScreen) ReleaseDC(NULL, hdcScreen);
+    timeEndPeriod(1);
+    
+    // Everything still held goes to the encoder now (blocking is fine here)
+    size_t deferred = pending.size();
+    while (!pending.empty()) {
+        GetEncodePool().Submit(MakeBurstJob(pending.front(), baseName));
+        pending.pop_front();
+    }
+    
+    // Per-frame timestamps next to the images
+    FILE* f = _wfopen((baseName + L".csv").c_str(), L"w");
+    if (f) {
+        fwprintf(f, L"frame,time_ms,lateness_ms,capture_ms\n");
+        for (const BurstFrame& frame : timeline) {
+            fwprintf(f, L"%d,%.3f,%.3f,%.3f\n", frame.index, frame.timeMs, frame.latenessMs, frame.captureMs);
+        }
+        fclose(f);
+    }
+    
+    ringCharge.Release();
+    
+    double fps = totalMs > 0 ? captured * 1000.0 / totalMs : 0;
+    DebugLog(L"=== Burst end: %d frames in %.0fms (%.1f fps), dropped late=%d ringFull=%d, maxCapture=%.1fms, deferred encodes=%zu ===",
+        captured, totalMs, fps, droppedLate, droppedRingFull, maxCaptureMs, deferred);
+    
+    g_burstRunning = false;
+}
+
+bool StartBurst() {
+    if (g_burstRunning) {
+        DebugLog(L"StartBurst: already running");
+        return false;
+    }
+    if (g_burstThread.joinable()) {
+        g_burstThread.join();
+    }
+    
+    std::wstring dir = GetSaveDirectory();
+    if (!EnsureDirectoryExists(dir)) {
+        DebugLog(L"StartBurst: ERROR: Failed to create directory");
+        return false;
+    }
+    
+    g_burstStop = false;
+    g_burstRunning = true;
+    g_burstThread = std::thread(BurstThread, GetConfig(), GetVirtualScreenRect(),
+                                dir + L"\\Burst_" + GetTimestamp());
+    return true;
+}
+
+void StopBurst() {
+    g_burstStop = true;
+    if (g_burstThread.joinable()) {
+        g_burstThread.join();
+    }
+}
+
+bool IsBurstRunning() {
+    return g_burstRunning;
+}
+
+} // namespace ScreenCapture
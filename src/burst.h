@@ -0,0 +1,17 @@
+#pragma once
+#include <windows.h>
+
+namespace ScreenCapture {
+
+// Start a burst capture of the virtual screen. Frames are grabbed at the
+// configured rate into a preallocated ring of pooled frames until the
+// hotkey modifiers (Ctrl+Shift) are released or MaxSeconds elapses.
+// Returns false if a burst is already running.
+bool StartBurst();
+
+// Ask a running burst to stop and wait for it (queued saves keep going)
+void StopBurst();
+
+bool IsBurstRunning();
+
+} // namespace ScreenCapture
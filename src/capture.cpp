@@ -1,16 +1,38 @@
 #include "capture.h"
 #include "utils.h"
 #include "preview.h"
-#include <dwmapi.h>
+#include "config.h"
+#include "encodepool.h"
+#include "framehash.h"
+#include "capturesession.h"
+#include "memorygovernor.h"
+#include <atomic>
+#include <memory>
 #include <thread>
 #include <mmsystem.h>
 #include <stdio.h>
 
-#pragma comment(lib, "dwmapi.lib")
 #pragma comment(lib, "winmm.lib")
 
 namespace ScreenCapture {
 
+static EncodePool* g_encodePool = nullptr;
+static RecentCaptures g_recentCaptures(16);
+static DuplicateStats g_duplicateStats = {};
+
+// Warm capture state, rebuilt on display or config changes
+static CaptureSession* g_session = nullptr;
+static unsigned g_sessionConfig = 0;
+
+// What SaveCapture needs on every call, resolved once per session
+struct SavePaths {
+    std::wstring dir;
+    std::wstring sound;  // Empty if no sound file was found
+    bool valid;
+};
+static SavePaths g_savePaths = {};
+static std::atomic<bool> g_savePathsStale(false);  // A write failed; re-check the directory
+
 // Debug logging helper
 static void DebugLog(const wchar_t* format, ...) {
     FILE* f = _wfopen(L"debug_capture.txt", L"a");
@@ -30,76 +52,173 @@ static void DebugLog(const wchar_t* format, ...) {
     }
 }
 
-HBITMAP CaptureScreenArea(int x, int y, int width, int height) {
-    DebugLog(L"CaptureScreenArea: x=%d, y=%d, w=%d, h=%d", x, y, width, height);
-    
-    HDC hdcScreen = GetDC(NULL);
-    if (!hdcScreen) {
-        DebugLog(L"  ERROR: GetDC(NULL) failed");
-        return NULL;
+EncodePool& GetEncodePool() {
+    if (!g_encodePool) {
+        const Config& config = GetConfig();
+        g_encodePool = new EncodePool(config.encodeThreads, config.encodeQueueCapacity, config.backpressure);
+        g_encodePool->SetJobCallback([](const EncodeJobStats& stats) {
+            DebugLog(L"[ENCODE] job=%llu wait=%.1fms run=%.1fms fast=%d ok=%d",
+                stats.id, stats.queueWaitMs, stats.runMs, stats.fastPreset, stats.ok);
+        });
+        DebugLog(L"EncodePool started: threads=%d capacity=%d policy=%d",
+            config.encodeThreads, config.encodeQueueCapacity, (int)config.backpressure);
+    }
+    return *g_encodePool;
+}
+
+DuplicateStats GetDuplicateStats() {
+    return g_duplicateStats;
+}
+
+static uint64_t GetFileSize64(const std::wstring& path) {
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data)) return 0;
+    return ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+}
+
+// A recent save with identical pixels that still exists. A hash match is
+// confirmed with the independent CheckPixels hash before it is trusted.
+// Safe on any thread (encode workers use it for merged jobs).
+static bool FindSavedCopy(const FrameRef& frame, const FrameHash& hash, std::wstring* existing, uint64_t* existingSize) {
+    uint64_t existingCheck = 0;
+    if (!g_recentCaptures.Find(hash, frame->Width(), frame->Height(), existing, existingSize, &existingCheck)) {
+        return false;
+    }
+    uint64_t check = CheckPixels(frame->Bits(), frame->Width(), frame->Height(), frame->Stride());
+    if (check != existingCheck) {
+        DebugLog(L"  [DUP] Hash collision with %s (check %016llx != %016llx), encoding", existing->c_str(), check,
+                 existingCheck);
+        return false;
+    }
+    if (GetFileAttributesW(existing->c_str()) == INVALID_FILE_ATTRIBUTES) {
+        DebugLog(L"  [DUP] Match %s no longer exists, encoding", existing->c_str());
+        g_recentCaptures.Remove(*existing);
+        return false;
+    }
+    return true;
+}
+
+// Hard links need NTFS; fall back to a plain copy, still far cheaper than encoding
+static bool LinkSavedCopy(const std::wstring& existing, const std::wstring& filename) {
+    if (CreateHardLinkW(filename.c_str(), existing.c_str(), NULL) || CopyFileW(existing.c_str(), filename.c_str(), TRUE)) {
+        return true;
+    }
+    DebugLog(L"  [DUP] Link/copy of %s failed (error=%d), encoding", existing.c_str(), GetLastError());
+    return false;
+}
+
+// Looks for a recent save with identical pixels. On a match the capture is
+// resolved without encoding: 'filename' is hard-linked to the existing file
+// or replaced by it, depending on the configured mode.
+static bool ResolveDuplicate(const FrameRef& frame, const FrameHash& hash, DuplicateMode mode, std::wstring& filename) {
+    std::wstring existing;
+    uint64_t existingSize = 0;
+    if (!FindSavedCopy(frame, hash, &existing, &existingSize)) {
+        return false;
     }
-    DebugLog(L"  GetDC OK");
     
-    HDC hdcMem = CreateCompatibleDC(hdcScreen);
-    if (!hdcMem) {
-        DebugLog(L"  ERROR: CreateCompatibleDC failed");
-        ReleaseDC(NULL, hdcScreen);
-        return NULL;
+    if (mode == DuplicateMode::HardLink) {
+        if (!LinkSavedCopy(existing, filename)) return false;
+        g_duplicateStats.linked++;
+    } else {
+        filename = existing;
+        g_duplicateStats.referenced++;
     }
-    DebugLog(L"  CreateCompatibleDC OK");
     
-    // Create DIB section for faster access
-    BITMAPINFO bmi = {};
-    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    bmi.bmiHeader.biWidth = width;
-    bmi.bmiHeader.biHeight = -height; // Top-down
-    bmi.bmiHeader.biPlanes = 1;
-    bmi.bmiHeader.biBitCount = 32;
-    bmi.bmiHeader.biCompression = BI_RGB;
+    g_duplicateStats.skipped++;
+    g_duplicateStats.bytesAvoided += existingSize;
+    DebugLog(L"  [DUP] Same pixels as %s -> %s", existing.c_str(), filename.c_str());
+    return true;
+}
+
+// Raw pixels of a capture parked on disk while memory is over the ceiling.
+// The temp file is delete-on-close, so it never outlives the process.
+class SpilledFrame {
+public:
+    static std::shared_ptr<SpilledFrame> Create(const FrameRef& frame) {
+        wchar_t dir[MAX_PATH], path[MAX_PATH];
+        if (!GetTempPathW(MAX_PATH, dir) || !GetTempFileNameW(dir, L"scs", 0, path)) return nullptr;
+        HANDLE file = CreateFileW(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                                  FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+        if (file == INVALID_HANDLE_VALUE) return nullptr;
+        
+        std::shared_ptr<SpilledFrame> spill(new SpilledFrame(file, frame->Width(), frame->Height()));
+        DWORD rowBytes = (DWORD)frame->Width() * 4;
+        for (int y = 0; y < frame->Height(); y++) {
+            DWORD written = 0;
+            if (!WriteFile(file, frame->Row(y), rowBytes, &written, NULL) || written != rowBytes) {
+                return nullptr;
+            }
+        }
+        return spill;
+    }
     
-    void* pBits = NULL;
-    HBITMAP hBitmap = CreateDIBSection(hdcScreen, &bmi, DIB_RGB_COLORS, &pBits, NULL, 0);
+    ~SpilledFrame() { CloseHandle(m_file); }
     
-    if (hBitmap) {
-        DebugLog(L"  CreateDIBSection OK, pBits=%p", pBits);
-        HBITMAP hOldBitmap = (HBITMAP)SelectObject(hdcMem, hBitmap);
-        
-        // Use BitBlt with CAPTUREBLT flag to capture layered windows
-        BOOL result = BitBlt(hdcMem, 0, 0, width, height, hdcScreen, x, y, SRCCOPY | CAPTUREBLT);
-        DebugLog(L"  BitBlt result=%d", result);
-        
-        SelectObject(hdcMem, hOldBitmap);
-    } else {
-        DebugLog(L"  ERROR: CreateDIBSection failed, GetLastError=%d", GetLastError());
+    FrameRef Load() {
+        FrameRef frame = FramePool::Instance().Acquire(m_width, m_height);
+        if (!frame || SetFilePointer(m_file, 0, NULL, FILE_BEGIN) == INVALID_SET_FILE_POINTER) return nullptr;
+        DWORD rowBytes = (DWORD)m_width * 4;
+        for (int y = 0; y < m_height; y++) {
+            DWORD read = 0;
+            if (!ReadFile(m_file, frame->Row(y), rowBytes, &read, NULL) || read != rowBytes) return nullptr;
+        }
+        return frame;
     }
     
-    DeleteDC(hdcMem);
-    ReleaseDC(NULL, hdcScreen);
+    size_t Bytes() const { return (size_t)m_width * 4 * m_height; }
+    
+private:
+    SpilledFrame(HANDLE file, int width, int height) : m_file(file), m_width(width), m_height(height) {}
     
-    DebugLog(L"  Returning hBitmap=%p", hBitmap);
-    return hBitmap;
+    HANDLE m_file;
+    int m_width;
+    int m_height;
+};
+
+void ShutdownCapture() {
+    if (g_encodePool) {
+        DebugLog(L"ShutdownCapture: draining encode pool...");
+        g_encodePool->Drain();
+        EncodePoolStats stats = g_encodePool->GetStats();
+        DebugLog(L"  Drained: completed=%llu failed=%llu", stats.completed, stats.failed);
+        delete g_encodePool;
+        g_encodePool = nullptr;
+    }
+    delete g_session;
+    g_session = nullptr;
 }
 
-bool SaveCapture(HBITMAP hBitmap, const std::wstring& prefix) {
-    DebugLog(L"SaveCapture: hBitmap=%p, prefix=%s", hBitmap, prefix.c_str());
-    
-    if (!hBitmap) {
-        DebugLog(L"  ERROR: hBitmap is NULL");
-        return false;
+static CaptureSession& GetCaptureSession() {
+    unsigned generation = GetConfigGeneration();
+    if (g_session && g_sessionConfig != generation) {
+        DebugLog(L"[SESSION] Config changed, rebuilding");
+        g_session->Invalidate();
+        g_savePaths.valid = false;
     }
+    g_sessionConfig = generation;
     
-    std::wstring dir = GetSaveDirectory();
-    DebugLog(L"  Save directory: %s", dir.c_str());
+    if (!g_session) {
+        RECT vs = GetVirtualScreenRect();
+        g_session = new CaptureSession(CreateGdiBackend(), vs.right - vs.left, vs.bottom - vs.top, 2);
+    }
+    return *g_session;
+}
+
+static const SavePaths& GetSavePaths() {
+    if (g_savePathsStale.exchange(false)) {
+        g_savePaths.valid = false;
+    }
+    if (g_savePaths.valid) {
+        return g_savePaths;
+    }
     
-    if (!EnsureDirectoryExists(dir)) {
+    g_savePaths.dir = GetSaveDirectory();
+    DebugLog(L"  Save directory: %s", g_savePaths.dir.c_str());
+    g_savePaths.valid = EnsureDirectoryExists(g_savePaths.dir);
+    if (!g_savePaths.valid) {
         DebugLog(L"  ERROR: Failed to create directory");
-        DeleteObject(hBitmap);
-        return false;
     }
-    DebugLog(L"  Directory exists/created OK");
-    
-    std::wstring filename = dir + L"\\" + prefix + L"_" + GetTimestamp() + L".png";
-    DebugLog(L"  Filename: %s", filename.c_str());
     
     // Get the directory where the exe is located
     wchar_t exePath[MAX_PATH];
@@ -118,20 +237,130 @@ bool SaveCapture(HBITMAP hBitmap, const std::wstring& prefix) {
         L"src\\sound.wav"                  // Current directory
     };
     
-    bool soundPlayed = false;
+    g_savePaths.sound.clear();
     for (const auto& soundPath : soundPaths) {
         DebugLog(L"  Trying sound: %s", soundPath.c_str());
         if (GetFileAttributesW(soundPath.c_str()) != INVALID_FILE_ATTRIBUTES) {
-            DebugLog(L"    Found! Playing...");
-            BOOL playResult = PlaySoundW(soundPath.c_str(), NULL, SND_FILENAME | SND_ASYNC);
-            DebugLog(L"    PlaySound result: %d", playResult);
-            soundPlayed = true;
+            g_savePaths.sound = soundPath;
             break;
         }
     }
-    if (!soundPlayed) {
+    if (g_savePaths.sound.empty()) {
         DebugLog(L"  WARNING: No sound file found");
     }
+    return g_savePaths;
+}
+
+void WarmCaptureSession() {
+    LARGE_INTEGER freq, start, end;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+    bool built = GetCaptureSession().Build();
+    GetSavePaths();
+    QueryPerformanceCounter(&end);
+    DebugLog(L"[SESSION] Warmed: built=%d in %.1fms", built,
+        (double)(end.QuadPart - start.QuadPart) * 1000.0 / (double)freq.QuadPart);
+}
+
+void InvalidateCaptureSession() {
+    DebugLog(L"[SESSION] Invalidated (display change)");
+    if (g_session) {
+        RECT vs = GetVirtualScreenRect();
+        g_session->Resize(vs.right - vs.left, vs.bottom - vs.top);
+        g_session->Invalidate();
+    }
+    g_savePaths.valid = false;
+}
+
+FrameRef CaptureScreenArea(int x, int y, int width, int height) {
+    DebugLog(L"CaptureScreenArea: x=%d, y=%d, w=%d, h=%d", x, y, width, height);
+    
+    // Warm slot of the session: DCs, DIB and pre-faulted pages already exist
+    CaptureSession& session = GetCaptureSession();
+    CaptureSessionStats before = session.GetStats();
+    FrameRef frame = session.Capture(x, y, width, height);
+    CaptureSessionStats after = session.GetStats();
+    
+    if (!frame) {
+        DebugLog(L"  ERROR: Capture failed (backend=%hs)", session.BackendName());
+        return nullptr;
+    }
+    
+    const wchar_t* path = after.cold > before.cold ? L"cold" : (after.builds > before.builds ? L"rebuild" : L"warm");
+    DebugLog(L"  [SESSION] %s: total=%.2fms grab=%.2fms (warm=%llu cold=%llu builds=%llu)",
+        path, after.lastTotalMs, after.lastGrabMs, after.warm, after.cold, after.builds);
+    
+    FramePoolStats stats = FramePool::Instance().GetStats();
+    DebugLog(L"  FramePool: hits=%llu misses=%llu faultedPages=%llu inUse=%zuKB cached=%zuKB",
+        stats.hits, stats.misses, stats.faultedPages, stats.bytesInUse / 1024, stats.bytesCached / 1024);
+    
+    return frame;
+}
+
+bool SaveCapture(const FrameRef& frame, const std::wstring& prefix) {
+    DebugLog(L"SaveCapture: frame=%p, prefix=%s", frame.get(), prefix.c_str());
+    
+    if (!frame) {
+        DebugLog(L"  ERROR: frame is NULL");
+        return false;
+    }
+    
+    // Cached per session: no shell folder lookup or file probes per capture
+    const SavePaths& paths = GetSavePaths();
+    if (!paths.valid) {
+        return false;
+    }
+    
+    std::wstring filename = paths.dir + L"\\" + prefix + L"_" + GetTimestamp() + L".png";
+    DebugLog(L"  Filename: %s", filename.c_str());
+    
+    // Exact repeats of a recent capture skip the encode entirely
+    const Config& config = GetConfig();
+    bool hashed = config.duplicateMode != DuplicateMode::Off;
+    bool duplicate = false;
+    FrameHash hash = {};
+    if (hashed) {
+        LARGE_INTEGER freq, start, end;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&start);
+        hash = HashPixels(frame->Bits(), frame->Width(), frame->Height(), frame->Stride());
+        QueryPerformanceCounter(&end);
+        double hashMs = (double)(end.QuadPart - start.QuadPart) * 1000.0 / (double)freq.QuadPart;
+        g_duplicateStats.hashed++;
+        g_duplicateStats.hashMs += hashMs;
+        DebugLog(L"  Hash %016llx%016llx in %.2fms", hash.hi, hash.lo, hashMs);
+        
+        g_recentCaptures.SetCapacity(config.duplicateRecent);
+        duplicate = ResolveDuplicate(frame, hash, config.duplicateMode, filename);
+    }
+    
+    if (!paths.sound.empty()) {
+        BOOL playResult = PlaySoundW(paths.sound.c_str(), NULL, SND_FILENAME | SND_ASYNC);
+        DebugLog(L"  PlaySound result: %d", playResult);
+    }
+    
+    // Admission against the memory ceiling, before the preview takes its
+    // reference: a spilled frame must not stay alive in the preview either,
+    // or its block (often a warm session slot) would not be released. The
+    // queued frame is charged until its job finishes (a merged job runs
+    // behind its twin).
+    MemoryGovernor& governor = MemoryGovernor::Instance();
+    governor.SetCeiling(config.memoryCeiling);
+    size_t frameBytes = (size_t)frame->Stride() * frame->Height();
+    MemoryDecision decision = MemoryDecision::Normal;
+    std::shared_ptr<SpilledFrame> spill;
+    if (!duplicate) {
+        decision = governor.Admit(frameBytes);
+        if (decision == MemoryDecision::Spill) {
+            spill = SpilledFrame::Create(frame);
+            if (spill) {
+                governor.RecordSpill(spill->Bytes());
+            } else {
+                DebugLog(L"  [MEM] Spill failed (error=%d), keeping the frame in memory", GetLastError());
+                decision = MemoryDecision::FastPreset;
+            }
+        }
+    }
     
     // Show preview window (will self-delete when closed)
     DebugLog(L"  Creating PreviewWindow...");
@@ -139,41 +368,182 @@ bool SaveCapture(HBITMAP hBitmap, const std::wstring& prefix) {
     DebugLog(L"  PreviewWindow created at %p", preview);
     
     DebugLog(L"  Calling preview->Show()...");
-    preview->Show(hBitmap, filename);
+    preview->Show(frame, filename, !spill);
     DebugLog(L"  preview->Show() returned");
     
-    // Save async using QueueUserWorkItem (faster than std::thread)
-    struct SaveContext {
-        HBITMAP hBitmap;
-        wchar_t filename[MAX_PATH];
-    };
+    if (duplicate) {
+        DebugLog(L"  Encode skipped (skipped=%llu linked=%llu referenced=%llu bytesAvoided=%lluKB)",
+            g_duplicateStats.skipped, g_duplicateStats.linked, g_duplicateStats.referenced,
+            g_duplicateStats.bytesAvoided / 1024);
+        return true;
+    }
     
-    SaveContext* ctx = new SaveContext();
-    ctx->hBitmap = hBitmap;
-    wcscpy_s(ctx->filename, MAX_PATH, filename.c_str());
+    auto charge = std::make_shared<MemoryCharge>(
+        governor.Charge(MemoryStage::Queued, spill ? 0 : frameBytes));
+    MemoryGovernorStats memory = governor.GetStats();
+    DebugLog(L"  [MEM] %s: frame=%zuKB inUse=%zuKB (queued=%zuKB encode=%zuKB preview=%zuKB session=%zuKB) ceiling=%zuKB",
+        MemoryGovernor::DecisionName(decision), frameBytes / 1024, memory.inUse / 1024,
+        memory.byStage[(int)MemoryStage::Queued] / 1024, memory.byStage[(int)MemoryStage::Encode] / 1024,
+        memory.byStage[(int)MemoryStage::Preview] / 1024, memory.byStage[(int)MemoryStage::Session] / 1024,
+        memory.ceiling / 1024);
     
-    DebugLog(L"  Queueing async save...");
-    BOOL queueResult = QueueUserWorkItem([](PVOID param) -> DWORD {
-        SaveContext* ctx = (SaveContext*)param;
-        SaveBitmapToPNG(ctx->hBitmap, ctx->filename);
-        DeleteObject(ctx->hBitmap);
-        delete ctx;
-        return 0;
-    }, ctx, WT_EXECUTEDEFAULT);
-    DebugLog(L"  QueueUserWorkItem result: %d", queueResult);
+    // Save async on the bounded encode pool (tracked, drained on exit).
+    // Only finished files are remembered, so a job still queued never
+    // becomes a duplicate target. A spilled job holds no frame at all.
+    // The merge key is the content: a repeat of a queued capture runs right
+    // behind it and links the file it just wrote instead of encoding.
+    EncodeJob job;
+    if (hashed) {
+        char key[64];
+        snprintf(key, sizeof(key), "%016llx%016llx_%dx%d", hash.hi, hash.lo, frame->Width(), frame->Height());
+        job.mergeKey = key;
+    }
+    FrameRef held = spill ? FrameRef() : frame;
+    bool fast = decision != MemoryDecision::Normal;
+    int width = frame->Width(), height = frame->Height();
+    job.run = [held, spill, charge, fast, filename, hashed, hash, width, height](const EncodeOptions& options) {
+        // A reloaded spill is encoder memory until the job ends
+        MemoryCharge reloaded = spill ? MemoryGovernor::Instance().Charge(MemoryStage::Encode, spill->Bytes())
+                                      : MemoryCharge();
+        FrameRef pixels = spill ? spill->Load() : held;
+        // Saved meanwhile (a merged repeat runs right after its twin)
+        std::wstring existing;
+        uint64_t existingSize = 0;
+        if (pixels && hashed && FindSavedCopy(pixels, hash, &existing, &existingSize) &&
+            LinkSavedCopy(existing, filename)) {
+            return true;
+        }
+        bool ok = pixels && SaveFrameToPNG(pixels, filename, fast ? EncodeOptions::Fast() : options);
+        if (!ok) {
+            g_savePathsStale = true;
+        }
+        if (ok && hashed) {
+            // The confirming hash is paid here, on the encode worker
+            uint64_t check = CheckPixels(pixels->Bits(), width, height, pixels->Stride());
+            g_recentCaptures.Add(hash, check, width, height, filename, GetFileSize64(filename));
+        }
+        return ok;
+    };
+    
+    DebugLog(L"  Submitting async save...");
+    bool queueResult = GetEncodePool().Submit(std::move(job));
+    EncodePoolStats poolStats = GetEncodePool().GetStats();
+    DebugLog(L"  Submit result: %d (queued=%zu running=%d blocked=%llu merged=%llu downgraded=%llu)",
+        queueResult, poolStats.queued, poolStats.running, poolStats.blocked, poolStats.merged, poolStats.downgraded);
+    if (!queueResult) {
+        // Draining for exit: nothing will write the file
+        DebugLog(L"  ERROR: Encode pool refused the save, %s not written", filename.c_str());
+        return false;
+    }
     
     DebugLog(L"  SaveCapture completed successfully");
     return true;
 }
 
+// BitBlt a screen rectangle into 'target' at column destX. Every call owns
+// its DCs and DIB, so several can run on different threads at once.
+static bool BlitToFrame(const FrameRef& target, int destX, const ScreenRect& source) {
+    HDC hdcScreen = GetDC(NULL);
+    if (!hdcScreen) return false;
+    HDC hdcMem = CreateCompatibleDC(hdcScreen);
+    HBITMAP hBitmap = hdcMem ? CreateFrameDIB(hdcScreen, target) : NULL;
+    
+    BOOL result = FALSE;
+    if (hBitmap) {
+        HBITMAP hOldBitmap = (HBITMAP)SelectObject(hdcMem, hBitmap);
+        result = BitBlt(hdcMem, target->Left() + destX, 0, source.width, source.height,
+                        hdcScreen, source.x, source.y, SRCCOPY | CAPTUREBLT);
+        GdiFlush();
+        SelectObject(hdcMem, hOldBitmap);
+        DeleteObject(hBitmap);
+    }
+    if (hdcMem) DeleteDC(hdcMem);
+    ReleaseDC(NULL, hdcScreen);
+    return result != FALSE;
+}
+
+// One thread per monitor. Stitched: each thread writes the monitor's rows
+// of the shared frame through its own full-width row-band view (row-aligned,
+// so the DIB stays inside the block). Separate: one pooled frame each.
+static bool CaptureMonitors(const MonitorLayout& layout, bool stitched, FrameRef& stitchedFrame,
+                            std::vector<FrameRef>& separateFrames) {
+    size_t count = layout.monitors.size();
+    std::vector<FrameRef> targets(count);
+    if (stitched) {
+        stitchedFrame = FramePool::Instance().Acquire(layout.bounds.width, layout.bounds.height);
+        if (!stitchedFrame) return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const ScreenRect& m = layout.monitors[i];
+        targets[i] = stitched ? FramePool::SubView(stitchedFrame, 0, m.y, layout.bounds.width, m.height)
+                              : FramePool::Instance().Acquire(m.width, m.height);
+        if (!targets[i]) return false;
+    }
+    
+    std::vector<char> ok(count, 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < count; i++) {
+        threads.emplace_back([&, i]() {
+            const ScreenRect& m = layout.monitors[i];
+            ScreenRect source = { layout.bounds.x + m.x, layout.bounds.y + m.y, m.width, m.height };
+            ok[i] = BlitToFrame(targets[i], stitched ? m.x : 0, source);
+        });
+    }
+    for (std::thread& t : threads) t.join();
+    
+    for (size_t i = 0; i < count; i++) {
+        DebugLog(L"  Monitor %zu: %d,%d %dx%d ok=%d", i + 1,
+            layout.monitors[i].x, layout.monitors[i].y, layout.monitors[i].width, layout.monitors[i].height, ok[i]);
+        if (!ok[i]) return false;
+    }
+    
+    if (stitched) {
+        // Constant black, as BitBlt of the bounding box produced there; such
+        // rows filter to zeros and deflate to almost nothing
+        FillDeadAreas(stitchedFrame->Bits(), stitchedFrame->Stride(), layout.deadAreas, 0);
+    } else {
+        separateFrames = targets;
+    }
+    return true;
+}
+
 bool CaptureFullScreen() {
     DebugLog(L"=== CaptureFullScreen ===");
-    RECT rect = GetVirtualScreenRect();
-    int width = rect.right - rect.left;
-    int height = rect.bottom - rect.top;
+    const Config& config = GetConfig();
+    std::vector<ScreenRect> monitors = EnumerateMonitors();
     
-    HBITMAP hBitmap = CaptureScreenArea(rect.left, rect.top, width, height);
-    return SaveCapture(hBitmap, L"FullScreen");
+    if (config.monitorMode == MonitorCaptureMode::Virtual || monitors.size() <= 1) {
+        RECT rect = GetVirtualScreenRect();
+        int width = rect.right - rect.left;
+        int height = rect.bottom - rect.top;
+        
+        FrameRef frame = CaptureScreenArea(rect.left, rect.top, width, height);
+        return SaveCapture(frame, L"FullScreen");
+    }
+    
+    MonitorLayout layout = BuildMonitorLayout(monitors);
+    bool stitched = config.monitorMode == MonitorCaptureMode::Stitched;
+    DebugLog(L"  %zu monitors, bounds %d,%d %dx%d, dead areas=%zu (%zu px), mode=%s",
+        layout.monitors.size(), layout.bounds.x, layout.bounds.y, layout.bounds.width, layout.bounds.height,
+        layout.deadAreas.size(), layout.DeadPixels(), stitched ? L"stitched" : L"separate");
+    
+    FrameRef stitchedFrame;
+    std::vector<FrameRef> frames;
+    if (!CaptureMonitors(layout, stitched, stitchedFrame, frames)) {
+        DebugLog(L"  ERROR: Monitor capture failed");
+        return false;
+    }
+    
+    if (stitched) {
+        return SaveCapture(stitchedFrame, L"FullScreen");
+    }
+    
+    // Separate files; the encode pool works on them in parallel
+    bool allSaved = true;
+    for (size_t i = 0; i < frames.size(); i++) {
+        allSaved = SaveCapture(frames[i], L"Monitor" + std::to_wstring(i + 1)) && allSaved;
+    }
+    return allSaved;
 }
 
 bool CaptureActiveWindow() {
@@ -184,18 +554,13 @@ bool CaptureActiveWindow() {
         return false;
     }
     
+    // Without the DWM shadow (Windows 10/11)
     RECT rect;
-    if (!GetWindowRect(hwnd, &rect)) {
+    if (!GetVisibleWindowRect(hwnd, &rect)) {
         DebugLog(L"  ERROR: GetWindowRect failed");
         return false;
     }
     
-    // Adjust for DWM shadow (Windows 10/11)
-    RECT frame = {};
-    if (SUCCEEDED(DwmGetWindowAttribute(hwnd, DWMWA_EXTENDED_FRAME_BOUNDS, &frame, sizeof(RECT)))) {
-        rect = frame;
-    }
-    
     int width = rect.right - rect.left;
     int height = rect.bottom - rect.top;
     
@@ -204,8 +569,8 @@ bool CaptureActiveWindow() {
         return false;
     }
     
-    HBITMAP hBitmap = CaptureScreenArea(rect.left, rect.top, width, height);
-    return SaveCapture(hBitmap, L"Window");
+    FrameRef frame = CaptureScreenArea(rect.left, rect.top, width, height);
+    return SaveCapture(frame, L"Window");
 }
 
 bool CaptureRegion(const RECT& rect) {
@@ -222,8 +587,21 @@ bool CaptureRegion(const RECT& rect) {
         return false;
     }
     
-    HBITMAP hBitmap = CaptureScreenArea(rect.left, rect.top, width, height);
-    return SaveCapture(hBitmap, L"Region");
+    FrameRef frame = CaptureScreenArea(rect.left, rect.top, width, height);
+    return SaveCapture(frame, L"Region");
+}
+
+bool CaptureRegionFromFrame(const FrameRef& region) {
+    DebugLog(L"=== CaptureRegionFromFrame ===");
+    
+    if (!region) {
+        DebugLog(L"  ERROR: No frozen frame");
+        return false;
+    }
+    
+    // No second screen grab: the view already holds the pixels
+    DebugLog(L"  Size: %dx%d (view=%d)", region->Width(), region->Height(), region->IsView());
+    return SaveCapture(region, L"Region");
 }
 
 } // namespace ScreenCapture
@@ -1,6 +1,9 @@
 #pragma once
 #include <windows.h>
 #include <string>
+#include "framepool.h"
+#include "encodepool.h"
+#include "framehash.h"
 
 namespace ScreenCapture {
 
@@ -19,10 +22,28 @@ bool CaptureActiveWindow();
 // Capture specific region
 bool CaptureRegion(const RECT& rect);
 
-// Internal: Capture screen area to HBITMAP
-HBITMAP CaptureScreenArea(int x, int y, int width, int height);
+// Save a region already cropped from the overlay's frozen frame
+bool CaptureRegionFromFrame(const FrameRef& region);
 
-// Save captured bitmap
-bool SaveCapture(HBITMAP hBitmap, const std::wstring& prefix);
+// Internal: Capture screen area into a pooled frame (warm session slot)
+FrameRef CaptureScreenArea(int x, int y, int width, int height);
+
+// Build the capture session and resolve save paths ahead of the first hotkey
+void WarmCaptureSession();
+
+// Drop session resources after a display change; rebuilt on next capture
+void InvalidateCaptureSession();
+
+// Save captured frame (encode runs on the bounded encode pool)
+bool SaveCapture(const FrameRef& frame, const std::wstring& prefix);
+
+// Shared encode pool used by every save path (created on first use)
+EncodePool& GetEncodePool();
+
+// Duplicate-capture counters (encodes skipped, bytes avoided)
+DuplicateStats GetDuplicateStats();
+
+// Finish every queued save; call once before the process exits
+void ShutdownCapture();
 
 } // namespace ScreenCapture
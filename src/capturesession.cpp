@@ -0,0 +1,258 @@
+#include "capturesession.h"
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#include "utils.h"
+#endif
+
+namespace ScreenCapture {
+
+static double MsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// ---------------------------------------------------------------------------
+// Backends
+
+#ifdef _WIN32
+namespace {
+
+class GdiBackend : public CaptureBackend {
+public:
+    GdiBackend() : m_hdcScreen(NULL), m_hdcMem(NULL) {}
+    ~GdiBackend() { Close(); }
+
+    const char* Name() const override { return "gdi"; }
+
+    bool Open() override {
+        m_hdcScreen = GetDC(NULL);
+        m_hdcMem = m_hdcScreen ? CreateCompatibleDC(m_hdcScreen) : NULL;
+        return m_hdcMem != NULL;
+    }
+
+    void Close() override {
+        if (m_hdcMem) DeleteDC(m_hdcMem);
+        if (m_hdcScreen) ReleaseDC(NULL, m_hdcScreen);
+        m_hdcMem = NULL;
+        m_hdcScreen = NULL;
+    }
+
+    void* AttachTarget(const FrameRef& frame) override {
+        return m_hdcScreen ? CreateFrameDIB(m_hdcScreen, frame) : NULL;
+    }
+
+    void DetachTarget(void* target) override {
+        if (target) DeleteObject((HBITMAP)target);
+    }
+
+    bool Grab(void* target, int x, int y, int width, int height) override {
+        HBITMAP hOldBitmap = (HBITMAP)SelectObject(m_hdcMem, (HBITMAP)target);
+        BOOL result = BitBlt(m_hdcMem, 0, 0, width, height, m_hdcScreen, x, y, SRCCOPY | CAPTUREBLT);
+        GdiFlush();
+        SelectObject(m_hdcMem, hOldBitmap);
+        return result != FALSE;
+    }
+
+private:
+    HDC m_hdcScreen;
+    HDC m_hdcMem;
+};
+
+} // namespace
+
+std::unique_ptr<CaptureBackend> CreateGdiBackend() {
+    return std::unique_ptr<CaptureBackend>(new GdiBackend());
+}
+#endif
+
+namespace {
+
+// Desktop made of flat panels and text-like noise. The image is generated
+// once per size and shared, so Open() costs what a real backend's would.
+class SyntheticBackend : public CaptureBackend {
+public:
+    SyntheticBackend(int width, int height) : m_width(width), m_height(height) {}
+
+    const char* Name() const override { return "synthetic"; }
+
+    bool Open() override {
+        static std::mutex mutex;
+        static FrameRef shared;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!shared || shared->Width() != m_width || shared->Height() != m_height) {
+            shared = Generate(m_width, m_height);
+        }
+        m_desktop = shared;
+        return m_desktop != nullptr;
+    }
+
+    void Close() override {
+        m_desktop = nullptr;
+    }
+
+    // The target must not own a reference: the session tells free slots
+    // apart by use_count()
+    void* AttachTarget(const FrameRef& frame) override {
+        return frame.get();
+    }
+
+    void DetachTarget(void*) override {
+    }
+
+    bool Grab(void* target, int x, int y, int width, int height) override {
+        FrameBuffer* frame = (FrameBuffer*)target;
+        if (!m_desktop || x < 0 || y < 0 || x + width > m_width || y + height > m_height) return false;
+        for (int row = 0; row < height; row++) {
+            memcpy(frame->Row(row), m_desktop->Row(y + row) + (size_t)x * 4, (size_t)width * 4);
+        }
+        return true;
+    }
+
+private:
+    static FrameRef Generate(int width, int height) {
+        FrameRef desktop = FramePool::Instance().Acquire(width, height);
+        if (!desktop) return nullptr;
+        uint32_t seed = 12345;
+        for (int y = 0; y < height; y++) {
+            uint32_t* row = (uint32_t*)desktop->Row(y);
+            for (int x = 0; x < width; x++) {
+                uint32_t panel = 0xFF202020u + (uint32_t)(((x / 240) + (y / 160)) % 4) * 0x00303030u;
+                seed = seed * 1664525u + 1013904223u;
+                row[x] = ((y % 24) < 14 && (seed >> 28) == 0) ? 0xFF000000u : panel;
+            }
+        }
+        return desktop;
+    }
+
+    int m_width;
+    int m_height;
+    FrameRef m_desktop;
+};
+
+} // namespace
+
+std::unique_ptr<CaptureBackend> CreateSyntheticBackend(int width, int height) {
+    return std::unique_ptr<CaptureBackend>(new SyntheticBackend(width, height));
+}
+
+// ---------------------------------------------------------------------------
+// Session
+
+CaptureSession::CaptureSession(std::unique_ptr<CaptureBackend> backend, int width, int height, int slots)
+    : m_backend(std::move(backend)), m_width(width), m_height(height)
+    , m_warmSlots(slots < 1 ? 1 : (slots > MAX_SLOTS ? MAX_SLOTS : slots))
+    , m_built(false), m_stats() {
+}
+
+CaptureSession::~CaptureSession() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ReleaseLocked();
+}
+
+void CaptureSession::ReleaseLocked() {
+    // Targets are detached even if a caller still holds the frame: the
+    // pixels are in the pooled block, the target was only a view of them
+    for (Slot& slot : m_slots) {
+        m_backend->DetachTarget(slot.target);
+    }
+    m_slots.clear();
+    if (m_built) {
+        m_backend->Close();
+    }
+    m_built = false;
+}
+
+bool CaptureSession::BuildLocked() {
+    ReleaseLocked();
+    if (!m_backend->Open()) return false;
+    m_built = true;
+    m_stats.builds++;
+
+    for (int i = 0; i < m_warmSlots; i++) {
+        if (!AddSlot()) break;
+    }
+    return true;
+}
+
+bool CaptureSession::AddSlot() {
+    Slot slot;
+    slot.frame = FramePool::Instance().Acquire(m_width, m_height);
+    slot.target = slot.frame ? m_backend->AttachTarget(slot.frame) : nullptr;
+    if (!slot.target) return false;
+    slot.charge = MemoryGovernor::Instance().Charge(MemoryStage::Session,
+                                                    (size_t)slot.frame->Stride() * slot.frame->Height());
+    m_slots.push_back(std::move(slot));
+    return true;
+}
+
+bool CaptureSession::Build() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return BuildLocked();
+}
+
+void CaptureSession::Invalidate() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ReleaseLocked();
+}
+
+void CaptureSession::Resize(int width, int height) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (width == m_width && height == m_height) return;
+    ReleaseLocked();
+    m_width = width;
+    m_height = height;
+}
+
+FrameRef CaptureSession::CaptureCold(int x, int y, int width, int height) {
+    FrameRef frame = FramePool::Instance().Acquire(width, height);
+    void* target = frame ? m_backend->AttachTarget(frame) : nullptr;
+    if (!target) return nullptr;
+    bool ok = m_backend->Grab(target, x, y, width, height);
+    m_backend->DetachTarget(target);
+    m_stats.cold++;
+    return ok ? frame : nullptr;
+}
+
+FrameRef CaptureSession::Capture(int x, int y, int width, int height) {
+    auto start = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (width <= 0 || height <= 0) return nullptr;
+    if (!m_built && !BuildLocked()) return nullptr;
+
+    // Warm path: a free slot large enough for the request
+    Slot* slot = nullptr;
+    if (width <= m_width && height <= m_height) {
+        for (Slot& candidate : m_slots) {
+            if (candidate.frame.use_count() == 1) {
+                slot = &candidate;
+                break;
+            }
+        }
+        // Every slot still referenced (open previews, queued saves): grow
+        if (!slot && (int)m_slots.size() < MAX_SLOTS && AddSlot()) {
+            slot = &m_slots.back();
+        }
+    }
+
+    FrameRef result;
+    auto grabStart = std::chrono::steady_clock::now();
+    if (slot) {
+        if (m_backend->Grab(slot->target, x, y, width, height)) {
+            result = FramePool::SubView(slot->frame, 0, 0, width, height);
+        }
+        m_stats.warm++;
+    } else {
+        result = CaptureCold(x, y, width, height);
+    }
+    m_stats.lastGrabMs = MsSince(grabStart);
+    m_stats.lastTotalMs = MsSince(start);
+    return result;
+}
+
+CaptureSessionStats CaptureSession::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+} // namespace ScreenCapture
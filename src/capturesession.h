@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "framepool.h"
+#include "memorygovernor.h"
+
+namespace ScreenCapture {
+
+// Where pixels come from. A backend keeps its expensive handles (screen DC,
+// memory DC, ...) between captures and can attach per-target state (a DIB
+// section over the frame) that lives as long as the target does.
+class CaptureBackend {
+public:
+    virtual ~CaptureBackend() {}
+
+    virtual const char* Name() const = 0;
+
+    // Acquire / release long-lived resources
+    virtual bool Open() = 0;
+    virtual void Close() = 0;
+
+    // Per-target state, created once for each warm slot. Must not keep a
+    // reference to the frame (free slots are found by use_count()).
+    virtual void* AttachTarget(const FrameRef& frame) = 0;
+    virtual void DetachTarget(void* target) = 0;
+
+    // Copy the desktop rectangle (x, y, width, height) to the top-left of the target
+    virtual bool Grab(void* target, int x, int y, int width, int height) = 0;
+};
+
+#ifdef _WIN32
+// BitBlt (with CAPTUREBLT) from the screen DC
+std::unique_ptr<CaptureBackend> CreateGdiBackend();
+#endif
+
+// Deterministic in-memory "desktop" of the given size (benchmarks, tools)
+std::unique_ptr<CaptureBackend> CreateSyntheticBackend(int width, int height);
+
+struct CaptureSessionStats {
+    uint64_t builds;      // Times the session (re)opened its backend
+    uint64_t warm;        // Captures served by a warm slot
+    uint64_t cold;        // Captures that needed a fresh frame + target
+    double lastGrabMs;
+    double lastTotalMs;   // Including any rebuild / cold setup
+};
+
+// Long-lived capture state: an open backend plus a few pre-faulted,
+// pre-attached target frames sized for the whole desktop. A capture grabs
+// into a free slot and returns a sub-view of it, so the hot path does no
+// allocation and no handle creation. The slot is free again once every
+// reference to the returned frame is gone. Slots are charged to the memory
+// governor (MemoryStage::Session) for as long as the session keeps them.
+class CaptureSession {
+public:
+    CaptureSession(std::unique_ptr<CaptureBackend> backend, int width, int height, int slots);
+    ~CaptureSession();
+
+    // Next capture rebuilds (display or config change)
+    void Invalidate();
+
+    // Open the backend and warm the slots now instead of on first capture
+    bool Build();
+
+    FrameRef Capture(int x, int y, int width, int height);
+
+    // Desktop size the slots are built for
+    void Resize(int width, int height);
+
+    CaptureSessionStats GetStats() const;
+    const char* BackendName() const { return m_backend->Name(); }
+
+    static const int MAX_SLOTS = 4;
+
+private:
+    struct Slot {
+        FrameRef frame;
+        void* target;
+        MemoryCharge charge;  // The whole slot, whatever is captured into it
+    };
+
+    bool BuildLocked();
+    void ReleaseLocked();
+    bool AddSlot();
+    FrameRef CaptureCold(int x, int y, int width, int height);
+
+    mutable std::mutex m_mutex;
+    std::unique_ptr<CaptureBackend> m_backend;
+    std::vector<Slot> m_slots;
+    int m_width;
+    int m_height;
+    int m_warmSlots;
+    bool m_built;
+    CaptureSessionStats m_stats;
+};
+
+} // namespace ScreenCapture
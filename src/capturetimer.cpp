@@ -0,0 +1,212 @@
+#include "capturetimer.h"
+#include <chrono>
+
+namespace ScreenCapture {
+
+// Sleep on the condition variable until this close to the deadline, then
+// yield: OS sleeps overshoot by up to a scheduler quantum
+static const int64_t SPIN_WINDOW_US = 2000;
+
+int64_t SteadyTimerClock::NowUs() const {
+    return (int64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void SteadyTimerClock::SleepUntilUs(int64_t deadlineUs) {
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        int64_t coarse = deadlineUs - SPIN_WINDOW_US;
+        if (coarse > NowUs()) {
+            std::chrono::steady_clock::time_point wake{std::chrono::microseconds(coarse)};
+            m_wake.wait_until(lock, wake, [this] { return m_interrupted; });
+        }
+        if (m_interrupted) return;
+    }
+    while (NowUs() < deadlineUs) {
+        std::this_thread::yield();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_interrupted) return;
+    }
+}
+
+void SteadyTimerClock::SetInterrupted(bool interrupted) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_interrupted = interrupted;
+    m_wake.notify_all();
+}
+
+LatencyHistogram::LatencyHistogram() : m_buckets(), m_count(0), m_sum(0), m_max(0) {
+}
+
+void LatencyHistogram::Add(int64_t us) {
+    if (us < 0) us = 0;
+    int bucket = 0;
+    while (bucket < BUCKETS - 1 && us >= ((int64_t)1 << bucket)) bucket++;
+    m_buckets[bucket]++;
+    m_count++;
+    m_sum += us;
+    if (us > m_max) m_max = us;
+}
+
+int64_t LatencyHistogram::PercentileUs(double fraction) const {
+    if (!m_count) return 0;
+    uint64_t target = (uint64_t)(fraction * (double)m_count + 0.5);
+    if (target < 1) target = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += m_buckets[i];
+        if (seen >= target) return i == BUCKETS - 1 || BucketUpperUs(i) > m_max ? m_max : BucketUpperUs(i);
+    }
+    return m_max;
+}
+
+CaptureTimer::CaptureTimer(CaptureSession& session, TimerClock& clock)
+    : m_session(session), m_clock(clock), m_options(), m_mailbox(),
+      m_mailboxFull(false), m_ticking(false), m_consuming(false), m_stopping(false), m_stats() {
+}
+
+CaptureTimer::~CaptureTimer() {
+    Stop();
+}
+
+bool CaptureTimer::Start(const TimedCaptureOptions& options, Consumer consumer) {
+    if (options.intervalUs <= 0 || options.width <= 0 || options.height <= 0 || !consumer) return false;
+    Stop();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_options = options;
+    m_consumer = consumer;
+    m_mailbox = TimedFrame();
+    m_mailboxFull = false;
+    m_ticking = true;
+    m_consuming = true;
+    m_stopping = false;
+    m_stats = CaptureTimerStats();
+    m_clock.SetInterrupted(false);
+    m_consumeThread = std::thread(&CaptureTimer::ConsumeLoop, this);
+    m_tickThread = std::thread(&CaptureTimer::TickLoop, this);
+    return true;
+}
+
+void CaptureTimer::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_mailboxReady.notify_all();
+    }
+    m_clock.SetInterrupted(true);
+    if (m_tickThread.joinable()) m_tickThread.join();
+    if (m_consumeThread.joinable()) m_consumeThread.join();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_mailbox = TimedFrame();  // Return an undelivered frame to the session
+    m_mailboxFull = false;
+}
+
+void CaptureTimer::Wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_mailboxReady.wait(lock, [this] { return !m_ticking && !m_consuming; });
+}
+
+bool CaptureTimer::Running() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_ticking || m_consuming;
+}
+
+CaptureTimerStats CaptureTimer::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void CaptureTimer::TickLoop() {
+    const int64_t interval = m_options.intervalUs;
+    const int64_t start = m_clock.NowUs();
+    uint64_t tick = 0;
+    bool haveLast = false;
+    uint64_t lastTick = 0;
+    int64_t lastCaptureUs = 0;
+
+    for (;;) {
+        int64_t due = (int64_t)tick * interval;
+        if (m_options.durationUs > 0 && due >= m_options.durationUs) break;
+
+        m_clock.SleepUntilUs(start + due);
+        int64_t now = m_clock.NowUs() - start;
+
+        // A whole slot went by (suspend, a long grab): resume at the current
+        // slot instead of firing the missed ones back to back
+        if (now >= due + interval) {
+            uint64_t current = (uint64_t)(now / interval);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.missed += current - tick;
+            tick = current;
+            due = (int64_t)tick * interval;
+        }
+        if (m_options.durationUs > 0 && due >= m_options.durationUs) break;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stopping) break;
+            m_stats.ticks++;
+            if (m_mailboxFull && m_options.behind == BehindPolicy::Skip) {
+                m_stats.skippedBusy++;
+                tick++;
+                continue;
+            }
+        }
+
+        FrameRef frame = m_session.Capture(m_options.x, m_options.y, m_options.width, m_options.height);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.lateness.Add(now - due);
+        if (!frame) {
+            m_stats.failed++;
+            tick++;
+            continue;
+        }
+        m_stats.captured++;
+        if (haveLast) {
+            int64_t spacing = now - lastCaptureUs;
+            int64_t nominal = (int64_t)(tick - lastTick) * interval;
+            m_stats.jitter.Add(spacing > nominal ? spacing - nominal : nominal - spacing);
+        }
+        haveLast = true;
+        lastTick = tick;
+        lastCaptureUs = now;
+
+        if (m_mailboxFull) m_stats.merged++;  // Merge policy: the newer frame wins
+        m_mailbox.frame = frame;
+        m_mailbox.tick = tick;
+        m_mailbox.scheduledUs = due;
+        m_mailbox.capturedUs = now;
+        m_mailboxFull = true;
+        m_mailboxReady.notify_all();
+        tick++;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ticking = false;
+    m_mailboxReady.notify_all();
+}
+
+void CaptureTimer::ConsumeLoop() {
+    for (;;) {
+        TimedFrame item;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_mailboxReady.wait(lock, [this] { return m_mailboxFull || !m_ticking || m_stopping; });
+            if (m_stopping || !m_mailboxFull) break;
+            item = m_mailbox;
+            m_mailbox = TimedFrame();
+            m_mailboxFull = false;
+            m_stats.delivered++;
+        }
+        m_consumer(item);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_consuming = false;
+    m_mailboxReady.notify_all();
+}
+
+} // namespace ScreenCapture
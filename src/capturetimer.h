@@ -0,0 +1,162 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "capturesession.h"
+
+namespace ScreenCapture {
+
+// Monotonic microsecond time base for CaptureTimer. Injectable so the
+// schedule can be driven by a fake clock in tests.
+class TimerClock {
+public:
+    virtual ~TimerClock() {}
+    virtual int64_t NowUs() const = 0;
+    // Return at (or as soon as possible after) 'deadlineUs', or early while
+    // interrupted
+    virtual void SleepUntilUs(int64_t deadlineUs) = 0;
+    virtual void SetInterrupted(bool interrupted) = 0;
+};
+
+// steady_clock (QueryPerformanceCounter on Windows). Sleeps coarsely until
+// ~2 ms before the deadline, then yields; pair with timeBeginPeriod(1) on
+// Windows for a 1 ms sleep granularity.
+class SteadyTimerClock : public TimerClock {
+public:
+    SteadyTimerClock() : m_interrupted(false) {}
+    int64_t NowUs() const override;
+    void SleepUntilUs(int64_t deadlineUs) override;
+    void SetInterrupted(bool interrupted) override;
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_interrupted;
+};
+
+// Simulated time for single-threaded simulations: sleeping jumps straight
+// to the deadline
+class ManualTimerClock : public TimerClock {
+public:
+    explicit ManualTimerClock(int64_t startUs = 0) : m_nowUs(startUs) {}
+    int64_t NowUs() const override { return m_nowUs; }
+    void SleepUntilUs(int64_t deadlineUs) override { if (deadlineUs > m_nowUs) m_nowUs = deadlineUs; }
+    void SetInterrupted(bool) override {}
+    void Advance(int64_t us) { m_nowUs += us; }
+
+private:
+    int64_t m_nowUs;
+};
+
+// Log2-bucketed microsecond histogram: bucket 0 holds 0 us, bucket i holds
+// [2^(i-1), 2^i) us, the last bucket everything longer
+class LatencyHistogram {
+public:
+    static const int BUCKETS = 26;  // Up to ~33 s
+
+    LatencyHistogram();
+    void Add(int64_t us);
+
+    uint64_t Count() const { return m_count; }
+    int64_t Max() const { return m_max; }
+    double MeanUs() const { return m_count ? (double)m_sum / (double)m_count : 0.0; }
+    // Upper bound of the bucket holding the given fraction (0..1) of
+    // samples, capped at Max()
+    int64_t PercentileUs(double fraction) const;
+    uint64_t Bucket(int index) const { return m_buckets[index]; }
+    // Exclusive upper bound of a bucket
+    static int64_t BucketUpperUs(int index) { return (int64_t)1 << index; }
+
+private:
+    uint64_t m_buckets[BUCKETS];
+    uint64_t m_count;
+    int64_t m_sum;
+    int64_t m_max;
+};
+
+// What a tick does when the consumer still has not taken the last frame
+enum class BehindPolicy {
+    Skip,   // Do not capture; the consumer finishes what it has
+    Merge   // Capture and replace the waiting frame (the newest wins)
+};
+
+struct TimedCaptureOptions {
+    int x, y, width, height;  // Desktop rectangle
+    int64_t intervalUs;
+    int64_t durationUs;       // 0 = until Stop()
+    BehindPolicy behind;
+};
+
+struct TimedFrame {
+    FrameRef frame;
+    uint64_t tick;          // Schedule slot: due at start + tick * interval
+    int64_t scheduledUs;    // Relative to start
+    int64_t capturedUs;     // Relative to start (when the grab began)
+};
+
+struct CaptureTimerStats {
+    uint64_t ticks;         // Schedule slots that came due
+    uint64_t captured;
+    uint64_t delivered;     // Handed to the consumer
+    uint64_t missed;        // Slots that passed entirely while the timer was late
+    uint64_t skippedBusy;   // Skip policy: slots not captured, a frame still waits
+    uint64_t merged;        // Merge policy: waiting frames replaced
+    uint64_t failed;        // Captures that returned no frame
+    LatencyHistogram lateness;  // Grab start - scheduled time
+    LatencyHistogram jitter;    // |actual spacing - nominal spacing| between captures
+};
+
+// "Capture every N ms for M minutes". Ticks are scheduled at absolute
+// times start + k * interval, so a late tick does not push later ones back
+// (no drift); when a whole slot has passed the timer jumps to the next
+// future slot instead of bursting to catch up. Captures go through a
+// CaptureSession, so the synthetic backend can measure accuracy headless.
+//
+// Frames reach 'consumer' on a separate thread through a one-frame
+// mailbox; when the consumer (typically an encoder) falls behind, the
+// BehindPolicy decides between skipping ticks and replacing the frame.
+class CaptureTimer {
+public:
+    typedef std::function<void(TimedFrame&)> Consumer;
+
+    CaptureTimer(CaptureSession& session, TimerClock& clock);
+    ~CaptureTimer();
+
+    bool Start(const TimedCaptureOptions& options, Consumer consumer);
+
+    // Stop ticking, deliver nothing more, join both threads
+    void Stop();
+
+    // Block until the configured duration has elapsed and the last frame
+    // was consumed (never returns for durationUs = 0 unless Stop() is called
+    // from another thread)
+    void Wait();
+
+    bool Running() const;
+    CaptureTimerStats GetStats() const;
+
+private:
+    void TickLoop();
+    void ConsumeLoop();
+
+    CaptureSession& m_session;
+    TimerClock& m_clock;
+    TimedCaptureOptions m_options;
+    Consumer m_consumer;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_mailboxReady;
+    TimedFrame m_mailbox;
+    bool m_mailboxFull;
+    bool m_ticking;
+    bool m_consuming;
+    bool m_stopping;
+    CaptureTimerStats m_stats;
+
+    std::thread m_tickThread;
+    std::thread m_consumeThread;
+};
+
+} // namespace ScreenCapture
@@ -0,0 +1,124 @@
+#include "config.h"
+#include <thread>
+
+namespace ScreenCapture {
+
+static Config g_config;
+static bool g_configLoaded = false;
+static unsigned g_configGeneration = 0;
+
+std::wstring GetConfigPath() {
+    wchar_t exePath[MAX_PATH];
+    GetModuleFileNameW(NULL, exePath, MAX_PATH);
+    std::wstring path = exePath;
+    size_t lastSlash = path.find_last_of(L"\\/");
+    if (lastSlash != std::wstring::npos) {
+        path = path.substr(0, lastSlash);
+    }
+    return path + L"\\ScreenCapture.ini";
+}
+
+static BackpressurePolicy ParseBackpressure(const wchar_t* value) {
+    if (_wcsicmp(value, L"block") == 0) return BackpressurePolicy::Block;
+    if (_wcsicmp(value, L"merge") == 0) return BackpressurePolicy::Merge;
+    return BackpressurePolicy::FastPreset;
+}
+
+static DuplicateMode ParseDuplicateMode(const wchar_t* value) {
+    if (_wcsicmp(value, L"off") == 0) return DuplicateMode::Off;
+    if (_wcsicmp(value, L"reference") == 0) return DuplicateMode::Reference;
+    return DuplicateMode::HardLink;
+}
+
+static BehindPolicy ParseBehindPolicy(const wchar_t* value) {
+    if (_wcsicmp(value, L"merge") == 0) return BehindPolicy::Merge;
+    return BehindPolicy::Skip;
+}
+
+static MonitorCaptureMode ParseMonitorMode(const wchar_t* value) {
+    if (_wcsicmp(value, L"separate") == 0) return MonitorCaptureMode::Separate;
+    if (_wcsicmp(value, L"virtual") == 0) return MonitorCaptureMode::Virtual;
+    return MonitorCaptureMode::Stitched;
+}
+
+const Config& ReloadConfig() {
+    std::wstring ini = GetConfigPath();
+    const wchar_t* file = ini.c_str();
+    
+    int threads = (int)GetPrivateProfileIntW(L"Encode", L"Threads", 2, file);
+    if (threads <= 0) {
+        int cores = (int)std::thread::hardware_concurrency();
+        threads = cores > 1 ? cores - 1 : 1;
+    }
+    if (threads > 4) threads = 4;
+    g_config.encodeThreads = threads;
+    
+    int capacity = (int)GetPrivateProfileIntW(L"Encode", L"QueueCapacity", 4, file);
+    g_config.encodeQueueCapacity = capacity > 0 ? capacity : 1;
+    
+    wchar_t policy[32];
+    GetPrivateProfileStringW(L"Encode", L"Backpressure", L"fast", policy, 32, file);
+    g_config.backpressure = ParseBackpressure(policy);
+    
+    int fps = (int)GetPrivateProfileIntW(L"Burst", L"Fps", 15, file);
+    g_config.burstFps = fps < 1 ? 1 : (fps > 120 ? 120 : fps);
+    int ring = (int)GetPrivateProfileIntW(L"Burst", L"RingFrames", 32, file);
+    g_config.burstRingFrames = ring < 2 ? 2 : ring;
+    int ringMB = (int)GetPrivateProfileIntW(L"Burst", L"RingMB", 256, file);
+    g_config.burstRingBytes = (size_t)(ringMB < 16 ? 16 : ringMB) * 1024 * 1024;
+    int maxSeconds = (int)GetPrivateProfileIntW(L"Burst", L"MaxSeconds", 10, file);
+    g_config.burstMaxSeconds = maxSeconds < 1 ? 1 : maxSeconds;
+    g_config.burstEncodeDuring = GetPrivateProfileIntW(L"Burst", L"EncodeDuring", 1, file) != 0;
+    
+    int recordFps = (int)GetPrivateProfileIntW(L"Record", L"Fps", 30, file);
+    g_config.recordFps = recordFps < 1 ? 1 : (recordFps > 60 ? 60 : recordFps);
+    int tileSize = (int)GetPrivateProfileIntW(L"Record", L"TileSize", 64, file);
+    g_config.recordTileSize = tileSize < 16 ? 16 : (tileSize > 256 ? 256 : tileSize);
+    
+    wchar_t duplicates[32];
+    GetPrivateProfileStringW(L"Duplicates", L"Mode", L"hardlink", duplicates, 32, file);
+    g_config.duplicateMode = ParseDuplicateMode(duplicates);
+    int recent = (int)GetPrivateProfileIntW(L"Duplicates", L"Recent", 16, file);
+    g_config.duplicateRecent = recent < 1 ? 1 : (recent > 256 ? 256 : recent);
+    
+    wchar_t monitors[32];
+    GetPrivateProfileStringW(L"Capture", L"Monitors", L"stitched", monitors, 32, file);
+    g_config.monitorMode = ParseMonitorMode(monitors);
+    
+    int ceilingMB = (int)GetPrivateProfileIntW(L"Memory", L"CeilingMB", 512, file);
+    g_config.memoryCeiling = ceilingMB <= 0 ? 0 : (size_t)ceilingMB * 1024 * 1024;
+    
+    int intervalMs = (int)GetPrivateProfileIntW(L"Timed", L"IntervalMs", 1000, file);
+    g_config.timedIntervalMs = intervalMs < 10 ? 10 : intervalMs;
+    int minutes = (int)GetPrivateProfileIntW(L"Timed", L"Minutes", 10, file);
+    g_config.timedMinutes = minutes < 0 ? 0 : minutes;
+    wchar_t behind[32];
+    GetPrivateProfileStringW(L"Timed", L"WhenBehind", L"skip", behind, 32, file);
+    g_config.timedBehind = ParseBehindPolicy(behind);
+    
+    int loupeZoom = (int)GetPrivateProfileIntW(L"Overlay", L"LoupeZoom", 8, file);
+    g_config.overlayLoupeZoom = loupeZoom <= 0 ? 0 : (loupeZoom < 2 ? 2 : (loupeZoom > 16 ? 16 : loupeZoom));
+    int snapDistance = (int)GetPrivateProfileIntW(L"Overlay", L"SnapDistance", 8, file);
+    g_config.overlaySnapDistance = snapDistance < 0 ? 0 : (snapDistance > 64 ? 64 : snapDistance);
+    g_config.overlayPickWindows = GetPrivateProfileIntW(L"Overlay", L"PickWindows", 1, file) != 0;
+    g_config.overlayRecordInput = GetPrivateProfileIntW(L"Overlay", L"RecordInput", 0, file) != 0;
+    g_config.overlaySelectionStats = GetPrivateProfileIntW(L"Overlay", L"SelectionStats", 0, file) != 0;
+    
+    g_configLoaded = true;
+    g_configGeneration++;
+    return g_config;
+}
+
+const Config& GetConfig() {
+    if (!g_configLoaded) {
+        return ReloadConfig();
+    }
+    return g_config;
+}
+
+unsigned GetConfigGeneration() {
+    GetConfig();
+    return g_configGeneration;
+}
+
+} // namespace ScreenCapture
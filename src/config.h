@@ -0,0 +1,127 @@
+#pragma once
+#include <windows.h>
+#include <string>
+#include "encodepool.h"
+#include "capturetimer.h"
+
+namespace ScreenCapture {
+
+// User settings from ScreenCapture.ini next to the exe. Every key is
+// optional; missing keys keep the defaults below.
+//
+//   [Encode]
+//   Threads=2              ; encode worker threads (0 = cores - 1, max 4)
+//   QueueCapacity=4        ; queued saves before backpressure kicks in
+//   Backpressure=fast      ; block | merge | fast (merge: a capture with the
+//                          ; same pixels as a queued one is linked to its file
+//                          ; instead of encoded, full queue or not)
+//
+//   [Burst]
+//   Fps=15                 ; target capture rate while the burst hotkey is held
+//   RingFrames=32          ; preallocated frame slots, at most
+//   RingMB=256             ; byte budget of the ring (also kept under the
+//                          ; [Memory] ceiling); fewer slots for large screens
+//   MaxSeconds=10          ; safety stop
+//   EncodeDuring=1         ; 1 = encode on spare pool slots while capturing,
+//                          ; 0 = encode only after the burst ends
+//
+//   [Record]
+//   Fps=30                 ; screen recording frame rate
+//   TileSize=64            ; tile edge in pixels (16..256)
+//
+//   [Duplicates]
+//   Mode=hardlink          ; hardlink | reference | off - what to do when a
+//                          ; capture is pixel-identical to a recent one
+//   Recent=16              ; saved captures remembered for matching
+//
+//   [Capture]
+//   Monitors=stitched      ; stitched | separate | virtual - full-screen
+//                          ; capture of several monitors: one image with the
+//                          ; areas outside every monitor filled, one file per
+//                          ; monitor, or the raw virtual-screen bounding box
+//
+//   [Memory]
+//   CeilingMB=512          ; bytes held by in-flight captures (queued frames,
+//                          ; encoder, previews, burst ring, warm capture
+//                          ; slots); above 3/4 new saves use the fast preset,
+//                          ; above the ceiling raw frames are parked in a
+//                          ; temp file until encoded. 0 = no limit
+//
+//   [Timed]
+//   IntervalMs=1000        ; timed capture (tray): one full-screen PNG per interval
+//   Minutes=10             ; run length (0 = until stopped from the tray)
+//   WhenBehind=skip        ; skip | merge - a tick that finds the previous frame
+//                          ; still waiting for the encoder is skipped, or its
+//                          ; frame replaces the waiting one
+//
+//   [Overlay]
+//   LoupeZoom=8            ; magnifier beside the cursor while selecting a
+//                          ; region (2..16, 0 = off)
+//   SnapDistance=8         ; selection corners snap to window borders and
+//                          ; UI edges this close, in pixels (0 = off; hold
+//                          ; Alt to place freely)
+//   PickWindows=1          ; before dragging, the window or control under the
+//                          ; cursor is highlighted and a click captures it
+//                          ; (Ctrl = its whole top-level window; 0 = off)
+//   RecordInput=0          ; 1 = save each session's mouse/keyboard input to
+//                          ; overlay_input_<time>.trace for tools/overlayreplay
+//   SelectionStats=0       ; 1 = the size label also shows the selection's
+//                          ; mean color and luma mean/deviation (20 bytes
+//                          ; of tables per screen pixel)
+enum class DuplicateMode {
+    Off,        // Always encode
+    HardLink,   // New file name, hard link (or copy) of the existing file
+    Reference   // No new file; the capture resolves to the existing one
+};
+
+enum class MonitorCaptureMode {
+    Stitched,
+    Separate,
+    Virtual
+};
+
+struct Config {
+    int encodeThreads;
+    int encodeQueueCapacity;
+    BackpressurePolicy backpressure;
+    
+    int burstFps;
+    int burstRingFrames;
+    size_t burstRingBytes;
+    int burstMaxSeconds;
+    bool burstEncodeDuring;
+    
+    int recordFps;
+    int recordTileSize;
+    
+    DuplicateMode duplicateMode;
+    int duplicateRecent;
+    
+    MonitorCaptureMode monitorMode;
+    
+    size_t memoryCeiling;  // Bytes, 0 = unlimited
+    
+    int timedIntervalMs;
+    int timedMinutes;      // 0 = until stopped
+    BehindPolicy timedBehind;
+    
+    int overlayLoupeZoom;  // 0 = no loupe
+    int overlaySnapDistance;  // 0 = no snapping
+    bool overlayPickWindows;
+    bool overlayRecordInput;
+    bool overlaySelectionStats;
+};
+
+// Loaded on first use
+const Config& GetConfig();
+
+// Re-read the ini file (returns the new settings)
+const Config& ReloadConfig();
+
+// Bumped by every (re)load, so long-lived state can notice config changes
+unsigned GetConfigGeneration();
+
+// Full path of the ini file
+std::wstring GetConfigPath();
+
+} // namespace ScreenCapture
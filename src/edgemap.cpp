@@ -0,0 +1,183 @@
+#include "edgemap.h"
+#include "pixelconvert.h"
+#include "taskscheduler.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+namespace ScreenCapture {
+
+// Work units: rows per band for the row pass, columns per strip for the
+// column pass (a strip's run state stays in L1)
+static const int BAND_ROWS = 32;
+static const int STRIP_COLUMNS = 256;
+
+EdgeMap::EdgeMap() : m_width(0), m_height(0), m_originX(0), m_originY(0), m_stats() {
+}
+
+void EdgeMap::Clear() {
+    m_width = 0;
+    m_height = 0;
+    m_rowOffsets.clear();
+    m_rowColumns.clear();
+    m_columnOffsets.clear();
+    m_columnRows.clear();
+    m_stats = EdgeMapStats();
+}
+
+bool EdgeMap::Build(const uint8_t* pixels, int stride, int width, int height, const EdgeMapOptions& options) {
+    Clear();
+    if (!pixels || width <= 0 || height <= 0 || width > 65535 || height > 65535) return false;
+    const int threshold = std::max(1, options.threshold);
+    const int minRun = std::max(1, options.minRun);
+
+    // Luma plane (BT.601, same weights as Gray8 captures)
+    std::vector<uint8_t> luma((size_t)width * height);
+    RowConverter toGray = GetRowConverter(PixelFormat::BGRX, PixelFormat::Gray8);
+    ParallelFor(0, height, 64, [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++) toGray(pixels + (size_t)y * stride, &luma[(size_t)y * width], width);
+    });
+
+    // Horizontal edges: boundaries between rows y - 1 and y, runs along x.
+    // Bands write their own lists, so joined in band order they are sorted
+    // by row.
+    const int bands = (height + BAND_ROWS - 1) / BAND_ROWS;
+    std::vector<std::vector<Run>> bandRuns(bands);
+    ParallelFor(0, bands, 1, [&](int b0, int b1) {
+        std::vector<uint8_t> strong((size_t)width + 8, 0);
+        for (int b = b0; b < b1; b++) {
+            std::vector<Run>& runs = bandRuns[b];
+            for (int y = std::max(1, b * BAND_ROWS); y < std::min(height, (b + 1) * BAND_ROWS); y++) {
+                const uint8_t* above = &luma[(size_t)(y - 1) * width];
+                const uint8_t* row = &luma[(size_t)y * width];
+                // Branch-free so it vectorizes; then skip quiet stretches
+                // eight pixels at a time
+                for (int x = 0; x < width; x++) strong[x] = abs(row[x] - above[x]) >= threshold;
+                for (int x = 0; x < width;) {
+                    uint64_t word;
+                    memcpy(&word, &strong[x], 8);
+                    if (!word) {
+                        x += 8;
+                        continue;
+                    }
+                    if (!strong[x]) {
+                        x++;
+                        continue;
+                    }
+                    int start = x;
+                    while (x < width && strong[x]) x++;
+                    if (x - start >= minRun) runs.push_back({ (uint16_t)y, (uint16_t)start, (uint16_t)x });
+                }
+            }
+        }
+    });
+
+    // Vertical edges: boundaries between columns x - 1 and x, runs along y.
+    // Each strip walks every row over its own columns, counting how long
+    // each column's run is so far; runs are emitted when they end.
+    const int strips = (width + STRIP_COLUMNS - 1) / STRIP_COLUMNS;
+    std::vector<std::vector<Run>> stripRuns(strips);
+    ParallelFor(0, strips, 1, [&](int s0, int s1) {
+        for (int s = s0; s < s1; s++) {
+            const int x0 = std::max(1, s * STRIP_COLUMNS);
+            const int x1 = std::min(width, (s + 1) * STRIP_COLUMNS);
+            if (x0 >= x1) continue;
+            const int columns = x1 - x0;
+            std::vector<Run>& runs = stripRuns[s];
+            std::vector<uint16_t> length(columns, 0), ended(columns, 0);
+            std::vector<uint8_t> strong(columns, 0);
+            for (int y = 0; y <= height; y++) {
+                // The row past the bottom ends every run
+                if (y < height) {
+                    const uint8_t* row = &luma[(size_t)y * width + x0];
+                    for (int i = 0; i < columns; i++) strong[i] = abs(row[i] - row[i - 1]) >= threshold;
+                } else {
+                    std::fill(strong.begin(), strong.end(), 0);
+                }
+                // Branch-free so it vectorizes
+                uint16_t any = 0;
+                for (int i = 0; i < columns; i++) {
+                    uint16_t run = length[i];
+                    uint16_t keep = (uint16_t)-(int)strong[i];
+                    ended[i] = run >= minRun ? (uint16_t)(run & ~keep) : 0;
+                    length[i] = (uint16_t)((run + 1) & keep);
+                    any |= ended[i];
+                }
+                if (!any) continue;
+                for (int i = 0; i < columns; i++) {
+                    if (ended[i]) runs.push_back({ (uint16_t)(x0 + i), (uint16_t)(y - ended[i]), (uint16_t)y });
+                }
+            }
+            std::sort(runs.begin(), runs.end(), [](const Run& a, const Run& b) {
+                return a.position != b.position ? a.position < b.position : a.from < b.from;
+            });
+        }
+    });
+
+    std::vector<Run> horizontal, vertical;
+    for (const std::vector<Run>& runs : bandRuns) horizontal.insert(horizontal.end(), runs.begin(), runs.end());
+    for (const std::vector<Run>& runs : stripRuns) vertical.insert(vertical.end(), runs.begin(), runs.end());
+
+    m_width = width;
+    m_height = height;
+    BuildIndex(vertical, height, &m_rowOffsets, &m_rowColumns);
+    BuildIndex(horizontal, width, &m_columnOffsets, &m_columnRows);
+
+    m_stats.verticalRuns = vertical.size();
+    m_stats.horizontalRuns = horizontal.size();
+    m_stats.entries = m_rowColumns.size() + m_columnRows.size();
+    m_stats.bytes = (m_rowOffsets.size() + m_columnOffsets.size()) * sizeof(uint32_t) +
+                    (size_t)m_stats.entries * sizeof(uint16_t);
+    return true;
+}
+
+// Runs sorted by position -> per line (row or column) sorted positions
+void EdgeMap::BuildIndex(const std::vector<Run>& runs, int lines, std::vector<uint32_t>* offsets,
+                         std::vector<uint16_t>* entries) {
+    offsets->assign((size_t)lines + 1, 0);
+    for (const Run& run : runs) {
+        (*offsets)[run.from]++;
+        (*offsets)[run.to]--;
+    }
+    // Coverage counts, then exclusive prefix sums
+    uint32_t covering = 0, total = 0;
+    for (int line = 0; line <= lines; line++) {
+        covering += (*offsets)[line];
+        uint32_t count = line < lines ? covering : 0;
+        (*offsets)[line] = total;
+        total += count;
+    }
+    entries->resize(total);
+    std::vector<uint32_t> cursor(offsets->begin(), offsets->end() - 1);
+    for (const Run& run : runs) {
+        for (int line = run.from; line < run.to; line++) (*entries)[cursor[line]++] = run.position;
+    }
+}
+
+int EdgeMap::Nearest(const std::vector<uint32_t>& offsets, const std::vector<uint16_t>& entries,
+                     int line, int value, int radius) {
+    if (line < 0 || line + 1 >= (int)offsets.size()) return -1;
+    const uint16_t* begin = entries.data() + offsets[line];
+    const uint16_t* end = entries.data() + offsets[line + 1];
+    const uint16_t* next = std::lower_bound(begin, end, (uint16_t)std::max(0, std::min(value, 65535)));
+    int best = -1;
+    int bestDistance = radius + 1;
+    if (next != end && *next - value < bestDistance) {
+        best = *next;
+        bestDistance = *next - value;
+    }
+    if (next != begin && value - next[-1] < bestDistance) best = next[-1];
+    return best;
+}
+
+int EdgeMap::SnapColumn(int x, int y, int radius) const {
+    int column = Nearest(m_rowOffsets, m_rowColumns, y - m_originY, x - m_originX, radius);
+    return column < 0 ? -1 : column + m_originX;
+}
+
+int EdgeMap::SnapRow(int x, int y, int radius) const {
+    int row = Nearest(m_columnOffsets, m_columnRows, x - m_originX, y - m_originY, radius);
+    return row < 0 ? -1 : row + m_originY;
+}
+
+} // namespace ScreenCapture
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ScreenCapture {
+
+struct EdgeMapOptions {
+    int threshold;  // Luma step (0..255) that counts as an edge
+    int minRun;     // Shortest straight run kept (drops text and noise)
+
+    static EdgeMapOptions Default() { return { 32, 16 }; }
+};
+
+struct EdgeMapStats {
+    uint64_t verticalRuns;    // Straight runs of column boundaries
+    uint64_t horizontalRuns;  // Straight runs of row boundaries
+    uint64_t entries;         // Row + column index entries
+    size_t bytes;             // Index memory
+};
+
+// Strong straight edges of a frozen screenshot (window borders, panel and
+// control outlines) for snapping a selection. Edges are pixel boundaries:
+// column edge x lies between pixels x - 1 and x, so snapping both sides of
+// a half-open selection to edges selects whole pixels of what is inside.
+//
+// Build() takes the luma gradient in parallel and keeps only boundaries
+// that are part of a straight run of at least minRun pixels, then indexes
+// them: for every row the sorted columns of vertical edges crossing it,
+// for every column the sorted rows of horizontal edges crossing it. A
+// snap query is one binary search in one list. Contains no Win32 code.
+class EdgeMap {
+public:
+    EdgeMap();
+
+    // 32bpp BGRA/BGRX; false (and an empty map) for sizes over 65535
+    bool Build(const uint8_t* pixels, int stride, int width, int height,
+               const EdgeMapOptions& options = EdgeMapOptions::Default());
+
+    void Clear();
+
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+
+    // Where pixel (0, 0) of the built image sits in query coordinates
+    // (a monitor tile of the overlay); Build keeps it
+    void SetOrigin(int x, int y) { m_originX = x; m_originY = y; }
+
+    // Nearest vertical edge crossing row y within 'radius' of x (-1 = none)
+    int SnapColumn(int x, int y, int radius) const;
+
+    // Nearest horizontal edge crossing column x within 'radius' of y
+    int SnapRow(int x, int y, int radius) const;
+
+    EdgeMapStats GetStats() const { return m_stats; }
+
+private:
+    // Run of boundaries at 'position' (a column or row edge) covering
+    // [from, to) along the other axis
+    struct Run {
+        uint16_t position;
+        uint16_t from, to;
+    };
+
+    static void BuildIndex(const std::vector<Run>& runs, int lines, std::vector<uint32_t>* offsets,
+                           std::vector<uint16_t>* entries);
+    static int Nearest(const std::vector<uint32_t>& offsets, const std::vector<uint16_t>& entries,
+                       int line, int value, int radius);
+
+    int m_width;
+    int m_height;
+    int m_originX, m_originY;
+    std::vector<uint32_t> m_rowOffsets;     // Height + 1
+    std::vector<uint16_t> m_rowColumns;     // Vertical edges per row
+    std::vector<uint32_t> m_columnOffsets;  // Width + 1
+    std::vector<uint16_t> m_columnRows;     // Horizontal edges per column
+    EdgeMapStats m_stats;
+};
+
+} // namespace ScreenCapture
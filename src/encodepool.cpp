@@ -0,0 +1,164 @@
+#include "encodepool.h"
+
+namespace ScreenCapture {
+
+EncodePool::EncodePool(int threads, size_t capacity, BackpressurePolicy policy)
+    : m_capacity(capacity ? capacity : 1)
+    , m_policy(policy) {
+    if (threads < 1) threads = 1;
+    for (int i = 0; i < threads; i++) {
+        m_threads.emplace_back(&EncodePool::WorkerLoop, this);
+    }
+}
+
+EncodePool::~EncodePool() {
+    Drain();
+}
+
+bool EncodePool::Submit(EncodeJob job) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_stopping) return false;
+
+    if (m_policy == BackpressurePolicy::Merge && !job.mergeKey.empty()) {
+        // Same pixels already queued: ride along behind that job instead of
+        // waiting for a slot; it still produces its own output
+        for (auto it = m_queue.rbegin(); it != m_queue.rend(); ++it) {
+            if (it->job.mergeKey == job.mergeKey) {
+                it->followers.push_back(std::move(job));
+                m_stats.submitted++;
+                m_stats.merged++;
+                return true;
+            }
+        }
+    }
+
+    bool saturated = m_queue.size() >= m_capacity;
+    if (saturated) {
+        if (m_policy == BackpressurePolicy::FastPreset) {
+            for (Pending& pending : m_queue) {
+                if (!pending.fast) {
+                    pending.fast = true;
+                    m_stats.downgraded++;
+                }
+            }
+        }
+
+        m_stats.blocked++;
+        m_notFull.wait(lock, [this]() { return m_queue.size() < m_capacity || m_stopping; });
+        if (m_stopping) return false;
+    }
+
+    // Arrived while saturated: encode it fast too
+    bool fast = saturated && m_policy == BackpressurePolicy::FastPreset;
+    if (fast) m_stats.downgraded++;
+
+    Enqueue(std::move(job), fast, lock);
+    return true;
+}
+
+bool EncodePool::TrySubmit(EncodeJob& job) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_stopping || m_queue.size() >= m_capacity) return false;
+
+    Enqueue(std::move(job), false, lock);
+    return true;
+}
+
+size_t EncodePool::DowngradeQueued() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = 0;
+    for (Pending& pending : m_queue) {
+        if (!pending.fast) {
+            pending.fast = true;
+            count++;
+        }
+    }
+    m_stats.downgraded += count;
+    return count;
+}
+
+void EncodePool::Enqueue(EncodeJob job, bool fast, std::unique_lock<std::mutex>& lock) {
+    Pending pending;
+    pending.job = std::move(job);
+    pending.id = m_nextId++;
+    pending.enqueued = std::chrono::steady_clock::now();
+    pending.fast = fast;
+
+    m_queue.push_back(std::move(pending));
+    m_stats.submitted++;
+    m_stats.queued = m_queue.size();
+    lock.unlock();
+    m_notEmpty.notify_one();
+}
+
+void EncodePool::WorkerLoop() {
+    for (;;) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this]() { return !m_queue.empty() || m_stopping; });
+        if (m_queue.empty()) return;  // Stopping and fully drained
+
+        Pending pending = std::move(m_queue.front());
+        m_queue.pop_front();
+        m_stats.queued = m_queue.size();
+        m_stats.running++;
+        std::function<void(const EncodeJobStats&)> callback = m_callback;
+        lock.unlock();
+        m_notFull.notify_one();
+
+        auto start = std::chrono::steady_clock::now();
+        EncodeOptions options = pending.fast ? EncodeOptions::Fast() : EncodeOptions::Default();
+        bool ok = pending.job.run ? pending.job.run(options) : false;
+        // Merged jobs right after, while the output they can reuse is fresh
+        uint64_t followersFailed = 0;
+        for (EncodeJob& follower : pending.followers) {
+            if (!(follower.run ? follower.run(options) : false)) followersFailed++;
+        }
+        size_t followers = pending.followers.size();
+        pending.followers.clear();
+        auto end = std::chrono::steady_clock::now();
+
+        EncodeJobStats jobStats;
+        jobStats.id = pending.id;
+        jobStats.queueWaitMs = std::chrono::duration<double, std::milli>(start - pending.enqueued).count();
+        jobStats.runMs = std::chrono::duration<double, std::milli>(end - start).count();
+        jobStats.fastPreset = pending.fast;
+        jobStats.ok = ok;
+
+        // Drop the job (and the frame it holds) before reporting
+        pending.job = EncodeJob();
+        if (callback) callback(jobStats);
+
+        lock.lock();
+        m_stats.running--;
+        m_stats.completed += 1 + followers;
+        m_stats.failed += (ok ? 0 : 1) + followersFailed;
+    }
+}
+
+void EncodePool::Drain() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping && m_threads.empty()) return;
+        m_stopping = true;
+    }
+    m_notEmpty.notify_all();
+    m_notFull.notify_all();
+
+    // Workers only exit once the queue is empty
+    for (std::thread& thread : m_threads) {
+        if (thread.joinable()) thread.join();
+    }
+    m_threads.clear();
+}
+
+void EncodePool::SetJobCallback(std::function<void(const EncodeJobStats&)> callback) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_callback = std::move(callback);
+}
+
+EncodePoolStats EncodePool::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+} // namespace ScreenCapture
@@ -0,0 +1,102 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include "encoder.h"
+
+namespace ScreenCapture {
+
+// What Submit() does when the queue is full
+enum class BackpressurePolicy {
+    Block,      // Wait for a free slot
+    Merge,      // Attach a job whose merge key is already queued to that job
+                // (full or not), else wait
+    FastPreset  // Downgrade queued and new jobs to EncodeOptions::Fast(), then wait
+};
+
+struct EncodeJob {
+    // Equal keys promise equal input (same pixels). A merged job takes no
+    // queue slot: it runs on the same worker right after the queued job,
+    // whose output it can reuse (e.g. hard-link the file just written).
+    // Empty = never merged.
+    std::string mergeKey;
+    std::function<bool(const EncodeOptions&)> run;
+};
+
+// Reported once per finished job (called on the worker thread)
+struct EncodeJobStats {
+    uint64_t id;
+    double queueWaitMs;
+    double runMs;
+    bool fastPreset;
+    bool ok;
+};
+
+struct EncodePoolStats {
+    uint64_t submitted;
+    uint64_t completed;
+    uint64_t failed;
+    uint64_t merged;      // Jobs run behind a queued one with the same key (Merge policy)
+    uint64_t downgraded;  // Jobs switched to the fast preset
+    uint64_t blocked;     // Submit() calls that had to wait for a slot
+    size_t queued;
+    int running;
+};
+
+// Fixed set of encode threads fed by a bounded FIFO. Unlike the old
+// fire-and-forget QueueUserWorkItem calls, every accepted job is tracked
+// and Drain() waits for all of them, so exiting never truncates a save.
+class EncodePool {
+public:
+    EncodePool(int threads, size_t capacity, BackpressurePolicy policy);
+    ~EncodePool();
+
+    // Queue a job. Returns false only after Drain() has started.
+    bool Submit(EncodeJob job);
+
+    // Queue a job only if a slot is free right now (never blocks, no policy)
+    bool TrySubmit(EncodeJob& job);
+
+    // Switch every queued (not yet running) job to EncodeOptions::Fast(),
+    // e.g. when an interactive capture needs the CPU. Returns how many.
+    size_t DowngradeQueued();
+
+    // Stop accepting jobs, finish everything queued or running, join threads
+    void Drain();
+
+    void SetJobCallback(std::function<void(const EncodeJobStats&)> callback);
+    EncodePoolStats GetStats() const;
+
+private:
+    struct Pending {
+        EncodeJob job;
+        uint64_t id;
+        std::chrono::steady_clock::time_point enqueued;
+        bool fast;
+        std::vector<EncodeJob> followers;  // Merged into this one, run after it
+    };
+
+    void WorkerLoop();
+    void Enqueue(EncodeJob job, bool fast, std::unique_lock<std::mutex>& lock);
+
+    const size_t m_capacity;
+    const BackpressurePolicy m_policy;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+    std::deque<Pending> m_queue;
+    std::vector<std::thread> m_threads;
+    std::function<void(const EncodeJobStats&)> m_callback;
+    EncodePoolStats m_stats = {};
+    uint64_t m_nextId = 1;
+    bool m_stopping = false;
+};
+
+} // namespace ScreenCapture
@@ -0,0 +1,304 @@
+#include "encoder.h"
+#include "inflate.h"
+#include "memorygovernor.h"
+#include "pixelconvert.h"
+#include "spscqueue.h"
+#include "taskscheduler.h"
+#include <stdlib.h>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "../stb_image_write.h"
+
+namespace ScreenCapture {
+
+namespace {
+
+const int CONVERT_GRAIN_ROWS = 64;
+const int FILTER_GRAIN_ROWS = 32;
+
+// Pipeline granularity: rows are handed from the filter stage to the
+// deflate stage in blocks of about this many filtered bytes, and at most
+// PIPELINE_DEPTH blocks (or their compressed pieces) are in flight
+const size_t PIPELINE_BLOCK = 1024 * 1024;
+const int PIPELINE_DEPTH = 4;
+
+// Deflate piece size inside a block: big enough that the per-piece sync
+// marker and the cold start of each piece's hash chains cost well under
+// 1% of the output
+const size_t DEFLATE_PIECE = 256 * 1024;
+const int DEFLATE_DICT = 32767;
+
+// A filtered block: 'prefix' bytes of preceding output (the deflate
+// dictionary), then 'size' bytes of filtered rows
+struct RowBlock {
+    unsigned char* buffer;
+    size_t prefix;
+    size_t size;
+};
+
+// One raw deflate piece, in stream order. 'adler' is the Adler-32 of all
+// filtered bytes so far; it is only meaningful on the last piece.
+struct DeflatedPiece {
+    unsigned char* data;
+    int size;
+    bool last;
+    uint32_t adler;
+};
+
+uint32_t Crc32Update(uint32_t crc, const uint8_t* data, size_t len) {
+    static const std::vector<uint32_t> table = []() {
+        std::vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+void PutBE32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+// Emit one PNG chunk whose payload is the concatenation of 'parts'
+bool WriteChunk(const PngSink& sink, const char* tag, const std::vector<std::pair<const uint8_t*, size_t>>& parts) {
+    size_t length = 0;
+    for (const auto& part : parts) length += part.second;
+    uint8_t header[8];
+    PutBE32(header, (uint32_t)length);
+    memcpy(header + 4, tag, 4);
+    uint32_t crc = Crc32Update(0, header + 4, 4);
+    if (!sink(header, 8)) return false;
+    for (const auto& part : parts) {
+        crc = Crc32Update(crc, part.first, part.second);
+        if (part.second && !sink(part.first, part.second)) return false;
+    }
+    uint8_t trailer[4];
+    PutBE32(trailer, crc);
+    return sink(trailer, 4);
+}
+
+// Filter row y into out[0] (type byte) + out[1..width*3], choosing with
+// stb's heuristic when filter < 0: smallest sum of absolute residuals
+void FilterRow(unsigned char* pixels, int stride, int width, int height, int y, int filter,
+               unsigned char* out) {
+    signed char* line = (signed char*)(out + 1);
+    int rowBytes = width * 3;
+    if (filter < 0) {
+        int best = 0, bestEst = 0x7fffffff;
+        for (int f = 0; f < 5; f++) {
+            stbiw__encode_png_line(pixels, stride, width, height, y, 3, f, line);
+            int est = 0;
+            for (int i = 0; i < rowBytes; i++) est += abs(line[i]);
+            if (est < bestEst) {
+                bestEst = est;
+                best = f;
+            }
+        }
+        filter = best;
+        if (filter != 4) {  // The last trial already left the best residuals in place
+            stbiw__encode_png_line(pixels, stride, width, height, y, 3, filter, line);
+        }
+    } else {
+        stbiw__encode_png_line(pixels, stride, width, height, y, 3, filter, line);
+    }
+    out[0] = (unsigned char)filter;
+}
+
+} // namespace
+
+bool EncodePNGStream(const uint8_t* bgra, int width, int height, int stride,
+                     const EncodeOptions& options, const PngSink& sink) {
+    if (!bgra || width <= 0 || height <= 0) return false;
+
+    size_t rowBytes = (size_t)width * 3 + 1;
+    if (rowBytes * height > 0x7fffffff) return false;
+    int filter = options.filter < 5 ? options.filter : -1;
+    int blockRows = (int)(PIPELINE_BLOCK / rowBytes);
+    if (blockRows < 1) blockRows = 1;
+    if (blockRows > height) blockRows = height;
+    int blocks = (height + blockRows - 1) / blockRows;
+
+    // Working memory is a few blocks, whatever the frame size: an RGB block
+    // (plus the row above it, which the filters read) and PIPELINE_DEPTH + 1
+    // filtered-block buffers, each led by the 32 KB before the block so
+    // deflate can match across the boundary
+    size_t rgbStride = (size_t)width * 3;
+    size_t blockCapacity = DEFLATE_DICT + rowBytes * blockRows;
+    std::vector<unsigned char> rgb(rgbStride * (blockRows + 1));
+    std::vector<std::vector<unsigned char>> buffers(PIPELINE_DEPTH + 1);
+    for (auto& buffer : buffers) buffer.resize(blockCapacity);
+    MemoryCharge charge = MemoryGovernor::Instance().Charge(MemoryStage::Encode,
+        rgb.size() + buffers.size() * blockCapacity);
+
+    std::atomic<bool> abort(false);
+    SpscQueue<RowBlock> rowQueue(PIPELINE_DEPTH);
+    SpscQueue<unsigned char*> freeQueue(buffers.size());  // Buffers back from deflate
+    SpscQueue<DeflatedPiece> pieceQueue(PIPELINE_DEPTH * (PIPELINE_BLOCK / DEFLATE_PIECE + 1));
+    for (auto& buffer : buffers) freeQueue.TryPush(buffer.data());
+
+    // Stage 1: BGRX -> RGB (screen pixels are opaque, so the PNG carries 3
+    // channels and no undefined GDI alpha), then row filters. Both fan out
+    // over the task scheduler within the block.
+    std::thread filterStage([&]() {
+        std::vector<unsigned char> carry;  // Last <= 32 KB of filtered output
+        for (int b = 0; b < blocks; b++) {
+            int y0 = b * blockRows;
+            int y1 = y0 + blockRows < height ? y0 + blockRows : height;
+            unsigned char* buffer;
+            if (!freeQueue.Pop(buffer, abort)) return;
+
+            // RGB row 0 is the last row of the previous block
+            if (b > 0) memcpy(rgb.data(), rgb.data() + rgbStride * blockRows, rgbStride);
+            unsigned char* rgbRows = rgb.data() + rgbStride;
+            ParallelFor(y0, y1, CONVERT_GRAIN_ROWS, [&](int r0, int r1) {
+                ConvertPixels(bgra + (size_t)r0 * stride, stride, PixelFormat::BGRX,
+                              rgbRows + rgbStride * (r0 - y0), (int)rgbStride, PixelFormat::RGB,
+                              width, r1 - r0);
+            });
+
+            unsigned char* data = buffer + carry.size();
+            if (!carry.empty()) memcpy(buffer, carry.data(), carry.size());
+            ParallelFor(y0, y1, FILTER_GRAIN_ROWS, [&](int r0, int r1) {
+                for (int y = r0; y < r1; y++) {
+                    // Local row index: 0 only for the image's first row
+                    int local = y - y0 + (b > 0 ? 1 : 0);
+                    FilterRow(b > 0 ? rgb.data() : rgbRows, (int)rgbStride, width, height, local, filter,
+                              data + rowBytes * (y - y0));
+                }
+            });
+
+            size_t size = rowBytes * (y1 - y0);
+            size_t keep = carry.size() + size < (size_t)DEFLATE_DICT ? carry.size() + size : DEFLATE_DICT;
+            carry.assign(data + size - keep, data + size);
+            if (!rowQueue.Push({ buffer, (size_t)(data - buffer), size }, abort)) return;
+        }
+    });
+
+    // Stage 2: deflate each block as fixed-size pieces in parallel. Every
+    // piece ends on a byte boundary (sync flush), so the pieces concatenate
+    // into one stream; their Adler-32s combine the same way.
+    std::thread deflateStage([&]() {
+        uint32_t adler = 1;
+        for (int b = 0; b < blocks; b++) {
+            RowBlock block;
+            if (!rowQueue.Pop(block, abort)) return;
+            size_t start = block.prefix;
+            size_t end = block.prefix + block.size;
+            int pieces = (int)((block.size + DEFLATE_PIECE - 1) / DEFLATE_PIECE);
+            std::vector<DeflatedPiece> out(pieces);
+            std::vector<uint32_t> adlers(pieces);
+            ParallelFor(0, pieces, 1, [&](int p0, int p1) {
+                for (int p = p0; p < p1; p++) {
+                    size_t offset = start + (size_t)p * DEFLATE_PIECE;
+                    int len = (int)(end - offset < DEFLATE_PIECE ? end - offset : DEFLATE_PIECE);
+                    int dict = offset < (size_t)DEFLATE_DICT ? (int)offset : DEFLATE_DICT;
+                    out[p].last = b == blocks - 1 && p == pieces - 1;
+                    out[p].data = stbi_zlib_compress_raw(block.buffer + offset, len, dict, out[p].last,
+                                                         &out[p].size, options.compressionLevel);
+                    adlers[p] = Adler32(1, block.buffer + offset, len);
+                }
+            });
+            freeQueue.TryPush(block.buffer);  // Never full: one slot per buffer
+            for (int p = 0; p < pieces; p++) {
+                size_t len = end - (start + (size_t)p * DEFLATE_PIECE);
+                adler = Adler32Combine(adler, adlers[p], len < DEFLATE_PIECE ? len : DEFLATE_PIECE);
+                out[p].adler = adler;
+            }
+            for (int p = 0; p < pieces; p++) {
+                if (!out[p].data) abort = true;
+                if (abort || !pieceQueue.Push(out[p], abort)) {
+                    for (; p < pieces; p++) STBIW_FREE(out[p].data);
+                    return;
+                }
+            }
+        }
+    });
+
+    // Stage 3 (this thread): one IDAT chunk per piece, written as soon as
+    // it arrives
+    static const uint8_t SIGNATURE[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    static const uint8_t ZLIB_HEADER[2] = { 0x78, 0x5e };  // DEFLATE 32K window, FLEVEL = 1
+    uint8_t ihdr[13];
+    PutBE32(ihdr, (uint32_t)width);
+    PutBE32(ihdr + 4, (uint32_t)height);
+    ihdr[8] = 8;   // bit depth
+    ihdr[9] = 2;   // color type: RGB
+    ihdr[10] = 0;
+    ihdr[11] = 0;
+    ihdr[12] = 0;
+    bool ok = sink(SIGNATURE, 8) && WriteChunk(sink, "IHDR", { { ihdr, 13 } });
+
+    bool first = true;
+    for (bool last = false; ok && !last;) {
+        DeflatedPiece piece;
+        if (!pieceQueue.Pop(piece, abort)) {
+            ok = false;
+            break;
+        }
+        last = piece.last;
+        uint8_t adler[4];
+        PutBE32(adler, piece.adler);
+        ok = WriteChunk(sink, "IDAT", {
+            { ZLIB_HEADER, first ? 2u : 0u },
+            { piece.data, (size_t)piece.size },
+            { adler, last ? 4u : 0u } });
+        STBIW_FREE(piece.data);
+        first = false;
+    }
+    ok = ok && WriteChunk(sink, "IEND", {});
+
+    if (!ok) abort = true;
+    filterStage.join();
+    deflateStage.join();
+    DeflatedPiece leftover;
+    while (pieceQueue.TryPop(leftover)) STBIW_FREE(leftover.data);
+    return ok;
+}
+
+unsigned char* EncodePNG(const uint8_t* bgra, int width, int height, int stride,
+                         const EncodeOptions& options, int* outSize) {
+    unsigned char* buffer = NULL;
+    size_t size = 0, capacity = 0;
+    bool ok = EncodePNGStream(bgra, width, height, stride, options, [&](const void* data, size_t len) {
+        if (size + len > capacity) {
+            size_t grown = capacity ? capacity * 2 : (size_t)width * height / 2 + 4096;
+            while (grown < size + len) grown *= 2;
+            if (grown > 0x7fffffff) return false;
+            unsigned char* bigger = (unsigned char*)STBIW_REALLOC(buffer, grown);
+            if (!bigger) return false;
+            buffer = bigger;
+            capacity = grown;
+        }
+        memcpy(buffer + size, data, len);
+        size += len;
+        return true;
+    });
+    if (!ok) {
+        STBIW_FREE(buffer);
+        return NULL;
+    }
+    *outSize = (int)size;
+    return buffer;
+}
+
+void FreeEncodedImage(unsigned char* data) {
+    STBIW_FREE(data);
+}
+
+unsigned char* CompressZlib(const uint8_t* data, int size, int level, int* outSize) {
+    return stbi_zlib_compress((unsigned char*)data, size, outSize, level);
+}
+
+} // namespace ScreenCapture
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace ScreenCapture {
+
+// Per-job encoder settings (passed explicitly so concurrent jobs can differ)
+struct EncodeOptions {
+    int compressionLevel;  // stb deflate hash-chain length (5 = fastest)
+    int filter;            // PNG row filter 0-4, or -1 to try all per row
+
+    static EncodeOptions Default() { return { 8, -1 }; }
+    
+    // Used under backpressure: one fixed "up" filter instead of five trial
+    // passes per row, and the shortest match search
+    static EncodeOptions Fast() { return { 5, 2 }; }
+};
+
+// Receives the PNG in order; return false to abort the encode
+typedef std::function<bool(const void* data, size_t size)> PngSink;
+
+// Encode a top-down 32bpp BGRX surface to an RGB PNG (the 4th byte is
+// ignored). Rows may be padded (stride >= width * 4).
+//
+// Pipelined: a filter thread (BGRX -> RGB + row filters), a deflate thread
+// and the calling thread (writing one IDAT chunk per deflate piece to
+// 'sink') are joined by bounded lock-free queues of row blocks, so the
+// stages overlap and the file is being written while later rows are still
+// compressing. Filter and deflate fan out over the task scheduler per block.
+bool EncodePNGStream(const uint8_t* bgra, int width, int height, int stride,
+                     const EncodeOptions& options, const PngSink& sink);
+
+// Same, collected in memory. Returns NULL on failure; the caller releases
+// the result with FreeEncodedImage().
+unsigned char* EncodePNG(const uint8_t* bgra, int width, int height, int stride,
+                         const EncodeOptions& options, int* outSize);
+
+void FreeEncodedImage(unsigned char* data);
+
+// Raw zlib stream of arbitrary bytes with the same deflate the PNG path
+// uses. Release with FreeEncodedImage().
+unsigned char* CompressZlib(const uint8_t* data, int size, int level, int* outSize);
+
+} // namespace ScreenCapture
@@ -0,0 +1,227 @@
+#include "framehash.h"
+#include "taskscheduler.h"
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRAMEHASH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace ScreenCapture {
+
+static const int HASH_BAND_ROWS = 64;
+
+static const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+static const uint64_t KEYS[4] = {
+    0xBE4BA423396CFEB8ULL, 0x1CAD21F72C81017CULL, 0xDB979083E96DD4DEULL, 0x1F67B3B7A4A44072ULL
+};
+// Added to every lane's key per stripe, so the same 32 bytes accumulate
+// differently at every position of the row (XXH3 slides its secret
+// instead; a row can be far longer than any secret)
+static const uint64_t STRIPE_STEP = 0x9FB21C651E98DF25ULL;
+
+static uint64_t Mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME1;
+    h ^= h >> 32;
+    return h;
+}
+
+#ifndef FRAMEHASH_SSE2
+static uint64_t Load64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+// k = KEYS[i] + s * STRIPE_STEP for stripe s;
+// acc[i] += lo32(d ^ k) * hi32(d ^ k); acc[i ^ 1] += d
+static void AccumulateScalar(uint64_t acc[4], const uint8_t* p, size_t stripes) {
+    uint64_t keys[4] = { KEYS[0], KEYS[1], KEYS[2], KEYS[3] };
+    for (size_t s = 0; s < stripes; s++, p += 32) {
+        for (int i = 0; i < 4; i++) {
+            uint64_t d = Load64(p + i * 8);
+            uint64_t dk = d ^ keys[i];
+            acc[i ^ 1] += d;
+            acc[i] += (dk & 0xFFFFFFFF) * (dk >> 32);
+            keys[i] += STRIPE_STEP;
+        }
+    }
+}
+#else
+// Same as AccumulateScalar, two lanes per register
+static void AccumulateSSE2(uint64_t acc[4], const uint8_t* p, size_t stripes) {
+    __m128i a0 = _mm_loadu_si128((const __m128i*)acc);
+    __m128i a1 = _mm_loadu_si128((const __m128i*)(acc + 2));
+    __m128i k0 = _mm_loadu_si128((const __m128i*)KEYS);
+    __m128i k1 = _mm_loadu_si128((const __m128i*)(KEYS + 2));
+    const __m128i step = _mm_set1_epi64x((long long)STRIPE_STEP);
+    for (size_t s = 0; s < stripes; s++, p += 32) {
+        __m128i d0 = _mm_loadu_si128((const __m128i*)p);
+        __m128i d1 = _mm_loadu_si128((const __m128i*)(p + 16));
+        __m128i dk0 = _mm_xor_si128(d0, k0);
+        __m128i dk1 = _mm_xor_si128(d1, k1);
+        // _mm_mul_epu32 multiplies the low 32 bits of each 64-bit lane
+        a0 = _mm_add_epi64(a0, _mm_mul_epu32(dk0, _mm_srli_epi64(dk0, 32)));
+        a1 = _mm_add_epi64(a1, _mm_mul_epu32(dk1, _mm_srli_epi64(dk1, 32)));
+        a0 = _mm_add_epi64(a0, _mm_shuffle_epi32(d0, _MM_SHUFFLE(1, 0, 3, 2)));
+        a1 = _mm_add_epi64(a1, _mm_shuffle_epi32(d1, _MM_SHUFFLE(1, 0, 3, 2)));
+        k0 = _mm_add_epi64(k0, step);
+        k1 = _mm_add_epi64(k1, step);
+    }
+    _mm_storeu_si128((__m128i*)acc, a0);
+    _mm_storeu_si128((__m128i*)(acc + 2), a1);
+}
+#endif
+
+// Rows [y0, y1) into their own accumulators
+static void HashBand(const uint8_t* bgra, int width, int y0, int y1, int stride, uint64_t acc[4]) {
+    acc[0] = PRIME1;
+    acc[1] = PRIME2;
+    acc[2] = ~PRIME1;
+    acc[3] = ~PRIME2;
+    size_t rowBytes = (size_t)width * 4;
+    size_t stripes = rowBytes / 32;
+    size_t tail = rowBytes - stripes * 32;
+
+    for (int y = y0; y < y1; y++) {
+        const uint8_t* row = bgra + (size_t)y * stride;
+#ifdef FRAMEHASH_SSE2
+        AccumulateSSE2(acc, row, stripes);
+#else
+        AccumulateScalar(acc, row, stripes);
+#endif
+        // Row tail (width not a multiple of 8 pixels), one pixel at a time
+        for (size_t i = 0; i < tail; i += 4) {
+            uint32_t px;
+            memcpy(&px, row + stripes * 32 + i, 4);
+            acc[(i >> 2) & 3] = (acc[(i >> 2) & 3] ^ px) * PRIME1;
+        }
+        // Scramble every lane at the row boundary (XXH3-style, keyed by
+        // the row), so rows cannot be reordered or shifted unnoticed
+        for (int i = 0; i < 4; i++) {
+            uint64_t a = acc[i];
+            a ^= a >> 47;
+            a ^= KEYS[i] + (uint64_t)y * PRIME3;
+            acc[i] = a * PRIME1;
+        }
+    }
+}
+
+FrameHash HashPixels(const uint8_t* bgra, int width, int height, int stride) {
+    // Fixed-height bands hash in parallel and fold in band order, so the
+    // value never depends on how many workers took part
+    int bands = (height + HASH_BAND_ROWS - 1) / HASH_BAND_ROWS;
+    std::vector<uint64_t> bandAcc((size_t)bands * 4);
+    ParallelFor(0, bands, 1, [&](int b0, int b1) {
+        for (int b = b0; b < b1; b++) {
+            int y0 = b * HASH_BAND_ROWS;
+            int y1 = y0 + HASH_BAND_ROWS < height ? y0 + HASH_BAND_ROWS : height;
+            HashBand(bgra, width, y0, y1, stride, &bandAcc[(size_t)b * 4]);
+        }
+    });
+
+    uint64_t acc[4] = { PRIME1, PRIME2, ~PRIME1, ~PRIME2 };
+    for (int b = 0; b < bands; b++) {
+        for (int i = 0; i < 4; i++) {
+            acc[i] = (acc[i] ^ Mix64(bandAcc[(size_t)b * 4 + i])) * PRIME1;
+        }
+    }
+
+    uint64_t size = ((uint64_t)(uint32_t)width << 32) | (uint32_t)height;
+    FrameHash hash;
+    hash.lo = Mix64(acc[0] ^ Mix64(acc[1]) ^ (acc[2] * PRIME1) ^ size);
+    hash.hi = Mix64(acc[3] ^ Mix64(acc[2]) ^ (acc[1] * PRIME2) ^ ~size);
+    return hash;
+}
+
+// Rows [y0, y1) as one multiply-xor chain: every word depends on all the
+// words before it, unlike the lanes of HashBand
+static uint64_t CheckBand(const uint8_t* bgra, int width, int y0, int y1, int stride) {
+    uint64_t h = PRIME3 ^ (uint64_t)y0;
+    size_t rowBytes = (size_t)width * 4;
+    for (int y = y0; y < y1; y++) {
+        const uint8_t* row = bgra + (size_t)y * stride;
+        size_t i = 0;
+        for (; i + 8 <= rowBytes; i += 8) {
+            uint64_t v;
+            memcpy(&v, row + i, 8);
+            h = (h ^ v) * PRIME2;
+            h ^= h >> 31;
+        }
+        for (; i < rowBytes; i += 4) {
+            uint32_t px;
+            memcpy(&px, row + i, 4);
+            h = (h ^ px) * PRIME2;
+            h ^= h >> 31;
+        }
+        h = Mix64(h + (uint64_t)y);
+    }
+    return h;
+}
+
+uint64_t CheckPixels(const uint8_t* bgra, int width, int height, int stride) {
+    int bands = (height + HASH_BAND_ROWS - 1) / HASH_BAND_ROWS;
+    std::vector<uint64_t> bandHash((size_t)bands);
+    ParallelFor(0, bands, 1, [&](int b0, int b1) {
+        for (int b = b0; b < b1; b++) {
+            int y0 = b * HASH_BAND_ROWS;
+            int y1 = y0 + HASH_BAND_ROWS < height ? y0 + HASH_BAND_ROWS : height;
+            bandHash[b] = CheckBand(bgra, width, y0, y1, stride);
+        }
+    });
+    uint64_t h = ((uint64_t)(uint32_t)width << 32) | (uint32_t)height;
+    for (int b = 0; b < bands; b++) h = Mix64(h ^ bandHash[b]) * PRIME3;
+    return Mix64(h);
+}
+
+RecentCaptures::RecentCaptures(size_t capacity) : m_capacity(capacity) {
+}
+
+bool RecentCaptures::Find(const FrameHash& hash, int width, int height, std::wstring* path, uint64_t* fileSize,
+                          uint64_t* check) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const Entry& entry : m_entries) {
+        if (entry.hash == hash && entry.width == width && entry.height == height) {
+            *path = entry.path;
+            *fileSize = entry.fileSize;
+            *check = entry.check;
+            return true;
+        }
+    }
+    return false;
+}
+
+void RecentCaptures::Add(const FrameHash& hash, uint64_t check, int width, int height, const std::wstring& path,
+                         uint64_t fileSize) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.push_front({ hash, check, width, height, path, fileSize });
+    while (m_entries.size() > m_capacity) {
+        m_entries.pop_back();
+    }
+}
+
+void RecentCaptures::Remove(const std::wstring& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if (it->path == path) {
+            m_entries.erase(it);
+            return;
+        }
+    }
+}
+
+void RecentCaptures::SetCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = capacity;
+    while (m_entries.size() > m_capacity) {
+        m_entries.pop_back();
+    }
+}
+
+} // namespace ScreenCapture
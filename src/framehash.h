@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+namespace ScreenCapture {
+
+// 128-bit content hash of the visible pixels (row padding is ignored).
+// Not cryptographic: meant to spot exact repeat captures cheaply.
+struct FrameHash {
+    uint64_t lo;
+    uint64_t hi;
+
+    bool operator==(const FrameHash& other) const { return lo == other.lo && hi == other.hi; }
+};
+
+// Four 64-bit multiply-accumulate lanes over 32-byte stripes (SSE2 when
+// available, scalar otherwise; both give the same value) per 64-row band;
+// the key changes with every stripe and all lanes are scrambled at every
+// row, so moved content changes the hash. Bands run on the task scheduler
+// and fold in order. Runs at memory bandwidth, so a 4K frame hashes in a
+// few milliseconds.
+FrameHash HashPixels(const uint8_t* bgra, int width, int height, int stride);
+
+// Second, independent 64-bit hash (a sequential multiply-xor chain per
+// band) that confirms a HashPixels match before a file is reused. Slower,
+// so it runs off the capture path or only on a match.
+uint64_t CheckPixels(const uint8_t* bgra, int width, int height, int stride);
+
+struct DuplicateStats {
+    uint64_t hashed;        // Frames hashed by SaveCapture
+    uint64_t skipped;       // Encodes avoided because of an exact match
+    uint64_t linked;        // ... served by a hard link (or copy) of the file
+    uint64_t referenced;    // ... served by pointing at the existing file
+    uint64_t bytesAvoided;  // Encoded bytes not written again
+    double hashMs;          // Total time spent hashing
+};
+
+// Most recent successfully saved captures, newest first
+class RecentCaptures {
+public:
+    explicit RecentCaptures(size_t capacity);
+
+    // Path of a saved capture with the same hash and size, if any, and its
+    // CheckPixels value (the caller confirms the match with it)
+    bool Find(const FrameHash& hash, int width, int height, std::wstring* path, uint64_t* fileSize, uint64_t* check);
+
+    // Record a finished save (called from encode workers)
+    void Add(const FrameHash& hash, uint64_t check, int width, int height, const std::wstring& path, uint64_t fileSize);
+
+    // Forget an entry whose file has disappeared
+    void Remove(const std::wstring& path);
+
+    void SetCapacity(size_t capacity);
+
+private:
+    struct Entry {
+        FrameHash hash;
+        uint64_t check;
+        int width;
+        int height;
+        std::wstring path;
+        uint64_t fileSize;
+    };
+
+    std::mutex m_mutex;
+    std::deque<Entry> m_entries;
+    size_t m_capacity;
+};
+
+} // namespace ScreenCapture
@@ -0,0 +1,69 @@
+#include "framepacer.h"
+
+namespace ScreenCapture {
+
+FramePacer::FramePacer(const TimerClock& clock, int64_t frameUs)
+    : m_clock(clock), m_frameUs(frameUs > 0 ? frameUs : 1), m_pending(false), m_x(0), m_y(0),
+      m_pendingSinceUs(0), m_haveFrame(false), m_lastFrameUs(0), m_lastStartUs(0), m_stats() {
+}
+
+void FramePacer::SetFrameInterval(int64_t frameUs) {
+    m_frameUs = frameUs > 0 ? frameUs : 1;
+}
+
+int64_t FramePacer::IntervalForRefresh(int refreshHz, int maxFps) {
+    if (maxFps <= 0) maxFps = 60;
+    if (refreshHz <= 1) return 1000000 / maxFps;
+    int refreshes = (refreshHz + maxFps - 1) / maxFps;
+    return (int64_t)refreshes * 1000000 / refreshHz;
+}
+
+void FramePacer::Submit(int x, int y) {
+    m_stats.inputs++;
+    if (m_pending) {
+        m_stats.merged++;
+    } else {
+        m_pendingSinceUs = m_clock.NowUs();
+    }
+    m_pending = true;
+    m_x = x;
+    m_y = y;
+}
+
+int64_t FramePacer::NextDeadlineUs() const {
+    if (!m_pending) return -1;
+    return m_haveFrame ? m_lastFrameUs + m_frameUs : m_pendingSinceUs;
+}
+
+bool FramePacer::BeginFrame(int* x, int* y) {
+    if (!m_pending) return false;
+    int64_t now = m_clock.NowUs();
+    if (m_haveFrame && now - m_lastFrameUs < m_frameUs) return false;
+
+    if (m_haveFrame) {
+        m_stats.interval.Add(now - m_lastStartUs);
+        // Keep the cadence when on time; after a stall start over from now
+        // instead of firing a burst of catch-up frames
+        int64_t scheduled = m_lastFrameUs + m_frameUs;
+        m_lastFrameUs = now - scheduled < m_frameUs ? scheduled : now;
+    } else {
+        m_lastFrameUs = now;
+    }
+    m_haveFrame = true;
+    m_lastStartUs = now;
+
+    if (now > m_pendingSinceUs) m_stats.deferred++;
+    m_stats.latency.Add(now - m_pendingSinceUs);
+    m_stats.frames++;
+
+    m_pending = false;
+    *x = m_x;
+    *y = m_y;
+    return true;
+}
+
+void FramePacer::Reset() {
+    m_pending = false;
+}
+
+} // namespace ScreenCapture
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include "capturetimer.h"
+
+namespace ScreenCapture {
+
+struct FramePacerStats {
+    uint64_t inputs;    // Positions submitted
+    uint64_t merged;    // Replaced by a newer one before being rendered
+    uint64_t frames;    // Frames started
+    uint64_t deferred;  // Frames whose input waited for the interval to pass
+    LatencyHistogram interval;  // Between consecutive frames
+    LatencyHistogram latency;   // Oldest unrendered input -> its frame
+};
+
+// Paces redraws of an interactive surface (the selection overlay) on a
+// monotonic microsecond clock. Input only records the latest position;
+// a frame starts when one is pending and its slot has come: frames keep a
+// fixed cadence while input keeps arriving and restart from "now" after an
+// idle spell. When input arrives early the caller waits until
+// NextDeadlineUs() and asks again, so the last position of a drag is
+// always drawn (a trailing frame) instead of being throttled away.
+// Contains no Win32 code; single-threaded.
+class FramePacer {
+public:
+    FramePacer(const TimerClock& clock, int64_t frameUs);
+
+    void SetFrameInterval(int64_t frameUs);
+    int64_t FrameInterval() const { return m_frameUs; }
+
+    // Interval that is a whole number of refreshes and no faster than
+    // maxFps (60 Hz -> 16.7 ms, 144 Hz at 120 fps -> 13.9 ms, 240 Hz ->
+    // 8.3 ms). Unknown refresh rates (<= 1) fall back to maxFps.
+    static int64_t IntervalForRefresh(int refreshHz, int maxFps);
+
+    // Latest input position; replaces any pending one
+    void Submit(int x, int y);
+
+    // Start a frame if one is due: returns the position to draw
+    bool BeginFrame(int* x, int* y);
+
+    // When the pending position becomes due (-1 = nothing pending)
+    int64_t NextDeadlineUs() const;
+
+    // Drop any pending position (selection ended)
+    void Reset();
+
+    FramePacerStats GetStats() const { return m_stats; }
+
+private:
+    const TimerClock& m_clock;
+    int64_t m_frameUs;
+    bool m_pending;
+    int m_x, m_y;
+    int64_t m_pendingSinceUs;  // Arrival of the oldest unrendered input
+    bool m_haveFrame;
+    int64_t m_lastFrameUs;     // Slot of the last frame (on the cadence)
+    int64_t m_lastStartUs;     // When it actually started
+    FramePacerStats m_stats;
+};
+
+} // namespace ScreenCapture
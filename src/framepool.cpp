@@ -0,0 +1,285 @@
+#include "framepool.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace ScreenCapture {
+
+static const size_t MIN_CLASS_BYTES = 64 * 1024;
+static const size_t PAGE_BYTES = 4096;
+
+FramePool& FramePool::Instance() {
+    // Intentionally leaked: frames may still be released by worker threads
+    // while static destructors run at exit.
+    static FramePool* pool = new FramePool();
+    return *pool;
+}
+
+int FramePool::AlignedStride(int width) {
+    return ((width * 4) + 63) & ~63;
+}
+
+size_t FramePool::SizeClass(size_t bytes) {
+    if (bytes <= MIN_CLASS_BYTES) return MIN_CLASS_BYTES;
+
+    // Quarter steps between powers of two: at most 25% slack per block
+    size_t base = MIN_CLASS_BYTES;
+    while (base * 2 < bytes) base *= 2;
+    for (int q = 1; q <= 4; q++) {
+        size_t size = base + (base / 4) * q;
+        if (size >= bytes) return size;
+    }
+    return base * 2;
+}
+
+bool FramePool::MapBlock(size_t capacity, Block& block) {
+    block = {};
+    block.capacity = capacity;
+    block.sizeClass = capacity;
+
+#ifdef _WIN32
+    bool large = false;
+    DWORD protect = PAGE_READWRITE | SEC_COMMIT;
+    DWORD access = FILE_MAP_ALL_ACCESS;
+    if (m_largePages) {
+        size_t largeMin = GetLargePageMinimum();
+        if (largeMin) {
+            capacity = (capacity + largeMin - 1) & ~(largeMin - 1);
+            protect |= SEC_LARGE_PAGES;
+#ifdef FILE_MAP_LARGE_PAGES
+            access |= FILE_MAP_LARGE_PAGES;
+#endif
+            large = true;
+        }
+    }
+
+    HANDLE hSection = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, protect,
+        (DWORD)((uint64_t)capacity >> 32), (DWORD)capacity, NULL);
+    if (!hSection && large) {
+        // Privilege missing or no contiguous large pages left: fall back
+        large = false;
+        capacity = block.sizeClass;
+        protect = PAGE_READWRITE | SEC_COMMIT;
+        access = FILE_MAP_ALL_ACCESS;
+        hSection = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, protect,
+            (DWORD)((uint64_t)capacity >> 32), (DWORD)capacity, NULL);
+    }
+    if (!hSection) return false;
+
+    void* view = MapViewOfFile(hSection, access, 0, 0, capacity);
+    if (!view) {
+        CloseHandle(hSection);
+        return false;
+    }
+
+    block.base = (uint8_t*)view;
+    block.section = hSection;
+    block.capacity = capacity;
+    block.largePages = large;
+#else
+    void* view = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (view == MAP_FAILED) return false;
+
+    block.base = (uint8_t*)view;
+#ifdef MADV_HUGEPAGE
+    if (m_largePages && madvise(view, capacity, MADV_HUGEPAGE) == 0) {
+        block.largePages = true;
+    }
+#endif
+#endif
+    return true;
+}
+
+void FramePool::UnmapBlock(Block& block) {
+#ifdef _WIN32
+    UnmapViewOfFile(block.base);
+    CloseHandle((HANDLE)block.section);
+#else
+    munmap(block.base, block.capacity);
+#endif
+    block.base = nullptr;
+    block.section = nullptr;
+}
+
+uint64_t FramePool::Prefault(const Block& block) {
+    // Write one byte per page so the zero-fill faults happen here, not in
+    // the middle of a capture. Large pages fault in fewer, bigger steps but
+    // touching every 4K page is still correct and cheap.
+    volatile uint8_t* p = block.base;
+    uint64_t pages = 0;
+    for (size_t offset = 0; offset < block.capacity; offset += PAGE_BYTES) {
+        p[offset] = 0;
+        pages++;
+    }
+    return pages;
+}
+
+FrameRef FramePool::Acquire(int width, int height) {
+    if (width <= 0 || height <= 0) return nullptr;
+
+    int stride = AlignedStride(width);
+    size_t sizeClass = SizeClass((size_t)stride * height);
+
+    Block block = {};
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_free.find(sizeClass);
+        if (it != m_free.end() && !it->second.empty()) {
+            // Most recently released block is the most likely to be resident
+            block = it->second.back();
+            it->second.pop_back();
+            m_stats.hits++;
+            m_stats.bytesCached -= block.capacity;
+            m_stats.bytesInUse += block.capacity;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        if (!MapBlock(sizeClass, block)) return nullptr;
+        uint64_t pages = Prefault(block);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.misses++;
+        m_stats.faultedPages += pages;
+        m_stats.bytesInUse += block.capacity;
+        if (block.largePages) m_stats.largePageBlocks++;
+    }
+
+    FrameBuffer* frame = new FrameBuffer();
+    frame->m_bits = block.base;
+    frame->m_section = block.section;
+    frame->m_capacity = block.capacity;
+    frame->m_largePages = block.largePages;
+    frame->m_sizeClass = block.sizeClass;
+    frame->m_width = width;
+    frame->m_height = height;
+    frame->m_stride = stride;
+
+    return FrameRef(frame, [this](FrameBuffer* f) { Release(f); });
+}
+
+void FramePool::Release(FrameBuffer* frame) {
+    Block block = {};
+    block.base = frame->m_bits;
+    block.section = frame->m_section;
+    block.capacity = frame->m_capacity;
+    block.largePages = frame->m_largePages;
+    block.sizeClass = frame->m_sizeClass;
+    block.releasedAt = std::chrono::steady_clock::now();
+    delete frame;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_free[block.sizeClass].push_back(block);
+    m_stats.bytesInUse -= block.capacity;
+    m_stats.bytesCached += block.capacity;
+}
+
+FrameRef FramePool::SubView(const FrameRef& parent, int x, int y, int width, int height) {
+    if (!parent) return nullptr;
+
+    int left = x < 0 ? 0 : x;
+    int top = y < 0 ? 0 : y;
+    int right = x + width > parent->Width() ? parent->Width() : x + width;
+    int bottom = y + height > parent->Height() ? parent->Height() : y + height;
+    if (right <= left || bottom <= top) return nullptr;
+
+    size_t offset = (size_t)top * parent->Stride() + (size_t)left * 4;
+
+    FrameBuffer* view = new FrameBuffer();
+    view->m_bits = parent->Bits() + offset;
+    view->m_section = parent->Section();
+    view->m_sectionOffset = parent->SectionOffset() + offset;
+    view->m_width = right - left;
+    view->m_height = bottom - top;
+    view->m_stride = parent->Stride();
+    view->m_left = parent->Left() + left;
+    view->m_isView = true;
+
+    // The deleter owns a parent reference; the block goes back to the pool
+    // only after the last view of it is gone
+    FrameRef keepAlive = parent;
+    return FrameRef(view, [keepAlive](FrameBuffer* f) { delete f; });
+}
+
+void FramePool::Prewarm(int width, int height, int count) {
+    std::vector<FrameRef> frames;
+    for (int i = 0; i < count; i++) {
+        FrameRef frame = Acquire(width, height);
+        if (!frame) break;
+        frames.push_back(frame);
+    }
+    // Dropping the references parks the pre-faulted blocks in the cache
+}
+
+size_t FramePool::Trim(uint32_t idleMs) {
+    auto now = std::chrono::steady_clock::now();
+    auto idle = std::chrono::milliseconds(idleMs);
+    std::vector<Block> victims;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& entry : m_free) {
+            std::vector<Block>& blocks = entry.second;
+            for (size_t i = 0; i < blocks.size();) {
+                if (now - blocks[i].releasedAt >= idle) {
+                    victims.push_back(blocks[i]);
+                    blocks[i] = blocks.back();
+                    blocks.pop_back();
+                } else {
+                    i++;
+                }
+            }
+        }
+        for (const Block& block : victims) {
+            m_stats.bytesCached -= block.capacity;
+            m_stats.trimmedBlocks++;
+        }
+    }
+
+    size_t bytes = 0;
+    for (Block& block : victims) {
+        bytes += block.capacity;
+        UnmapBlock(block);
+    }
+    return bytes;
+}
+
+bool FramePool::EnableLargePages(bool enable) {
+    bool ok = !enable;
+#ifdef _WIN32
+    if (enable && GetLargePageMinimum()) {
+        HANDLE hToken = NULL;
+        if (OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &hToken)) {
+            TOKEN_PRIVILEGES tp = {};
+            tp.PrivilegeCount = 1;
+            tp.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+            if (LookupPrivilegeValueW(NULL, SE_LOCK_MEMORY_NAME, &tp.Privileges[0].Luid) &&
+                AdjustTokenPrivileges(hToken, FALSE, &tp, 0, NULL, NULL) &&
+                GetLastError() == ERROR_SUCCESS) {
+                ok = true;
+            }
+            CloseHandle(hToken);
+        }
+    }
+#else
+#ifdef MADV_HUGEPAGE
+    if (enable) ok = true;
+#endif
+#endif
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_largePages = enable && ok;
+    return ok;
+}
+
+FramePoolStats FramePool::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+} // namespace ScreenCapture
@@ -0,0 +1,124 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ScreenCapture {
+
+// Pool counters (monotonic since process start)
+struct FramePoolStats {
+    uint64_t hits;            // Acquire served from a cached block
+    uint64_t misses;          // Acquire had to map a fresh block
+    uint64_t faultedPages;    // Pages touched while pre-faulting fresh blocks
+    uint64_t trimmedBlocks;   // Blocks released by Trim()
+    uint64_t largePageBlocks; // Blocks backed by large pages
+    size_t bytesInUse;
+    size_t bytesCached;
+};
+
+// Pooled 32bpp top-down surface. Every row starts on a 64-byte boundary:
+// the stride is padded up to a multiple of 64 so SIMD loops can run whole
+// vectors per row without alignment prologues.
+class FrameBuffer {
+public:
+    uint8_t* Bits() const { return m_bits; }
+    uint8_t* Row(int y) const { return m_bits + (size_t)y * m_stride; }
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+    int Stride() const { return m_stride; }
+    size_t Capacity() const { return m_capacity; }
+
+    // Win32 file-mapping handle backing the block (NULL on other platforms).
+    // Lets GDI create a DIB section over pooled memory without copying.
+    void* Section() const { return m_section; }
+    size_t SectionOffset() const { return m_sectionOffset; }
+
+    // True for sub-views made by FramePool::SubView
+    bool IsView() const { return m_isView; }
+
+    // Column of the view inside its parent's rows (0 for whole frames).
+    // Bits() - Left() * 4 starts a whole parent row; GDI bitmaps of
+    // Stride() / 4 pixels per row must start there, or the last row runs
+    // Left() * 4 bytes past the parent's block.
+    int Left() const { return m_left; }
+
+private:
+    friend class FramePool;
+    FrameBuffer() = default;
+
+    uint8_t* m_bits = nullptr;
+    void* m_section = nullptr;
+    size_t m_capacity = 0;
+    size_t m_sizeClass = 0;
+    size_t m_sectionOffset = 0;
+    bool m_largePages = false;
+    bool m_isView = false;
+    int m_width = 0;
+    int m_height = 0;
+    int m_stride = 0;
+    int m_left = 0;
+};
+
+// Shared handle; the last reference returns the block to the pool
+using FrameRef = std::shared_ptr<FrameBuffer>;
+
+// Size-classed cache of page-aligned frame blocks. Releasing a frame keeps
+// its pages committed and resident, so the next capture of a similar size
+// skips both the allocation and the zero-fill page faults.
+class FramePool {
+public:
+    static FramePool& Instance();
+
+    // Get a frame of at least width x height pixels (contents undefined)
+    FrameRef Acquire(int width, int height);
+
+    // Zero-copy rectangle of an existing frame. The view shares the parent's
+    // pixels and stride (rows are no longer 64-byte aligned unless x is a
+    // multiple of 16) and keeps the parent alive until the view is released.
+    // The rectangle is clipped to the parent; returns NULL if empty.
+    static FrameRef SubView(const FrameRef& parent, int x, int y, int width, int height);
+
+    // Map and pre-fault 'count' blocks for width x height ahead of time
+    void Prewarm(int width, int height, int count);
+
+    // Release cached blocks that have been idle longer than idleMs.
+    // Returns the number of bytes given back to the OS.
+    size_t Trim(uint32_t idleMs);
+
+    // Try to back new blocks with large pages (needs SeLockMemoryPrivilege
+    // on Windows, transparent huge pages elsewhere). Returns false when the
+    // platform refuses; the pool then keeps using normal pages.
+    bool EnableLargePages(bool enable);
+
+    FramePoolStats GetStats() const;
+
+    static int AlignedStride(int width);
+
+private:
+    struct Block {
+        uint8_t* base;
+        void* section;
+        size_t capacity;    // May exceed sizeClass when rounded to large pages
+        size_t sizeClass;
+        bool largePages;
+        std::chrono::steady_clock::time_point releasedAt;
+    };
+
+    FramePool() = default;
+    static size_t SizeClass(size_t bytes);
+    bool MapBlock(size_t capacity, Block& block);
+    void UnmapBlock(Block& block);
+    uint64_t Prefault(const Block& block);
+    void Release(FrameBuffer* frame);
+
+    mutable std::mutex m_mutex;
+    std::map<size_t, std::vector<Block>> m_free;  // keyed by size class
+    FramePoolStats m_stats = {};
+    bool m_largePages = false;
+};
+
+} // namespace ScreenCapture
@@ -1,8 +1,15 @@
 #include "hotkeys.h"
 #include "capture.h"
 #include "overlay.h"
+#include "burst.h"
+#include "recorder.h"
+#include "encodepool.h"
 #include <stdio.h>
 
+#ifndef MOD_NOREPEAT
+#define MOD_NOREPEAT 0x4000
+#endif
+
 namespace ScreenCapture {
 
 // Debug logging helper
@@ -47,6 +54,25 @@ bool RegisterHotkeys(HWND hwnd) {
         return false;
     }
     
+    // Ctrl + Shift + PrintScreen (hold) - Burst
+    if (!RegisterHotKey(hwnd, HOTKEY_BURST, MOD_CONTROL | MOD_SHIFT | MOD_NOREPEAT, VK_SNAPSHOT)) {
+        DebugLog(L"  ERROR: Failed to register HOTKEY_BURST");
+        UnregisterHotKey(hwnd, HOTKEY_FULLSCREEN);
+        UnregisterHotKey(hwnd, HOTKEY_WINDOW);
+        UnregisterHotKey(hwnd, HOTKEY_REGION);
+        return false;
+    }
+    
+    // Ctrl + Alt + PrintScreen - Start/stop recording
+    if (!RegisterHotKey(hwnd, HOTKEY_RECORD, MOD_CONTROL | MOD_ALT | MOD_NOREPEAT, VK_SNAPSHOT)) {
+        DebugLog(L"  ERROR: Failed to register HOTKEY_RECORD");
+        UnregisterHotKey(hwnd, HOTKEY_FULLSCREEN);
+        UnregisterHotKey(hwnd, HOTKEY_WINDOW);
+        UnregisterHotKey(hwnd, HOTKEY_REGION);
+        UnregisterHotKey(hwnd, HOTKEY_BURST);
+        return false;
+    }
+    
     DebugLog(L"  All hotkeys registered successfully");
     return true;
 }
@@ -55,6 +81,122 @@ void UnregisterHotkeys(HWND hwnd) {
     UnregisterHotKey(hwnd, HOTKEY_FULLSCREEN);
     UnregisterHotKey(hwnd, HOTKEY_WINDOW);
     UnregisterHotKey(hwnd, HOTKEY_REGION);
+    UnregisterHotKey(hwnd, HOTKEY_BURST);
+    UnregisterHotKey(hwnd, HOTKEY_RECORD);
+}
+
+// Tick count: the clock message times are taken from
+class TickRequestClock : public RequestClock {
+public:
+    uint64_t NowMs() const override { return GetTickCount64(); }
+};
+
+// Capture requests from hotkeys and the tray wait here until the message
+// loop dispatches them (see DispatchCaptureRequest)
+static TickRequestClock g_requestClock;
+static RequestScheduler g_requests(g_requestClock, RequestPolicy::Default());
+static HWND g_requestWindow = NULL;
+static bool g_dispatchPosted = false;
+
+static const wchar_t* KindName(CaptureKind kind) {
+    switch (kind) {
+        case CaptureKind::FullScreen: return L"fullscreen";
+        case CaptureKind::ActiveWindow: return L"window";
+        case CaptureKind::Region: return L"region";
+    }
+    return L"?";
+}
+
+static void PostDispatch() {
+    if (g_requestWindow && !g_dispatchPosted) {
+        g_dispatchPosted = PostMessageW(g_requestWindow, WM_CAPTURE_REQUEST, 0, 0) != FALSE;
+    }
+}
+
+void InitCaptureRequests(HWND hwnd) {
+    g_requestWindow = hwnd;
+}
+
+// When the message being handled was posted, on the request clock. A key
+// pressed during a region selection is handled only after the overlay
+// closes; its message time is when the user actually pressed it.
+static uint64_t MessageTimeMs() {
+    uint64_t now = g_requestClock.NowMs();
+    DWORD age = (DWORD)now - (DWORD)GetMessageTime();  // 32-bit ticks wrap
+    if (age > 0x7FFFFFFF || age > now) age = 0;
+    return now - age;
+}
+
+void SubmitCaptureRequest(CaptureKind kind) {
+    uint64_t atMs = MessageTimeMs();
+    SubmitResult result = g_requests.Submit(kind, RequestScheduler::DefaultPriority(kind), atMs);
+    DebugLog(L"  Request %s: id=%llu merged=%d age=%llums", KindName(kind), result.id, result.merged,
+        g_requestClock.NowMs() - atMs);
+    
+    // The user is about to select a region: queued saves switch to the
+    // fast preset so they leave the CPU to the overlay sooner
+    if (result.preempt) {
+        size_t downgraded = GetEncodePool().DowngradeQueued();
+        if (downgraded) DebugLog(L"  Downgraded %zu queued encodes", downgraded);
+    }
+    PostDispatch();
+}
+
+static void RunRegionCapture() {
+    DebugLog(L"  Region - creating Overlay");
+    Overlay overlay;
+    DebugLog(L"  Overlay created, calling Show()...");
+    bool result = overlay.Show();
+    DebugLog(L"  overlay.Show() returned: %d", result);
+    
+    if (result) {
+        RECT rect = overlay.GetSelectedRegion();
+        DebugLog(L"  Selected rect: L=%d T=%d R=%d B=%d", rect.left, rect.top, rect.right, rect.bottom);
+        
+        // Crop from the overlay's frozen frame: no re-capture, so no
+        // need to wait for the overlay window to disappear
+        DebugLog(L"  Calling CaptureRegionFromFrame()...");
+        bool captureResult = CaptureRegionFromFrame(overlay.GetSelectedFrame());
+        DebugLog(L"  CaptureRegionFromFrame() returned: %d", captureResult);
+    } else {
+        DebugLog(L"  Overlay was cancelled (ESC pressed)");
+    }
+}
+
+void DispatchCaptureRequest() {
+    g_dispatchPosted = false;
+    
+    // Runs inside the window procedure and blocks the main message loop
+    // until the capture returns. Nothing re-enters: the overlay's modal
+    // loop only retrieves messages for its own window, so this message and
+    // WM_HOTKEY wait in the queue until the selection ends.
+    CaptureRequest request;
+    if (!g_requests.Next(&request)) return;
+    
+    DebugLog(L"=== Dispatch %s: id=%llu waited=%llums merged=%d ===", KindName(request.kind), request.id,
+        g_requestClock.NowMs() - request.submittedMs, request.merged);
+    switch (request.kind) {
+        case CaptureKind::FullScreen:
+            CaptureFullScreen();
+            break;
+        case CaptureKind::ActiveWindow:
+            CaptureActiveWindow();
+            break;
+        case CaptureKind::Region:
+            RunRegionCapture();
+            break;
+    }
+    
+    // One request per message, so input and paint messages interleave
+    if (!g_requests.Empty()) PostDispatch();
+}
+
+void ShutdownCaptureRequests() {
+    size_t cancelled = g_requests.CancelAll();
+    RequestSchedulerStats stats = g_requests.GetStats();
+    DebugLog(L"Capture requests: submitted=%llu dispatched=%llu merged=%llu expired=%llu evicted=%llu cancelled=%llu (%zu at exit)",
+        stats.submitted, stats.dispatched, stats.merged, stats.expired, stats.evicted, stats.cancelled, cancelled);
+    g_requestWindow = NULL;
 }
 
 void HandleHotkey(int hotkeyId) {
@@ -62,40 +204,27 @@ void HandleHotkey(int hotkeyId) {
     
     switch (hotkeyId) {
         case HOTKEY_FULLSCREEN:
-            DebugLog(L"  HOTKEY_FULLSCREEN - calling CaptureFullScreen()");
-            CaptureFullScreen();
-            DebugLog(L"  CaptureFullScreen() returned");
+            SubmitCaptureRequest(CaptureKind::FullScreen);
             break;
             
         case HOTKEY_WINDOW:
-            DebugLog(L"  HOTKEY_WINDOW - calling CaptureActiveWindow()");
-            CaptureActiveWindow();
-            DebugLog(L"  CaptureActiveWindow() returned");
+            SubmitCaptureRequest(CaptureKind::ActiveWindow);
             break;
             
-        case HOTKEY_REGION: {
-            DebugLog(L"  HOTKEY_REGION - creating Overlay");
-            Overlay overlay;
-            DebugLog(L"  Overlay created, calling Show()...");
-            bool result = overlay.Show();
-            DebugLog(L"  overlay.Show() returned: %d", result);
+        case HOTKEY_REGION:
+            SubmitCaptureRequest(CaptureKind::Region);
+            break;
+        
+        case HOTKEY_BURST:
+            DebugLog(L"  HOTKEY_BURST - calling StartBurst()");
+            StartBurst();
+            DebugLog(L"  StartBurst() returned (burst runs on its own thread)");
+            break;
             
-            if (result) {
-                RECT rect = overlay.GetSelectedRegion();
-                DebugLog(L"  Selected rect: L=%d T=%d R=%d B=%d", rect.left, rect.top, rect.right, rect.bottom);
-                
-                // Small delay to ensure overlay is fully closed
-                DebugLog(L"  Sleeping 100ms...");
-                Sleep(100);
-                
-                DebugLog(L"  Calling CaptureRegion()...");
-                bool captureResult = CaptureRegion(rect);
-                DebugLog(L"  CaptureRegion() returned: %d", captureResult);
-            } else {
-                DebugLog(L"  Overlay was cancelled (ESC pressed)");
-            }
+        case HOTKEY_RECORD:
+            DebugLog(L"  HOTKEY_RECORD - calling ToggleRecording() (recording=%d)", IsRecording());
+            ToggleRecording();
             break;
-        }
     }
     
     DebugLog(L"=== HandleHotkey completed ===\n");
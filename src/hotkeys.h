@@ -1,12 +1,15 @@
 #pragma once
 #include <windows.h>
+#include "requestscheduler.h"
 
 namespace ScreenCapture {
 
 enum HotkeyID {
     HOTKEY_FULLSCREEN = 1,
     HOTKEY_WINDOW = 2,
-    HOTKEY_REGION = 3
+    HOTKEY_REGION = 3,
+    HOTKEY_BURST = 4,
+    HOTKEY_RECORD = 5
 };
 
 // Register all hotkeys
@@ -15,7 +18,23 @@ bool RegisterHotkeys(HWND hwnd);
 // Unregister all hotkeys
 void UnregisterHotkeys(HWND hwnd);
 
-// Handle hotkey message
+// Posted to the main window when capture requests are waiting
+static const UINT WM_CAPTURE_REQUEST = WM_APP + 1;
+
+// Handle hotkey message. Captures are only queued here; burst and
+// recording toggles run immediately.
 void HandleHotkey(int hotkeyId);
 
+// Capture request queue shared by hotkeys and the tray menu. Submit from
+// the handler of the input message: the request is stamped with its
+// message time.
+void InitCaptureRequests(HWND hwnd);
+void SubmitCaptureRequest(CaptureKind kind);
+
+// WM_CAPTURE_REQUEST handler: run one queued capture, re-post if more wait
+void DispatchCaptureRequest();
+
+// Drop queued requests and log scheduler statistics
+void ShutdownCaptureRequests();
+
 } // namespace ScreenCapture
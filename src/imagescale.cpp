@@ -0,0 +1,63 @@
+#include "imagescale.h"
+#include "taskscheduler.h"
+#include <algorithm>
+#include <vector>
+
+namespace ScreenCapture {
+
+static const int SCALE_GRAIN_ROWS = 8;
+
+void DownscaleBox(const uint8_t* src, int srcWidth, int srcHeight, int srcStride,
+                  uint8_t* dst, int dstWidth, int dstHeight, int dstStride) {
+    if (dstWidth <= 0 || dstHeight <= 0 || dstWidth > srcWidth || dstHeight > srcHeight) return;
+
+    // Source column span of every destination column, shared by all rows
+    std::vector<int> colStart(dstWidth + 1);
+    for (int x = 0; x <= dstWidth; x++) {
+        colStart[x] = (int)((int64_t)x * srcWidth / dstWidth);
+    }
+
+    ParallelFor(0, dstHeight, SCALE_GRAIN_ROWS, [&](int y0, int y1) {
+        // Per-column channel sums of the current source row band
+        std::vector<uint32_t> sums((size_t)dstWidth * 4);
+        for (int y = y0; y < y1; y++) {
+            int sy0 = (int)((int64_t)y * srcHeight / dstHeight);
+            int sy1 = (int)((int64_t)(y + 1) * srcHeight / dstHeight);
+            std::fill(sums.begin(), sums.end(), 0u);
+
+            for (int sy = sy0; sy < sy1; sy++) {
+                const uint8_t* row = src + (size_t)sy * srcStride;
+                uint32_t* sum = sums.data();
+                for (int x = 0; x < dstWidth; x++, sum += 4) {
+                    const uint8_t* px = row + (size_t)colStart[x] * 4;
+                    const uint8_t* end = row + (size_t)colStart[x + 1] * 4;
+                    uint32_t b = 0, g = 0, r = 0, a = 0;
+                    for (; px < end; px += 4) {
+                        b += px[0];
+                        g += px[1];
+                        r += px[2];
+                        a += px[3];
+                    }
+                    sum[0] += b;
+                    sum[1] += g;
+                    sum[2] += r;
+                    sum[3] += a;
+                }
+            }
+
+            uint8_t* out = dst + (size_t)y * dstStride;
+            const uint32_t* sum = sums.data();
+            uint32_t rows = (uint32_t)(sy1 - sy0);
+            for (int x = 0; x < dstWidth; x++, sum += 4, out += 4) {
+                uint32_t count = rows * (uint32_t)(colStart[x + 1] - colStart[x]);
+                uint32_t half = count / 2;
+                out[0] = (uint8_t)((sum[0] + half) / count);
+                out[1] = (uint8_t)((sum[1] + half) / count);
+                out[2] = (uint8_t)((sum[2] + half) / count);
+                out[3] = (uint8_t)((sum[3] + half) / count);
+            }
+        }
+    });
+}
+
+} // namespace ScreenCapture
@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdint>
+
+namespace ScreenCapture {
+
+// Area-average (box filter) downscale of a top-down 32bpp surface. Every
+// destination pixel is the mean of the source pixels it covers, so text
+// and thin lines stay legible instead of aliasing. dstWidth/dstHeight must
+// not exceed the source size. Rows run in parallel on the task scheduler.
+void DownscaleBox(const uint8_t* src, int srcWidth, int srcHeight, int srcStride,
+                  uint8_t* dst, int dstWidth, int dstHeight, int dstStride);
+
+} // namespace ScreenCapture
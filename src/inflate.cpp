@@ -0,0 +1,266 @@
+#include "inflate.h"
+#include <cstring>
+
+namespace ScreenCapture {
+
+namespace {
+
+struct BitReader {
+    const uint8_t* src;
+    size_t len;
+    size_t pos;
+    uint32_t bitBuffer;
+    int bitCount;
+
+    bool Need(int n) {
+        while (bitCount < n) {
+            if (pos >= len) return false;
+            bitBuffer |= (uint32_t)src[pos++] << bitCount;
+            bitCount += 8;
+        }
+        return true;
+    }
+
+    bool Bits(int n, uint32_t* value) {
+        if (n == 0) { *value = 0; return true; }
+        if (!Need(n)) return false;
+        *value = bitBuffer & ((1u << n) - 1);
+        bitBuffer >>= n;
+        bitCount -= n;
+        return true;
+    }
+
+    void AlignToByte() {
+        int drop = bitCount & 7;
+        bitBuffer >>= drop;
+        bitCount -= drop;
+    }
+};
+
+// Canonical Huffman decoding table (counts per length + sorted symbols)
+struct Huffman {
+    uint16_t counts[16];
+    uint16_t symbols[288];
+
+    bool Build(const uint8_t* lengths, int n) {
+        memset(counts, 0, sizeof(counts));
+        for (int i = 0; i < n; i++) counts[lengths[i]]++;
+        counts[0] = 0;
+
+        // Over-subscribed sets are invalid; incomplete ones are allowed
+        int left = 1;
+        for (int len = 1; len < 16; len++) {
+            left <<= 1;
+            left -= counts[len];
+            if (left < 0) return false;
+        }
+
+        uint16_t offsets[16];
+        offsets[1] = 0;
+        for (int len = 1; len < 15; len++) offsets[len + 1] = offsets[len] + counts[len];
+        for (int i = 0; i < n; i++) {
+            if (lengths[i]) symbols[offsets[lengths[i]]++] = (uint16_t)i;
+        }
+        return true;
+    }
+
+    int Decode(BitReader& br) const {
+        int code = 0, first = 0, index = 0;
+        for (int len = 1; len < 16; len++) {
+            uint32_t bit;
+            if (!br.Bits(1, &bit)) return -1;
+            code |= (int)bit;
+            int count = counts[len];
+            if (code - count < first) return symbols[index + (code - first)];
+            index += count;
+            first += count;
+            first <<= 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+};
+
+const uint16_t LENGTH_BASE[29] = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258 };
+const uint8_t LENGTH_EXTRA[29] = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+const uint16_t DIST_BASE[30] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
+const uint8_t DIST_EXTRA[30] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+
+bool InflateCodes(BitReader& br, const Huffman& lit, const Huffman& dist, std::vector<uint8_t>& out, size_t base) {
+    for (;;) {
+        int sym = lit.Decode(br);
+        if (sym < 0) return false;
+        if (sym < 256) {
+            out.push_back((uint8_t)sym);
+        } else if (sym == 256) {
+            return true;
+        } else {
+            sym -= 257;
+            if (sym >= 29) return false;
+            uint32_t extra;
+            if (!br.Bits(LENGTH_EXTRA[sym], &extra)) return false;
+            size_t length = LENGTH_BASE[sym] + extra;
+
+            int dsym = dist.Decode(br);
+            if (dsym < 0 || dsym >= 30) return false;
+            if (!br.Bits(DIST_EXTRA[dsym], &extra)) return false;
+            size_t distance = DIST_BASE[dsym] + extra;
+            if (distance > out.size() - base) return false;
+
+            size_t from = out.size() - distance;
+            for (size_t i = 0; i < length; i++) out.push_back(out[from + i]);
+        }
+    }
+}
+
+bool InflateFixed(BitReader& br, std::vector<uint8_t>& out, size_t base) {
+    uint8_t lengths[288 + 30];
+    int i = 0;
+    for (; i < 144; i++) lengths[i] = 8;
+    for (; i < 256; i++) lengths[i] = 9;
+    for (; i < 280; i++) lengths[i] = 7;
+    for (; i < 288; i++) lengths[i] = 8;
+    for (; i < 288 + 30; i++) lengths[i] = 5;
+
+    Huffman lit, dist;
+    if (!lit.Build(lengths, 288) || !dist.Build(lengths + 288, 30)) return false;
+    return InflateCodes(br, lit, dist, out, base);
+}
+
+bool InflateDynamic(BitReader& br, std::vector<uint8_t>& out, size_t base) {
+    static const uint8_t ORDER[19] = { 16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15 };
+    uint32_t hlit, hdist, hclen;
+    if (!br.Bits(5, &hlit) || !br.Bits(5, &hdist) || !br.Bits(4, &hclen)) return false;
+    hlit += 257;
+    hdist += 1;
+    hclen += 4;
+    if (hlit > 286 || hdist > 30) return false;
+
+    uint8_t lengths[288 + 32] = {};
+    for (uint32_t i = 0; i < hclen; i++) {
+        uint32_t len;
+        if (!br.Bits(3, &len)) return false;
+        lengths[ORDER[i]] = (uint8_t)len;
+    }
+    Huffman codeLengths;
+    if (!codeLengths.Build(lengths, 19)) return false;
+
+    uint32_t index = 0;
+    memset(lengths, 0, sizeof(lengths));
+    while (index < hlit + hdist) {
+        int sym = codeLengths.Decode(br);
+        if (sym < 0) return false;
+        if (sym < 16) {
+            lengths[index++] = (uint8_t)sym;
+            continue;
+        }
+        uint8_t value = 0;
+        uint32_t repeat;
+        if (sym == 16) {
+            if (index == 0) return false;
+            value = lengths[index - 1];
+            if (!br.Bits(2, &repeat)) return false;
+            repeat += 3;
+        } else if (sym == 17) {
+            if (!br.Bits(3, &repeat)) return false;
+            repeat += 3;
+        } else {
+            if (!br.Bits(7, &repeat)) return false;
+            repeat += 11;
+        }
+        if (index + repeat > hlit + hdist) return false;
+        while (repeat--) lengths[index++] = value;
+    }
+    if (lengths[256] == 0) return false;
+
+    Huffman lit, dist;
+    if (!lit.Build(lengths, (int)hlit) || !dist.Build(lengths + hlit, (int)hdist)) return false;
+    return InflateCodes(br, lit, dist, out, base);
+}
+
+bool InflateStored(BitReader& br, std::vector<uint8_t>& out) {
+    br.AlignToByte();
+    uint32_t len, nlen;
+    if (!br.Bits(16, &len) || !br.Bits(16, &nlen)) return false;
+    if ((len ^ 0xFFFF) != nlen) return false;
+
+    // Whole bytes may still sit in the bit buffer after alignment
+    while (len && br.bitCount >= 8) {
+        out.push_back((uint8_t)br.bitBuffer);
+        br.bitBuffer >>= 8;
+        br.bitCount -= 8;
+        len--;
+    }
+    if (br.pos + len > br.len) return false;
+    out.insert(out.end(), br.src + br.pos, br.src + br.pos + len);
+    br.pos += len;
+    return true;
+}
+
+bool InflateBlocks(BitReader& br, std::vector<uint8_t>& out) {
+    size_t base = out.size();
+    uint32_t last = 0;
+    while (!last) {
+        uint32_t type;
+        if (!br.Bits(1, &last) || !br.Bits(2, &type)) return false;
+        bool ok = false;
+        switch (type) {
+            case 0: ok = InflateStored(br, out); break;
+            case 1: ok = InflateFixed(br, out, base); break;
+            case 2: ok = InflateDynamic(br, out, base); break;
+            default: ok = false; break;
+        }
+        if (!ok) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+uint32_t Adler32(uint32_t adler, const uint8_t* data, size_t len) {
+    uint32_t s1 = adler & 0xFFFF;
+    uint32_t s2 = adler >> 16;
+    while (len) {
+        size_t block = len < 5552 ? len : 5552;
+        len -= block;
+        while (block--) {
+            s1 += *data++;
+            s2 += s1;
+        }
+        s1 %= 65521;
+        s2 %= 65521;
+    }
+    return (s2 << 16) | s1;
+}
+
+uint32_t Adler32Combine(uint32_t adlerA, uint32_t adlerB, size_t lenB) {
+    const uint64_t BASE = 65521;
+    uint64_t rem = lenB % BASE;
+    uint64_t s1 = (adlerA & 0xFFFF) + (adlerB & 0xFFFF) + BASE - 1;
+    uint64_t s2 = rem * (adlerA & 0xFFFF) + (adlerA >> 16) + (adlerB >> 16) + BASE - rem;
+    s1 %= BASE;
+    s2 %= BASE;
+    return (uint32_t)((s2 << 16) | s1);
+}
+
+bool RawInflate(const uint8_t* src, size_t srcLen, std::vector<uint8_t>& out) {
+    BitReader br = { src, srcLen, 0, 0, 0 };
+    return InflateBlocks(br, out);
+}
+
+bool ZlibDecompress(const uint8_t* src, size_t srcLen, std::vector<uint8_t>& out) {
+    if (srcLen < 6) return false;
+    if ((src[0] & 0x0F) != 8 || ((src[0] << 8) | src[1]) % 31 != 0) return false;
+    if (src[1] & 0x20) return false;  // Preset dictionaries are not used by PNG
+
+    size_t start = out.size();
+    BitReader br = { src + 2, srcLen - 6, 0, 0, 0 };
+    if (!InflateBlocks(br, out)) return false;
+
+    const uint8_t* trailer = src + srcLen - 4;
+    uint32_t expected = ((uint32_t)trailer[0] << 24) | ((uint32_t)trailer[1] << 16) |
+                        ((uint32_t)trailer[2] << 8) | trailer[3];
+    return Adler32(1, out.data() + start, out.size() - start) == expected;
+}
+
+} // namespace ScreenCapture
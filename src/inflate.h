@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ScreenCapture {
+
+// Minimal zlib (RFC 1950/1951) decoder: the read side of stb's deflate.
+// Handles stored, fixed and dynamic Huffman blocks; verifies the Adler-32
+// trailer. Appends the decompressed bytes to 'out'.
+bool ZlibDecompress(const uint8_t* src, size_t srcLen, std::vector<uint8_t>& out);
+
+// Same, for streams without the 2-byte zlib header and Adler-32 trailer
+bool RawInflate(const uint8_t* src, size_t srcLen, std::vector<uint8_t>& out);
+
+uint32_t Adler32(uint32_t adler, const uint8_t* data, size_t len);
+
+// Adler-32 of A followed by B, given Adler32(1, A), Adler32(1, B) and len(B)
+uint32_t Adler32Combine(uint32_t adlerA, uint32_t adlerB, size_t lenB);
+
+} // namespace ScreenCapture
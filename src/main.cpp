@@ -2,10 +2,16 @@
 #include <dwmapi.h>
 #include "hotkeys.h"
 #include "capture.h"
-#include "overlay.h"
 #include "tray.h"
 #include "utils.h"
+#include "framepool.h"
+#include "burst.h"
+#include "recorder.h"
+#include "timedcapture.h"
+#include "memorygovernor.h"
 #include <stdio.h>
+#include <string.h>
+#include <thread>
 
 #pragma comment(lib, "dwmapi.lib")
 #pragma comment(lib, "shell32.lib")
@@ -18,6 +24,11 @@ using namespace ScreenCapture;
 static const wchar_t* WINDOW_CLASS = L"ScreenCaptureMainWindow";
 static TrayIcon* g_trayIcon = nullptr;
 
+// Frame pool upkeep: check every 30s, unmap blocks idle for over a minute
+static const UINT_PTR TIMER_POOL_TRIM = 1;
+static const UINT POOL_TRIM_INTERVAL_MS = 30000;
+static const DWORD POOL_IDLE_MS = 60000;
+
 // Debug logging
 static void MainLog(const wchar_t* format, ...) {
     FILE* f = _wfopen(L"debug_main.txt", L"a");
@@ -51,15 +62,46 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                 MessageBoxW(hwnd, L"Không thể tạo tray icon!", L"Lỗi", MB_ICONERROR);
                 return -1;
             }
+            
+            // Pre-fault two virtual-screen frames in the background so the
+            // first capture (or overlay) does not pay for page faults
+            std::thread([]() {
+                RECT vs = GetVirtualScreenRect();
+                FramePool::Instance().Prewarm(vs.right - vs.left, vs.bottom - vs.top, 2);
+            }).detach();
+            SetTimer(hwnd, TIMER_POOL_TRIM, POOL_TRIM_INTERVAL_MS, NULL);
+            
+            InitCaptureRequests(hwnd);
+            
+            // Screen DC, DIB targets and save paths ready before the first hotkey
+            WarmCaptureSession();
             MainLog(L"  Initialization complete");
             break;
             
+        case WM_TIMER:
+            if (wParam == TIMER_POOL_TRIM) {
+                size_t trimmed = FramePool::Instance().Trim(POOL_IDLE_MS);
+                if (trimmed) {
+                    MainLog(L"WM_TIMER: FramePool trimmed %zuKB", trimmed / 1024);
+                }
+            }
+            break;
+            
+        case WM_DISPLAYCHANGE:
+            MainLog(L"WM_DISPLAYCHANGE: %dx%d", LOWORD(lParam), HIWORD(lParam));
+            InvalidateCaptureSession();
+            break;
+            
         case WM_HOTKEY:
             MainLog(L"WM_HOTKEY: id=%d", wParam);
             HandleHotkey((int)wParam);
             MainLog(L"WM_HOTKEY: HandleHotkey returned");
             break;
             
+        case WM_CAPTURE_REQUEST:
+            DispatchCaptureRequest();
+            break;
+            
         case TrayIcon::WM_TRAYICON:
             if (lParam == WM_RBUTTONUP) {
                 g_trayIcon->ShowContextMenu(hwnd);
@@ -70,28 +112,24 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             MainLog(L"WM_COMMAND: id=%d", LOWORD(wParam));
             switch (LOWORD(wParam)) {
                 case TrayIcon::MENU_CAPTURE_FULLSCREEN:
-                    CaptureFullScreen();
+                    SubmitCaptureRequest(CaptureKind::FullScreen);
                     break;
                     
                 case TrayIcon::MENU_CAPTURE_WINDOW:
-                    CaptureActiveWindow();
+                    SubmitCaptureRequest(CaptureKind::ActiveWindow);
                     break;
                     
-                case TrayIcon::MENU_CAPTURE_REGION: {
-                    MainLog(L"  MENU_CAPTURE_REGION: Creating overlay...");
-                    Overlay overlay;
-                    MainLog(L"  Calling overlay.Show()...");
-                    if (overlay.Show()) {
-                        RECT rect = overlay.GetSelectedRegion();
-                        MainLog(L"  Overlay returned true, rect: L=%d T=%d R=%d B=%d", rect.left, rect.top, rect.right, rect.bottom);
-                        CaptureRegion(rect);
-                        MainLog(L"  CaptureRegion returned");
-                    } else {
-                        MainLog(L"  Overlay returned false (cancelled)");
-                    }
-                    MainLog(L"  MENU_CAPTURE_REGION completed");
+                case TrayIcon::MENU_CAPTURE_REGION:
+                    SubmitCaptureRequest(CaptureKind::Region);
+                    break;
+                    
+                case TrayIcon::MENU_RECORD:
+                    ToggleRecording();
+                    break;
+                    
+                case TrayIcon::MENU_TIMED:
+                    ToggleTimedCapture();
                     break;
-                }
                     
                 case TrayIcon::MENU_OPEN_FOLDER: {
                     std::wstring dir = GetSaveDirectory();
@@ -110,6 +148,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         case WM_DESTROY:
             MainLog(L"WM_DESTROY received!");
             UnregisterHotkeys(hwnd);
+            KillTimer(hwnd, TIMER_POOL_TRIM);
             if (g_trayIcon) {
                 delete g_trayIcon;
                 g_trayIcon = nullptr;
@@ -138,6 +177,12 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         FreeLibrary(hUser32);
     }
     
+    // Optional large-page backing for frame buffers (needs "Lock pages in memory")
+    if (lpCmdLine && strstr(lpCmdLine, "--large-pages")) {
+        bool enabled = FramePool::Instance().EnableLargePages(true);
+        MainLog(L"Large pages requested: %s", enabled ? L"enabled" : L"unavailable");
+    }
+    
     // Prevent multiple instances
     HANDLE hMutex = CreateMutexW(NULL, TRUE, L"ScreenCaptureAppMutex");
     if (GetLastError() == ERROR_ALREADY_EXISTS) {
@@ -188,6 +233,23 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     
     MainLog(L"=== Message loop exited, wParam=%d ===", msg.wParam);
     
+    // Let accepted captures finish saving before the process goes away
+    ShutdownCaptureRequests();
+    StopBurst();
+    StopRecording();
+    StopTimedCapture();
+    ShutdownCapture();
+    MainLog(L"Pending saves drained");
+    
+    DuplicateStats dup = GetDuplicateStats();
+    MainLog(L"Duplicates: hashed=%llu skipped=%llu (linked=%llu referenced=%llu) bytesAvoided=%lluKB hashTime=%.1fms",
+        dup.hashed, dup.skipped, dup.linked, dup.referenced, dup.bytesAvoided / 1024, dup.hashMs);
+    
+    MemoryGovernorStats memory = MemoryGovernor::Instance().GetStats();
+    MainLog(L"Memory: peak=%zuKB ceiling=%zuKB decisions normal=%llu fast=%llu spill=%llu spilled=%lluKB",
+        memory.peak / 1024, memory.ceiling / 1024, memory.normal, memory.fast, memory.spilled,
+        memory.spilledBytes / 1024);
+    
     if (hMutex) {
         ReleaseMutex(hMutex);
         CloseHandle(hMutex);
@@ -0,0 +1,86 @@
+#include "memorygovernor.h"
+
+namespace ScreenCapture {
+
+MemoryCharge& MemoryCharge::operator=(MemoryCharge&& other) {
+    if (this != &other) {
+        Release();
+        m_stage = other.m_stage;
+        m_bytes = other.m_bytes;
+        other.m_bytes = 0;
+    }
+    return *this;
+}
+
+void MemoryCharge::Release() {
+    if (m_bytes) {
+        MemoryGovernor::Instance().Return(m_stage, m_bytes);
+        m_bytes = 0;
+    }
+}
+
+MemoryGovernor& MemoryGovernor::Instance() {
+    static MemoryGovernor governor;
+    return governor;
+}
+
+MemoryGovernor::MemoryGovernor() : m_stats() {
+}
+
+void MemoryGovernor::SetCeiling(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.ceiling = bytes;
+}
+
+MemoryCharge MemoryGovernor::Charge(MemoryStage stage, size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.byStage[(int)stage] += bytes;
+    m_stats.inUse += bytes;
+    if (m_stats.inUse > m_stats.peak) m_stats.peak = m_stats.inUse;
+    return MemoryCharge(stage, bytes);
+}
+
+void MemoryGovernor::Return(MemoryStage stage, size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.byStage[(int)stage] -= bytes;
+    m_stats.inUse -= bytes;
+}
+
+MemoryDecision MemoryGovernor::Admit(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t projected = m_stats.inUse + bytes;
+    MemoryDecision decision = MemoryDecision::Normal;
+    if (m_stats.ceiling && projected > m_stats.ceiling) {
+        decision = MemoryDecision::Spill;
+    } else if (m_stats.ceiling && projected > m_stats.ceiling / 4 * 3) {
+        decision = MemoryDecision::FastPreset;
+    }
+
+    switch (decision) {
+        case MemoryDecision::Normal: m_stats.normal++; break;
+        case MemoryDecision::FastPreset: m_stats.fast++; break;
+        case MemoryDecision::Spill: m_stats.spilled++; break;
+    }
+    return decision;
+}
+
+void MemoryGovernor::RecordSpill(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.spilledBytes += bytes;
+}
+
+MemoryGovernorStats MemoryGovernor::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+const wchar_t* MemoryGovernor::DecisionName(MemoryDecision decision) {
+    switch (decision) {
+        case MemoryDecision::Normal: return L"normal";
+        case MemoryDecision::FastPreset: return L"fast";
+        case MemoryDecision::Spill: return L"spill";
+    }
+    return L"?";
+}
+
+} // namespace ScreenCapture
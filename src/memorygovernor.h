@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace ScreenCapture {
+
+// Where a capture's bytes are held
+enum class MemoryStage {
+    Queued,   // Full frames waiting in the encode queue
+    Encode,   // Encoder working set (RGB block, filtered blocks)
+    Preview,  // Frames shown by preview windows
+    Burst,    // Preallocated ring of a running burst
+    Session,  // Warm capture slots (full-desktop frames kept attached)
+    Count
+};
+
+// How a new save should run, given what is already in flight
+enum class MemoryDecision {
+    Normal,      // Default preset
+    FastPreset,  // Above the soft limit: finish sooner, release sooner
+    Spill        // Over the ceiling: park the raw frame in a temp file
+                 // until the encoder picks it up
+};
+
+struct MemoryGovernorStats {
+    size_t ceiling;  // 0 = unlimited
+    size_t inUse;
+    size_t peak;
+    size_t byStage[(int)MemoryStage::Count];
+    uint64_t normal;
+    uint64_t fast;
+    uint64_t spilled;
+    uint64_t spilledBytes;
+};
+
+class MemoryGovernor;
+
+// Bytes charged to a stage for as long as the charge lives. Move-only.
+class MemoryCharge {
+public:
+    MemoryCharge() : m_stage(MemoryStage::Queued), m_bytes(0) {}
+    MemoryCharge(MemoryCharge&& other) : m_stage(other.m_stage), m_bytes(other.m_bytes) { other.m_bytes = 0; }
+    MemoryCharge& operator=(MemoryCharge&& other);
+    ~MemoryCharge() { Release(); }
+
+    void Release();
+    size_t Bytes() const { return m_bytes; }
+
+private:
+    friend class MemoryGovernor;
+    MemoryCharge(MemoryStage stage, size_t bytes) : m_stage(stage), m_bytes(bytes) {}
+    MemoryCharge(const MemoryCharge&) = delete;
+    MemoryCharge& operator=(const MemoryCharge&) = delete;
+
+    MemoryStage m_stage;
+    size_t m_bytes;
+};
+
+// Process-wide account of the bytes every capture stage holds, checked
+// against a configured ceiling when a new save is admitted. Charges are
+// bookkeeping only (nothing is allocated or refused here); a frame shared
+// by two stages is counted by both, which errs on the safe side.
+class MemoryGovernor {
+public:
+    static MemoryGovernor& Instance();
+
+    // 0 disables the ceiling (every save is Normal)
+    void SetCeiling(size_t bytes);
+
+    MemoryCharge Charge(MemoryStage stage, size_t bytes);
+
+    // Decide for a save that will hold 'bytes' until it is encoded:
+    // Normal up to 3/4 of the ceiling, FastPreset up to the ceiling,
+    // Spill beyond it. Counted in the stats.
+    MemoryDecision Admit(size_t bytes);
+
+    // Bytes written to spill files (metrics only)
+    void RecordSpill(size_t bytes);
+
+    MemoryGovernorStats GetStats() const;
+
+    static const wchar_t* DecisionName(MemoryDecision decision);
+
+private:
+    friend class MemoryCharge;
+    MemoryGovernor();
+    void Return(MemoryStage stage, size_t bytes);
+
+    mutable std::mutex m_mutex;
+    MemoryGovernorStats m_stats;
+};
+
+} // namespace ScreenCapture
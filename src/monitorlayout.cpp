@@ -0,0 +1,99 @@
+#include "monitorlayout.h"
+#include <algorithm>
+#include <cstring>
+
+namespace ScreenCapture {
+
+size_t MonitorLayout::DeadPixels() const {
+    size_t total = 0;
+    for (const ScreenRect& r : deadAreas) total += (size_t)r.width * r.height;
+    return total;
+}
+
+MonitorLayout BuildMonitorLayout(const std::vector<ScreenRect>& input) {
+    MonitorLayout layout = {};
+    std::vector<ScreenRect> screens;
+    for (const ScreenRect& r : input) {
+        if (r.width > 0 && r.height > 0) screens.push_back(r);
+    }
+    if (screens.empty()) return layout;
+
+    int left = screens[0].x, top = screens[0].y;
+    int right = left + screens[0].width, bottom = top + screens[0].height;
+    for (const ScreenRect& r : screens) {
+        left = std::min(left, r.x);
+        top = std::min(top, r.y);
+        right = std::max(right, r.x + r.width);
+        bottom = std::max(bottom, r.y + r.height);
+    }
+    layout.bounds = { left, top, right - left, bottom - top };
+    for (const ScreenRect& r : screens) {
+        layout.monitors.push_back({ r.x - left, r.y - top, r.width, r.height });
+    }
+
+    // Horizontal bands between consecutive monitor top/bottom edges have a
+    // fixed set of covering monitors; the gaps between them are dead
+    std::vector<int> edges;
+    for (const ScreenRect& r : layout.monitors) {
+        edges.push_back(r.y);
+        edges.push_back(r.y + r.height);
+    }
+    edges.push_back(0);
+    edges.push_back(layout.bounds.height);
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    std::vector<ScreenRect> gaps;
+    for (size_t e = 0; e + 1 < edges.size(); e++) {
+        int y0 = edges[e], y1 = edges[e + 1];
+
+        std::vector<std::pair<int, int>> spans;
+        for (const ScreenRect& r : layout.monitors) {
+            if (r.y <= y0 && r.y + r.height >= y1) spans.push_back({ r.x, r.x + r.width });
+        }
+        std::sort(spans.begin(), spans.end());
+
+        int x = 0;
+        for (const auto& span : spans) {
+            if (span.first > x) gaps.push_back({ x, y0, span.first - x, y1 - y0 });
+            x = std::max(x, span.second);
+        }
+        if (x < layout.bounds.width) gaps.push_back({ x, y0, layout.bounds.width - x, y1 - y0 });
+    }
+
+    // Join the same gap across consecutive bands into one rect
+    std::sort(gaps.begin(), gaps.end(), [](const ScreenRect& a, const ScreenRect& b) {
+        if (a.x != b.x) return a.x < b.x;
+        if (a.width != b.width) return a.width < b.width;
+        return a.y < b.y;
+    });
+    for (const ScreenRect& gap : gaps) {
+        if (!layout.deadAreas.empty()) {
+            ScreenRect& last = layout.deadAreas.back();
+            if (last.x == gap.x && last.width == gap.width && last.y + last.height == gap.y) {
+                last.height += gap.height;
+                continue;
+            }
+        }
+        layout.deadAreas.push_back(gap);
+    }
+
+    std::sort(layout.deadAreas.begin(), layout.deadAreas.end(), [](const ScreenRect& a, const ScreenRect& b) {
+        return a.y != b.y ? a.y < b.y : a.x < b.x;
+    });
+    return layout;
+}
+
+void FillDeadAreas(uint8_t* bgra, int stride, const std::vector<ScreenRect>& deadAreas, uint32_t value) {
+    for (const ScreenRect& r : deadAreas) {
+        uint8_t* first = bgra + (size_t)r.y * stride + (size_t)r.x * 4;
+        uint32_t* row = (uint32_t*)first;
+        for (int x = 0; x < r.width; x++) row[x] = value;
+        // Remaining rows are copies of the first one
+        for (int y = 1; y < r.height; y++) {
+            memcpy(first + (size_t)y * stride, first, (size_t)r.width * 4);
+        }
+    }
+}
+
+} // namespace ScreenCapture
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ScreenCapture {
+
+struct ScreenRect {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+// Monitor arrangement inside its bounding box. With monitors of different
+// sizes or offsets the box contains areas no monitor covers; those are
+// listed as deadAreas so a stitched image can fill them instead of
+// capturing them.
+struct MonitorLayout {
+    ScreenRect bounds;                  // Desktop coordinates
+    std::vector<ScreenRect> monitors;   // Relative to bounds, input order
+    std::vector<ScreenRect> deadAreas;  // Relative to bounds, top to bottom
+
+    size_t DeadPixels() const;
+};
+
+// Monitors are in desktop coordinates (may be negative); empty ones are dropped
+MonitorLayout BuildMonitorLayout(const std::vector<ScreenRect>& monitors);
+
+// Write a constant 32bpp value over every dead area of a stitched frame
+void FillDeadAreas(uint8_t* bgra, int stride, const std::vector<ScreenRect>& deadAreas, uint32_t value);
+
+} // namespace ScreenCapture
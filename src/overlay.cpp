@@ -1,8 +1,14 @@
 #include "overlay.h"
+#include "config.h"
 #include "utils.h"
+#include <dwmapi.h>
+#include <mmsystem.h>
 #include <stdio.h>
 #include <algorithm>
 
+#pragma comment(lib, "dwmapi.lib")
+#pragma comment(lib, "winmm.lib")
+
 using std::min;
 using std::max;
 
@@ -10,6 +16,25 @@ namespace ScreenCapture {
 
 static const wchar_t* OVERLAY_CLASS = L"ScreenCaptureOverlay";
 
+// Redraw cap; the frame interval is a whole number of display refreshes
+static const int OVERLAY_MAX_FPS = 120;
+
+// A monitor finished preparing on the tile thread (wParam = tile)
+static const UINT WM_OVERLAY_TILE_READY = WM_APP + 1;
+
+// Selection statistics can be shown (redraw the label)
+static const UINT WM_OVERLAY_STATS_READY = WM_APP + 2;
+
+// Windows 10 2004+: the window is left out of screen captures
+#ifndef WDA_EXCLUDEFROMCAPTURE
+#define WDA_EXCLUDEFROMCAPTURE 0x00000011
+#endif
+
+// Window snapshot bounds: controls nested deeper than this, or past this
+// many elements, are not pickable
+static const int PICK_MAX_DEPTH = 6;
+static const size_t PICK_MAX_ELEMENTS = 4096;
+
 // Debug logging helper
 static void DebugLog(const wchar_t* format, ...) {
     FILE* f = _wfopen(L"debug_overlay_detail.txt", L"a");
@@ -31,61 +56,39 @@ static void DebugLog(const wchar_t* format, ...) {
 
 Overlay::Overlay() 
     : m_hwnd(NULL)
-    , m_isSelecting(false)
     , m_isComplete(false)
-    , m_hdcScreenshot(NULL)
-    , m_hbmScreenshot(NULL)
-    , m_hbmOldScreenshot(NULL)
-    , m_hdcBackbuffer(NULL)
-    , m_hbmBackbuffer(NULL)
-    , m_hbmOldBackbuffer(NULL)
-    , m_backbufferWidth(0)
-    , m_backbufferHeight(0)
-    , m_hPenBorder(NULL)
-    , m_hBrushDim(NULL)
-    , m_lastPaintTime(0) {
+    , m_sessionStartUs(0)
+    , m_stopTiles(false)
+    , m_excludedFromCapture(false)
+    , m_buildEdges(false)
+    , m_buildStats(false)
+    , m_showStartUs(0)
+    , m_tilesDoneUs(0)
+    , m_firstEdgesUs(0)
+    , m_edgesDoneUs(0)
+    , m_statsDoneUs(0)
+    , m_renderer(m_paceClock, FramePacer::IntervalForRefresh(0, OVERLAY_MAX_FPS))
+    , m_recordInput(false) {
     m_selectedRect = {};
-    m_startPoint = {};
-    m_currentPoint = {};
     m_windowOffset = {};
-    m_lastRect = {};
-    m_prevRect = {};
     DebugLog(L"Overlay constructor called");
 }
 
 Overlay::~Overlay() {
     DebugLog(L"Overlay destructor called");
-    
-    // Cleanup cached GDI objects
-    if (m_hBrushDim) {
-        DeleteObject(m_hBrushDim);
-        m_hBrushDim = NULL;
-    }
-    if (m_hPenBorder) {
-        DeleteObject(m_hPenBorder);
-        m_hPenBorder = NULL;
-    }
-    
-    // Cleanup backbuffer
-    if (m_hdcBackbuffer) {
-        if (m_hbmOldBackbuffer) {
-            SelectObject(m_hdcBackbuffer, m_hbmOldBackbuffer);
-        }
-        if (m_hbmBackbuffer) {
-            DeleteObject(m_hbmBackbuffer);
-        }
-        DeleteDC(m_hdcBackbuffer);
-    }
-    
-    // Cleanup screenshot buffer
-    if (m_hdcScreenshot) {
-        if (m_hbmOldScreenshot) {
-            SelectObject(m_hdcScreenshot, m_hbmOldScreenshot);
+    m_stopTiles = true;
+    if (m_tileThread.joinable()) m_tileThread.join();
+    
+    // Cleanup tile backbuffers
+    for (TileSurface& surface : m_surfaces) {
+        if (!surface.dc) continue;
+        if (surface.oldBitmap) {
+            SelectObject(surface.dc, surface.oldBitmap);
         }
-        if (m_hbmScreenshot) {
-            DeleteObject(m_hbmScreenshot);
+        if (surface.bitmap) {
+            DeleteObject(surface.bitmap);
         }
-        DeleteDC(m_hdcScreenshot);
+        DeleteDC(surface.dc);
     }
     
     if (m_hwnd) {
@@ -124,6 +127,12 @@ LRESULT CALLBACK Overlay::WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lPa
                 DebugLog(L"WndProc: WM_LBUTTONUP at (%d,%d)", LOWORD(lParam), HIWORD(lParam));
                 overlay->OnLButtonUp(LOWORD(lParam), HIWORD(lParam));
                 return 0;
+            case WM_OVERLAY_TILE_READY:
+                overlay->OnTileReady((int)wParam);
+                return 0;
+            case WM_OVERLAY_STATS_READY:
+                overlay->m_renderer.Publish(overlay->m_input.Selection(), overlay->m_input.Cursor());
+                return 0;
             case WM_KEYDOWN:
                 DebugLog(L"WndProc: WM_KEYDOWN key=%d", wParam);
                 overlay->OnKeyDown(wParam);
@@ -167,9 +176,10 @@ bool Overlay::Show() {
     int height = screenRect.bottom - screenRect.top;
     DebugLog(L"  Creating window: size=%dx%d", width, height);
     
-    // Create layered window with composited flag for double buffering
+    // Opaque window: the compositor's backbuffer already holds the dimmed
+    // screen, so nothing is alpha-blended over the desktop per frame
     m_hwnd = CreateWindowExW(
-        WS_EX_LAYERED | WS_EX_TOPMOST | WS_EX_TOOLWINDOW | WS_EX_COMPOSITED,
+        WS_EX_TOPMOST | WS_EX_TOOLWINDOW | WS_EX_COMPOSITED,
         OVERLAY_CLASS,
         L"",
         WS_POPUP,
@@ -184,64 +194,116 @@ bool Overlay::Show() {
     }
     DebugLog(L"  Window created: hwnd=%p", m_hwnd);
     
-    // Capture screenshot BEFORE showing overlay
-    HDC hdcScreen = GetDC(NULL);
-    if (!hdcScreen) {
-        DebugLog(L"  ERROR: GetDC(NULL) failed");
-        DestroyWindow(m_hwnd);
-        m_hwnd = NULL;
-        return false;
+    // One tile per monitor, nothing allocated yet
+    const Config& config = GetConfig();
+    OverlayStyle style = OverlayStyle::Default();
+    style.loupeZoom = config.overlayLoupeZoom;
+    MonitorLayout layout = BuildMonitorLayout(EnumerateMonitors());
+    std::vector<PixelRect> monitors;
+    for (const ScreenRect& m : layout.monitors) {
+        // Layout coordinates are relative to the bounding box, which is the
+        // virtual screen the window covers
+        int dx = layout.bounds.x - screenRect.left, dy = layout.bounds.y - screenRect.top;
+        monitors.push_back({ m.x + dx, m.y + dy, m.x + dx + m.width, m.y + dy + m.height });
     }
-    
-    m_backbufferWidth = width;
-    m_backbufferHeight = height;
-    
-    // Create screenshot buffer and capture current screen
-    m_hdcScreenshot = CreateCompatibleDC(hdcScreen);
-    m_hbmScreenshot = CreateCompatibleBitmap(hdcScreen, width, height);
-    m_hbmOldScreenshot = (HBITMAP)SelectObject(m_hdcScreenshot, m_hbmScreenshot);
-    
-    // Capture entire screen to screenshot buffer
+    if (monitors.empty()) monitors.push_back({ 0, 0, width, height });
+    m_tiles.Reset(monitors, width, height, style);
+    m_surfaces.assign(m_tiles.Count(), TileSurface());
+    
+    // The monitor under the cursor first
+    POINT cursor = {};
+    GetCursorPos(&cursor);
+    std::vector<int> order = m_tiles.OrderFrom(cursor.x - m_windowOffset.x, cursor.y - m_windowOffset.y);
+    
+    // Left out of screen grabs, the window can appear before the other
+    // monitors are captured; otherwise every monitor is frozen first (their
+    // backdrops are still built after the window shows)
+    m_excludedFromCapture = order.size() > 1 && SetWindowDisplayAffinity(m_hwnd, WDA_EXCLUDEFROMCAPTURE);
+    m_showStartUs = m_paceClock.NowUs();
     DWORD captureStart = GetTickCount();
-    BitBlt(m_hdcScreenshot, 0, 0, width, height, hdcScreen, screenRect.left, screenRect.top, SRCCOPY | CAPTUREBLT);
+    for (size_t i = 0; i < (m_excludedFromCapture ? 1 : order.size()); i++) {
+        if (!CaptureTile(order[i])) {
+            DebugLog(L"  ERROR: capturing monitor %d failed", order[i]);
+            DestroyWindow(m_hwnd);
+            m_hwnd = NULL;
+            return false;
+        }
+    }
     DWORD captureTime = GetTickCount() - captureStart;
-    DebugLog(L"  Screenshot captured: %dx%d in %dms", width, height, captureTime);
+    DebugLog(L"  Screenshot captured: %d of %d monitors in %dms (excluded from capture: %d)",
+        m_excludedFromCapture ? 1 : (int)order.size(), (int)order.size(), captureTime, m_excludedFromCapture);
+    
+    OverlayInputOptions options = OverlayInputOptions::Default();
+    options.snapDistance = config.overlaySnapDistance;
+    options.pickWindows = config.overlayPickWindows;
+    options.dragX = GetSystemMetrics(SM_CXDRAG);
+    options.dragY = GetSystemMetrics(SM_CYDRAG);
+    m_buildEdges = options.snapDistance > 0;
+    m_buildStats = config.overlaySelectionStats;
+    
+    // Window rectangles for hover-to-pick, taken with the screenshot so
+    // they match what is frozen on screen
+    if (options.pickWindows) {
+        int64_t indexStart = m_paceClock.NowUs();
+        IndexWindows(screenRect);
+        WindowIndexStats windows = m_windows.GetStats();
+        DebugLog(L"  Window index: %llu elements, %llu entries (cell %dpx) in %.2fms",
+            windows.elements, windows.entries, windows.cellSize, (m_paceClock.NowUs() - indexStart) / 1000.0);
+    }
+    m_input.Reset(options, &m_windows);
+    m_sessionStartUs = m_paceClock.NowUs();
     
     FILE* f = _wfopen(L"debug_overlay.txt", L"a");
     if (f) {
         fwprintf(f, L"\n=== NEW OVERLAY SESSION ===\n");
-        fwprintf(f, L"Screen size: %dx%d\n", width, height);
+        fwprintf(f, L"Screen size: %dx%d, %d monitors\n", width, height, m_tiles.Count());
         fwprintf(f, L"Screenshot capture time: %dms\n", captureTime);
-        fwprintf(f, L"Using: Direct rendering + Screenshot restore + Selective redraw\n");
-        fwprintf(f, L"Target FPS: 120 (8ms frame time)\n\n");
+        fwprintf(f, L"Using: Software compositor + Pre-dimmed backdrop + Damage strips + Per-monitor tiles\n");
         fclose(f);
     }
     
-    // Create drawing backbuffer
-    m_hdcBackbuffer = CreateCompatibleDC(hdcScreen);
-    m_hbmBackbuffer = CreateCompatibleBitmap(hdcScreen, width, height);
-    m_hbmOldBackbuffer = (HBITMAP)SelectObject(m_hdcBackbuffer, m_hbmBackbuffer);
-    
-    ReleaseDC(NULL, hdcScreen);
-    DebugLog(L"  Backbuffer created: %dx%d", width, height);
-    
-    // Cache GDI objects
-    m_hPenBorder = CreatePen(PS_SOLID, 2, RGB(0, 120, 215));
-    m_hBrushDim = CreateSolidBrush(RGB(0, 0, 0));  // For dimming effect
-    m_lastPaintTime = 0;
-    m_lastRect = {};
-    m_prevRect = {};
+    // Pace redraws on whole refreshes of the primary display
+    DEVMODEW mode = {};
+    mode.dmSize = sizeof(mode);
+    int refreshHz = EnumDisplaySettingsW(NULL, ENUM_CURRENT_SETTINGS, &mode) ? (int)mode.dmDisplayFrequency : 0;
+    int64_t frameUs = FramePacer::IntervalForRefresh(refreshHz, OVERLAY_MAX_FPS);
+    m_renderer.SetFrameInterval(frameUs);
+    f = _wfopen(L"debug_overlay.txt", L"a");
+    if (f) {
+        fwprintf(f, L"Refresh: %dHz, frame interval %.2fms (render thread)\n\n", refreshHz, frameUs / 1000.0);
+        fclose(f);
+    }
     
-    // Initial draw: copy screenshot with dim overlay
-    BitBlt(m_hdcBackbuffer, 0, 0, width, height, m_hdcScreenshot, 0, 0, SRCCOPY);
+    // The replay rebuilds the scene from these (not from the screenshot)
+    m_recordInput = config.overlayRecordInput;
+    if (m_recordInput) {
+        m_trace = InputTrace();
+        m_trace.width = width;
+        m_trace.height = height;
+        m_trace.frameUs = frameUs;
+        m_trace.loupeZoom = style.loupeZoom;
+        m_trace.options = options;
+        for (size_t i = 0; i < m_windows.Size(); i++) m_trace.windows.push_back(m_windows.Element((int)i));
+    }
     
-    // Set transparency
-    SetLayeredWindowAttributes(m_hwnd, 0, 200, LWA_ALPHA);  // Slightly less transparent
-    DebugLog(L"  Transparency set");
+    // Initial draw: the first monitor's dimmed backdrop; the window covers
+    // only the monitors that are ready
+    DWORD attachStart = GetTickCount();
+    PrepareTile(order[0]);
+    UpdateWindowRegion();
+    DebugLog(L"  First monitor ready in %.1fms (backdrop %dms)",
+        (m_paceClock.NowUs() - m_showStartUs) / 1000.0, GetTickCount() - attachStart);
     
     ShowWindow(m_hwnd, SW_SHOW);
     UpdateWindow(m_hwnd);
-    DebugLog(L"  Window shown, entering message loop...");
+    // Selection frames are drawn and presented on the render thread; this
+    // thread only handles input. 1ms timer resolution keeps the render
+    // thread's frame-slot sleeps on time.
+    timeBeginPeriod(1);
+    m_renderer.Start([this](const OverlayState& state) { RenderSelection(state); });
+    m_stopTiles = false;
+    m_tileThread = std::thread(&Overlay::PrepareRemainingTiles, this, order, m_excludedFromCapture);
+    DebugLog(L"  Window shown, render and tile threads started, entering message loop...");
     
     // Simple message loop - process ALL messages to avoid issues
     MSG msg;
@@ -270,6 +332,33 @@ bool Overlay::Show() {
             DebugLog(L"  Message loop iteration %d, isComplete=%d", loopCount, m_isComplete);
         }
     }
+    // Before the window and the backbuffer go away
+    m_renderer.Stop();
+    timeEndPeriod(1);
+    m_stopTiles = true;
+    if (m_tileThread.joinable()) m_tileThread.join();
+    OverlayTilesStats tiles = m_tiles.GetStats();
+    DebugLog(L"  Tiles: %d/%d ready, all in %.1fms, edges first monitor %.1fms / all %.1fms, stats in %.1fms, %zuKB (bounding box %zuKB, stats %zuKB)",
+        tiles.ready, tiles.tiles, m_tilesDoneUs / 1000.0, m_firstEdgesUs / 1000.0, m_edgesDoneUs / 1000.0,
+        m_statsDoneUs / 1000.0,
+        tiles.bytes / 1024, tiles.boundingBytes / 1024, tiles.statsBytes / 1024);
+    
+    if (m_recordInput) SaveInputTrace();
+    
+    OverlayRenderStats rendering = m_renderer.GetStats();
+    const FramePacerStats& pacing = rendering.pacing;
+    f = _wfopen(L"debug_overlay.txt", L"a");
+    if (f) {
+        fwprintf(f, L"[PACE] inputs=%llu frames=%llu merged=%llu deferred=%llu interval p50<=%.2fms p99<=%.2fms latency max=%.2fms\n",
+            pacing.inputs, pacing.frames, pacing.merged, pacing.deferred,
+            pacing.interval.PercentileUs(0.50) / 1000.0, pacing.interval.PercentileUs(0.99) / 1000.0,
+            pacing.latency.Max() / 1000.0);
+        fwprintf(f, L"[RENDER] published=%llu rendered=%llu superseded=%llu input->present p50<=%.2fms p99<=%.2fms max=%.2fms\n",
+            rendering.published, rendering.rendered, rendering.superseded,
+            rendering.inputToPresent.PercentileUs(0.50) / 1000.0, rendering.inputToPresent.PercentileUs(0.99) / 1000.0,
+            rendering.inputToPresent.Max() / 1000.0);
+        fclose(f);
+    }
     
     DebugLog(L"  Message loop exited, loopCount=%d, isComplete=%d", loopCount, m_isComplete);
     DebugLog(L"  Selected rect: L=%d T=%d R=%d B=%d", m_selectedRect.left, m_selectedRect.top, m_selectedRect.right, m_selectedRect.bottom);
@@ -281,22 +370,137 @@ bool Overlay::Show() {
     UnregisterClassW(OVERLAY_CLASS, hInstance);
     
     bool result = m_isComplete && (m_selectedRect.right > m_selectedRect.left);
+    // Every monitor the selection touches is cropped from a real screenshot
+    if (result && !CaptureSelectedTiles()) result = false;
     DebugLog(L"=== Overlay::Show() END, returning %d ===\n", result);
     
     return result;
 }
 
+PixelRect Overlay::SelectedTileRect() const {
+    // m_selectedRect is in screen coordinates; the tiles are in client coordinates
+    return { m_selectedRect.left - m_windowOffset.x, m_selectedRect.top - m_windowOffset.y,
+             m_selectedRect.right - m_windowOffset.x, m_selectedRect.bottom - m_windowOffset.y };
+}
+
+bool Overlay::CaptureSelectedTiles() {
+    PixelRect selection = SelectedTileRect();
+    for (int i = 0; i < m_tiles.Count(); i++) {
+        if (m_tiles.Captured(i) || selection.Intersect(m_tiles.Bounds(i)).Empty()) continue;
+        // Selected before the tile thread reached it: the user saw the live
+        // monitor there (the window covers ready tiles only), grab it now
+        if (!CaptureTile(i)) {
+            DebugLog(L"  ERROR: capturing selected monitor %d failed", i);
+            return false;
+        }
+        DebugLog(L"  Monitor %d captured after the selection", i);
+    }
+    return true;
+}
+
+FrameRef Overlay::GetSelectedFrame() const {
+    return m_tiles.Crop(SelectedTileRect());
+}
+
+bool Overlay::CaptureTile(int tile) {
+    FrameRef frame = m_tiles.Screenshot(tile);
+    HDC hdcScreen = frame ? GetDC(NULL) : NULL;
+    HDC hdc = hdcScreen ? CreateCompatibleDC(hdcScreen) : NULL;
+    HBITMAP bitmap = hdc ? CreateFrameDIB(hdcScreen, frame) : NULL;
+    BOOL copied = FALSE;
+    if (bitmap) {
+        HBITMAP oldBitmap = (HBITMAP)SelectObject(hdc, bitmap);
+        const PixelRect& bounds = m_tiles.Bounds(tile);
+        copied = BitBlt(hdc, 0, 0, bounds.Width(), bounds.Height(), hdcScreen,
+                        bounds.left + m_windowOffset.x, bounds.top + m_windowOffset.y, SRCCOPY | CAPTUREBLT);
+        // GDI must be done with the DIB before its bits are touched directly
+        GdiFlush();
+        SelectObject(hdc, oldBitmap);
+        DeleteObject(bitmap);
+    }
+    if (hdc) DeleteDC(hdc);
+    if (hdcScreen) ReleaseDC(NULL, hdcScreen);
+    // The pooled frame holds whatever it held before: never crop from it
+    if (!copied) m_tiles.DropScreenshot(tile);
+    return copied != FALSE;
+}
+
+void Overlay::PrepareTile(int tile) {
+    FrameRef backbuffer = m_tiles.Backbuffer(tile);
+    if (!backbuffer) return;
+    TileSurface& surface = m_surfaces[tile];
+    surface.dc = CreateCompatibleDC(NULL);
+    surface.bitmap = CreateFrameDIB(surface.dc, backbuffer);
+    surface.oldBitmap = (HBITMAP)SelectObject(surface.dc, surface.bitmap);
+    m_tiles.Prepare(tile);
+}
+
+void Overlay::PrepareRemainingTiles(std::vector<int> order, bool capture) {
+    // The cursor's monitor is where the first drag starts: its snap edges
+    // come before the other monitors are even captured
+    if (m_buildEdges && !m_stopTiles) {
+        m_tiles.BuildEdges(order[0]);
+        m_firstEdgesUs = m_paceClock.NowUs() - m_showStartUs;
+    }
+    for (size_t i = 1; i < order.size() && !m_stopTiles; i++) {
+        if (capture && !CaptureTile(order[i])) continue;
+        PrepareTile(order[i]);
+        PostMessage(m_hwnd, WM_OVERLAY_TILE_READY, (WPARAM)order[i], 0);
+    }
+    m_tilesDoneUs = m_paceClock.NowUs() - m_showStartUs;
+    for (size_t i = 1; i < order.size() && m_buildEdges && !m_stopTiles; i++) m_tiles.BuildEdges(order[i]);
+    m_edgesDoneUs = m_paceClock.NowUs() - m_showStartUs;
+    // Selection statistics: O(1) per frame once the tables exist
+    if (!m_buildStats) return;
+    for (size_t i = 0; i < order.size() && !m_stopTiles; i++) m_tiles.BuildStats(order[i]);
+    m_statsDoneUs = m_paceClock.NowUs() - m_showStartUs;
+    PostMessage(m_hwnd, WM_OVERLAY_STATS_READY, 0, 0);
+}
+
+void Overlay::OnTileReady(int tile) {
+    UpdateWindowRegion();
+    const PixelRect& bounds = m_tiles.Bounds(tile);
+    RECT rect = { bounds.left, bounds.top, bounds.right, bounds.bottom };
+    InvalidateRect(m_hwnd, &rect, FALSE);
+    // The new monitor draws the current selection on the next frame
+    m_renderer.Publish(m_input.Selection(), m_input.Cursor());
+    
+    // Every monitor frozen: back to a normal window for other capture tools
+    bool allReady = true;
+    for (int i = 0; i < m_tiles.Count(); i++) allReady = allReady && m_tiles.Ready(i);
+    if (allReady && m_excludedFromCapture) {
+        SetWindowDisplayAffinity(m_hwnd, WDA_NONE);
+        m_excludedFromCapture = false;
+    }
+}
+
+void Overlay::UpdateWindowRegion() {
+    HRGN region = CreateRectRgn(0, 0, 0, 0);
+    int ready = 0;
+    for (int i = 0; i < m_tiles.Count(); i++) {
+        if (!m_tiles.Ready(i)) continue;
+        const PixelRect& bounds = m_tiles.Bounds(i);
+        HRGN part = CreateRectRgn(bounds.left, bounds.top, bounds.right, bounds.bottom);
+        CombineRgn(region, region, part, RGN_OR);
+        DeleteObject(part);
+        ready++;
+    }
+    // All monitors: no region, the window is a plain rectangle again (dead
+    // areas are never painted by anyone else anyway)
+    if (ready == m_tiles.Count()) {
+        DeleteObject(region);
+        region = NULL;
+    }
+    // The system owns the region from here
+    SetWindowRgn(m_hwnd, region, TRUE);
+}
+
 void Overlay::OnPaint(HWND hwnd) {
     PAINTSTRUCT ps;
     HDC hdc = BeginPaint(hwnd, &ps);
     
     DWORD paintStartTime = GetTickCount();
     
-    if (!m_hdcBackbuffer || !m_hdcScreenshot) {
-        EndPaint(hwnd, &ps);
-        return;
-    }
-    
     FILE* f = _wfopen(L"debug_overlay.txt", L"a");
     if (f) {
         fwprintf(f, L"[OnPaint] Called - InvalidRect: L=%d T=%d R=%d B=%d\n",
@@ -304,58 +508,22 @@ void Overlay::OnPaint(HWND hwnd) {
         fclose(f);
     }
     
-    // Restore old rect area from screenshot (erase old border)
-    if (m_lastRect.right > 0) {
-        RECT restoreRect = m_lastRect;
-        InflateRect(&restoreRect, 3, 30);  // Include border width and text
-        BitBlt(m_hdcBackbuffer, 
-               restoreRect.left, restoreRect.top,
-               restoreRect.right - restoreRect.left, 
-               restoreRect.bottom - restoreRect.top,
-               m_hdcScreenshot, 
-               restoreRect.left, restoreRect.top, 
-               SRCCOPY);
-    }
-    
-    // Draw new selection rectangle
-    if (m_isSelecting) {
-        int left = min(m_startPoint.x, m_currentPoint.x);
-        int top = min(m_startPoint.y, m_currentPoint.y);
-        int right = max(m_startPoint.x, m_currentPoint.x);
-        int bottom = max(m_startPoint.y, m_currentPoint.y);
-        
-        m_lastRect = { left, top, right, bottom };
-        
-        // Draw border
-        HPEN hOldPen = (HPEN)SelectObject(m_hdcBackbuffer, m_hPenBorder);
-        HBRUSH hOldBrush = (HBRUSH)SelectObject(m_hdcBackbuffer, GetStockObject(NULL_BRUSH));
-        
-        Rectangle(m_hdcBackbuffer, left, top, right, bottom);
-        
-        SelectObject(m_hdcBackbuffer, hOldPen);
-        SelectObject(m_hdcBackbuffer, hOldBrush);
-        
-        // Draw size info
-        if (top > 30) {
-            wchar_t info[64];
-            swprintf_s(info, L"%dx%d", right - left, bottom - top);
-            
-            SetBkMode(m_hdcBackbuffer, OPAQUE);
-            SetBkColor(m_hdcBackbuffer, RGB(0, 0, 0));
-            SetTextColor(m_hdcBackbuffer, RGB(255, 255, 0));
-            TextOutW(m_hdcBackbuffer, left, top - 20, info, (int)wcslen(info));
+    // The compositors keep the backbuffers current, so painting is a copy
+    // of the invalidated region from each ready monitor (not while the
+    // render thread rewrites them)
+    {
+        std::lock_guard<std::mutex> lock(m_surfaceMutex);
+        PixelRect invalid = { ps.rcPaint.left, ps.rcPaint.top, ps.rcPaint.right, ps.rcPaint.bottom };
+        for (int i = 0; i < m_tiles.Count(); i++) {
+            const PixelRect& bounds = m_tiles.Bounds(i);
+            PixelRect part = invalid.Intersect(bounds);
+            if (part.Empty() || !m_tiles.Ready(i)) continue;
+            BitBlt(hdc, part.left, part.top, part.Width(), part.Height(),
+                   m_surfaces[i].dc, part.left - bounds.left, part.top - bounds.top, SRCCOPY);
         }
+        GdiFlush();
     }
     
-    // BitBlt only the invalidated region (partial redraw)
-    BitBlt(hdc, 
-           ps.rcPaint.left, ps.rcPaint.top,
-           ps.rcPaint.right - ps.rcPaint.left, 
-           ps.rcPaint.bottom - ps.rcPaint.top,
-           m_hdcBackbuffer, 
-           ps.rcPaint.left, ps.rcPaint.top,
-           SRCCOPY);
-    
     DWORD paintTime = GetTickCount() - paintStartTime;
     
     f = _wfopen(L"debug_overlay.txt", L"a");
@@ -367,149 +535,164 @@ void Overlay::OnPaint(HWND hwnd) {
     EndPaint(hwnd, &ps);
 }
 
-void Overlay::OnMouseMove(int x, int y) {
-    static int mouseMoveCount = 0;
-    mouseMoveCount++;
-    
-    if (!m_isSelecting) return;
-    
-    // Ultra-fast frame limiting (8ms = 120fps)
-    DWORD now = GetTickCount();
-    DWORD timeSinceLastFrame = now - m_lastPaintTime;
-    if (timeSinceLastFrame < 8) {
-        // Log throttled frames
-        if (mouseMoveCount % 50 == 0) {
-            FILE* f = _wfopen(L"debug_overlay.txt", L"a");
-            if (f) {
-                fwprintf(f, L"[OnMouseMove] Throttled - only %dms since last frame\n", timeSinceLastFrame);
-                fclose(f);
-            }
+void Overlay::PresentDamage(HDC hdc) {
+    // Strips never cross monitors: each comes from one tile's compositor
+    for (const PixelRect& strip : m_damage) {
+        int tile = m_tiles.TileAt(strip.left, strip.top);
+        if (tile < 0) continue;
+        const PixelRect& bounds = m_tiles.Bounds(tile);
+        BitBlt(hdc, strip.left, strip.top, strip.Width(), strip.Height(),
+               m_surfaces[tile].dc, strip.left - bounds.left, strip.top - bounds.top, SRCCOPY);
+    }
+}
+
+// State for walking the window tree into WindowIndex priority order
+struct WindowCollector {
+    std::vector<WindowElement> elements;
+    HWND exclude;
+    POINT offset;
+    PixelRect screen;
+};
+
+static PixelRect ToClient(const RECT& rect, POINT offset) {
+    return { rect.left - offset.x, rect.top - offset.y, rect.right - offset.x, rect.bottom - offset.y };
+}
+
+// Child windows front to back (each before its own parent), then the
+// window itself; returns the window's element index
+static int CollectWindow(HWND hwnd, const PixelRect& rect, int depth, WindowCollector* collector) {
+    std::vector<int> children;
+    if (depth < PICK_MAX_DEPTH) {
+        for (HWND child = GetWindow(hwnd, GW_CHILD); child; child = GetWindow(child, GW_HWNDNEXT)) {
+            if (collector->elements.size() >= PICK_MAX_ELEMENTS) break;
+            RECT bounds;
+            if (!IsWindowVisible(child) || !GetWindowRect(child, &bounds)) continue;
+            // Child windows are clipped to their parent on screen too
+            PixelRect childRect = ToClient(bounds, collector->offset).Intersect(rect);
+            if (childRect.Empty()) continue;
+            children.push_back(CollectWindow(child, childRect, depth + 1, collector));
         }
-        return;
     }
-    
-    DWORD startTime = now;
-    m_lastPaintTime = now;
+    int self = (int)collector->elements.size();
+    collector->elements.push_back({ rect, -1 });
+    for (int child : children) collector->elements[child].parent = self;
+    return self;
+}
+
+// Top-level windows arrive in z-order, topmost first
+static BOOL CALLBACK CollectTopLevelProc(HWND hwnd, LPARAM lParam) {
+    WindowCollector* collector = (WindowCollector*)lParam;
+    if (collector->elements.size() >= PICK_MAX_ELEMENTS) return FALSE;
+    if (hwnd == collector->exclude || !IsWindowVisible(hwnd) || IsIconic(hwnd)) return TRUE;
+    // Click-through windows are never what the user points at
+    if (GetWindowLongW(hwnd, GWL_EXSTYLE) & WS_EX_TRANSPARENT) return TRUE;
+    // Windows on other virtual desktops and suspended UWP frames are
+    // "visible" but cloaked
+    DWORD cloaked = 0;
+    if (SUCCEEDED(DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloaked, sizeof(cloaked))) && cloaked) return TRUE;
+    RECT bounds;
+    if (!GetVisibleWindowRect(hwnd, &bounds)) return TRUE;
+    PixelRect rect = ToClient(bounds, collector->offset).Intersect(collector->screen);
+    if (!rect.Empty()) CollectWindow(hwnd, rect, 0, collector);
+    return TRUE;
+}
+
+void Overlay::IndexWindows(const RECT& screenRect) {
+    WindowCollector collector;
+    collector.exclude = m_hwnd;
+    collector.offset = m_windowOffset;
+    collector.screen = ToClient(screenRect, m_windowOffset);
+    EnumWindows(CollectTopLevelProc, (LPARAM)&collector);
+    m_windows.Build(collector.elements);
+}
+
+void Overlay::ApplyInput(InputEventType type, int x, int y) {
+    uint8_t modifiers = (GetKeyState(VK_CONTROL) < 0 ? INPUT_CTRL : 0) | (GetKeyState(VK_MENU) < 0 ? INPUT_ALT : 0);
+    InputEvent event = { m_paceClock.NowUs() - m_sessionStartUs, type, modifiers, x, y };
+    m_input.Apply(event, m_tiles.EdgesAt(x, y));
+    if (m_recordInput) m_trace.events.push_back(event);
+}
+
+void Overlay::SaveInputTrace() {
+    std::wstring path = L"overlay_input_" + GetTimestamp() + L".trace";
+    FILE* f = _wfopen(path.c_str(), L"w");
+    bool saved = f && m_trace.Write(f);
+    if (f) fclose(f);
+    DebugLog(L"  Input trace: %zu events -> %s (%s)", m_trace.events.size(), path.c_str(), saved ? L"saved" : L"FAILED");
+}
+
+void Overlay::OnMouseMove(int x, int y) {
+    // Hand the newest selection and cursor (the loupe follows it before the
+    // drag starts too) to the render thread; it draws at the paced rate,
+    // and positions between two frames collapse into the latest
+    ApplyInput(InputEventType::Move, x, y);
+    m_renderer.Publish(m_input.Selection(), m_input.Cursor());
+}
+
+void Overlay::RenderSelection(const OverlayState& state) {
+    static int frameNumber = 0;
+    frameNumber++;
+    int64_t startUs = m_paceClock.NowUs();
     
     // Log that we're doing direct rendering
-    if (mouseMoveCount % 10 == 0) {
+    if (frameNumber % 10 == 0) {
         FILE* f = _wfopen(L"debug_overlay.txt", L"a");
         if (f) {
-            fwprintf(f, L"[OnMouseMove] DIRECT RENDER at (%d,%d) - count=%d\n", x, y, mouseMoveCount);
+            fwprintf(f, L"[RenderSelection] DIRECT RENDER at (%d,%d) - frame=%d\n",
+                state.cursor.x, state.cursor.y, frameNumber);
             fclose(f);
         }
     }
     
     // Direct rendering (bypass WM_PAINT message queue for instant response)
-    if (!m_hdcBackbuffer || !m_hdcScreenshot) return;
-    
-    // Save previous rect before updating
-    m_prevRect = m_lastRect;
-    
-    // Update current point
-    m_currentPoint.x = x;
-    m_currentPoint.y = y;
-    
-    // Calculate new selection rect
-    int left = min(m_startPoint.x, m_currentPoint.x);
-    int top = min(m_startPoint.y, m_currentPoint.y);
-    int right = max(m_startPoint.x, m_currentPoint.x);
-    int bottom = max(m_startPoint.y, m_currentPoint.y);
-    
-    m_lastRect = { left, top, right, bottom };
-    
-    // Restore old rect from screenshot (erase old border)
-    if (m_prevRect.right > 0) {
-        RECT restoreRect = m_prevRect;
-        InflateRect(&restoreRect, 3, 30);
-        BitBlt(m_hdcBackbuffer, 
-               restoreRect.left, restoreRect.top,
-               restoreRect.right - restoreRect.left, 
-               restoreRect.bottom - restoreRect.top,
-               m_hdcScreenshot, 
-               restoreRect.left, restoreRect.top, 
-               SRCCOPY);
-    }
-    
-    // Draw border
-    HPEN hOldPen = (HPEN)SelectObject(m_hdcBackbuffer, m_hPenBorder);
-    HBRUSH hOldBrush = (HBRUSH)SelectObject(m_hdcBackbuffer, GetStockObject(NULL_BRUSH));
-    Rectangle(m_hdcBackbuffer, left, top, right, bottom);
-    SelectObject(m_hdcBackbuffer, hOldPen);
-    SelectObject(m_hdcBackbuffer, hOldBrush);
-    
-    // Draw size info
-    if (top > 30) {
-        wchar_t info[64];
-        swprintf_s(info, L"%dx%d", right - left, bottom - top);
-        SetBkMode(m_hdcBackbuffer, OPAQUE);
-        SetBkColor(m_hdcBackbuffer, RGB(0, 0, 0));
-        SetTextColor(m_hdcBackbuffer, RGB(255, 255, 0));
-        TextOutW(m_hdcBackbuffer, left, top - 20, info, (int)wcslen(info));
-    }
-    
-    // Direct BitBlt to screen (no message queue, instant update)
-    HDC hdcWindow = GetDC(m_hwnd);
-    if (hdcWindow) {
-        // Calculate update region (old + new rect)
-        RECT updateRect = m_lastRect;
-        InflateRect(&updateRect, 3, 30);
-        
-        // Union with previous rect area to ensure old border is cleared
-        if (m_prevRect.right > 0) {
-            RECT oldRestoreRect = m_prevRect;
-            InflateRect(&oldRestoreRect, 3, 30);
-            UnionRect(&updateRect, &updateRect, &oldRestoreRect);
-        }
-        
-        int updateWidth = updateRect.right - updateRect.left;
-        int updateHeight = updateRect.bottom - updateRect.top;
+    long long touched = 0;
+    int strips = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_surfaceMutex);
         
-        // BitBlt only the changed region
-        BitBlt(hdcWindow, 
-               updateRect.left, updateRect.top,
-               updateWidth, updateHeight,
-               m_hdcBackbuffer, 
-               updateRect.left, updateRect.top,
-               SRCCOPY);
+        // Only the changed border edges, the size label and the loupe are
+        // redrawn, on the monitors prepared so far
+        m_tiles.SetView(state.selection, state.cursor, &m_damage);
+        if (m_damage.empty()) return;
         
+        // Direct BitBlt to screen (no message queue, instant update); flush
+        // so the blits have read the backbuffer before it is rewritten
+        HDC hdcWindow = GetDC(m_hwnd);
+        if (!hdcWindow) return;
+        PresentDamage(hdcWindow);
+        GdiFlush();
         ReleaseDC(m_hwnd, hdcWindow);
         
-        // Calculate total render time
-        DWORD renderTime = GetTickCount() - startTime;
-        
-        // Log performance metrics (every 10 frames to avoid spam)
-        static int frameCount = 0;
-        static DWORD totalRenderTime = 0;
-        static DWORD minRenderTime = 999999;
-        static DWORD maxRenderTime = 0;
-        
-        frameCount++;
-        totalRenderTime += renderTime;
-        if (renderTime < minRenderTime) minRenderTime = renderTime;
-        if (renderTime > maxRenderTime) maxRenderTime = renderTime;
-        
-        if (frameCount % 10 == 0) {
-            DWORD avgRenderTime = totalRenderTime / frameCount;
-            int fps = (renderTime > 0) ? (1000 / renderTime) : 999;
-            
-            FILE* f = _wfopen(L"debug_overlay.txt", L"a");
-            if (f) {
-                fwprintf(f, L"[PERF] Frame %d: Render=%dms (avg=%dms, min=%dms, max=%dms) FPS=%d UpdateArea=%dx%d TimeSinceLastFrame=%dms\n",
-                    frameCount, renderTime, avgRenderTime, minRenderTime, maxRenderTime, fps, updateWidth, updateHeight, timeSinceLastFrame);
-                fclose(f);
-            }
+        for (const PixelRect& strip : m_damage) touched += strip.Area();
+        strips = (int)m_damage.size();
+    }
+    
+    // Calculate total render time
+    double renderMs = (m_paceClock.NowUs() - startUs) / 1000.0;
+    
+    // Log performance metrics (every 10 frames to avoid spam)
+    static int frameCount = 0;
+    static double totalRenderMs = 0;
+    static double maxRenderMs = 0;
+    
+    frameCount++;
+    totalRenderMs += renderMs;
+    if (renderMs > maxRenderMs) maxRenderMs = renderMs;
+    
+    if (frameCount % 10 == 0) {
+        FILE* f = _wfopen(L"debug_overlay.txt", L"a");
+        if (f) {
+            fwprintf(f, L"[PERF] Frame %d: Render=%.2fms (avg=%.2fms, max=%.2fms) Damage=%d strips/%lldpx Input->present=%.2fms\n",
+                frameCount, renderMs, totalRenderMs / frameCount, maxRenderMs, strips, touched,
+                (m_paceClock.NowUs() - state.inputUs) / 1000.0);
+            fclose(f);
         }
     }
 }
 
 void Overlay::OnLButtonDown(int x, int y) {
     DebugLog(L"OnLButtonDown: (%d,%d)", x, y);
-    m_startPoint.x = x;
-    m_startPoint.y = y;
-    m_currentPoint = m_startPoint;
-    m_isSelecting = true;
-    m_lastPaintTime = 0;
+    ApplyInput(InputEventType::ButtonDown, x, y);
     SetCapture(m_hwnd);
     DebugLog(L"  Capture set, isSelecting=true");
 }
@@ -517,21 +700,19 @@ void Overlay::OnLButtonDown(int x, int y) {
 void Overlay::OnLButtonUp(int x, int y) {
     DebugLog(L"OnLButtonUp: (%d,%d)", x, y);
     
-    if (m_isSelecting) {
+    if (m_input.Selecting()) {
         ReleaseCapture();
-        m_isSelecting = false;
         
-        // Convert client coordinates to screen coordinates using saved offset
-        int screenStartX = m_startPoint.x + m_windowOffset.x;
-        int screenStartY = m_startPoint.y + m_windowOffset.y;
-        int screenEndX = x + m_windowOffset.x;
-        int screenEndY = y + m_windowOffset.y;
+        // A click captures the highlighted window or control, a drag the
+        // (snapped) region
+        ApplyInput(InputEventType::ButtonUp, x, y);
         
-        // Calculate selected region
-        int left = min(screenStartX, screenEndX);
-        int top = min(screenStartY, screenEndY);
-        int right = max(screenStartX, screenEndX);
-        int bottom = max(screenStartY, screenEndY);
+        // Convert client coordinates to screen coordinates using saved offset
+        PixelRect result = m_input.Result();
+        int left = result.left + m_windowOffset.x;
+        int top = result.top + m_windowOffset.y;
+        int right = result.right + m_windowOffset.x;
+        int bottom = result.bottom + m_windowOffset.y;
         
         m_selectedRect = { left, top, right, bottom };
         m_isComplete = true;
@@ -548,6 +729,9 @@ void Overlay::OnKeyDown(WPARAM key) {
     DebugLog(L"OnKeyDown: key=%d", key);
     if (key == VK_ESCAPE) {
         DebugLog(L"  ESC pressed, cancelling");
+        POINT cursor = {};
+        GetCursorPos(&cursor);
+        ApplyInput(InputEventType::Cancel, cursor.x - m_windowOffset.x, cursor.y - m_windowOffset.y);
         m_isComplete = true;
         m_selectedRect = { 0, 0, 0, 0 };
         PostMessage(m_hwnd, WM_NULL, 0, 0);
@@ -1,5 +1,15 @@
 #pragma once
 #include <windows.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "framepool.h"
+#include "framepacer.h"
+#include "overlayinput.h"
+#include "overlayrenderer.h"
+#include "overlaytiles.h"
+#include "windowindex.h"
 
 namespace ScreenCapture {
 
@@ -14,6 +24,12 @@ public:
     // Get selected region
     RECT GetSelectedRegion() const { return m_selectedRect; }
     
+    // Selected region of the frozen screenshot taken when the overlay opened
+    // (exactly what the user saw while selecting): a zero-copy view when it
+    // lies on one monitor, else stitched. A monitor not yet frozen when the
+    // selection ended was grabbed then; if that failed, Show() returned false.
+    FrameRef GetSelectedFrame() const;
+    
 private:
     static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
     
@@ -23,36 +39,90 @@ private:
     void OnLButtonUp(int x, int y);
     void OnKeyDown(WPARAM key);
     
+    // Feed one event to the selection logic (and the trace when recording)
+    void ApplyInput(InputEventType type, int x, int y);
+    
+    // Snapshot the visible windows and their controls into m_windows
+    void IndexWindows(const RECT& screenRect);
+    
+    // Write the recorded session next to the debug logs
+    void SaveInputTrace();
+    
+    // Grab one monitor's pixels into its tile
+    bool CaptureTile(int tile);
+    
+    // Selection in tile (client) coordinates
+    PixelRect SelectedTileRect() const;
+    
+    // Capture the tiles the selection touches that the tile thread did not
+    // get to; false if one fails
+    bool CaptureSelectedTiles();
+    
+    // Wrap the tile's backbuffer for presenting, then build its backdrop
+    void PrepareTile(int tile);
+    
+    // Remaining monitors (and snap edges); runs on m_tileThread
+    void PrepareRemainingTiles(std::vector<int> order, bool capture);
+    
+    // A monitor finished preparing: reveal it and draw the selection on it
+    void OnTileReady(int tile);
+    
+    // Window region = the ready monitors; the others show the desktop
+    void UpdateWindowRegion();
+    
+    // Compose and present one frame; runs on the render thread
+    void RenderSelection(const OverlayState& state);
+    
+    // Blit the damage strips from the tile backbuffers to the window
+    void PresentDamage(HDC hdc);
+    
     HWND m_hwnd;
     RECT m_selectedRect;
-    POINT m_startPoint;
-    POINT m_currentPoint;
     POINT m_windowOffset;  // Offset of overlay window
-    bool m_isSelecting;
     bool m_isComplete;
     
-    // Screenshot backbuffer (captured once at start)
-    HDC m_hdcScreenshot;
-    HBITMAP m_hbmScreenshot;
-    HBITMAP m_hbmOldScreenshot;
+    // Selection state machine: hover pick, click or drag, snapping
+    OverlayInput m_input;
+    int64_t m_sessionStartUs;
+    
+    // One screenshot, backbuffer and compositor per monitor (no dead
+    // areas), allocated and filled lazily: the monitor under the cursor
+    // before the window shows, the others on m_tileThread after it
+    OverlayTiles m_tiles;
+    struct TileSurface {
+        HDC dc;
+        HBITMAP bitmap;
+        HBITMAP oldBitmap;
+    };
+    std::vector<TileSurface> m_surfaces;  // Backbuffer DCs, valid once the tile is ready
+    std::thread m_tileThread;
+    std::atomic<bool> m_stopTiles;
+    bool m_excludedFromCapture;  // Screen grabs do not see the overlay window
+    bool m_buildEdges;
+    bool m_buildStats;
+    int64_t m_showStartUs;
+    std::atomic<int64_t> m_tilesDoneUs;
+    std::atomic<int64_t> m_firstEdgesUs;  // Snap edges of the cursor's monitor
+    std::atomic<int64_t> m_edgesDoneUs;
+    std::atomic<int64_t> m_statsDoneUs;
     
-    // Drawing backbuffer (for current frame)
-    HDC m_hdcBackbuffer;
-    HBITMAP m_hbmBackbuffer;
-    HBITMAP m_hbmOldBackbuffer;
-    int m_backbufferWidth;
-    int m_backbufferHeight;
+    // Damage of the last frame, in client coordinates. Touched by the
+    // render thread while it runs; m_surfaceMutex keeps WM_PAINT from
+    // blitting a half-written backbuffer.
+    std::vector<PixelRect> m_damage;
+    std::mutex m_surfaceMutex;
     
-    // Cached GDI objects
-    HPEN m_hPenBorder;
-    HBRUSH m_hBrushDim;  // Semi-transparent overlay
+    // Paced render thread (QueryPerformanceCounter-based steady clock)
+    SteadyTimerClock m_paceClock;
+    OverlayRenderThread m_renderer;
     
-    // Last drawn rectangle for selective redraw
-    RECT m_lastRect;
-    RECT m_prevRect;  // Previous rect before last update
+    // Windows and controls on screen when the overlay opened: hovering
+    // highlights one, a click (no drag) captures it
+    WindowIndex m_windows;
     
-    // Frame rate limiting
-    DWORD m_lastPaintTime;
+    // Session input kept for replay ([Overlay] RecordInput=1)
+    bool m_recordInput;
+    InputTrace m_trace;
 };
 
 } // namespace ScreenCapture
@@ -0,0 +1,393 @@
+#include "overlaycompositor.h"
+#include "pixelconvert.h"
+#include "taskscheduler.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+namespace ScreenCapture {
+
+// 5x7 glyphs for the size label, the selection statistics and the loupe's
+// color readout, one row per byte (bit 4 = left column)
+struct Glyph {
+    char ch;
+    uint8_t rows[7];
+};
+
+static const Glyph FONT[] = {
+    { '0', { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E } },
+    { '1', { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+    { '2', { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F } },
+    { '3', { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E } },
+    { '4', { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 } },
+    { '5', { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E } },
+    { '6', { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E } },
+    { '7', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 } },
+    { '8', { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E } },
+    { '9', { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C } },
+    { 'x', { 0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11 } },
+    { '#', { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A } },
+    { 'A', { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } },
+    { 'B', { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E } },
+    { 'C', { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E } },
+    { 'D', { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C } },
+    { 'E', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F } },
+    { 'F', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 } },
+    { 'L', { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F } },
+    { LABEL_PLUS_MINUS, { 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00, 0x1F } },
+};
+
+static const int GLYPH_WIDTH = 5;
+static const int GLYPH_HEIGHT = 7;
+static const int GLYPH_ADVANCE = 6;
+
+static const uint8_t* FindGlyph(char ch) {
+    for (const Glyph& glyph : FONT) {
+        if (glyph.ch == ch) return glyph.rows;
+    }
+    return nullptr;  // Unknown characters render as blanks
+}
+
+PixelRect PixelRect::Intersect(const PixelRect& other) const {
+    PixelRect result = { std::max(left, other.left), std::max(top, other.top),
+                         std::min(right, other.right), std::min(bottom, other.bottom) };
+    if (result.Empty()) result = { 0, 0, 0, 0 };
+    return result;
+}
+
+void SubtractRects(const PixelRect& rect, const std::vector<PixelRect>& cut, std::vector<PixelRect>* out) {
+    if (rect.Empty()) return;
+    std::vector<PixelRect> pieces(1, rect), next;
+    for (const PixelRect& c : cut) {
+        next.clear();
+        for (const PixelRect& p : pieces) {
+            PixelRect overlap = p.Intersect(c);
+            if (overlap.Empty()) {
+                next.push_back(p);
+                continue;
+            }
+            // Full-width bands above and below, side pieces beside the overlap
+            if (p.top < overlap.top) next.push_back({ p.left, p.top, p.right, overlap.top });
+            if (overlap.bottom < p.bottom) next.push_back({ p.left, overlap.bottom, p.right, p.bottom });
+            if (p.left < overlap.left) next.push_back({ p.left, overlap.top, overlap.left, overlap.bottom });
+            if (overlap.right < p.right) next.push_back({ overlap.right, overlap.top, p.right, overlap.bottom });
+        }
+        pieces.swap(next);
+        if (pieces.empty()) return;
+    }
+    out->insert(out->end(), pieces.begin(), pieces.end());
+}
+
+OverlayCompositor::OverlayCompositor()
+    : m_source(nullptr), m_sourceStride(0), m_target(nullptr), m_targetStride(0),
+      m_width(0), m_height(0), m_screen(), m_style(OverlayStyle::Default()), m_selection(), m_cursor(), m_current(), m_stats() {
+}
+
+void OverlayCompositor::Attach(const uint8_t* source, int sourceStride, uint8_t* target, int targetStride,
+                               int width, int height, const OverlayStyle& style, std::vector<PixelRect>* damage) {
+    m_source = source;
+    m_sourceStride = sourceStride;
+    m_target = target;
+    m_targetStride = targetStride;
+    m_width = width;
+    m_height = height;
+    m_screen = { 0, 0, width, height };
+    m_style = style;
+    m_selection = { 0, 0, 0, 0 };
+    m_cursor = OverlayCursor();
+
+    m_dimmed = FramePool::Instance().Acquire(width, height);
+    if (m_dimmed) {
+        FrameRef dimmed = m_dimmed;
+        ParallelFor(0, height, 64, [&](int y0, int y1) {
+            ScalePixels(source + (size_t)y0 * sourceStride, sourceStride, dimmed->Row(y0), dimmed->Stride(),
+                        width, y1 - y0, style.dimLevel);
+        });
+    }
+    m_current = Layout(m_selection, m_cursor);
+
+    PixelRect all = { 0, 0, width, height };
+    Paint(m_current, all, m_target, m_targetStride);
+    damage->assign(1, all);
+    m_stats.frames++;
+    m_stats.strips++;
+    m_stats.pixelsTouched += (uint64_t)all.Area();
+}
+
+static int TextWidth(size_t length, int scale) {
+    return (int)length * GLYPH_ADVANCE * scale - scale;
+}
+
+OverlayCompositor::Decorations OverlayCompositor::Layout(const PixelRect& selection, const OverlayCursor& cursor) const {
+    Decorations d = {};
+    const PixelRect bounds = { 0, 0, m_width, m_height };
+    const int scale = m_style.labelScale;
+
+    // Loupe below-right of the cursor, flipped to the other side at the
+    // screen edges
+    if (cursor.visible && m_style.loupeZoom > 0 && cursor.x >= 0 && cursor.y >= 0 &&
+        cursor.x < m_width && cursor.y < m_height) {
+        uint32_t pixel = ((const uint32_t*)(m_source + (size_t)cursor.y * m_sourceStride))[cursor.x];
+        char readout[16];
+        snprintf(readout, sizeof(readout), "#%06X", pixel & 0xFFFFFF);
+        d.readout = readout;
+
+        const int imageSize = (2 * m_style.loupeRadius + 1) * m_style.loupeZoom;
+        const int boxWidth = std::max(imageSize + 2, TextWidth(d.readout.size(), scale) + 2 * m_style.labelPadding);
+        const int boxHeight = imageSize + 2 + GLYPH_HEIGHT * scale + 2 * m_style.labelPadding;
+        int left = cursor.x + m_style.loupeOffset;
+        if (left + boxWidth > m_width) left = std::max(0, cursor.x - m_style.loupeOffset - boxWidth);
+        int top = cursor.y + m_style.loupeOffset;
+        if (top + boxHeight > m_height) top = std::max(0, cursor.y - m_style.loupeOffset - boxHeight);
+
+        d.loupeShown = true;
+        d.cursorX = cursor.x;
+        d.cursorY = cursor.y;
+        d.loupeBox = { left, top, left + boxWidth, top + boxHeight };
+        d.loupeImage = { left + 1, top + 1, left + 1 + imageSize, top + 1 + imageSize };
+        d.readoutBox = { left, top + imageSize + 2, left + boxWidth, top + boxHeight };
+        d.loupe = d.loupeBox.Intersect(bounds);
+    }
+
+    if (selection.Empty()) return d;
+    d.selection = selection.Intersect(bounds);
+
+    const int width = m_style.borderWidth;
+    const int half = width / 2;
+    PixelRect outer = { selection.left - half, selection.top - half,
+                        selection.right + (width - half), selection.bottom + (width - half) };
+    PixelRect inner = { outer.left + width, outer.top + width, outer.right - width, outer.bottom - width };
+    if (inner.Empty()) {
+        d.border[0] = outer.Intersect(bounds);
+    } else {
+        d.border[0] = PixelRect{ outer.left, outer.top, outer.right, inner.top }.Intersect(bounds);
+        d.border[1] = PixelRect{ outer.left, inner.bottom, outer.right, outer.bottom }.Intersect(bounds);
+        d.border[2] = PixelRect{ outer.left, inner.top, inner.left, inner.bottom }.Intersect(bounds);
+        d.border[3] = PixelRect{ inner.right, inner.top, outer.right, inner.bottom }.Intersect(bounds);
+    }
+
+    char text[32];
+    snprintf(text, sizeof(text), "%dx%d", selection.Width(), selection.Height());
+    d.text = text;
+    if (!m_labelDetail.empty()) d.text += " " + m_labelDetail;
+
+    const int boxWidth = TextWidth(d.text.size(), scale) + 2 * m_style.labelPadding;
+    const int boxHeight = GLYPH_HEIGHT * scale + 2 * m_style.labelPadding;
+    // Above the selection's top-left corner, or just inside it at the screen top
+    int top = outer.top - m_style.labelGap - boxHeight;
+    if (top < m_screen.top) top = inner.top + m_style.labelGap;
+    d.labelBox = { outer.left, top, outer.left + boxWidth, top + boxHeight };
+    d.label = d.labelBox.Intersect(bounds);
+    return d;
+}
+
+static void FillRect(uint8_t* target, int stride, const PixelRect& rect, uint32_t color) {
+    for (int y = rect.top; y < rect.bottom; y++) {
+        uint32_t* row = (uint32_t*)(target + (size_t)y * stride);
+        std::fill(row + rect.left, row + rect.right, color);
+    }
+}
+
+static void CopyRect(const uint8_t* source, int sourceStride, uint8_t* target, int targetStride,
+                     const PixelRect& rect) {
+    for (int y = rect.top; y < rect.bottom; y++) {
+        memcpy(target + (size_t)y * targetStride + (size_t)rect.left * 4,
+               source + (size_t)y * sourceStride + (size_t)rect.left * 4, (size_t)rect.Width() * 4);
+    }
+}
+
+// 'text' in the 5x7 font at 'scale', top-left at (originX, originY),
+// limited to 'clip'
+static void DrawText(uint8_t* target, int stride, const PixelRect& clip, const std::string& text,
+                     int originX, int originY, int scale, uint32_t color) {
+    for (int y = clip.top; y < clip.bottom; y++) {
+        int glyphRow = (y - originY) / scale;
+        if (y < originY || glyphRow >= GLYPH_HEIGHT) continue;
+        uint32_t* row = (uint32_t*)(target + (size_t)y * stride);
+        for (int x = clip.left; x < clip.right; x++) {
+            if (x < originX) continue;
+            int column = (x - originX) / scale;
+            size_t index = (size_t)(column / GLYPH_ADVANCE);
+            int glyphColumn = column % GLYPH_ADVANCE;
+            if (index >= text.size() || glyphColumn >= GLYPH_WIDTH) continue;
+            const uint8_t* glyph = FindGlyph(text[index]);
+            if (glyph && (glyph[glyphRow] >> (GLYPH_WIDTH - 1 - glyphColumn)) & 1) {
+                row[x] = color;
+            }
+        }
+    }
+}
+
+void OverlayCompositor::Paint(const Decorations& d, const PixelRect& area, uint8_t* target, int targetStride) const {
+    // Dimmed backdrop, the selection at full brightness (no dimmed copy:
+    // out of memory, show the screenshot as is)
+    PixelRect cutout = m_dimmed ? d.selection.Intersect(area) : area;
+    if (m_dimmed) {
+        std::vector<PixelRect> outside;
+        SubtractRects(area, std::vector<PixelRect>(1, cutout), &outside);
+        for (const PixelRect& part : outside) {
+            CopyRect(m_dimmed->Bits(), m_dimmed->Stride(), target, targetStride, part);
+        }
+    }
+    CopyRect(m_source, m_sourceStride, target, targetStride, cutout);
+    for (const PixelRect& strip : d.border) {
+        PixelRect part = strip.Intersect(area);
+        if (!part.Empty()) FillRect(target, targetStride, part, m_style.borderColor);
+    }
+
+    PixelRect label = d.label.Intersect(area);
+    if (!label.Empty()) {
+        FillRect(target, targetStride, label, m_style.labelBackground);
+        DrawText(target, targetStride, label, d.text, d.labelBox.left + m_style.labelPadding,
+                 d.labelBox.top + m_style.labelPadding, m_style.labelScale, m_style.labelText);
+    }
+
+    // The loupe floats above everything else
+    PixelRect loupe = d.loupe.Intersect(area);
+    if (!loupe.Empty()) PaintLoupe(d, loupe, target, targetStride);
+}
+
+// Average of two colors, opaque
+static inline uint32_t Blend50(uint32_t a, uint32_t b) {
+    return (((a & 0xFEFEFEFEu) >> 1) + ((b & 0xFEFEFEFEu) >> 1)) | 0xFF000000u;
+}
+
+// 1-pixel outline of 'rect', limited to 'clip'
+static void StrokeRect(uint8_t* target, int stride, const PixelRect& rect, const PixelRect& clip, uint32_t color) {
+    const PixelRect edges[4] = {
+        { rect.left, rect.top, rect.right, rect.top + 1 },
+        { rect.left, rect.bottom - 1, rect.right, rect.bottom },
+        { rect.left, rect.top + 1, rect.left + 1, rect.bottom - 1 },
+        { rect.right - 1, rect.top + 1, rect.right, rect.bottom - 1 },
+    };
+    for (const PixelRect& edge : edges) {
+        PixelRect part = edge.Intersect(clip);
+        if (!part.Empty()) FillRect(target, stride, part, color);
+    }
+}
+
+void OverlayCompositor::PaintLoupe(const Decorations& d, const PixelRect& area, uint8_t* target, int targetStride) const {
+    FillRect(target, targetStride, area, m_style.labelBackground);
+    StrokeRect(target, targetStride, { d.loupeImage.left - 1, d.loupeImage.top - 1, d.loupeImage.right + 1,
+               d.loupeImage.bottom + 1 }, area, m_style.borderColor);
+
+    const int zoom = m_style.loupeZoom;
+    const int radius = m_style.loupeRadius;
+    const int span = 2 * radius + 1;
+    PixelRect image = d.loupeImage.Intersect(area);
+    if (!image.Empty()) {
+        // Each screenshot row is zoomed once (SIMD) and copied to its
+        // 'zoom' output rows; pixels beyond the screen show the background
+        std::vector<uint32_t> pixels(span), zoomed((size_t)span * zoom);
+        RowZoomer zoomRow = GetRowZoomer();
+        int zoomedRow = -1;
+        for (int y = image.top; y < image.bottom; y++) {
+            int cell = (y - d.loupeImage.top) / zoom;
+            if (cell != zoomedRow) {
+                int sourceY = d.cursorY - radius + cell;
+                for (int i = 0; i < span; i++) {
+                    int sourceX = d.cursorX - radius + i;
+                    bool inside = sourceX >= 0 && sourceX < m_width && sourceY >= 0 && sourceY < m_height;
+                    pixels[i] = inside ? ((const uint32_t*)(m_source + (size_t)sourceY * m_sourceStride))[sourceX]
+                                       : m_style.labelBackground;
+                }
+                zoomRow((const uint8_t*)pixels.data(), (uint8_t*)zoomed.data(), span, zoom);
+                zoomedRow = cell;
+            }
+            uint32_t* row = (uint32_t*)(target + (size_t)y * targetStride);
+            memcpy(row + image.left, zoomed.data() + (image.left - d.loupeImage.left), (size_t)image.Width() * 4);
+
+            // Grid lines on the first row and column of every cell
+            if (zoom < 4) continue;
+            if ((y - d.loupeImage.top) % zoom == 0) {
+                for (int x = image.left; x < image.right; x++) row[x] = Blend50(row[x], m_style.loupeGrid);
+            } else {
+                int offset = (image.left - d.loupeImage.left) % zoom;
+                for (int x = offset ? image.left + zoom - offset : image.left; x < image.right; x += zoom) {
+                    row[x] = Blend50(row[x], m_style.loupeGrid);
+                }
+            }
+        }
+
+        // The cursor's pixel
+        const int cellLeft = d.loupeImage.left + radius * zoom;
+        const int cellTop = d.loupeImage.top + radius * zoom;
+        StrokeRect(target, targetStride, { cellLeft - 1, cellTop - 1, cellLeft + zoom + 1, cellTop + zoom + 1 }, image,
+                   m_style.labelText);
+    }
+
+    DrawText(target, targetStride, area, d.readout, d.readoutBox.left + m_style.labelPadding,
+             d.readoutBox.top + m_style.labelPadding, m_style.labelScale, m_style.labelText);
+}
+
+// Append the parts of 'rect' not already covered by 'strips'
+static void AddDisjoint(const PixelRect& rect, std::vector<PixelRect>* strips) {
+    std::vector<PixelRect> parts;
+    SubtractRects(rect, *strips, &parts);
+    strips->insert(strips->end(), parts.begin(), parts.end());
+}
+
+void OverlayCompositor::SetSelection(const PixelRect& selection, std::vector<PixelRect>* damage) {
+    SetView(selection, m_cursor, damage);
+}
+
+void OverlayCompositor::SetView(const PixelRect& selection, const OverlayCursor& cursor,
+                                std::vector<PixelRect>* damage) {
+    damage->clear();
+    if (!m_target) return;
+    PixelRect normalized = selection.Empty() ? PixelRect{ 0, 0, 0, 0 } : selection;
+    bool cursorMoved = cursor.visible != m_cursor.visible ||
+                       (cursor.visible && (cursor.x != m_cursor.x || cursor.y != m_cursor.y));
+    if (normalized == m_selection && !cursorMoved) return;
+
+    Decorations next = Layout(normalized, cursor);
+    std::vector<PixelRect> oldBorder(m_current.border, m_current.border + 4);
+    std::vector<PixelRect> newBorder(next.border, next.border + 4);
+
+    // Label and loupe boxes repaint whole when they move or their content
+    // changes (the loupe's content follows the cursor)
+    std::vector<PixelRect> labels;
+    if (next.label != m_current.label || next.text != m_current.text) {
+        AddDisjoint(next.label, &labels);
+        AddDisjoint(m_current.label, &labels);
+    }
+    if (next.loupe != m_current.loupe || next.loupeShown != m_current.loupeShown ||
+        next.cursorX != m_current.cursorX || next.cursorY != m_current.cursorY) {
+        AddDisjoint(next.loupe, &labels);
+        AddDisjoint(m_current.loupe, &labels);
+    }
+
+    // Border pixels that are border in both frames keep their color, and
+    // only pixels entering or leaving the selection change brightness
+    std::vector<PixelRect> changed;
+    for (const PixelRect& strip : oldBorder) SubtractRects(strip, newBorder, &changed);
+    for (const PixelRect& strip : newBorder) SubtractRects(strip, oldBorder, &changed);
+    std::vector<PixelRect> oldSelection(1, m_current.selection), newSelection(1, next.selection);
+    std::vector<PixelRect> brightness;
+    SubtractRects(m_current.selection, newSelection, &brightness);
+    SubtractRects(next.selection, oldSelection, &brightness);
+    std::vector<PixelRect> brightnessOnly;
+    for (const PixelRect& part : brightness) SubtractRects(part, changed, &brightnessOnly);
+    changed.insert(changed.end(), brightnessOnly.begin(), brightnessOnly.end());
+
+    for (const PixelRect& strip : changed) SubtractRects(strip, labels, damage);
+    damage->insert(damage->end(), labels.begin(), labels.end());
+
+    m_selection = normalized;
+    m_cursor = cursor;
+    m_current = next;
+    for (const PixelRect& strip : *damage) {
+        Paint(m_current, strip, m_target, m_targetStride);
+        m_stats.pixelsTouched += (uint64_t)strip.Area();
+    }
+    m_stats.frames++;
+    m_stats.strips += damage->size();
+}
+
+void OverlayCompositor::RenderFull(const PixelRect& selection, const OverlayCursor& cursor, uint8_t* target,
+                                   int targetStride) const {
+    Paint(Layout(selection.Empty() ? PixelRect{ 0, 0, 0, 0 } : selection, cursor), { 0, 0, m_width, m_height },
+          target, targetStride);
+}
+
+} // namespace ScreenCapture
@@ -0,0 +1,150 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "framepool.h"
+
+namespace ScreenCapture {
+
+// Half-open pixel rectangle [left, right) x [top, bottom)
+struct PixelRect {
+    int left, top, right, bottom;
+
+    int Width() const { return right - left; }
+    int Height() const { return bottom - top; }
+    bool Empty() const { return right <= left || bottom <= top; }
+    int64_t Area() const { return Empty() ? 0 : (int64_t)Width() * Height(); }
+    bool operator==(const PixelRect& other) const {
+        return left == other.left && top == other.top && right == other.right && bottom == other.bottom;
+    }
+    bool operator!=(const PixelRect& other) const { return !(*this == other); }
+
+    PixelRect Intersect(const PixelRect& other) const;
+};
+
+// Append the parts of 'rect' outside every rectangle of 'cut' (at most
+// 4 * cut.size() disjoint pieces)
+void SubtractRects(const PixelRect& rect, const std::vector<PixelRect>& cut, std::vector<PixelRect>* out);
+
+// Colors are 32bpp BGRA words as stored in the frame (0xAARRGGBB)
+struct OverlayStyle {
+    uint32_t borderColor;
+    int borderWidth;        // Centered on the selection edge
+    uint32_t labelBackground;
+    uint32_t labelText;
+    int labelScale;         // Font pixel size (the font is 5x7)
+    int labelPadding;
+    int labelGap;           // Space between the label and the selection
+    int dimLevel;           // Brightness outside the selection, 0..256 (256 = none)
+    int loupeZoom;          // Magnifier scale (0 = no loupe)
+    int loupeRadius;        // Screenshot pixels shown each side of the cursor
+    int loupeOffset;        // Distance from the cursor to the loupe corner
+    uint32_t loupeGrid;     // Pixel grid, blended 50% (zoom 4 and up)
+
+    static OverlayStyle Default() {
+        return { 0xFF0078D7, 2, 0xFF000000, 0xFFFFFF00, 2, 3, 4, 160, 8, 7, 24, 0xFF808080 };
+    }
+};
+
+// Character code of the label font's plus-minus sign (Latin-1)
+static const char LABEL_PLUS_MINUS = '\xB1';
+
+// Mouse position on the overlay (client = frame coordinates)
+struct OverlayCursor {
+    int x, y;
+    bool visible;
+};
+
+struct CompositorStats {
+    uint64_t frames;
+    uint64_t strips;         // Damage rectangles reported
+    uint64_t pixelsTouched;  // Pixels rewritten (= pixels to present)
+};
+
+// Software renderer for the region-selection overlay. Keeps 'target' equal
+// to a dimmed copy of 'source' (the frozen screenshot) with the selection
+// cut out at full brightness, the border and size label drawn on top, and
+// a magnifier loupe beside the cursor: a nearest-neighbour zoom of the
+// screenshot around it with a pixel grid and the color under the cursor.
+// The dimmed copy is built once by Attach(); after that every selection
+// change rewrites only the pixels that differ: the symmetric difference of
+// the old and new selections and border strips, plus the old and new label
+// boxes, and the old and new loupe when the cursor moves. Those disjoint
+// damage strips are what the window needs to
+// present, so a frame costs in proportion to the change, not the screen.
+// Works on raw top-down 32bpp buffers; no Win32 code.
+class OverlayCompositor {
+public:
+    OverlayCompositor();
+
+    // Both buffers width x height; the caller keeps them alive. Builds the
+    // dimmed backdrop (SIMD, parallel rows); 'damage' receives the whole
+    // surface.
+    void Attach(const uint8_t* source, int sourceStride, uint8_t* target, int targetStride,
+                int width, int height, const OverlayStyle& style, std::vector<PixelRect>* damage);
+
+    // When the surface is one tile (a monitor) of a larger screen: that
+    // screen in surface coordinates (Attach resets it to the surface). The
+    // size label only moves inside the selection at the real screen top,
+    // so neighbouring tiles agree on where it goes.
+    void SetScreenArea(const PixelRect& screen) { m_screen = screen; }
+
+    // Text shown after the size in the label (empty = size only), e.g.
+    // statistics of the selection. Drawn by the next SetView.
+    void SetLabelDetail(const std::string& detail) { m_labelDetail = detail; }
+
+    // New selection (empty = none) and cursor. Replaces 'damage' with the
+    // strips that changed, in no particular order; empty when nothing
+    // changed.
+    void SetView(const PixelRect& selection, const OverlayCursor& cursor, std::vector<PixelRect>* damage);
+
+    // Same, cursor unchanged
+    void SetSelection(const PixelRect& selection, std::vector<PixelRect>* damage);
+
+    const PixelRect& Selection() const { return m_selection; }
+    const OverlayCursor& Cursor() const { return m_cursor; }
+    CompositorStats GetStats() const { return m_stats; }
+
+    // Draw source + decorations for 'selection' into 'target' from scratch
+    // (reference for SetSelection, and for callers that redraw everything)
+    void RenderFull(const PixelRect& selection, const OverlayCursor& cursor, uint8_t* target, int targetStride) const;
+
+private:
+    struct Decorations {
+        PixelRect selection;  // Undimmed cut-out, clipped
+        PixelRect border[4];  // Top, bottom, left, right (disjoint, clipped)
+        PixelRect label;      // Box behind the text, clipped (empty = none)
+        PixelRect labelBox;   // Unclipped, the text origin
+        std::string text;
+
+        bool loupeShown;
+        int cursorX, cursorY;
+        PixelRect loupe;       // Frame + readout, clipped (empty = none)
+        PixelRect loupeBox;    // Unclipped
+        PixelRect loupeImage;  // Zoomed pixels inside the frame, unclipped
+        PixelRect readoutBox;  // Below the image, unclipped
+        std::string readout;   // #RRGGBB under the cursor
+    };
+
+    Decorations Layout(const PixelRect& selection, const OverlayCursor& cursor) const;
+    void Paint(const Decorations& decorations, const PixelRect& area, uint8_t* target, int targetStride) const;
+    void PaintLoupe(const Decorations& decorations, const PixelRect& area, uint8_t* target, int targetStride) const;
+
+    const uint8_t* m_source;
+    int m_sourceStride;
+    FrameRef m_dimmed;
+    uint8_t* m_target;
+    int m_targetStride;
+    int m_width;
+    int m_height;
+    PixelRect m_screen;
+    std::string m_labelDetail;
+    OverlayStyle m_style;
+
+    PixelRect m_selection;
+    OverlayCursor m_cursor;
+    Decorations m_current;
+    CompositorStats m_stats;
+};
+
+} // namespace ScreenCapture
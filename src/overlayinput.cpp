@@ -0,0 +1,161 @@
+#include "overlayinput.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+namespace ScreenCapture {
+
+OverlayInput::OverlayInput() : m_windows(nullptr) {
+    Reset(OverlayInputOptions::Default(), nullptr);
+}
+
+void OverlayInput::Reset(const OverlayInputOptions& options, const WindowIndex* windows) {
+    m_options = options;
+    m_windows = windows;
+    m_selecting = false;
+    m_dragging = false;
+    m_complete = false;
+    m_startX = m_startY = 0;
+    m_downX = m_downY = 0;
+    m_hover = { 0, 0, 0, 0 };
+    m_selection = { 0, 0, 0, 0 };
+    m_result = { 0, 0, 0, 0 };
+    m_cursor = { 0, 0, false };
+}
+
+PixelRect OverlayInput::Span(int x0, int y0, int x1, int y1) {
+    return { std::min(x0, x1), std::min(y0, y1), std::max(x0, x1), std::max(y0, y1) };
+}
+
+void OverlayInput::Snap(int x, int y, uint8_t modifiers, const EdgeMap* edges, int* snappedX, int* snappedY) const {
+    *snappedX = x;
+    *snappedY = y;
+    // Alt held = place freely
+    if (m_options.snapDistance <= 0 || !edges || (modifiers & INPUT_ALT)) return;
+    int column = edges->SnapColumn(x, y, m_options.snapDistance);
+    int row = edges->SnapRow(x, y, m_options.snapDistance);
+    if (column >= 0) *snappedX = column;
+    if (row >= 0) *snappedY = row;
+}
+
+PixelRect OverlayInput::Pick(int x, int y, uint8_t modifiers) const {
+    if (!m_options.pickWindows || !m_windows) return { 0, 0, 0, 0 };
+    int element = m_windows->HitTest(x, y);
+    if (element < 0) return { 0, 0, 0, 0 };
+    // Ctrl held = the whole window, not the control inside it
+    if (modifiers & INPUT_CTRL) element = m_windows->TopLevel(element);
+    return m_windows->Element(element).rect;
+}
+
+void OverlayInput::Apply(const InputEvent& event, const EdgeMap* edges) {
+    if (m_complete) return;
+    m_cursor = { event.x, event.y, true };
+    int x, y;
+    switch (event.type) {
+        case InputEventType::Move:
+            if (m_selecting && !m_dragging && !m_hover.Empty() &&
+                abs(event.x - m_downX) <= m_options.dragX && abs(event.y - m_downY) <= m_options.dragY) {
+                // Still a click on the picked element (hands wobble a pixel or two)
+                m_selection = m_hover;
+            } else if (m_selecting) {
+                m_dragging = true;
+                Snap(event.x, event.y, event.modifiers, edges, &x, &y);
+                m_selection = Span(m_startX, m_startY, x, y);
+            } else {
+                // Before the button goes down the selection is the hovered
+                // window or control
+                m_hover = Pick(event.x, event.y, event.modifiers);
+                m_selection = m_hover;
+            }
+            break;
+        case InputEventType::ButtonDown:
+            Snap(event.x, event.y, event.modifiers, edges, &m_startX, &m_startY);
+            m_downX = event.x;
+            m_downY = event.y;
+            m_dragging = false;
+            m_selecting = true;
+            break;
+        case InputEventType::ButtonUp:
+            if (!m_selecting) break;
+            m_selecting = false;
+            // A click without a drag captures the highlighted element; the
+            // end of a drag snaps like the corner shown while dragging
+            if (!m_dragging && !m_hover.Empty()) {
+                m_result = m_hover;
+            } else {
+                Snap(event.x, event.y, event.modifiers, edges, &x, &y);
+                m_result = Span(m_startX, m_startY, x, y);
+            }
+            m_selection = m_result;
+            m_complete = true;
+            break;
+        case InputEventType::Cancel:
+            m_selecting = false;
+            m_selection = { 0, 0, 0, 0 };
+            m_result = { 0, 0, 0, 0 };
+            m_complete = true;
+            break;
+    }
+}
+
+// Trace format:
+//   SCRTRACE 1 <width> <height> <frameUs> <loupeZoom> <snap> <pick> <dragX> <dragY>
+//   W <left> <top> <right> <bottom> <parent>      (pick snapshot, in order)
+//   E <timeUs> <M|D|U|C> <x> <y> <modifiers>
+static const char EVENT_CODES[] = { 'M', 'D', 'U', 'C' };
+
+InputTrace::InputTrace()
+    : width(0), height(0), frameUs(0), loupeZoom(0), options(OverlayInputOptions::Default()) {
+}
+
+bool InputTrace::Write(FILE* file) const {
+    if (!file) return false;
+    fprintf(file, "SCRTRACE 1 %d %d %lld %d %d %d %d %d\n", width, height, (long long)frameUs, loupeZoom,
+            options.snapDistance, options.pickWindows ? 1 : 0, options.dragX, options.dragY);
+    for (const WindowElement& window : windows) {
+        fprintf(file, "W %d %d %d %d %d\n", window.rect.left, window.rect.top, window.rect.right,
+                window.rect.bottom, window.parent);
+    }
+    for (const InputEvent& event : events) {
+        fprintf(file, "E %lld %c %d %d %d\n", (long long)event.timeUs, EVENT_CODES[(int)event.type],
+                event.x, event.y, event.modifiers);
+    }
+    return fflush(file) == 0 && !ferror(file);
+}
+
+bool InputTrace::Read(FILE* file) {
+    *this = InputTrace();
+    if (!file) return false;
+    long long frame = 0;
+    int pick = 0;
+    if (fscanf(file, " SCRTRACE 1 %d %d %lld %d %d %d %d %d", &width, &height, &frame, &loupeZoom,
+               &options.snapDistance, &pick, &options.dragX, &options.dragY) != 8) {
+        return false;
+    }
+    frameUs = frame;
+    options.pickWindows = pick != 0;
+    if (width <= 0 || height <= 0 || frameUs <= 0) return false;
+
+    char tag;
+    while (fscanf(file, " %c", &tag) == 1) {
+        if (tag == 'W') {
+            WindowElement window;
+            if (fscanf(file, "%d %d %d %d %d", &window.rect.left, &window.rect.top, &window.rect.right,
+                       &window.rect.bottom, &window.parent) != 5) return false;
+            windows.push_back(window);
+        } else if (tag == 'E') {
+            long long time;
+            char code;
+            int x, y, modifiers;
+            if (fscanf(file, "%lld %c %d %d %d", &time, &code, &x, &y, &modifiers) != 5) return false;
+            const char* found = (const char*)memchr(EVENT_CODES, code, sizeof(EVENT_CODES));
+            if (!found) return false;
+            events.push_back({ time, (InputEventType)(found - EVENT_CODES), (uint8_t)modifiers, x, y });
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace ScreenCapture
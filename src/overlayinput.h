@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "edgemap.h"
+#include "overlaycompositor.h"
+#include "windowindex.h"
+
+namespace ScreenCapture {
+
+enum class InputEventType : uint8_t {
+    Move,
+    ButtonDown,
+    ButtonUp,
+    Cancel  // ESC
+};
+
+// Keys held during an input event
+static const uint8_t INPUT_CTRL = 1;
+static const uint8_t INPUT_ALT = 2;
+
+struct InputEvent {
+    int64_t timeUs;  // Since the overlay opened
+    InputEventType type;
+    uint8_t modifiers;
+    int x, y;        // Overlay client coordinates
+};
+
+struct OverlayInputOptions {
+    int snapDistance;  // 0 = no snapping
+    bool pickWindows;
+    int dragX, dragY;  // Movement that turns a click into a drag
+
+    static OverlayInputOptions Default() { return { 8, true, 4, 4 }; }
+};
+
+// What the region-selection overlay does with mouse and keyboard input:
+// hovering highlights the window or control under the cursor, a click
+// captures it, a drag selects a region whose corners snap to edges (Alt
+// places freely, Ctrl picks the whole window). Produces the selection to
+// draw after every event. Contains no Win32 code, so recorded sessions
+// can be replayed headless through the same logic.
+class OverlayInput {
+public:
+    OverlayInput();
+
+    // windows: pick index for the session (null = no picking)
+    void Reset(const OverlayInputOptions& options, const WindowIndex* windows);
+
+    // edges: null while the edge map is still being built
+    void Apply(const InputEvent& event, const EdgeMap* edges);
+
+    bool Selecting() const { return m_selecting; }
+    bool Complete() const { return m_complete; }
+
+    // Selection to draw now (empty = none)
+    PixelRect Selection() const { return m_selection; }
+    OverlayCursor Cursor() const { return m_cursor; }
+
+    // Chosen region once Complete() (empty = cancelled)
+    PixelRect Result() const { return m_result; }
+
+private:
+    // Point moved onto the nearest strong edge within the snap distance
+    void Snap(int x, int y, uint8_t modifiers, const EdgeMap* edges, int* snappedX, int* snappedY) const;
+
+    // Rectangle of the window or control under the cursor (empty = none)
+    PixelRect Pick(int x, int y, uint8_t modifiers) const;
+
+    static PixelRect Span(int x0, int y0, int x1, int y1);
+
+    OverlayInputOptions m_options;
+    const WindowIndex* m_windows;
+    bool m_selecting;
+    bool m_dragging;  // Moved past the drag threshold since button down
+    bool m_complete;
+    int m_startX, m_startY;  // Snapped button-down position
+    int m_downX, m_downY;    // Unsnapped
+    PixelRect m_hover;       // Picked element, empty = nothing picked
+    PixelRect m_selection;
+    PixelRect m_result;
+    OverlayCursor m_cursor;
+};
+
+// One overlay session's input, with what the replay needs to rebuild the
+// scene: screen size, frame interval, settings and the window snapshot
+// (the screenshot itself is not stored). Text format, one event per line.
+struct InputTrace {
+    int width, height;
+    int64_t frameUs;
+    int loupeZoom;
+    OverlayInputOptions options;
+    std::vector<WindowElement> windows;  // Pick snapshot, priority order
+    std::vector<InputEvent> events;
+
+    InputTrace();
+
+    bool Write(FILE* file) const;
+    bool Read(FILE* file);
+};
+
+} // namespace ScreenCapture
@@ -0,0 +1,105 @@
+#include "overlayrenderer.h"
+
+namespace ScreenCapture {
+
+OverlayRenderThread::OverlayRenderThread(TimerClock& clock, int64_t frameUs)
+    : m_clock(clock), m_pacer(clock, frameUs), m_sequence(0), m_idle(false), m_stopping(false), m_stats() {
+}
+
+OverlayRenderThread::~OverlayRenderThread() {
+    Stop();
+}
+
+void OverlayRenderThread::SetFrameInterval(int64_t frameUs) {
+    if (!Running()) m_pacer.SetFrameInterval(frameUs);
+}
+
+bool OverlayRenderThread::Start(RenderFunction render) {
+    if (!render) return false;
+    Stop();
+    m_render = render;
+    m_pacer.Reset();
+    m_stopping = false;
+    m_clock.SetInterrupted(false);
+    m_thread = std::thread(&OverlayRenderThread::RenderLoop, this);
+    return true;
+}
+
+void OverlayRenderThread::Stop() {
+    if (!m_thread.joinable()) return;
+    m_stopping = true;
+    m_clock.SetInterrupted(true);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_wake.notify_all();
+    }
+    m_thread.join();
+}
+
+void OverlayRenderThread::Publish(const PixelRect& selection, const OverlayCursor& cursor) {
+    OverlayState state = { selection, cursor, m_clock.NowUs(), m_sequence.load(std::memory_order_relaxed) + 1 };
+    m_states.Publish(state);
+    m_sequence.store(state.sequence, std::memory_order_relaxed);
+
+    // Pairs with the fence in RenderLoop: either the render thread sees the
+    // new state before it sleeps, or this sees it idle and wakes it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_idle.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_wake.notify_one();
+    }
+}
+
+OverlayRenderStats OverlayRenderThread::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    OverlayRenderStats stats = m_stats;
+    stats.published = m_sequence.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void OverlayRenderThread::RenderLoop() {
+    OverlayState state = {};
+    uint64_t lastRendered = 0;
+
+    while (!m_stopping) {
+        OverlayState next;
+        if (m_states.Consume(&next)) {
+            state = next;
+            m_pacer.Submit(state.cursor.x, state.cursor.y);
+        }
+
+        int x, y;
+        if (m_pacer.BeginFrame(&x, &y)) {
+            int64_t start = m_clock.NowUs();
+            m_render(state);
+            int64_t end = m_clock.NowUs();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.rendered++;
+            m_stats.superseded += state.sequence - lastRendered - 1;
+            m_stats.pacing = m_pacer.GetStats();
+            m_stats.inputToPresent.Add(end - state.inputUs);
+            m_stats.render.Add(end - start);
+            lastRendered = state.sequence;
+            continue;
+        }
+
+        // Newer input that lands while waiting for the frame slot is
+        // picked up on the next pass
+        int64_t deadline = m_pacer.NextDeadlineUs();
+        if (deadline >= 0) {
+            m_clock.SleepUntilUs(deadline);
+            continue;
+        }
+
+        // Nothing pending: sleep until the input thread publishes
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        m_wake.wait(lock, [this] { return m_states.HasNew() || m_stopping; });
+        m_idle.store(false, std::memory_order_relaxed);
+        m_stats.wakeups++;
+    }
+}
+
+} // namespace ScreenCapture
@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "capturetimer.h"
+#include "framepacer.h"
+#include "overlaycompositor.h"
+#include "triplebuffer.h"
+
+namespace ScreenCapture {
+
+// What the input thread hands to the render thread
+struct OverlayState {
+    PixelRect selection;  // Empty = none
+    OverlayCursor cursor;
+    int64_t inputUs;      // Clock time the input was handled
+    uint64_t sequence;    // Publish count, 1-based
+};
+
+struct OverlayRenderStats {
+    uint64_t published;        // States handed over by the input thread
+    uint64_t rendered;         // Frames drawn and presented
+    uint64_t superseded;       // Published states never drawn (a newer one won)
+    uint64_t wakeups;          // Render thread woken from idle
+    FramePacerStats pacing;
+    LatencyHistogram inputToPresent;  // inputUs -> render callback returned
+    LatencyHistogram render;          // Render callback duration
+};
+
+// Moves overlay drawing off the window's input thread. The input thread
+// only publishes the newest selection (a lock-free triple buffer; it takes
+// a mutex just to wake the render thread when that is idle). The render
+// thread picks the newest state up at the paced frame rate and calls the
+// render callback, which composes and presents it (GDI blits, logging),
+// so none of that delays the next mouse message. States published between
+// two frames collapse into the latest. Contains no Win32 code.
+class OverlayRenderThread {
+public:
+    // Draws 'state'; runs on the render thread
+    typedef std::function<void(const OverlayState& state)> RenderFunction;
+
+    OverlayRenderThread(TimerClock& clock, int64_t frameUs);
+    ~OverlayRenderThread();
+
+    OverlayRenderThread(const OverlayRenderThread&) = delete;
+    OverlayRenderThread& operator=(const OverlayRenderThread&) = delete;
+
+    // While stopped
+    void SetFrameInterval(int64_t frameUs);
+
+    bool Start(RenderFunction render);
+
+    // Stops after the frame in progress; states not yet drawn are dropped
+    void Stop();
+
+    bool Running() const { return m_thread.joinable(); }
+
+    // Input thread only
+    void Publish(const PixelRect& selection, const OverlayCursor& cursor);
+
+    // Since construction
+    OverlayRenderStats GetStats() const;
+
+private:
+    void RenderLoop();
+
+    TimerClock& m_clock;
+    FramePacer m_pacer;          // Render thread's
+    RenderFunction m_render;
+    TripleBuffer<OverlayState> m_states;
+    std::atomic<uint64_t> m_sequence;  // Written by the input thread only
+    std::thread m_thread;
+
+    mutable std::mutex m_mutex;  // Guards the wakeup and m_stats
+    std::condition_variable m_wake;
+    std::atomic<bool> m_idle;    // Render thread waits on m_wake
+    std::atomic<bool> m_stopping;
+    OverlayRenderStats m_stats;
+};
+
+} // namespace ScreenCapture
@@ -0,0 +1,193 @@
+#include "overlaytiles.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+namespace ScreenCapture {
+
+OverlayTiles::OverlayTiles() : m_width(0), m_height(0), m_style(OverlayStyle::Default()) {
+}
+
+void OverlayTiles::Reset(const std::vector<PixelRect>& monitors, int width, int height, const OverlayStyle& style) {
+    m_tiles.clear();
+    m_width = width;
+    m_height = height;
+    m_style = style;
+    const PixelRect screen = { 0, 0, width, height };
+    for (const PixelRect& monitor : monitors) {
+        PixelRect bounds = monitor.Intersect(screen);
+        if (bounds.Empty()) continue;
+        std::unique_ptr<Tile> tile(new Tile());
+        tile->bounds = bounds;
+        m_tiles.push_back(std::move(tile));
+    }
+}
+
+int OverlayTiles::TileAt(int x, int y) const {
+    for (size_t i = 0; i < m_tiles.size(); i++) {
+        const PixelRect& b = m_tiles[i]->bounds;
+        if (x >= b.left && x < b.right && y >= b.top && y < b.bottom) return (int)i;
+    }
+    return -1;
+}
+
+// Squared distance from a point to the nearest pixel of a rectangle
+static int64_t DistanceSquared(const PixelRect& rect, int x, int y) {
+    int64_t dx = x < rect.left ? rect.left - x : (x >= rect.right ? x - rect.right + 1 : 0);
+    int64_t dy = y < rect.top ? rect.top - y : (y >= rect.bottom ? y - rect.bottom + 1 : 0);
+    return dx * dx + dy * dy;
+}
+
+std::vector<int> OverlayTiles::OrderFrom(int x, int y) const {
+    std::vector<int> order(m_tiles.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = (int)i;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return DistanceSquared(m_tiles[a]->bounds, x, y) < DistanceSquared(m_tiles[b]->bounds, x, y);
+    });
+    return order;
+}
+
+FrameRef OverlayTiles::Screenshot(int tile) {
+    Tile& t = *m_tiles[tile];
+    if (!t.screenshot) t.screenshot = FramePool::Instance().Acquire(t.bounds.Width(), t.bounds.Height());
+    return t.screenshot;
+}
+
+void OverlayTiles::DropScreenshot(int tile) {
+    Tile& t = *m_tiles[tile];
+    if (!t.ready.load(std::memory_order_acquire)) t.screenshot = nullptr;
+}
+
+FrameRef OverlayTiles::Backbuffer(int tile) {
+    Tile& t = *m_tiles[tile];
+    if (!t.backbuffer) t.backbuffer = FramePool::Instance().Acquire(t.bounds.Width(), t.bounds.Height());
+    return t.backbuffer;
+}
+
+void OverlayTiles::Prepare(int tile) {
+    Tile& t = *m_tiles[tile];
+    if (t.ready.load(std::memory_order_acquire)) return;
+    FrameRef screenshot = Screenshot(tile);
+    FrameRef backbuffer = Backbuffer(tile);
+    if (!screenshot || !backbuffer) return;
+    t.compositor.Attach(screenshot->Bits(), screenshot->Stride(), backbuffer->Bits(), backbuffer->Stride(),
+                        t.bounds.Width(), t.bounds.Height(), m_style, &t.damage);
+    t.compositor.SetScreenArea({ -t.bounds.left, -t.bounds.top, m_width - t.bounds.left, m_height - t.bounds.top });
+    t.ready.store(true, std::memory_order_release);
+}
+
+void OverlayTiles::BuildEdges(int tile, const EdgeMapOptions& options) {
+    Tile& t = *m_tiles[tile];
+    if (!t.ready.load(std::memory_order_acquire) || t.edgesReady.load(std::memory_order_acquire)) return;
+    t.edges.SetOrigin(t.bounds.left, t.bounds.top);
+    t.edges.Build(t.screenshot->Bits(), t.screenshot->Stride(), t.bounds.Width(), t.bounds.Height(), options);
+    t.edgesReady.store(true, std::memory_order_release);
+}
+
+const EdgeMap* OverlayTiles::EdgesAt(int x, int y) const {
+    int tile = TileAt(x, y);
+    if (tile < 0 || !m_tiles[tile]->edgesReady.load(std::memory_order_acquire)) return nullptr;
+    return &m_tiles[tile]->edges;
+}
+
+void OverlayTiles::BuildStats(int tile) {
+    Tile& t = *m_tiles[tile];
+    if (!t.ready.load(std::memory_order_acquire) || t.statsReady.load(std::memory_order_acquire)) return;
+    if (!t.stats.Build(t.screenshot->Bits(), t.screenshot->Stride(), t.bounds.Width(), t.bounds.Height())) return;
+    t.statsReady.store(true, std::memory_order_release);
+}
+
+bool OverlayTiles::SumRegion(const PixelRect& rect, RegionSums* sums) const {
+    *sums = RegionSums();
+    for (const std::unique_ptr<Tile>& tile : m_tiles) {
+        const Tile& t = *tile;
+        PixelRect part = rect.Intersect(t.bounds);
+        if (part.Empty()) continue;
+        if (!t.statsReady.load(std::memory_order_acquire)) return false;
+        sums->Add(t.stats.Sum({ part.left - t.bounds.left, part.top - t.bounds.top,
+                                part.right - t.bounds.left, part.bottom - t.bounds.top }));
+    }
+    return sums->pixels > 0;
+}
+
+void OverlayTiles::SetView(const PixelRect& selection, const OverlayCursor& cursor, std::vector<PixelRect>* damage) {
+    damage->clear();
+    // "#RRGGBB L<mean>±<deviation>" after the size
+    std::string detail;
+    RegionSums sums;
+    if (!selection.Empty() && SumRegion(selection, &sums)) {
+        char text[32];
+        snprintf(text, sizeof(text), "#%06X L%d%c%d", sums.MeanColor() & 0xFFFFFF, (int)lround(sums.MeanLuma()),
+                 LABEL_PLUS_MINUS, (int)lround(sums.LumaDeviation()));
+        detail = text;
+    }
+    for (const std::unique_ptr<Tile>& tile : m_tiles) {
+        Tile& t = *tile;
+        if (!t.ready.load(std::memory_order_acquire)) continue;
+        const PixelRect& b = t.bounds;
+        PixelRect local = selection.Empty() ? PixelRect{ 0, 0, 0, 0 }
+                                            : PixelRect{ selection.left - b.left, selection.top - b.top,
+                                                         selection.right - b.left, selection.bottom - b.top };
+        bool inside = cursor.x >= b.left && cursor.x < b.right && cursor.y >= b.top && cursor.y < b.bottom;
+        OverlayCursor localCursor = { cursor.x - b.left, cursor.y - b.top, cursor.visible && inside };
+        t.compositor.SetLabelDetail(detail);
+        t.compositor.SetView(local, localCursor, &t.damage);
+        for (const PixelRect& strip : t.damage) {
+            damage->push_back({ strip.left + b.left, strip.top + b.top, strip.right + b.left, strip.bottom + b.top });
+        }
+    }
+}
+
+FrameRef OverlayTiles::Crop(const PixelRect& rect) const {
+    if (rect.Empty()) return nullptr;
+    for (const std::unique_ptr<Tile>& tile : m_tiles) {
+        const Tile& t = *tile;
+        if (t.screenshot && rect.Intersect(t.bounds) == rect) {
+            return FramePool::SubView(t.screenshot, rect.left - t.bounds.left, rect.top - t.bounds.top,
+                                      rect.Width(), rect.Height());
+        }
+    }
+
+    // Spans monitors (or dead areas): stitch
+    FrameRef frame = FramePool::Instance().Acquire(rect.Width(), rect.Height());
+    if (!frame) return nullptr;
+    for (int y = 0; y < rect.Height(); y++) {
+        uint32_t* row = (uint32_t*)frame->Row(y);
+        std::fill(row, row + rect.Width(), 0xFF000000u);
+    }
+    for (const std::unique_ptr<Tile>& tile : m_tiles) {
+        const Tile& t = *tile;
+        PixelRect part = rect.Intersect(t.bounds);
+        if (!t.screenshot || part.Empty()) continue;
+        for (int y = part.top; y < part.bottom; y++) {
+            memcpy(frame->Row(y - rect.top) + (size_t)(part.left - rect.left) * 4,
+                   t.screenshot->Row(y - t.bounds.top) + (size_t)(part.left - t.bounds.left) * 4,
+                   (size_t)part.Width() * 4);
+        }
+    }
+    return frame;
+}
+
+OverlayTilesStats OverlayTiles::GetStats() const {
+    OverlayTilesStats stats = {};
+    stats.tiles = (int)m_tiles.size();
+    for (const std::unique_ptr<Tile>& tile : m_tiles) {
+        const Tile& t = *tile;
+        size_t bytes = (size_t)t.bounds.Width() * t.bounds.Height() * 4;
+        if (t.screenshot) {
+            stats.captured++;
+            stats.bytes += bytes;
+        }
+        if (t.backbuffer) stats.bytes += bytes;
+        if (t.ready.load(std::memory_order_acquire)) {
+            stats.ready++;
+            stats.bytes += bytes;  // The compositor's dimmed copy
+        }
+        if (t.statsReady.load(std::memory_order_acquire)) stats.statsBytes += t.stats.Bytes();
+    }
+    stats.boundingBytes = (size_t)m_width * m_height * 4 * 3;
+    return stats;
+}
+
+} // namespace ScreenCapture
@@ -0,0 +1,121 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "edgemap.h"
+#include "framepool.h"
+#include "overlaycompositor.h"
+#include "summedarea.h"
+
+namespace ScreenCapture {
+
+struct OverlayTilesStats {
+    int tiles;
+    int captured;
+    int ready;
+    size_t bytes;          // Screenshots, backbuffers and dimmed backdrops allocated
+    size_t boundingBytes;  // The same three buffers over the whole bounding box
+    size_t statsBytes;     // Summed-area tables
+};
+
+// The region-selection overlay split into one tile per monitor, so dead
+// areas of a mixed monitor layout are never allocated, and nothing is
+// allocated for a monitor until it is needed. A tile goes through:
+//   Screenshot()  allocates its frozen frame, which the caller fills
+//   Prepare()     allocates its backbuffer and builds the dimmed backdrop;
+//                 from then on it is ready and takes part in SetView()
+//   BuildEdges()  its edge map for snapping (optional, any time after)
+//   BuildStats()  its summed-area tables for the selection statistics
+//                 (optional, any time after)
+// Preparing and building may run on another thread than SetView: a tile
+// only becomes visible to SetView, EdgesAt and SumRegion once it is done.
+// Coordinates are overlay client coordinates. Contains no Win32 code.
+class OverlayTiles {
+public:
+    OverlayTiles();
+
+    // Monitor rectangles inside a width x height screen (the bounding box)
+    void Reset(const std::vector<PixelRect>& monitors, int width, int height, const OverlayStyle& style);
+
+    int Count() const { return (int)m_tiles.size(); }
+    const PixelRect& Bounds(int tile) const { return m_tiles[tile]->bounds; }
+
+    // Tile holding the point, -1 = no monitor there
+    int TileAt(int x, int y) const;
+
+    // Tiles in preparation order: the one under (x, y) first (or the
+    // nearest one), then by distance from it
+    std::vector<int> OrderFrom(int x, int y) const;
+
+    // Frozen frame of a tile, allocated on the first call
+    FrameRef Screenshot(int tile);
+
+    // Whether a tile has a frozen frame
+    bool Captured(int tile) const { return m_tiles[tile]->screenshot != nullptr; }
+
+    // Forget the frozen frame of a tile whose fill failed, so its pool
+    // garbage is never cropped. Only before the tile is prepared.
+    void DropScreenshot(int tile);
+
+    // Backbuffer of a tile, allocated on the first call (the caller may
+    // wrap it for presenting before Prepare)
+    FrameRef Backbuffer(int tile);
+
+    // Dimmed backdrop from the filled screenshot; marks the tile ready
+    void Prepare(int tile);
+
+    bool Ready(int tile) const { return m_tiles[tile]->ready.load(std::memory_order_acquire); }
+
+    // Snap edges of a ready tile
+    void BuildEdges(int tile, const EdgeMapOptions& options = EdgeMapOptions::Default());
+
+    // Edge map of the tile under the point, null while not built
+    const EdgeMap* EdgesAt(int x, int y) const;
+
+    // Summed-area tables of a ready tile
+    void BuildStats(int tile);
+
+    // Sums over the monitor pixels of 'rect' (dead areas left out); false
+    // while a tile it touches has no tables yet
+    bool SumRegion(const PixelRect& rect, RegionSums* sums) const;
+
+    // Bring every ready tile to the selection and cursor (the loupe stays
+    // on the cursor's monitor). Replaces 'damage' with the changed strips
+    // of all tiles. A tile that just became ready is not reported whole:
+    // the caller presents it when it learns the tile is ready. Once the
+    // selection's tiles have statistics, the size label shows its mean
+    // color and luma mean and deviation, the same on every tile.
+    void SetView(const PixelRect& selection, const OverlayCursor& cursor, std::vector<PixelRect>* damage);
+
+    // Part of the frozen screenshot: a zero-copy view when it lies in one
+    // captured tile, else a stitched copy with dead areas black (and tiles
+    // not captured, which the caller makes sure the rect does not touch).
+    // Like GetStats, only while no tile is being prepared.
+    FrameRef Crop(const PixelRect& rect) const;
+
+    OverlayTilesStats GetStats() const;
+
+private:
+    struct Tile {
+        PixelRect bounds;
+        FrameRef screenshot;
+        FrameRef backbuffer;
+        OverlayCompositor compositor;
+        std::vector<PixelRect> damage;
+        EdgeMap edges;
+        SummedAreaTable stats;
+        std::atomic<bool> ready;
+        std::atomic<bool> edgesReady;
+        std::atomic<bool> statsReady;
+
+        Tile() : bounds(), ready(false), edgesReady(false), statsReady(false) {}
+    };
+
+    std::vector<std::unique_ptr<Tile>> m_tiles;
+    int m_width;
+    int m_height;
+    OverlayStyle m_style;
+};
+
+} // namespace ScreenCapture
@@ -0,0 +1,312 @@
+#include "pixelconvert.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PIXELCONVERT_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC/Clang only emit SSSE3/AVX2 instructions inside functions that opt in;
+// MSVC allows the intrinsics anywhere
+#if defined(__GNUC__) || defined(__clang__)
+#define PIXEL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define PIXEL_TARGET(isa)
+#endif
+
+namespace ScreenCapture {
+
+int BytesPerPixel(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::RGB: return 3;
+        case PixelFormat::Gray8: return 1;
+        case PixelFormat::RGB565: return 2;
+        default: return 4;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// SIMD kernels (byte shuffles). Each finishes its row with the scalar
+// specialization for the same pair.
+
+#ifdef PIXELCONVERT_X86
+
+// BGRA -> RGBA: swap bytes 0 and 2 of every pixel
+#define SWAP_RB_MASK 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15
+// BGRx -> RGB: 4 pixels into the low 12 bytes
+#define PACK_RGB_MASK 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+
+template <bool OpaqueAlpha>
+PIXEL_TARGET("ssse3")
+static void SwapRBSSSE3(const uint8_t* src, uint8_t* dst, int width) {
+    const __m128i mask = _mm_setr_epi8(SWAP_RB_MASK);
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        __m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + x * 4)), mask);
+        if (OpaqueAlpha) v = _mm_or_si128(v, alpha);
+        _mm_storeu_si128((__m128i*)(dst + x * 4), v);
+    }
+    if (OpaqueAlpha) {
+        ConvertRowScalar<PixelFormat::BGRX, PixelFormat::RGBA>(src + x * 4, dst + x * 4, width - x);
+    } else {
+        ConvertRowScalar<PixelFormat::BGRA, PixelFormat::RGBA>(src + x * 4, dst + x * 4, width - x);
+    }
+}
+
+template <bool OpaqueAlpha>
+PIXEL_TARGET("avx2")
+static void SwapRBAVX2(const uint8_t* src, uint8_t* dst, int width) {
+    // vpshufb works within 128-bit lanes, so the mask is just repeated
+    const __m256i mask = _mm256_setr_epi8(SWAP_RB_MASK, SWAP_RB_MASK);
+    const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m256i v = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(src + x * 4)), mask);
+        if (OpaqueAlpha) v = _mm256_or_si256(v, alpha);
+        _mm256_storeu_si256((__m256i*)(dst + x * 4), v);
+    }
+    if (OpaqueAlpha) {
+        ConvertRowScalar<PixelFormat::BGRX, PixelFormat::RGBA>(src + x * 4, dst + x * 4, width - x);
+    } else {
+        ConvertRowScalar<PixelFormat::BGRA, PixelFormat::RGBA>(src + x * 4, dst + x * 4, width - x);
+    }
+}
+
+PIXEL_TARGET("ssse3")
+static void PackRGBSSSE3(const uint8_t* src, uint8_t* dst, int width) {
+    const __m128i mask = _mm_setr_epi8(PACK_RGB_MASK);
+    int x = 0;
+    // Each store writes 16 bytes for 12 useful ones; stop while the 4 spare
+    // bytes still land inside the row (the next store overwrites them)
+    for (; x + 6 <= width; x += 4) {
+        __m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + x * 4)), mask);
+        _mm_storeu_si128((__m128i*)(dst + x * 3), v);
+    }
+    ConvertRowScalar<PixelFormat::BGRX, PixelFormat::RGB>(src + x * 4, dst + x * 3, width - x);
+}
+
+PIXEL_TARGET("avx2")
+static void PackRGBAVX2(const uint8_t* src, uint8_t* dst, int width) {
+    // Per lane: 4 pixels -> 12 bytes; then gather the two 12-byte halves
+    const __m256i mask = _mm256_setr_epi8(PACK_RGB_MASK, PACK_RGB_MASK);
+    const __m256i compact = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+    int x = 0;
+    for (; x + 11 <= width; x += 8) {
+        __m256i v = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(src + x * 4)), mask);
+        v = _mm256_permutevar8x32_epi32(v, compact);
+        _mm256_storeu_si256((__m256i*)(dst + x * 3), v);
+    }
+    PackRGBSSSE3(src + x * 4, dst + x * 3, width - x);
+}
+
+// Brightness scale: widen to 16 bits, multiply, keep the high byte
+PIXEL_TARGET("ssse3")
+static void ScaleRowSSSE3(const uint8_t* src, uint8_t* dst, int width, int level) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i factor = _mm_set1_epi16((short)level);
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + x * 4));
+        __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(v, zero), factor), 8);
+        __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(v, zero), factor), 8);
+        _mm_storeu_si128((__m128i*)(dst + x * 4), _mm_or_si128(_mm_packus_epi16(lo, hi), alpha));
+    }
+    ScaleRowScalar(src + x * 4, dst + x * 4, width - x, level);
+}
+
+PIXEL_TARGET("avx2")
+static void ScaleRowAVX2(const uint8_t* src, uint8_t* dst, int width, int level) {
+    // Unpack and pack both work per 128-bit lane, so pixel order is kept
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i factor = _mm256_set1_epi16((short)level);
+    const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + x * 4));
+        __m256i lo = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(v, zero), factor), 8);
+        __m256i hi = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(v, zero), factor), 8);
+        _mm256_storeu_si256((__m256i*)(dst + x * 4), _mm256_or_si256(_mm256_packus_epi16(lo, hi), alpha));
+    }
+    ScaleRowSSSE3(src + x * 4, dst + x * 4, width - x, level);
+}
+
+// Zoom: broadcast each pixel and store it zoom times, one vector at a time.
+// Stores may run past a pixel's run into the next one's (rewritten next);
+// the last pixel is finished by the scalar loop so nothing lands past the
+// end of dst.
+PIXEL_TARGET("ssse3")
+static void ZoomRowSSSE3(const uint8_t* src, uint8_t* dst, int width, int zoom) {
+    if (zoom < 4) {
+        ZoomRowScalar(src, dst, width, zoom);
+        return;
+    }
+    const uint32_t* in = (const uint32_t*)src;
+    uint32_t* out = (uint32_t*)dst;
+    for (int x = 0; x + 1 < width; x++, out += zoom) {
+        __m128i v = _mm_set1_epi32((int)in[x]);
+        for (int k = 0; k < zoom; k += 4) _mm_storeu_si128((__m128i*)(out + k), v);
+    }
+    if (width > 0) ZoomRowScalar(src + (size_t)(width - 1) * 4, (uint8_t*)out, 1, zoom);
+}
+
+PIXEL_TARGET("avx2")
+static void ZoomRowAVX2(const uint8_t* src, uint8_t* dst, int width, int zoom) {
+    if (zoom < 8) {
+        ZoomRowSSSE3(src, dst, width, zoom);
+        return;
+    }
+    const uint32_t* in = (const uint32_t*)src;
+    uint32_t* out = (uint32_t*)dst;
+    for (int x = 0; x + 1 < width; x++, out += zoom) {
+        __m256i v = _mm256_set1_epi32((int)in[x]);
+        for (int k = 0; k < zoom; k += 8) _mm256_storeu_si256((__m256i*)(out + k), v);
+    }
+    if (width > 0) ZoomRowScalar(src + (size_t)(width - 1) * 4, (uint8_t*)out, 1, zoom);
+}
+
+static bool g_hasSSSE3 = false;
+static bool g_hasAVX2 = false;
+static PixelIsa g_isaLimit = PixelIsa::AVX2;
+
+static bool QueryCpu() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    g_hasSSSE3 = (info[2] & (1 << 9)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6) {
+        __cpuidex(info, 7, 0);
+        g_hasAVX2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    g_hasSSSE3 = __builtin_cpu_supports("ssse3");
+    g_hasAVX2 = __builtin_cpu_supports("avx2");
+#endif
+    return true;
+}
+
+// Called from worker threads too (ParallelFor); the static makes the first
+// query happen exactly once
+static void DetectCpu() {
+    static const bool detected = QueryCpu();
+    (void)detected;
+}
+
+static bool UseAVX2() { return g_hasAVX2 && g_isaLimit >= PixelIsa::AVX2; }
+static bool UseSSSE3() { return g_hasSSSE3 && g_isaLimit >= PixelIsa::SSSE3; }
+
+#endif // PIXELCONVERT_X86
+
+// ---------------------------------------------------------------------------
+// Dispatch
+
+template <PixelFormat Src>
+static RowConverter ScalarFor(PixelFormat dst) {
+    switch (dst) {
+        case PixelFormat::BGRA: return ConvertRowScalar<Src, PixelFormat::BGRA>;
+        case PixelFormat::BGRX: return ConvertRowScalar<Src, PixelFormat::BGRX>;
+        case PixelFormat::RGBA: return ConvertRowScalar<Src, PixelFormat::RGBA>;
+        case PixelFormat::RGB: return ConvertRowScalar<Src, PixelFormat::RGB>;
+        case PixelFormat::Gray8: return ConvertRowScalar<Src, PixelFormat::Gray8>;
+        case PixelFormat::RGB565: return ConvertRowScalar<Src, PixelFormat::RGB565>;
+        case PixelFormat::RGBAPremul: return ConvertRowScalar<Src, PixelFormat::RGBAPremul>;
+    }
+    return nullptr;
+}
+
+RowConverter GetScalarRowConverter(PixelFormat src, PixelFormat dst) {
+    if (src == PixelFormat::BGRA) return ScalarFor<PixelFormat::BGRA>(dst);
+    if (src == PixelFormat::BGRX) return ScalarFor<PixelFormat::BGRX>(dst);
+    return nullptr;
+}
+
+RowConverter GetRowConverter(PixelFormat src, PixelFormat dst) {
+#ifdef PIXELCONVERT_X86
+    DetectCpu();
+    bool opaque = src == PixelFormat::BGRX;
+    bool bgrSource = src == PixelFormat::BGRA || src == PixelFormat::BGRX;
+    if (bgrSource && dst == PixelFormat::RGBA) {
+        if (UseAVX2()) return opaque ? SwapRBAVX2<true> : SwapRBAVX2<false>;
+        if (UseSSSE3()) return opaque ? SwapRBSSSE3<true> : SwapRBSSSE3<false>;
+    }
+    // Dropping alpha makes both sources identical
+    if (bgrSource && dst == PixelFormat::RGB) {
+        if (UseAVX2()) return PackRGBAVX2;
+        if (UseSSSE3()) return PackRGBSSSE3;
+    }
+    // Premultiplying an opaque source changes nothing
+    if (opaque && dst == PixelFormat::RGBAPremul) {
+        return GetRowConverter(src, PixelFormat::RGBA);
+    }
+#endif
+    return GetScalarRowConverter(src, dst);
+}
+
+bool ConvertPixels(const uint8_t* src, int srcStride, PixelFormat srcFormat,
+                   uint8_t* dst, int dstStride, PixelFormat dstFormat,
+                   int width, int height) {
+    RowConverter convert = GetRowConverter(srcFormat, dstFormat);
+    if (!convert || !src || !dst || width <= 0 || height <= 0) return false;
+    for (int y = 0; y < height; y++) {
+        convert(src + (size_t)y * srcStride, dst + (size_t)y * dstStride, width);
+    }
+    return true;
+}
+
+RowScaler GetRowScaler() {
+#ifdef PIXELCONVERT_X86
+    DetectCpu();
+    if (UseAVX2()) return ScaleRowAVX2;
+    if (UseSSSE3()) return ScaleRowSSSE3;
+#endif
+    return ScaleRowScalar;
+}
+
+bool ScalePixels(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride,
+                 int width, int height, int level) {
+    if (!src || !dst || width <= 0 || height <= 0 || level < 0 || level > 256) return false;
+    RowScaler scale = GetRowScaler();
+    for (int y = 0; y < height; y++) {
+        scale(src + (size_t)y * srcStride, dst + (size_t)y * dstStride, width, level);
+    }
+    return true;
+}
+
+RowZoomer GetRowZoomer() {
+#ifdef PIXELCONVERT_X86
+    DetectCpu();
+    if (UseAVX2()) return ZoomRowAVX2;
+    if (UseSSSE3()) return ZoomRowSSSE3;
+#endif
+    return ZoomRowScalar;
+}
+
+const char* PixelConvertIsa() {
+#ifdef PIXELCONVERT_X86
+    DetectCpu();
+    if (UseAVX2()) return "avx2";
+    if (UseSSSE3()) return "ssse3";
+#endif
+    return "scalar";
+}
+
+PixelIsa LimitPixelIsa(PixelIsa limit) {
+#ifdef PIXELCONVERT_X86
+    PixelIsa previous = g_isaLimit;
+    g_isaLimit = limit;
+    return previous;
+#else
+    (void)limit;
+    return PixelIsa::Scalar;
+#endif
+}
+
+} // namespace ScreenCapture
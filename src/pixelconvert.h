@@ -0,0 +1,123 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace ScreenCapture {
+
+// Packed pixel layouts, byte order in memory
+enum class PixelFormat {
+    BGRA,       // GDI 32bpp with meaningful alpha
+    BGRX,       // GDI 32bpp, 4th byte ignored (screen captures)
+    RGBA,
+    RGB,
+    Gray8,      // BT.601 luma
+    RGB565,     // 16-bit little-endian
+    RGBAPremul  // RGBA with color scaled by alpha
+};
+
+template <PixelFormat F> struct PixelTraits;
+template <> struct PixelTraits<PixelFormat::BGRA>       { static const int bytes = 4; };
+template <> struct PixelTraits<PixelFormat::BGRX>       { static const int bytes = 4; };
+template <> struct PixelTraits<PixelFormat::RGBA>       { static const int bytes = 4; };
+template <> struct PixelTraits<PixelFormat::RGB>        { static const int bytes = 3; };
+template <> struct PixelTraits<PixelFormat::Gray8>      { static const int bytes = 1; };
+template <> struct PixelTraits<PixelFormat::RGB565>     { static const int bytes = 2; };
+template <> struct PixelTraits<PixelFormat::RGBAPremul> { static const int bytes = 4; };
+
+int BytesPerPixel(PixelFormat format);
+
+// Portable reference kernel, specialized at compile time for each pair:
+// every format test below is resolved by the compiler, leaving a straight
+// per-pixel loop. Only BGRA/BGRX sources are supported.
+template <PixelFormat Src, PixelFormat Dst>
+inline void ConvertRowScalar(const uint8_t* src, uint8_t* dst, int width) {
+    static_assert(Src == PixelFormat::BGRA || Src == PixelFormat::BGRX, "unsupported source format");
+    for (int x = 0; x < width; x++, src += 4, dst += PixelTraits<Dst>::bytes) {
+        uint32_t b = src[0], g = src[1], r = src[2];
+        uint32_t a = (Src == PixelFormat::BGRX) ? 255u : src[3];
+        if (Dst == PixelFormat::BGRA || Dst == PixelFormat::BGRX) {
+            dst[0] = (uint8_t)b; dst[1] = (uint8_t)g; dst[2] = (uint8_t)r; dst[3] = (uint8_t)a;
+        } else if (Dst == PixelFormat::RGBA) {
+            dst[0] = (uint8_t)r; dst[1] = (uint8_t)g; dst[2] = (uint8_t)b; dst[3] = (uint8_t)a;
+        } else if (Dst == PixelFormat::RGB) {
+            dst[0] = (uint8_t)r; dst[1] = (uint8_t)g; dst[2] = (uint8_t)b;
+        } else if (Dst == PixelFormat::Gray8) {
+            dst[0] = (uint8_t)((77 * r + 150 * g + 29 * b + 128) >> 8);
+        } else if (Dst == PixelFormat::RGB565) {
+            uint16_t v = (uint16_t)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+            dst[0] = (uint8_t)v; dst[1] = (uint8_t)(v >> 8);
+        } else if (Dst == PixelFormat::RGBAPremul) {
+            dst[0] = (uint8_t)((r * a + 127) / 255);
+            dst[1] = (uint8_t)((g * a + 127) / 255);
+            dst[2] = (uint8_t)((b * a + 127) / 255);
+            dst[3] = (uint8_t)a;
+        }
+    }
+}
+
+// Converts one row of 'width' pixels
+typedef void (*RowConverter)(const uint8_t* src, uint8_t* dst, int width);
+
+// Best kernel for this CPU (AVX2 / SSSE3 shuffles where they exist, the
+// scalar specialization otherwise). Resolve once, then call per row to
+// stream an image. Returns NULL for unsupported pairs.
+RowConverter GetRowConverter(PixelFormat src, PixelFormat dst);
+
+// Same, without SIMD (reference / comparison)
+RowConverter GetScalarRowConverter(PixelFormat src, PixelFormat dst);
+
+// Whole image with independent strides (either may be padded)
+bool ConvertPixels(const uint8_t* src, int srcStride, PixelFormat srcFormat,
+                   uint8_t* dst, int dstStride, PixelFormat dstFormat,
+                   int width, int height);
+
+// Scales B, G and R by level / 256 (0..256) and sets alpha to 255: the
+// dimmed backdrop behind a selection. Bit-exact across all kernels.
+typedef void (*RowScaler)(const uint8_t* src, uint8_t* dst, int width, int level);
+
+inline void ScaleRowScalar(const uint8_t* src, uint8_t* dst, int width, int level) {
+    for (int x = 0; x < width; x++, src += 4, dst += 4) {
+        dst[0] = (uint8_t)((src[0] * level) >> 8);
+        dst[1] = (uint8_t)((src[1] * level) >> 8);
+        dst[2] = (uint8_t)((src[2] * level) >> 8);
+        dst[3] = 255;
+    }
+}
+
+RowScaler GetRowScaler();
+
+bool ScalePixels(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride,
+                 int width, int height, int level);
+
+// Nearest-neighbour horizontal zoom: each of 'width' source pixels is
+// repeated 'zoom' times (1..64), so dst receives width * zoom pixels (the
+// magnifier loupe; vertical zoom is repeating the row).
+typedef void (*RowZoomer)(const uint8_t* src, uint8_t* dst, int width, int zoom);
+
+inline void ZoomRowScalar(const uint8_t* src, uint8_t* dst, int width, int zoom) {
+    const uint32_t* in = (const uint32_t*)src;
+    uint32_t* out = (uint32_t*)dst;
+    for (int x = 0; x < width; x++) {
+        for (int k = 0; k < zoom; k++) *out++ = in[x];
+    }
+}
+
+RowZoomer GetRowZoomer();
+
+// "avx2", "ssse3" or "scalar"
+const char* PixelConvertIsa();
+
+// Kernel sets, in order; the Get* functions pick the best one the CPU has
+// and the limit allows
+enum class PixelIsa {
+    Scalar,
+    SSSE3,
+    AVX2
+};
+
+// Cap the kernels handed out from now on (checks and benchmarks compare
+// every ISA on one machine). Returns the previous limit. Not meant to be
+// changed while other threads resolve kernels.
+PixelIsa LimitPixelIsa(PixelIsa limit);
+
+} // namespace ScreenCapture
@@ -1,6 +1,9 @@
 #include "preview.h"
+#include "imagescale.h"
+#include "memorygovernor.h"
 #include <shellapi.h>
 #include <stdio.h>
+#include <string.h>
 
 namespace ScreenCapture {
 
@@ -8,13 +11,11 @@ const wchar_t* PreviewWindow::WINDOW_CLASS = L"ScreenCapturePreview";
 bool PreviewWindow::s_classRegistered = false;
 
 PreviewWindow::PreviewWindow() 
-    : m_hwnd(NULL), m_hBitmap(NULL), m_imageWidth(0), m_imageHeight(0) {
+    : m_hwnd(NULL), m_imageWidth(0), m_imageHeight(0) {
 }
 
 PreviewWindow::~PreviewWindow() {
-    if (m_hBitmap) {
-        DeleteObject(m_hBitmap);
-    }
+    // m_frame and m_scaled return to the pool when the last reference drops
 }
 
 LRESULT CALLBACK PreviewWindow::WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
@@ -68,7 +69,7 @@ void PreviewWindow::OnPaint(HWND hwnd) {
     PAINTSTRUCT ps;
     HDC hdc = BeginPaint(hwnd, &ps);
     
-    if (m_hBitmap) {
+    if (m_frame || m_scaled) {
         RECT clientRect;
         GetClientRect(hwnd, &clientRect);
         int clientWidth = clientRect.right;
@@ -81,6 +82,11 @@ void PreviewWindow::OnPaint(HWND hwnd) {
         
         int displayWidth = (int)(m_imageWidth * scale);
         int displayHeight = (int)(m_imageHeight * scale);
+        if (!m_frame) {
+            // Full frame already released: show the fitted copy as is
+            displayWidth = m_scaled->Width();
+            displayHeight = m_scaled->Height();
+        }
         int offsetX = (clientWidth - displayWidth) / 2;
         int offsetY = (clientHeight - displayHeight) / 2;
         
@@ -89,19 +95,46 @@ void PreviewWindow::OnPaint(HWND hwnd) {
         FillRect(hdc, &clientRect, hBrush);
         DeleteObject(hBrush);
         
-        // Draw image with high-quality scaling
-        HDC hdcMem = CreateCompatibleDC(hdc);
-        HBITMAP hOldBitmap = (HBITMAP)SelectObject(hdcMem, m_hBitmap);
-        
-        // Use HALFTONE for better quality, SetBrushOrgEx for proper alignment
-        SetStretchBltMode(hdc, HALFTONE);
-        SetBrushOrgEx(hdc, 0, 0, NULL);
+        // Downscale once per window size (box filter on the task scheduler)
+        // and blit that 1:1, instead of a HALFTONE stretch of the full
+        // frame on every repaint
+        const FrameRef* source = m_frame ? &m_frame : &m_scaled;
+        if (m_frame && displayWidth > 0 && displayHeight > 0 &&
+            displayWidth <= m_imageWidth && displayHeight <= m_imageHeight &&
+            (displayWidth != m_imageWidth || displayHeight != m_imageHeight)) {
+            if (!m_scaled || m_scaled->Width() != displayWidth || m_scaled->Height() != displayHeight) {
+                m_scaled = FramePool::Instance().Acquire(displayWidth, displayHeight);
+                if (m_scaled) {
+                    DownscaleBox(m_frame->Bits(), m_imageWidth, m_imageHeight, m_frame->Stride(),
+                                 m_scaled->Bits(), displayWidth, displayHeight, m_scaled->Stride());
+                }
+            }
+            if (m_scaled) source = &m_scaled;
+        }
         
-        StretchBlt(hdc, offsetX, offsetY, displayWidth, displayHeight,
-                   hdcMem, 0, 0, m_imageWidth, m_imageHeight, SRCCOPY);
+        BITMAPINFO bmi = {};
+        bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bmi.bmiHeader.biWidth = (*source)->Stride() / 4;
+        bmi.bmiHeader.biHeight = -(*source)->Height(); // Top-down
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
         
-        SelectObject(hdcMem, hOldBitmap);
-        DeleteDC(hdcMem);
+        // A crop view is drawn from its row starts (whole rows of the
+        // parent) at its column, so GDI reads only rows the parent owns
+        const uint8_t* rows = (*source)->Bits() - (size_t)(*source)->Left() * 4;
+        if (source == &m_scaled) {
+            SetDIBitsToDevice(hdc, offsetX, offsetY, displayWidth, displayHeight,
+                              0, 0, 0, displayHeight, rows, &bmi, DIB_RGB_COLORS);
+        } else {
+            // 1:1 or upscaling (small captures): HALFTONE, SetBrushOrgEx for proper alignment
+            SetStretchBltMode(hdc, HALFTONE);
+            SetBrushOrgEx(hdc, 0, 0, NULL);
+            
+            StretchDIBits(hdc, offsetX, offsetY, displayWidth, displayHeight,
+                          m_frame->Left(), 0, m_imageWidth, m_imageHeight,
+                          rows, &bmi, DIB_RGB_COLORS, SRCCOPY);
+        }
         
         // Draw filename at bottom (cache text to avoid string operations)
         SetBkMode(hdc, TRANSPARENT);
@@ -127,8 +160,8 @@ void PreviewWindow::OnClose(HWND hwnd) {
     delete this;
 }
 
-void PreviewWindow::Show(HBITMAP hBitmap, const std::wstring& filename) {
-    if (!hBitmap) return;
+void PreviewWindow::Show(const FrameRef& frame, const std::wstring& filename, bool shareFrame) {
+    if (!frame) return;
     
     // Register window class if needed
     if (!s_classRegistered) {
@@ -146,10 +179,8 @@ void PreviewWindow::Show(HBITMAP hBitmap, const std::wstring& filename) {
     }
     
     // Get image dimensions
-    BITMAP bmp;
-    GetObject(hBitmap, sizeof(BITMAP), &bmp);
-    m_imageWidth = bmp.bmWidth;
-    m_imageHeight = bmp.bmHeight;
+    m_imageWidth = frame->Width();
+    m_imageHeight = frame->Height();
     m_filename = filename;
     
     // DEBUG: Write to log file
@@ -161,9 +192,6 @@ void PreviewWindow::Show(HBITMAP hBitmap, const std::wstring& filename) {
         fclose(f);
     }
     
-    // Fast bitmap clone using CopyImage
-    m_hBitmap = (HBITMAP)CopyImage(hBitmap, IMAGE_BITMAP, 0, 0, LR_CREATEDIBSECTION);
-    
     // Calculate window size (max 80% of screen)
     int screenWidth = GetSystemMetrics(SM_CXSCREEN);
     int screenHeight = GetSystemMetrics(SM_CYSCREEN);
@@ -182,6 +210,30 @@ void PreviewWindow::Show(HBITMAP hBitmap, const std::wstring& filename) {
         windowHeight = (int)(windowHeight * scale);
     }
     
+    // Share the captured frame; the saver only reads it, so no clone is
+    // needed. When the window is smaller than the capture, keep only the
+    // fitted copy: a full 8K frame stays alive no longer than its encode.
+    m_frame = frame;
+    if (windowWidth < m_imageWidth || windowHeight < m_imageHeight) {
+        m_scaled = FramePool::Instance().Acquire(windowWidth, windowHeight);
+        if (m_scaled) {
+            DownscaleBox(frame->Bits(), m_imageWidth, m_imageHeight, frame->Stride(),
+                         m_scaled->Bits(), windowWidth, windowHeight, m_scaled->Stride());
+            m_frame.reset();
+        }
+    } else if (!shareFrame) {
+        // A frame the size of the capture rather than of its parent block
+        FrameRef copy = FramePool::Instance().Acquire(m_imageWidth, m_imageHeight);
+        if (copy) {
+            for (int row = 0; row < m_imageHeight; row++) {
+                memcpy(copy->Row(row), frame->Row(row), (size_t)m_imageWidth * 4);
+            }
+            m_frame = copy;
+        }
+    }
+    const FrameRef& held = m_frame ? m_frame : m_scaled;
+    m_charge = MemoryGovernor::Instance().Charge(MemoryStage::Preview, (size_t)held->Stride() * held->Height());
+    
     // Center window
     int x = (screenWidth - windowWidth) / 2;
     int y = (screenHeight - windowHeight) / 2;
@@ -1,6 +1,8 @@
 #pragma once
 #include <windows.h>
 #include <string>
+#include "framepool.h"
+#include "memorygovernor.h"
 
 namespace ScreenCapture {
 
@@ -9,8 +11,10 @@ public:
     PreviewWindow();
     ~PreviewWindow();
     
-    // Show preview of captured image
-    void Show(HBITMAP hBitmap, const std::wstring& filename);
+    // Show preview of captured image (keeps a reference, no pixel copy).
+    // shareFrame = false: never keep 'frame' itself, only a fitted or full
+    // copy, so its block (e.g. a warm capture slot) can be released.
+    void Show(const FrameRef& frame, const std::wstring& filename, bool shareFrame = true);
     
 private:
     static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
@@ -18,7 +22,9 @@ private:
     void OnClose(HWND hwnd);
     
     HWND m_hwnd;
-    HBITMAP m_hBitmap;
+    FrameRef m_frame;
+    FrameRef m_scaled;  // m_frame fitted to the client area, rebuilt on resize
+    MemoryCharge m_charge;  // Whichever of the two is held
     std::wstring m_filename;
     int m_imageWidth;
     int m_imageHeight;
@@ -0,0 +1,167 @@
+#include "recorder.h"
+#include "recording.h"
+#include "config.h"
+#include "utils.h"
+#include <mmsystem.h>
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+
+#pragma comment(lib, "winmm.lib")
+
+namespace ScreenCapture {
+
+static std::thread g_recordThread;
+static std::atomic<bool> g_recordStop(false);
+static std::atomic<bool> g_recordRunning(false);
+
+// Debug logging helper
+static void DebugLog(const wchar_t* format, ...) {
+    FILE* f = _wfopen(L"debug_record.txt", L"a");
+    if (f) {
+        SYSTEMTIME st;
+        GetLocalTime(&st);
+        fwprintf(f, L"[%02d:%02d:%02d.%03d] ", st.wHour, st.wMinute, st.wSecond, st.wMilliseconds);
+        
+        va_list args;
+        va_start(args, format);
+        vfwprintf(f, format, args);
+        va_end(args);
+        
+        fwprintf(f, L"\n");
+        fclose(f);
+    }
+}
+
+static double ElapsedMs(const LARGE_INTEGER& start, const LARGE_INTEGER& freq) {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return (double)(now.QuadPart - start.QuadPart) * 1000.0 / (double)freq.QuadPart;
+}
+
+static void RecordThread(Config config, RECT area, std::wstring filename) {
+    int width = area.right - area.left;
+    int height = area.bottom - area.top;
+    DebugLog(L"=== Recording start: %dx%d @ %d fps, tile=%d -> %s ===",
+        width, height, config.recordFps, config.recordTileSize, filename.c_str());
+    
+    RecordingWriter writer;
+    if (!writer.Open(_wfopen(filename.c_str(), L"wb"), width, height, config.recordTileSize)) {
+        DebugLog(L"  ERROR: Failed to open recording file");
+        g_recordRunning = false;
+        return;
+    }
+    
+    timeBeginPeriod(1);
+    HDC hdcScreen = GetDC(NULL);
+    HDC hdcMem = hdcScreen ? CreateCompatibleDC(hdcScreen) : NULL;
+    FrameRef frame = FramePool::Instance().Acquire(width, height);
+    HBITMAP hBitmap = hdcMem ? CreateFrameDIB(hdcScreen, frame) : NULL;
+    HBITMAP hOldBitmap = hBitmap ? (HBITMAP)SelectObject(hdcMem, hBitmap) : NULL;
+    
+    LARGE_INTEGER freq, start;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+    
+    const double periodMs = 1000.0 / config.recordFps;
+    int droppedLate = 0;
+    double captureMs = 0, diffMs = 0, compressMs = 0, maxFrameMs = 0;
+    
+    for (long long tick = 0; hBitmap && !g_recordStop; tick++) {
+        // Fixed schedule from the start: no accumulated drift
+        double deadline = tick * periodMs;
+        for (;;) {
+            double remaining = deadline - ElapsedMs(start, freq);
+            if (remaining <= 0 || g_recordStop) break;
+            Sleep(remaining > 2.0 ? (DWORD)(remaining - 1.0) : 0);
+        }
+        
+        double now = ElapsedMs(start, freq);
+        long long behind = (long long)((now - deadline) / periodMs);
+        if (behind > 0) {
+            droppedLate += (int)behind;
+            tick += behind;
+        }
+        
+        BitBlt(hdcMem, 0, 0, width, height, hdcScreen, area.left, area.top, SRCCOPY | CAPTUREBLT);
+        GdiFlush();
+        double grabbed = ElapsedMs(start, freq);
+        
+        if (!writer.AddFrame(frame->Bits(), frame->Stride(), (uint64_t)(now * 1000.0))) {
+            DebugLog(L"  ERROR: Write failed, stopping");
+            break;
+        }
+        
+        RecordingStats stats = writer.GetStats();
+        captureMs += grabbed - now;
+        diffMs += stats.lastDiffMs;
+        compressMs += stats.lastCompressMs;
+        double frameMs = ElapsedMs(start, freq) - now;
+        if (frameMs > maxFrameMs) maxFrameMs = frameMs;
+    }
+    
+    double totalMs = ElapsedMs(start, freq);
+    
+    if (hOldBitmap) SelectObject(hdcMem, hOldBitmap);
+    if (hBitmap) DeleteObject(hBitmap);
+    if (hdcMem) DeleteDC(hdcMem);
+    if (hdcScreen) ReleaseDC(NULL, hdcScreen);
+    timeEndPeriod(1);
+    
+    RecordingStats stats = writer.GetStats();
+    bool closed = writer.Close();
+    
+    double frames = stats.frames ? (double)stats.frames : 1.0;
+    uint64_t tiles = stats.tilesChanged + stats.tilesReused;
+    DebugLog(L"=== Recording end: %llu frames in %.0fms, dropped late=%d, closed=%d ===",
+        stats.frames, totalMs, droppedLate, closed);
+    DebugLog(L"  Avg per frame: capture=%.2fms diff=%.2fms compress=%.2fms (max total %.1fms)",
+        captureMs / frames, diffMs / frames, compressMs / frames, maxFrameMs);
+    DebugLog(L"  Tiles changed %llu / %llu (%.1f%%), file %lluKB",
+        stats.tilesChanged, tiles, tiles ? stats.tilesChanged * 100.0 / tiles : 0.0, stats.bytesWritten / 1024);
+    
+    g_recordRunning = false;
+}
+
+bool StartRecording() {
+    if (g_recordRunning) {
+        DebugLog(L"StartRecording: already running");
+        return false;
+    }
+    if (g_recordThread.joinable()) {
+        g_recordThread.join();
+    }
+    
+    std::wstring dir = GetSaveDirectory();
+    if (!EnsureDirectoryExists(dir)) {
+        DebugLog(L"StartRecording: ERROR: Failed to create directory");
+        return false;
+    }
+    
+    g_recordStop = false;
+    g_recordRunning = true;
+    g_recordThread = std::thread(RecordThread, GetConfig(), GetVirtualScreenRect(),
+                                 dir + L"\\Recording_" + GetTimestamp() + L".scrv");
+    return true;
+}
+
+void StopRecording() {
+    g_recordStop = true;
+    if (g_recordThread.joinable()) {
+        g_recordThread.join();
+    }
+}
+
+void ToggleRecording() {
+    if (g_recordRunning) {
+        StopRecording();
+    } else {
+        StartRecording();
+    }
+}
+
+bool IsRecording() {
+    return g_recordRunning;
+}
+
+} // namespace ScreenCapture
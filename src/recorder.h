@@ -0,0 +1,20 @@
+#pragma once
+#include <windows.h>
+
+namespace ScreenCapture {
+
+// Lossless recording of the virtual screen into Recording_<ts>.scrv in the
+// save directory (see recording.h for the format). Runs on its own thread
+// at the configured rate until StopRecording() is called.
+// Returns false if a recording is already running.
+bool StartRecording();
+
+// Stop a running recording, write its index and wait for the file to close
+void StopRecording();
+
+// Start if idle, otherwise stop (hotkey / tray toggle)
+void ToggleRecording();
+
+bool IsRecording();
+
+} // namespace ScreenCapture
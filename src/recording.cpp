@@ -0,0 +1,388 @@
+#include "recording.h"
+#include "encoder.h"
+#include "inflate.h"
+#include "taskscheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace ScreenCapture {
+
+static const uint16_t RECORDING_VERSION = 1;
+
+static void PutU16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void PutU32(uint8_t* p, uint32_t v) { for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+static void PutU64(uint8_t* p, uint64_t v) { for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+static uint16_t GetU16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t GetU32(const uint8_t* p) { uint32_t v = 0; for (int i = 3; i >= 0; i--) v = (v << 8) | p[i]; return v; }
+static uint64_t GetU64(const uint8_t* p) { uint64_t v = 0; for (int i = 7; i >= 0; i--) v = (v << 8) | p[i]; return v; }
+
+static double MsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// ---------------------------------------------------------------------------
+// Writer
+
+RecordingWriter::RecordingWriter()
+    : m_file(nullptr), m_offset(0), m_width(0), m_height(0), m_tileSize(0)
+    , m_tilesX(0), m_tilesY(0), m_hasPrev(false), m_stats() {
+}
+
+RecordingWriter::~RecordingWriter() {
+    Close();
+}
+
+bool RecordingWriter::Write(const void* data, size_t size) {
+    if (fwrite(data, 1, size, m_file) != size) return false;
+    m_offset += size;
+    m_stats.bytesWritten += size;
+    return true;
+}
+
+bool RecordingWriter::Truncate(uint64_t offset) {
+    if (fflush(m_file) != 0) return false;
+#ifdef _WIN32
+    bool ok = _chsize_s(_fileno(m_file), (long long)offset) == 0 && _fseeki64(m_file, (long long)offset, SEEK_SET) == 0;
+#else
+    bool ok = ftruncate(fileno(m_file), (off_t)offset) == 0 && fseeko(m_file, (off_t)offset, SEEK_SET) == 0;
+#endif
+    if (ok) {
+        m_stats.bytesWritten -= m_offset - offset;
+        m_offset = offset;
+    }
+    return ok;
+}
+
+bool RecordingWriter::Open(FILE* file, int width, int height, int tileSize) {
+    if (!file || width <= 0 || height <= 0 || tileSize < 8 || tileSize > 1024) {
+        if (file) fclose(file);
+        return false;
+    }
+
+    m_file = file;
+    m_offset = 0;
+    m_width = width;
+    m_height = height;
+    m_tileSize = tileSize;
+    m_tilesX = (width + tileSize - 1) / tileSize;
+    m_tilesY = (height + tileSize - 1) / tileSize;
+    m_prev = FramePool::Instance().Acquire(width, height);
+    m_hasPrev = false;
+    m_table.assign((size_t)m_tilesX * m_tilesY, TileRef());
+    m_snapshots.clear();
+    m_frameOffsets.clear();
+    m_frameTimes.clear();
+    m_stats = RecordingStats();
+    if (!m_prev) {
+        fclose(m_file);
+        m_file = nullptr;
+        return false;
+    }
+
+    uint8_t header[20];
+    memcpy(header, "SCRV", 4);
+    PutU16(header + 4, RECORDING_VERSION);
+    PutU16(header + 6, (uint16_t)tileSize);
+    PutU32(header + 8, (uint32_t)width);
+    PutU32(header + 12, (uint32_t)height);
+    PutU32(header + 16, 0);
+    if (!Write(header, sizeof(header))) return false;
+
+    return true;
+}
+
+void RecordingWriter::CompressTile(TileJob& job) {
+    int tx = job.tile % m_tilesX;
+    int ty = job.tile / m_tilesX;
+    int x0 = tx * m_tileSize;
+    int y0 = ty * m_tileSize;
+    int w = (x0 + m_tileSize > m_width) ? m_width - x0 : m_tileSize;
+    int h = (y0 + m_tileSize > m_height) ? m_height - y0 : m_tileSize;
+    int rowBytes = w * 4;
+
+    // Left-neighbour delta per channel: flat UI areas become runs of zeros
+    thread_local std::vector<uint8_t> buffer;
+    buffer.resize((size_t)rowBytes * h);
+    for (int y = 0; y < h; y++) {
+        const uint8_t* src = m_prev->Row(y0 + y) + x0 * 4;
+        uint8_t* dst = buffer.data() + (size_t)y * rowBytes;
+        memcpy(dst, src, 4);
+        for (int i = 4; i < rowBytes; i++) dst[i] = (uint8_t)(src[i] - src[i - 4]);
+    }
+
+    job.data = CompressZlib(buffer.data(), (int)buffer.size(), COMPRESSION_LEVEL, &job.size);
+}
+
+bool RecordingWriter::AddFrame(const uint8_t* bgra, int stride, uint64_t timestampUs) {
+    if (!m_file) return false;
+
+    // Diff pass, row-major so both frames stream through the cache: whole
+    // rows are compared first and only differing rows are split per tile.
+    // Dirty tiles are then copied into m_prev, which is the (stable) source
+    // for compression.
+    auto diffStart = std::chrono::steady_clock::now();
+    m_jobs.clear();
+    std::vector<uint8_t> dirty(m_tilesX);
+    for (int ty = 0; ty < m_tilesY; ty++) {
+        int y0 = ty * m_tileSize;
+        int h = (y0 + m_tileSize > m_height) ? m_height - y0 : m_tileSize;
+        std::fill(dirty.begin(), dirty.end(), (uint8_t)!m_hasPrev);
+        for (int y = 0; y < h && m_hasPrev; y++) {
+            const uint8_t* cur = bgra + (size_t)(y0 + y) * stride;
+            const uint8_t* prev = m_prev->Row(y0 + y);
+            if (memcmp(cur, prev, (size_t)m_width * 4) == 0) continue;
+            for (int tx = 0; tx < m_tilesX; tx++) {
+                if (dirty[tx]) continue;
+                int x0 = tx * m_tileSize;
+                int rowBytes = ((x0 + m_tileSize > m_width) ? m_width - x0 : m_tileSize) * 4;
+                dirty[tx] = memcmp(cur + x0 * 4, prev + x0 * 4, rowBytes) != 0;
+            }
+        }
+
+        for (int tx = 0; tx < m_tilesX; tx++) {
+            if (!dirty[tx]) continue;
+            int x0 = tx * m_tileSize;
+            int rowBytes = ((x0 + m_tileSize > m_width) ? m_width - x0 : m_tileSize) * 4;
+            for (int y = 0; y < h; y++) {
+                memcpy(m_prev->Row(y0 + y) + x0 * 4, bgra + (size_t)(y0 + y) * stride + x0 * 4, rowBytes);
+            }
+            m_jobs.push_back({ ty * m_tilesX + tx, nullptr, 0 });
+        }
+    }
+    m_hasPrev = true;
+    m_stats.lastDiffMs = MsSince(diffStart);
+
+    // Compress dirty tiles on the shared task scheduler (this thread helps)
+    auto compressStart = std::chrono::steady_clock::now();
+    ParallelFor(0, (int)m_jobs.size(), 1, [this](int begin, int end) {
+        for (int i = begin; i < end; i++) CompressTile(m_jobs[i]);
+    });
+    m_stats.lastCompressMs = MsSince(compressStart);
+
+    // Nothing is written or recorded unless the whole frame is: the file
+    // stays readable up to the previous frame, and m_prev no longer
+    // matches the table, so the next frame (if any) is written whole
+    bool ok = true;
+    for (const TileJob& job : m_jobs) ok = ok && job.data;
+
+    uint64_t frameStart = m_offset;
+    uint32_t frameIndex = (uint32_t)m_frameOffsets.size();
+    if (ok) {
+        uint8_t header[20];
+        memcpy(header, "FRAM", 4);
+        PutU32(header + 4, frameIndex);
+        PutU64(header + 8, timestampUs);
+        PutU32(header + 16, (uint32_t)m_jobs.size());
+        ok = Write(header, sizeof(header));
+    }
+    std::vector<TileRef> written;
+    written.reserve(m_jobs.size());
+    for (TileJob& job : m_jobs) {
+        if (ok) {
+            uint8_t tileHeader[8];
+            PutU32(tileHeader, (uint32_t)job.tile);
+            PutU32(tileHeader + 4, (uint32_t)job.size);
+            ok = Write(tileHeader, sizeof(tileHeader));
+            written.push_back({ m_offset, (uint32_t)job.size });
+            ok = ok && Write(job.data, job.size);
+        }
+        FreeEncodedImage(job.data);
+    }
+    if (!ok) {
+        m_hasPrev = false;
+        Truncate(frameStart);
+        return false;
+    }
+
+    m_frameOffsets.push_back(frameStart);
+    m_frameTimes.push_back(timestampUs);
+    for (size_t i = 0; i < m_jobs.size(); i++) m_table[m_jobs[i].tile] = written[i];
+
+    if (frameIndex % SNAPSHOT_INTERVAL == 0) {
+        m_snapshots.insert(m_snapshots.end(), m_table.begin(), m_table.end());
+    }
+
+    m_stats.frames++;
+    m_stats.tilesChanged += m_jobs.size();
+    m_stats.tilesReused += m_table.size() - m_jobs.size();
+    return ok;
+}
+
+bool RecordingWriter::Close() {
+    if (!m_file) return false;
+
+    uint64_t indexOffset = m_offset;
+    uint8_t header[16];
+    memcpy(header, "INDX", 4);
+    PutU32(header + 4, (uint32_t)m_frameOffsets.size());
+    PutU32(header + 8, SNAPSHOT_INTERVAL);
+    PutU32(header + 12, (uint32_t)m_table.size());
+    bool ok = Write(header, sizeof(header));
+
+    for (size_t i = 0; ok && i < m_frameOffsets.size(); i++) {
+        uint8_t entry[16];
+        PutU64(entry, m_frameOffsets[i]);
+        PutU64(entry + 8, m_frameTimes[i]);
+        ok = Write(entry, sizeof(entry));
+    }
+    for (size_t i = 0; ok && i < m_snapshots.size(); i++) {
+        uint8_t entry[12];
+        PutU64(entry, m_snapshots[i].offset);
+        PutU32(entry + 8, m_snapshots[i].size);
+        ok = Write(entry, sizeof(entry));
+    }
+
+    uint8_t trailer[12];
+    PutU64(trailer, indexOffset);
+    memcpy(trailer + 8, "SCRE", 4);
+    ok = ok && Write(trailer, sizeof(trailer));
+
+    ok = (fclose(m_file) == 0) && ok;
+    m_file = nullptr;
+    m_prev = nullptr;
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// Reader
+
+RecordingReader::RecordingReader()
+    : m_file(nullptr), m_width(0), m_height(0), m_tileSize(0)
+    , m_tilesX(0), m_tilesY(0), m_interval(0) {
+}
+
+RecordingReader::~RecordingReader() {
+    Close();
+}
+
+void RecordingReader::Close() {
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+bool RecordingReader::Seek(uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(m_file, (long long)offset, SEEK_SET) == 0;
+#else
+    return fseeko(m_file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+bool RecordingReader::Open(FILE* file) {
+    Close();
+    m_file = file;
+    if (!m_file) return false;
+
+    uint8_t header[20];
+    if (fread(header, 1, sizeof(header), m_file) != sizeof(header) || memcmp(header, "SCRV", 4) != 0) return false;
+    if (GetU16(header + 4) != RECORDING_VERSION) return false;
+    m_tileSize = GetU16(header + 6);
+    m_width = (int)GetU32(header + 8);
+    m_height = (int)GetU32(header + 12);
+    if (m_tileSize <= 0 || m_width <= 0 || m_height <= 0) return false;
+    m_tilesX = (m_width + m_tileSize - 1) / m_tileSize;
+    m_tilesY = (m_height + m_tileSize - 1) / m_tileSize;
+
+    // Trailer -> index
+    uint8_t trailer[12];
+#ifdef _WIN32
+    if (_fseeki64(m_file, -12, SEEK_END) != 0) return false;
+#else
+    if (fseeko(m_file, -12, SEEK_END) != 0) return false;
+#endif
+    if (fread(trailer, 1, sizeof(trailer), m_file) != sizeof(trailer) || memcmp(trailer + 8, "SCRE", 4) != 0) {
+        return false;  // Recording was not closed cleanly
+    }
+    if (!Seek(GetU64(trailer))) return false;
+
+    uint8_t index[16];
+    if (fread(index, 1, sizeof(index), m_file) != sizeof(index) || memcmp(index, "INDX", 4) != 0) return false;
+    uint32_t frameCount = GetU32(index + 4);
+    m_interval = GetU32(index + 8);
+    uint32_t tileCount = GetU32(index + 12);
+    if (m_interval == 0 || tileCount != (uint32_t)(m_tilesX * m_tilesY)) return false;
+
+    std::vector<uint8_t> entries((size_t)frameCount * 16);
+    if (fread(entries.data(), 1, entries.size(), m_file) != entries.size()) return false;
+    m_frameOffsets.resize(frameCount);
+    m_frameTimes.resize(frameCount);
+    for (uint32_t i = 0; i < frameCount; i++) {
+        m_frameOffsets[i] = GetU64(&entries[i * 16]);
+        m_frameTimes[i] = GetU64(&entries[i * 16 + 8]);
+    }
+
+    size_t snapshotCount = (frameCount + m_interval - 1) / m_interval;
+    entries.resize(snapshotCount * tileCount * 12);
+    if (fread(entries.data(), 1, entries.size(), m_file) != entries.size()) return false;
+    m_snapshots.resize(snapshotCount * tileCount);
+    for (size_t i = 0; i < m_snapshots.size(); i++) {
+        m_snapshots[i].offset = GetU64(&entries[i * 12]);
+        m_snapshots[i].size = GetU32(&entries[i * 12 + 8]);
+    }
+    return true;
+}
+
+bool RecordingReader::DecodeFrame(int index, uint8_t* bgra, int stride) {
+    if (!m_file || index < 0 || index >= FrameCount()) return false;
+
+    // Start from the nearest snapshot and replay the frame headers after it
+    size_t tileCount = (size_t)m_tilesX * m_tilesY;
+    uint32_t snapshot = (uint32_t)index / m_interval;
+    std::vector<TileRef> table(m_snapshots.begin() + snapshot * tileCount,
+                               m_snapshots.begin() + (snapshot + 1) * tileCount);
+
+    for (int f = (int)(snapshot * m_interval) + 1; f <= index; f++) {
+        uint64_t pos = m_frameOffsets[f];
+        uint8_t header[20];
+        if (!Seek(pos) || fread(header, 1, sizeof(header), m_file) != sizeof(header)) return false;
+        if (memcmp(header, "FRAM", 4) != 0) return false;
+        pos += sizeof(header);
+
+        uint32_t changed = GetU32(header + 16);
+        for (uint32_t i = 0; i < changed; i++) {
+            uint8_t tileHeader[8];
+            if (fread(tileHeader, 1, sizeof(tileHeader), m_file) != sizeof(tileHeader)) return false;
+            uint32_t tile = GetU32(tileHeader);
+            uint32_t size = GetU32(tileHeader + 4);
+            if (tile >= tileCount) return false;
+            pos += sizeof(tileHeader);
+            table[tile].offset = pos;
+            table[tile].size = size;
+            pos += size;
+            if (!Seek(pos)) return false;
+        }
+    }
+
+    std::vector<uint8_t> compressed;
+    std::vector<uint8_t> pixels;
+    for (size_t tile = 0; tile < tileCount; tile++) {
+        int x0 = (int)(tile % m_tilesX) * m_tileSize;
+        int y0 = (int)(tile / m_tilesX) * m_tileSize;
+        int w = (x0 + m_tileSize > m_width) ? m_width - x0 : m_tileSize;
+        int h = (y0 + m_tileSize > m_height) ? m_height - y0 : m_tileSize;
+        int rowBytes = w * 4;
+
+        compressed.resize(table[tile].size);
+        if (!Seek(table[tile].offset) || fread(compressed.data(), 1, compressed.size(), m_file) != compressed.size()) return false;
+        pixels.clear();
+        if (!ZlibDecompress(compressed.data(), compressed.size(), pixels)) return false;
+        if (pixels.size() != (size_t)rowBytes * h) return false;
+
+        for (int y = 0; y < h; y++) {
+            uint8_t* row = pixels.data() + (size_t)y * rowBytes;
+            for (int i = 4; i < rowBytes; i++) row[i] = (uint8_t)(row[i] + row[i - 4]);
+            memcpy(bgra + (size_t)(y0 + y) * stride + x0 * 4, row, rowBytes);
+        }
+    }
+    return true;
+}
+
+} // namespace ScreenCapture
@@ -0,0 +1,127 @@
+#pragma once
+#include <stdio.h>
+#include <cstdint>
+#include <vector>
+#include "framepool.h"
+
+namespace ScreenCapture {
+
+// .scrv lossless screen recording container (all integers little-endian)
+//
+//   Header   "SCRV" u16 version u16 tileSize u32 width u32 height u32 reserved
+//   Frame    "FRAM" u32 index u64 timestampUs u32 changedTiles
+//            changedTiles x { u32 tileIndex u32 size u8 data[size] }
+//   Index    "INDX" u32 frameCount u32 snapshotInterval u32 tileCount
+//            frameCount x { u64 frameOffset u64 timestampUs }
+//            ceil(frameCount / interval) x tileCount x { u64 dataOffset u32 size }
+//   Trailer  u64 indexOffset "SCRE"
+//
+// Frames are split into tileSize x tileSize tiles. A tile is stored only
+// when it differs from the previous frame; otherwise the frame implicitly
+// references the last stored copy. Tile data is a zlib stream (the PNG
+// encoder's deflate) of the tile rows after a left-neighbour byte delta.
+// Every snapshotInterval frames the index records the full tile -> data
+// table, so seeking to frame N replays at most interval-1 frame headers.
+
+struct RecordingStats {
+    uint64_t frames;
+    uint64_t tilesChanged;
+    uint64_t tilesReused;
+    uint64_t bytesWritten;
+    double lastDiffMs;
+    double lastCompressMs;
+};
+
+class RecordingWriter {
+public:
+    RecordingWriter();
+    ~RecordingWriter();
+
+    // Takes ownership of 'file' (opened "wb"). Changed tiles of each frame
+    // are compressed in parallel on the shared TaskScheduler.
+    bool Open(FILE* file, int width, int height, int tileSize);
+
+    // Append a top-down BGRA frame of the size given to Open()
+    bool AddFrame(const uint8_t* bgra, int stride, uint64_t timestampUs);
+
+    // Write the index and trailer, close the file
+    bool Close();
+
+    bool IsOpen() const { return m_file != nullptr; }
+    RecordingStats GetStats() const { return m_stats; }
+
+    static const int SNAPSHOT_INTERVAL = 30;
+    static const int COMPRESSION_LEVEL = 5;
+
+private:
+    struct TileRef {
+        uint64_t offset;
+        uint32_t size;
+    };
+    struct TileJob {
+        int tile;
+        unsigned char* data;
+        int size;
+    };
+
+    void CompressTile(TileJob& job);
+    bool Write(const void* data, size_t size);
+    // Cut the file back to 'offset' (drops a partly written frame)
+    bool Truncate(uint64_t offset);
+
+    FILE* m_file;
+    uint64_t m_offset;
+    int m_width;
+    int m_height;
+    int m_tileSize;
+    int m_tilesX;
+    int m_tilesY;
+    FrameRef m_prev;  // Last written content of every tile
+    bool m_hasPrev;
+
+    std::vector<TileRef> m_table;
+    std::vector<TileRef> m_snapshots;
+    std::vector<uint64_t> m_frameOffsets;
+    std::vector<uint64_t> m_frameTimes;
+    RecordingStats m_stats;
+    std::vector<TileJob> m_jobs;  // Changed tiles of the current frame
+};
+
+class RecordingReader {
+public:
+    RecordingReader();
+    ~RecordingReader();
+
+    // Takes ownership of 'file' (opened "rb")
+    bool Open(FILE* file);
+    void Close();
+
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+    int FrameCount() const { return (int)m_frameOffsets.size(); }
+    uint64_t FrameTimestamp(int index) const { return m_frameTimes[index]; }
+
+    // Reconstruct frame 'index' into a top-down BGRA buffer
+    bool DecodeFrame(int index, uint8_t* bgra, int stride);
+
+private:
+    struct TileRef {
+        uint64_t offset;
+        uint32_t size;
+    };
+
+    bool Seek(uint64_t offset);
+
+    FILE* m_file;
+    int m_width;
+    int m_height;
+    int m_tileSize;
+    int m_tilesX;
+    int m_tilesY;
+    uint32_t m_interval;
+    std::vector<uint64_t> m_frameOffsets;
+    std::vector<uint64_t> m_frameTimes;
+    std::vector<TileRef> m_snapshots;
+};
+
+} // namespace ScreenCapture
@@ -0,0 +1,127 @@
+#include "requestscheduler.h"
+#include <chrono>
+
+namespace ScreenCapture {
+
+uint64_t SteadyRequestClock::NowMs() const {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+RequestScheduler::RequestScheduler(const RequestClock& clock, const RequestPolicy& policy)
+    : m_clock(clock), m_policy(policy), m_nextId(1), m_stats() {
+}
+
+RequestPriority RequestScheduler::DefaultPriority(CaptureKind kind) {
+    return kind == CaptureKind::Region ? RequestPriority::Interactive : RequestPriority::Normal;
+}
+
+SubmitResult RequestScheduler::Submit(CaptureKind kind, RequestPriority priority) {
+    return Submit(kind, priority, m_clock.NowMs());
+}
+
+SubmitResult RequestScheduler::Submit(CaptureKind kind, RequestPriority priority, uint64_t atMs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t now = m_clock.NowMs();
+    if (atMs > now) atMs = now;
+    m_stats.submitted++;
+
+    SubmitResult result = { 0, false, priority == RequestPriority::Interactive };
+
+    // Coalesce with the newest queued request of the same kind; it takes
+    // the higher of the two priorities
+    for (auto it = m_queue.rbegin(); it != m_queue.rend(); ++it) {
+        uint64_t apart = atMs > it->submittedMs ? atMs - it->submittedMs : it->submittedMs - atMs;
+        if (it->kind == kind && apart <= m_policy.coalesceMs) {
+            if (priority > it->priority) it->priority = priority;
+            it->merged++;
+            m_stats.merged++;
+            result.id = it->id;
+            result.merged = true;
+            return result;
+        }
+    }
+
+    // Full: evict the oldest request of the lowest priority present, but
+    // never for a request that ranks below everything queued
+    if (m_queue.size() >= m_policy.capacity && !m_queue.empty()) {
+        auto victim = m_queue.begin();
+        for (auto it = m_queue.begin(); it != m_queue.end(); ++it) {
+            if (it->priority < victim->priority) victim = it;
+        }
+        if (victim->priority > priority) {
+            m_stats.evicted++;  // The new request is the one dropped
+            return result;
+        }
+        m_queue.erase(victim);
+        m_stats.evicted++;
+    }
+
+    CaptureRequest request = { m_nextId++, kind, priority, atMs, 0 };
+    m_queue.push_back(request);
+    m_stats.queued = m_queue.size();
+    result.id = request.id;
+    return result;
+}
+
+bool RequestScheduler::Cancel(uint64_t id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_queue.begin(); it != m_queue.end(); ++it) {
+        if (it->id == id) {
+            m_queue.erase(it);
+            m_stats.cancelled++;
+            m_stats.queued = m_queue.size();
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t RequestScheduler::CancelAll() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = m_queue.size();
+    m_queue.clear();
+    m_stats.cancelled += count;
+    m_stats.queued = 0;
+    return count;
+}
+
+bool RequestScheduler::Next(CaptureRequest* request) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t now = m_clock.NowMs();
+
+    for (auto it = m_queue.begin(); it != m_queue.end();) {
+        if (now - it->submittedMs > m_policy.maxAgeMs) {
+            it = m_queue.erase(it);
+            m_stats.expired++;
+        } else {
+            ++it;
+        }
+    }
+
+    // First of the highest priority = FIFO within a level
+    auto best = m_queue.end();
+    for (auto it = m_queue.begin(); it != m_queue.end(); ++it) {
+        if (best == m_queue.end() || it->priority > best->priority) best = it;
+    }
+    m_stats.queued = m_queue.size();
+    if (best == m_queue.end()) return false;
+
+    *request = *best;
+    m_queue.erase(best);
+    m_stats.dispatched++;
+    m_stats.queued = m_queue.size();
+    return true;
+}
+
+bool RequestScheduler::Empty() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queue.empty();
+}
+
+RequestSchedulerStats RequestScheduler::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+} // namespace ScreenCapture
@@ -0,0 +1,122 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace ScreenCapture {
+
+// Time source for the scheduler policies. Injected so coalescing and
+// expiry can be driven deterministically (ManualClock) instead of by
+// wall time.
+class RequestClock {
+public:
+    virtual ~RequestClock() {}
+    virtual uint64_t NowMs() const = 0;
+};
+
+class SteadyRequestClock : public RequestClock {
+public:
+    uint64_t NowMs() const override;
+};
+
+class ManualClock : public RequestClock {
+public:
+    explicit ManualClock(uint64_t startMs = 0) : m_nowMs(startMs) {}
+    uint64_t NowMs() const override { return m_nowMs; }
+    void Advance(uint64_t ms) { m_nowMs += ms; }
+
+private:
+    uint64_t m_nowMs;
+};
+
+enum class CaptureKind {
+    FullScreen,
+    ActiveWindow,
+    Region
+};
+
+// Dispatch order: higher first, FIFO within a level
+enum class RequestPriority {
+    Background = 0,   // Non-interactive work (e.g. scripted captures)
+    Normal = 1,       // One-shot full screen / window captures
+    Interactive = 2   // Region selection: the user is waiting on screen
+};
+
+struct CaptureRequest {
+    uint64_t id;
+    CaptureKind kind;
+    RequestPriority priority;
+    uint64_t submittedMs;
+    int merged;  // Later duplicates folded into this request
+};
+
+struct RequestPolicy {
+    // A request of the same kind queued within this window absorbs the new
+    // one (key repeat, double presses, tray + hotkey at once)
+    uint64_t coalesceMs;
+    // Queued requests older than this are dropped at dispatch: the moment
+    // the user asked for has passed, a late capture shows the wrong screen
+    uint64_t maxAgeMs;
+    // Most requests kept queued; the oldest lowest-priority one makes room
+    size_t capacity;
+
+    static RequestPolicy Default() { return { 250, 3000, 8 }; }
+};
+
+struct SubmitResult {
+    uint64_t id;      // Request that will carry this submission (0 = dropped,
+                      // the queue is full of higher-priority requests)
+    bool merged;      // Folded into an already queued request
+    bool preempt;     // Interactive request: queued background encodes
+                      // should yield (the caller downgrades them)
+};
+
+struct RequestSchedulerStats {
+    uint64_t submitted;
+    uint64_t dispatched;
+    uint64_t merged;
+    uint64_t cancelled;
+    uint64_t expired;
+    uint64_t evicted;
+    size_t queued;
+};
+
+// Queue of capture requests between the input handlers (hotkeys, tray) and
+// the code that performs the captures. Handlers only Submit(), which is
+// cheap and never re-enters capture code; the UI thread pulls requests with
+// Next() one at a time from a posted message, so captures run one after
+// another instead of inside the handler of the key that asked for them.
+// Thread-safe; contains no Win32 code.
+class RequestScheduler {
+public:
+    RequestScheduler(const RequestClock& clock, const RequestPolicy& policy);
+
+    SubmitResult Submit(CaptureKind kind, RequestPriority priority);
+    // Input that happened at 'atMs' on the scheduler's clock, e.g. a key
+    // press handled late: coalescing and expiry count from then, not from
+    // when the handler ran. Times ahead of the clock count as now.
+    SubmitResult Submit(CaptureKind kind, RequestPriority priority, uint64_t atMs);
+
+    // Remove a queued request (no effect once it has been dispatched)
+    bool Cancel(uint64_t id);
+    size_t CancelAll();
+
+    // Highest-priority live request, dropping expired ones on the way
+    bool Next(CaptureRequest* request);
+
+    bool Empty() const;
+    RequestSchedulerStats GetStats() const;
+
+    static RequestPriority DefaultPriority(CaptureKind kind);
+
+private:
+    const RequestClock& m_clock;
+    const RequestPolicy m_policy;
+    mutable std::mutex m_mutex;
+    std::deque<CaptureRequest> m_queue;  // Submission order
+    uint64_t m_nextId;
+    RequestSchedulerStats m_stats;
+};
+
+} // namespace ScreenCapture
@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace ScreenCapture {
+
+// Bounded single-producer / single-consumer ring. Exactly one thread may
+// push and one thread may pop; neither side takes a lock. Head and tail
+// live on separate cache lines so the two threads do not false-share.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) : m_slots(capacity + 1), m_head(0), m_tail(0) {}
+
+    bool TryPush(const T& value) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        size_t next = tail + 1 == m_slots.size() ? 0 : tail + 1;
+        if (next == m_head.load(std::memory_order_acquire)) return false;  // Full
+        m_slots[tail] = value;
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPop(T& value) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) return false;  // Empty
+        value = m_slots[head];
+        m_head.store(head + 1 == m_slots.size() ? 0 : head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Blocking forms: spin, then yield, then nap, so a stage waiting on a
+    // slow neighbour does not burn a core. Return false if 'abort' becomes
+    // set while waiting (the other side gave up).
+    bool Push(const T& value, const std::atomic<bool>& abort) {
+        for (int attempt = 0; !TryPush(value); attempt++) {
+            if (abort.load(std::memory_order_relaxed)) return false;
+            Backoff(attempt);
+        }
+        return true;
+    }
+
+    bool Pop(T& value, const std::atomic<bool>& abort) {
+        for (int attempt = 0; !TryPop(value); attempt++) {
+            if (abort.load(std::memory_order_relaxed)) return false;
+            Backoff(attempt);
+        }
+        return true;
+    }
+
+private:
+    static void Backoff(int attempt) {
+        if (attempt < 64) return;
+        if (attempt < 256) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    std::vector<T> m_slots;  // One slot stays empty to tell full from empty
+    alignas(64) std::atomic<size_t> m_head;
+    alignas(64) std::atomic<size_t> m_tail;
+};
+
+} // namespace ScreenCapture
@@ -0,0 +1,124 @@
+#include "summedarea.h"
+#include "taskscheduler.h"
+#include <math.h>
+#include <algorithm>
+
+namespace ScreenCapture {
+
+// Work units: rows per band for the row pass, columns per strip for the
+// column pass (a strip's previous row stays in L1)
+static const int BAND_ROWS = 32;
+static const int STRIP_COLUMNS = 256;
+
+void RegionSums::Add(const RegionSums& other) {
+    pixels += other.pixels;
+    blue += other.blue;
+    green += other.green;
+    red += other.red;
+    luma += other.luma;
+    lumaSquares += other.lumaSquares;
+}
+
+uint32_t RegionSums::MeanColor() const {
+    if (pixels == 0) return 0xFF000000u;
+    uint32_t b = (uint32_t)((blue + pixels / 2) / pixels);
+    uint32_t g = (uint32_t)((green + pixels / 2) / pixels);
+    uint32_t r = (uint32_t)((red + pixels / 2) / pixels);
+    return 0xFF000000u | r << 16 | g << 8 | b;
+}
+
+double RegionSums::MeanLuma() const {
+    return pixels ? (double)luma / pixels / 256.0 : 0.0;
+}
+
+double RegionSums::LumaDeviation() const {
+    if (pixels == 0) return 0.0;
+    double mean = (double)luma / pixels;
+    double variance = (double)lumaSquares / pixels - mean * mean;
+    return variance > 0 ? sqrt(variance) / 256.0 : 0.0;
+}
+
+SummedAreaTable::SummedAreaTable() : m_width(0), m_height(0) {
+}
+
+void SummedAreaTable::Clear() {
+    m_width = 0;
+    m_height = 0;
+    m_colors.clear();
+    m_squares.clear();
+}
+
+bool SummedAreaTable::Build(const uint8_t* pixels, int stride, int width, int height) {
+    Clear();
+    if (!pixels || width <= 0 || height <= 0 || (size_t)width * height > MAX_PIXELS) return false;
+    const size_t columns = (size_t)width + 1;
+    m_colors.assign(columns * (height + 1) * 3, 0);
+    m_squares.assign(columns * (height + 1), 0);
+
+    // Row prefix sums into rows 1..height
+    ParallelFor(0, height, BAND_ROWS, [&](int y0, int y1) {
+        for (int y = y0; y < y1; y++) {
+            const uint8_t* p = pixels + (size_t)y * stride;
+            uint32_t* colors = &m_colors[(y + 1) * columns * 3 + 3];
+            uint64_t* squares = &m_squares[(y + 1) * columns + 1];
+            uint32_t b = 0, g = 0, r = 0;
+            uint64_t s = 0;
+            for (int x = 0; x < width; x++, p += 4) {
+                b += p[0];
+                g += p[1];
+                r += p[2];
+                uint64_t luma = 77u * p[2] + 150u * p[1] + 29u * p[0];
+                s += luma * luma;
+                colors[x * 3] = b;
+                colors[x * 3 + 1] = g;
+                colors[x * 3 + 2] = r;
+                squares[x] = s;
+            }
+        }
+    });
+
+    // Down the columns: each row adds the one above
+    const int strips = (width + STRIP_COLUMNS - 1) / STRIP_COLUMNS;
+    ParallelFor(0, strips, 1, [&](int s0, int s1) {
+        for (int strip = s0; strip < s1; strip++) {
+            size_t x0 = (size_t)strip * STRIP_COLUMNS + 1;
+            size_t x1 = std::min((size_t)width + 1, x0 + STRIP_COLUMNS);
+            for (int y = 2; y <= height; y++) {
+                uint32_t* colors = &m_colors[y * columns * 3];
+                const uint32_t* above = colors - columns * 3;
+                for (size_t i = x0 * 3; i < x1 * 3; i++) colors[i] += above[i];
+                uint64_t* squares = &m_squares[y * columns];
+                const uint64_t* squaresAbove = squares - columns;
+                for (size_t x = x0; x < x1; x++) squares[x] += squaresAbove[x];
+            }
+        }
+    });
+
+    m_width = width;
+    m_height = height;
+    return true;
+}
+
+RegionSums SummedAreaTable::Sum(const PixelRect& rect) const {
+    RegionSums sums = {};
+    PixelRect r = rect.Intersect({ 0, 0, m_width, m_height });
+    if (r.Empty()) return sums;
+    const size_t columns = (size_t)m_width + 1;
+    // Corners of the table: sum = D - B - C + A
+    const size_t a = (size_t)r.top * columns + r.left, b = (size_t)r.top * columns + r.right;
+    const size_t c = (size_t)r.bottom * columns + r.left, d = (size_t)r.bottom * columns + r.right;
+    // D - B - C + A may wrap midway in uint32; the result fits
+    uint32_t channel[3];
+    for (int i = 0; i < 3; i++) {
+        channel[i] = m_colors[d * 3 + i] - m_colors[b * 3 + i] - m_colors[c * 3 + i] + m_colors[a * 3 + i];
+    }
+    sums.pixels = (uint64_t)r.Area();
+    sums.blue = channel[0];
+    sums.green = channel[1];
+    sums.red = channel[2];
+    sums.luma = 77 * sums.red + 150 * sums.green + 29 * sums.blue;
+    sums.lumaSquares = m_squares[d] - m_squares[b] - m_squares[c] + m_squares[a];
+    return sums;
+}
+
+} // namespace ScreenCapture
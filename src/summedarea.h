@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "overlaycompositor.h"
+
+namespace ScreenCapture {
+
+// Pixel sums over a region. Luma is BT.601 without the final shift
+// (77 R + 150 G + 29 B, 0..65280), so it stays linear in the channels and
+// regions add up exactly.
+struct RegionSums {
+    uint64_t pixels;
+    uint64_t blue, green, red;
+    uint64_t luma;
+    uint64_t lumaSquares;
+
+    void Add(const RegionSums& other);
+
+    // Average color as a BGRA word (0xFFRRGGBB), rounded
+    uint32_t MeanColor() const;
+
+    // Average luma and its standard deviation, 0..255
+    double MeanLuma() const;
+    double LumaDeviation() const;
+};
+
+// Summed-area tables of a frozen screenshot: the sums of every channel and
+// of the squared luma over any rectangle in O(1) (four lookups per table),
+// so the mean color and luma variance of a selection follow the mouse
+// without touching its pixels. Build() runs the row prefix sums and then
+// the column accumulation in parallel. Up to MAX_PIXELS the channel sums
+// fit 32 bits, so a table costs 20 bytes per pixel. Contains no Win32 code.
+class SummedAreaTable {
+public:
+    static const size_t MAX_PIXELS = 0xFFFFFFFFu / 255;
+
+    SummedAreaTable();
+
+    // 32bpp BGRA/BGRX; false (and an empty table) over MAX_PIXELS
+    bool Build(const uint8_t* pixels, int stride, int width, int height);
+
+    void Clear();
+
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+    size_t Bytes() const { return m_colors.size() * sizeof(uint32_t) + m_squares.size() * sizeof(uint64_t); }
+
+    // Sums over the part of 'rect' inside the image
+    RegionSums Sum(const PixelRect& rect) const;
+
+private:
+    int m_width;
+    int m_height;
+    std::vector<uint32_t> m_colors;   // (width + 1) x (height + 1) x B, G, R; row and column 0 are zero
+    std::vector<uint64_t> m_squares;  // (width + 1) x (height + 1) squared luma
+};
+
+} // namespace ScreenCapture
@@ -0,0 +1,167 @@
+#include "taskscheduler.h"
+#include <chrono>
+
+namespace ScreenCapture {
+
+// Index of the scheduler worker running on this thread, -1 elsewhere
+static thread_local int t_workerIndex = -1;
+
+TaskScheduler& TaskScheduler::Instance() {
+    // Leaked on purpose: encode jobs may still wait on groups during exit
+    static TaskScheduler* scheduler = []() {
+        int cores = (int)std::thread::hardware_concurrency();
+        return new TaskScheduler(cores > 1 ? cores - 1 : 1);
+    }();
+    return *scheduler;
+}
+
+TaskScheduler::TaskScheduler(int workers) : m_queued(0), m_stopping(false) {
+    for (int i = 0; i < workers; i++) {
+        m_workers.emplace_back(new Worker());
+    }
+    for (int i = 0; i < workers; i++) {
+        m_workers[i]->thread = std::thread(&TaskScheduler::WorkerLoop, this, i);
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    Shutdown();
+}
+
+void TaskScheduler::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+void TaskScheduler::Spawn(Task task) {
+    int self = t_workerIndex;
+    if (self >= 0 && !m_stopping) {
+        std::lock_guard<std::mutex> lock(m_workers[self]->mutex);
+        m_workers[self]->tasks.push_back(std::move(task));
+    } else {
+        std::lock_guard<std::mutex> lock(m_injectMutex);
+        m_inject.push_back(std::move(task));
+    }
+    {
+        // Under the sleep lock, so a worker between its predicate check and
+        // the wait cannot miss this task and sleep out the timeout
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_queued++;
+    }
+    m_wake.notify_one();
+}
+
+bool TaskScheduler::Pop(int self, Task& task) {
+    // Own deque, newest first
+    if (self >= 0) {
+        Worker& own = *m_workers[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    // Work submitted from outside, oldest first
+    {
+        std::lock_guard<std::mutex> lock(m_injectMutex);
+        if (!m_inject.empty()) {
+            task = std::move(m_inject.front());
+            m_inject.pop_front();
+            return true;
+        }
+    }
+    // Steal the oldest task of another worker, starting after ourselves
+    size_t count = m_workers.size();
+    size_t start = self >= 0 ? (size_t)self + 1 : 0;
+    for (size_t k = 0; k < count; k++) {
+        Worker& victim = *m_workers[(start + k) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::Execute(Task& task) {
+    m_queued--;
+    task.fn();
+    if (--task.group->m_pending == 0) {
+        // Waiters may be sleeping on the wake condition
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_wake.notify_all();
+    }
+}
+
+bool TaskScheduler::TryRunOne(int self) {
+    Task task;
+    if (!Pop(self, task)) return false;
+    Execute(task);
+    return true;
+}
+
+void TaskScheduler::WorkerLoop(int index) {
+    t_workerIndex = index;
+    while (!m_stopping) {
+        if (TryRunOne(index)) continue;
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait_for(lock, std::chrono::milliseconds(50), [this]() {
+            return m_stopping || m_queued > 0;
+        });
+    }
+}
+
+void TaskScheduler::WaitForWork(TaskGroup& group) {
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    m_wake.wait_for(lock, std::chrono::milliseconds(1), [&]() {
+        return group.m_pending == 0 || m_queued > 0;
+    });
+}
+
+void TaskGroup::Run(std::function<void()> fn) {
+    m_pending++;
+    TaskScheduler::Instance().Spawn({ std::move(fn), this });
+}
+
+void TaskGroup::Wait() {
+    TaskScheduler& scheduler = TaskScheduler::Instance();
+    while (m_pending > 0) {
+        if (!scheduler.TryRunOne(t_workerIndex)) {
+            scheduler.WaitForWork(*this);
+        }
+    }
+}
+
+static void SplitRange(TaskGroup& group, int begin, int end, int grain, const std::function<void(int, int)>& fn) {
+    // Hand the upper half to the scheduler and keep splitting the lower
+    // one; thieves take the large pieces first
+    while (end - begin > grain) {
+        int mid = begin + (end - begin) / 2;
+        group.Run([&group, mid, end, grain, &fn]() { SplitRange(group, mid, end, grain, fn); });
+        end = mid;
+    }
+    fn(begin, end);
+}
+
+void ParallelFor(int begin, int end, int grain, const std::function<void(int, int)>& fn) {
+    if (end <= begin) return;
+    if (grain < 1) grain = 1;
+    if (end - begin <= grain) {
+        fn(begin, end);
+        return;
+    }
+    TaskGroup group;
+    SplitRange(group, begin, end, grain, fn);
+    group.Wait();
+}
+
+} // namespace ScreenCapture
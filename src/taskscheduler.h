@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ScreenCapture {
+
+class TaskGroup;
+
+// Process-wide work-stealing scheduler for image processing (conversion,
+// filtering, deflate, hashing, scaling). One worker per core minus one;
+// the thread that waits on a TaskGroup runs tasks too, so a single large
+// capture uses every core and concurrent captures share the same workers
+// instead of each bringing its own threads.
+//
+// Each worker owns a deque: it pushes and pops its own tasks at the back
+// (depth-first, cache-warm) while idle workers steal from the front (the
+// biggest remaining pieces of a split range). Tasks from threads outside
+// the scheduler go to a shared FIFO, so separate captures interleave.
+class TaskScheduler {
+public:
+    static TaskScheduler& Instance();
+
+    int WorkerCount() const { return (int)m_workers.size(); }
+
+    // Stop and join the workers (queued tasks still run on their waiters)
+    void Shutdown();
+
+private:
+    friend class TaskGroup;
+
+    struct Task {
+        std::function<void()> fn;
+        TaskGroup* group;
+    };
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    explicit TaskScheduler(int workers);
+    ~TaskScheduler();
+
+    void Spawn(Task task);
+    bool TryRunOne(int self);
+    bool Pop(int self, Task& task);
+    void Execute(Task& task);
+    void WorkerLoop(int index);
+    void WaitForWork(TaskGroup& group);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::mutex m_injectMutex;
+    std::deque<Task> m_inject;
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::atomic<int> m_queued;
+    std::atomic<bool> m_stopping;
+};
+
+// Fork/join scope. Run() may be called from inside tasks of the same or
+// another group (nested parallelism); Wait() helps execute queued tasks
+// instead of blocking, so nesting cannot deadlock.
+class TaskGroup {
+public:
+    TaskGroup() : m_pending(0) {}
+    ~TaskGroup() { Wait(); }
+
+    void Run(std::function<void()> fn);
+    void Wait();
+
+private:
+    friend class TaskScheduler;
+    std::atomic<int> m_pending;
+};
+
+// fn(begin, end) over [begin, end) split recursively down to 'grain'
+// items; returns when every piece has run
+void ParallelFor(int begin, int end, int grain, const std::function<void(int, int)>& fn);
+
+} // namespace ScreenCapture
@@ -0,0 +1,149 @@
+#include "timedcapture.h"
+#include "capturetimer.h"
+#include "config.h"
+#include "utils.h"
+#include <mmsystem.h>
+#include <stdio.h>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#pragma comment(lib, "winmm.lib")
+
+namespace ScreenCapture {
+
+// Debug logging helper
+static void DebugLog(const wchar_t* format, ...) {
+    FILE* f = _wfopen(L"debug_timed.txt", L"a");
+    if (f) {
+        SYSTEMTIME st;
+        GetLocalTime(&st);
+        fwprintf(f, L"[%02d:%02d:%02d.%03d] ", st.wHour, st.wMinute, st.wSecond, st.wMilliseconds);
+        
+        va_list args;
+        va_start(args, format);
+        vfwprintf(f, format, args);
+        va_end(args);
+        
+        fwprintf(f, L"\n");
+        fclose(f);
+    }
+}
+
+// One run: its own warm session (3 slots: grabbing, waiting, being saved)
+struct TimedRun {
+    TimedRun(int width, int height)
+        : session(CreateGdiBackend(), width, height, 3), timer(session, clock) {}
+    
+    CaptureSession session;
+    SteadyTimerClock clock;
+    CaptureTimer timer;
+};
+
+static std::mutex g_timedMutex;  // Start / stop from the UI thread vs. the watcher
+static std::unique_ptr<TimedRun> g_run;
+static std::thread g_watchThread;
+
+static void LogHistogram(const wchar_t* name, const LatencyHistogram& histogram) {
+    DebugLog(L"  %s: n=%llu mean=%.2fms p50<=%.2fms p95<=%.2fms p99<=%.2fms max=%.2fms", name,
+        histogram.Count(), histogram.MeanUs() / 1000.0,
+        histogram.PercentileUs(0.50) / 1000.0, histogram.PercentileUs(0.95) / 1000.0,
+        histogram.PercentileUs(0.99) / 1000.0, histogram.Max() / 1000.0);
+    for (int i = 0; i < LatencyHistogram::BUCKETS; i++) {
+        if (histogram.Bucket(i)) {
+            DebugLog(L"    <%lldus: %llu", LatencyHistogram::BucketUpperUs(i), histogram.Bucket(i));
+        }
+    }
+}
+
+// Waits for the run to end (duration elapsed or stopped) and reports it
+static void WatchThread(TimedRun* run) {
+    run->timer.Wait();
+    timeEndPeriod(1);
+    
+    CaptureTimerStats stats = run->timer.GetStats();
+    DebugLog(L"=== Timed capture end: ticks=%llu captured=%llu saved=%llu missed=%llu skipped busy=%llu merged=%llu failed=%llu ===",
+        stats.ticks, stats.captured, stats.delivered, stats.missed, stats.skippedBusy, stats.merged, stats.failed);
+    LogHistogram(L"Lateness", stats.lateness);
+    LogHistogram(L"Jitter", stats.jitter);
+}
+
+bool StartTimedCapture() {
+    std::lock_guard<std::mutex> lock(g_timedMutex);
+    if (g_run && g_run->timer.Running()) {
+        DebugLog(L"StartTimedCapture: already running");
+        return false;
+    }
+    if (g_watchThread.joinable()) {
+        g_watchThread.join();
+    }
+    g_run.reset();
+    
+    std::wstring dir = GetSaveDirectory();
+    if (!EnsureDirectoryExists(dir)) {
+        DebugLog(L"StartTimedCapture: ERROR: Failed to create directory");
+        return false;
+    }
+    
+    const Config& config = GetConfig();
+    RECT area = GetVirtualScreenRect();
+    TimedCaptureOptions options;
+    options.x = area.left;
+    options.y = area.top;
+    options.width = area.right - area.left;
+    options.height = area.bottom - area.top;
+    options.intervalUs = (int64_t)config.timedIntervalMs * 1000;
+    options.durationUs = (int64_t)config.timedMinutes * 60 * 1000000;
+    options.behind = config.timedBehind;
+    
+    std::wstring baseName = dir + L"\\Timed_" + GetTimestamp();
+    auto consumer = [baseName](TimedFrame& item) {
+        wchar_t suffix[32];
+        swprintf_s(suffix, L"_%05llu.png", item.tick);
+        std::wstring filename = baseName + suffix;
+        if (!SaveFrameToPNG(item.frame, filename)) {
+            DebugLog(L"  ERROR: Failed to save %s", filename.c_str());
+        }
+    };
+    
+    DebugLog(L"=== Timed capture start: %dx%d every %dms for %dmin, when behind=%s ===",
+        options.width, options.height, config.timedIntervalMs, config.timedMinutes,
+        options.behind == BehindPolicy::Merge ? L"merge" : L"skip");
+    
+    timeBeginPeriod(1);
+    g_run.reset(new TimedRun(options.width, options.height));
+    if (!g_run->timer.Start(options, consumer)) {
+        DebugLog(L"StartTimedCapture: ERROR: Invalid options");
+        timeEndPeriod(1);
+        g_run.reset();
+        return false;
+    }
+    g_watchThread = std::thread(WatchThread, g_run.get());
+    return true;
+}
+
+void StopTimedCapture() {
+    std::lock_guard<std::mutex> lock(g_timedMutex);
+    if (g_run) {
+        g_run->timer.Stop();
+    }
+    if (g_watchThread.joinable()) {
+        g_watchThread.join();
+    }
+    g_run.reset();
+}
+
+void ToggleTimedCapture() {
+    if (IsTimedCaptureRunning()) {
+        StopTimedCapture();
+    } else {
+        StartTimedCapture();
+    }
+}
+
+bool IsTimedCaptureRunning() {
+    std::lock_guard<std::mutex> lock(g_timedMutex);
+    return g_run && g_run->timer.Running();
+}
+
+} // namespace ScreenCapture
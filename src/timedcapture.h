@@ -0,0 +1,19 @@
+#pragma once
+#include <windows.h>
+
+namespace ScreenCapture {
+
+// Interval capture of the virtual screen: one PNG every [Timed] IntervalMs
+// for [Timed] Minutes into Timed_<ts>_<n>.png in the save directory (see
+// capturetimer.h for the scheduling). Returns false if already running.
+bool StartTimedCapture();
+
+// Stop a running timed capture and wait for the frame being saved
+void StopTimedCapture();
+
+// Start if idle, otherwise stop (tray toggle)
+void ToggleTimedCapture();
+
+bool IsTimedCaptureRunning();
+
+} // namespace ScreenCapture
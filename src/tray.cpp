@@ -2,6 +2,8 @@
 #include "capture.h"
 #include "overlay.h"
 #include "utils.h"
+#include "recorder.h"
+#include "timedcapture.h"
 #include <shellapi.h>
 
 namespace ScreenCapture {
@@ -45,6 +47,10 @@ void TrayIcon::ShowContextMenu(HWND hwnd) {
     AppendMenuW(hMenu, MF_STRING, MENU_CAPTURE_FULLSCREEN, L"Chụp toàn màn hình");
     AppendMenuW(hMenu, MF_STRING, MENU_CAPTURE_WINDOW, L"Chụp cửa sổ");
     AppendMenuW(hMenu, MF_STRING, MENU_CAPTURE_REGION, L"Chụp vùng chọn");
+    AppendMenuW(hMenu, MF_STRING | (IsRecording() ? MF_CHECKED : 0), MENU_RECORD,
+        IsRecording() ? L"Dừng quay màn hình" : L"Quay màn hình");
+    AppendMenuW(hMenu, MF_STRING | (IsTimedCaptureRunning() ? MF_CHECKED : 0), MENU_TIMED,
+        IsTimedCaptureRunning() ? L"Dừng chụp định kỳ" : L"Chụp định kỳ");
     AppendMenuW(hMenu, MF_SEPARATOR, 0, NULL);
     AppendMenuW(hMenu, MF_STRING, MENU_OPEN_FOLDER, L"Mở thư mục ảnh");
     AppendMenuW(hMenu, MF_SEPARATOR, 0, NULL);
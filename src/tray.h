@@ -21,7 +21,9 @@ public:
         MENU_CAPTURE_WINDOW = 1002,
         MENU_CAPTURE_REGION = 1003,
         MENU_OPEN_FOLDER = 1004,
-        MENU_EXIT = 1005
+        MENU_EXIT = 1005,
+        MENU_RECORD = 1006,
+        MENU_TIMED = 1007
     };
     
 private:
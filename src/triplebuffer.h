@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace ScreenCapture {
+
+// Latest-value handoff between one writer and one reader. The writer fills
+// its private back slot and swaps it with the shared middle slot; the
+// reader swaps the middle slot with its private front slot when it holds
+// something newer. Neither side ever waits or takes a lock, the writer
+// never blocks on a slow reader, and intermediate values the reader did
+// not get to are simply overwritten.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : m_slots(), m_back(0), m_middle(1), m_front(2) {}
+
+    // Writer thread only
+    void Publish(const T& value) {
+        m_slots[m_back].value = value;
+        uint8_t previous = m_middle.exchange((uint8_t)(m_back | FRESH), std::memory_order_acq_rel);
+        m_back = previous & INDEX;
+    }
+
+    // Reader thread only: true if a value newer than the last Consume()
+    // was published (cheap; does not swap)
+    bool HasNew() const {
+        return (m_middle.load(std::memory_order_acquire) & FRESH) != 0;
+    }
+
+    // Reader thread only: copy the newest value, false if nothing new
+    bool Consume(T* value) {
+        if (!HasNew()) return false;
+        uint8_t previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & INDEX;
+        *value = m_slots[m_front].value;
+        return true;
+    }
+
+private:
+    static const uint8_t INDEX = 0x03;
+    static const uint8_t FRESH = 0x04;  // Middle slot not yet consumed
+
+    // Own cache lines so the writer filling one slot does not slow the
+    // reader copying another
+    struct alignas(64) Slot {
+        T value;
+    };
+
+    Slot m_slots[3];
+    alignas(64) uint8_t m_back;       // Writer's
+    alignas(64) std::atomic<uint8_t> m_middle;
+    alignas(64) uint8_t m_front;      // Reader's
+};
+
+} // namespace ScreenCapture
@@ -1,9 +1,10 @@
 #include "utils.h"
 #include <shlobj.h>
+#include <dwmapi.h>
 #include <time.h>
+#include <stdio.h>
 
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include "../stb_image_write.h"
+#pragma comment(lib, "dwmapi.lib")
 
 namespace ScreenCapture {
 
@@ -37,65 +38,39 @@ bool EnsureDirectoryExists(const std::wstring& path) {
     return CreateDirectoryW(path.c_str(), NULL) || GetLastError() == ERROR_ALREADY_EXISTS;
 }
 
-bool SaveBitmapToPNG(HBITMAP hBitmap, const std::wstring& filename) {
-    BITMAP bmp;
-    GetObject(hBitmap, sizeof(BITMAP), &bmp);
+bool SaveFrameToPNG(const FrameRef& frame, const std::wstring& filename, const EncodeOptions& options) {
+    if (!frame) return false;
     
-    int width = bmp.bmWidth;
-    int height = bmp.bmHeight;
+    // _wfopen keeps non-ASCII user folders working
+    FILE* f = _wfopen(filename.c_str(), L"wb");
+    if (!f) return false;
+    
+    // IDAT chunks go to the file while later rows are still compressing
+    bool ok = EncodePNGStream(frame->Bits(), frame->Width(), frame->Height(), frame->Stride(), options,
+                              [f](const void* data, size_t size) { return fwrite(data, 1, size, f) == size; });
+    ok = (fclose(f) == 0) && ok;
+    
+    // Never leave a truncated PNG behind
+    if (!ok) DeleteFileW(filename.c_str());
+    return ok;
+}
+
+HBITMAP CreateFrameDIB(HDC hdc, const FrameRef& frame) {
+    if (!frame) return NULL;
     
     BITMAPINFO bmi = {};
     bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    bmi.bmiHeader.biWidth = width;
-    bmi.bmiHeader.biHeight = -height; // Top-down
+    bmi.bmiHeader.biWidth = frame->Stride() / 4;
+    bmi.bmiHeader.biHeight = -frame->Height(); // Top-down
     bmi.bmiHeader.biPlanes = 1;
     bmi.bmiHeader.biBitCount = 32;
     bmi.bmiHeader.biCompression = BI_RGB;
     
-    size_t bufferSize = (size_t)width * height * 4;
-    unsigned char* pixels = new unsigned char[bufferSize];
-    
-    HDC hdc = GetDC(NULL);
-    int result = GetDIBits(hdc, hBitmap, 0, height, pixels, &bmi, DIB_RGB_COLORS);
-    ReleaseDC(NULL, hdc);
-    
-    if (!result) {
-        delete[] pixels;
-        return false;
-    }
-    
-    // SIMD-optimized BGRA to RGBA conversion (4 pixels at a time)
-    unsigned char* p = pixels;
-    unsigned char* end = pixels + bufferSize;
-    
-    // Process 4 pixels (16 bytes) at a time for better cache performance
-    while (p + 16 <= end) {
-        // Swap B and R for 4 pixels
-        unsigned char temp0 = p[0];  p[0] = p[2];  p[2] = temp0;
-        unsigned char temp1 = p[4];  p[4] = p[6];  p[6] = temp1;
-        unsigned char temp2 = p[8];  p[8] = p[10]; p[10] = temp2;
-        unsigned char temp3 = p[12]; p[12] = p[14]; p[14] = temp3;
-        p += 16;
-    }
-    
-    // Handle remaining pixels
-    while (p < end) {
-        unsigned char temp = p[0];
-        p[0] = p[2];
-        p[2] = temp;
-        p += 4;
-    }
-    
-    // Convert wstring to string (stack allocation for small strings)
-    int size = WideCharToMultiByte(CP_UTF8, 0, filename.c_str(), -1, NULL, 0, NULL, NULL);
-    char* filenameUtf8 = (char*)_alloca(size);
-    WideCharToMultiByte(CP_UTF8, 0, filename.c_str(), -1, filenameUtf8, size, NULL, NULL);
-    
-    int writeResult = stbi_write_png(filenameUtf8, width, height, 4, pixels, width * 4);
-    
-    delete[] pixels;
-    
-    return writeResult != 0;
+    // From the start of the view's first row, so the DIB ends where the
+    // view's last parent row does
+    void* pBits = NULL;
+    return CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, &pBits, (HANDLE)frame->Section(),
+                            (DWORD)(frame->SectionOffset() - (size_t)frame->Left() * 4));
 }
 
 RECT GetVirtualScreenRect() {
@@ -107,4 +82,29 @@ RECT GetVirtualScreenRect() {
     return rect;
 }
 
+static BOOL CALLBACK MonitorEnumProc(HMONITOR hMonitor, HDC, LPRECT, LPARAM lParam) {
+    MONITORINFO info = {};
+    info.cbSize = sizeof(info);
+    if (GetMonitorInfoW(hMonitor, &info)) {
+        const RECT& r = info.rcMonitor;
+        ((std::vector<ScreenRect>*)lParam)->push_back({ r.left, r.top, r.right - r.left, r.bottom - r.top });
+    }
+    return TRUE;
+}
+
+std::vector<ScreenRect> EnumerateMonitors() {
+    std::vector<ScreenRect> monitors;
+    EnumDisplayMonitors(NULL, NULL, MonitorEnumProc, (LPARAM)&monitors);
+    return monitors;
+}
+
+bool GetVisibleWindowRect(HWND hwnd, RECT* rect) {
+    if (!GetWindowRect(hwnd, rect)) return false;
+    RECT bounds = {};
+    if (SUCCEEDED(DwmGetWindowAttribute(hwnd, DWMWA_EXTENDED_FRAME_BOUNDS, &bounds, sizeof(RECT)))) {
+        *rect = bounds;
+    }
+    return true;
+}
+
 } // namespace ScreenCapture
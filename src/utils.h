@@ -1,6 +1,10 @@
 #pragma once
 #include <windows.h>
 #include <string>
+#include "framepool.h"
+#include "encoder.h"
+#include "monitorlayout.h"
+#include <vector>
 
 namespace ScreenCapture {
 
@@ -13,10 +17,24 @@ std::wstring GetSaveDirectory();
 // Ensure directory exists
 bool EnsureDirectoryExists(const std::wstring& path);
 
-// Save bitmap to PNG file
-bool SaveBitmapToPNG(HBITMAP hBitmap, const std::wstring& filename);
+// Save pooled frame to PNG file
+bool SaveFrameToPNG(const FrameRef& frame, const std::wstring& filename,
+                    const EncodeOptions& options = EncodeOptions::Default());
+
+// Create a DIB section over a pooled frame's memory (no copy). The DIB is
+// stride/4 pixels wide; only the first Width() columns hold image data.
+// Works for sub-views too: the DIB covers the view's whole parent rows, so
+// the view's pixels start at column frame->Left() of the bitmap.
+HBITMAP CreateFrameDIB(HDC hdc, const FrameRef& frame);
 
 // Get monitor info for multi-monitor support
 RECT GetVirtualScreenRect();
 
+// Rectangles of all attached monitors in desktop coordinates
+std::vector<ScreenRect> EnumerateMonitors();
+
+// Window bounds as drawn on screen: the DWM extended frame (no invisible
+// resize borders or shadow on Windows 10/11), else GetWindowRect
+bool GetVisibleWindowRect(HWND hwnd, RECT* rect);
+
 } // namespace ScreenCapture
@@ -0,0 +1,117 @@
+#include "windowindex.h"
+#include <math.h>
+#include <algorithm>
+
+namespace ScreenCapture {
+
+// Cell edge limits for the automatic size
+static const int MIN_CELL = 16;
+static const int MAX_CELL = 512;
+
+WindowIndex::WindowIndex() : m_bounds(), m_cellSize(0), m_columns(0), m_rows(0), m_stats() {
+}
+
+void WindowIndex::Clear() {
+    m_elements.clear();
+    m_bounds = { 0, 0, 0, 0 };
+    m_cellSize = 0;
+    m_columns = 0;
+    m_rows = 0;
+    m_cellOffsets.clear();
+    m_cellElements.clear();
+    m_stats = WindowIndexStats();
+}
+
+void WindowIndex::Build(const std::vector<WindowElement>& elements, int cellSize) {
+    Clear();
+    m_elements = elements;
+    m_stats.elements = elements.size();
+
+    bool first = true;
+    for (const WindowElement& element : elements) {
+        if (element.rect.Empty()) continue;
+        if (first) {
+            m_bounds = element.rect;
+            first = false;
+            continue;
+        }
+        m_bounds.left = std::min(m_bounds.left, element.rect.left);
+        m_bounds.top = std::min(m_bounds.top, element.rect.top);
+        m_bounds.right = std::max(m_bounds.right, element.rect.right);
+        m_bounds.bottom = std::max(m_bounds.bottom, element.rect.bottom);
+    }
+    if (first) return;
+
+    // About four cells per element: a short list per cell without the
+    // large windows being copied into too many cells
+    if (cellSize <= 0) {
+        double perCell = (double)m_bounds.Area() / (4.0 * elements.size());
+        cellSize = std::max(MIN_CELL, std::min(MAX_CELL, (int)sqrt(perCell)));
+    }
+    m_cellSize = cellSize;
+    m_columns = (m_bounds.Width() + cellSize - 1) / cellSize;
+    m_rows = (m_bounds.Height() + cellSize - 1) / cellSize;
+    const size_t cells = (size_t)m_columns * m_rows;
+
+    // Elements arrive in priority order, so each cell's list comes out
+    // sorted; a cell closes once an element covers it completely
+    std::vector<std::vector<uint32_t>> lists(cells);
+    std::vector<uint8_t> closed(cells, 0);
+    for (size_t i = 0; i < elements.size(); i++) {
+        const PixelRect& rect = elements[i].rect;
+        if (rect.Empty()) continue;
+        int c0 = (rect.left - m_bounds.left) / cellSize;
+        int c1 = (rect.right - 1 - m_bounds.left) / cellSize;
+        int r0 = (rect.top - m_bounds.top) / cellSize;
+        int r1 = (rect.bottom - 1 - m_bounds.top) / cellSize;
+        for (int row = r0; row <= r1; row++) {
+            for (int column = c0; column <= c1; column++) {
+                size_t cell = (size_t)row * m_columns + column;
+                if (closed[cell]) {
+                    m_stats.pruned++;
+                    continue;
+                }
+                lists[cell].push_back((uint32_t)i);
+                PixelRect area = { m_bounds.left + column * cellSize, m_bounds.top + row * cellSize,
+                                   m_bounds.left + (column + 1) * cellSize, m_bounds.top + (row + 1) * cellSize };
+                if (rect.Intersect(area) == area) closed[cell] = 1;
+            }
+        }
+    }
+
+    m_cellOffsets.resize(cells + 1);
+    uint32_t total = 0;
+    for (size_t cell = 0; cell < cells; cell++) {
+        m_cellOffsets[cell] = total;
+        total += (uint32_t)lists[cell].size();
+    }
+    m_cellOffsets[cells] = total;
+    m_cellElements.reserve(total);
+    for (const std::vector<uint32_t>& list : lists) m_cellElements.insert(m_cellElements.end(), list.begin(), list.end());
+
+    m_stats.cells = cells;
+    m_stats.entries = total;
+    m_stats.cellSize = cellSize;
+}
+
+int WindowIndex::HitTest(int x, int y) const {
+    if (x < m_bounds.left || x >= m_bounds.right || y < m_bounds.top || y >= m_bounds.bottom) return -1;
+    size_t cell = (size_t)((y - m_bounds.top) / m_cellSize) * m_columns + (x - m_bounds.left) / m_cellSize;
+    for (uint32_t i = m_cellOffsets[cell]; i < m_cellOffsets[cell + 1]; i++) {
+        const PixelRect& rect = m_elements[m_cellElements[i]].rect;
+        if (x >= rect.left && x < rect.right && y >= rect.top && y < rect.bottom) return (int)m_cellElements[i];
+    }
+    return -1;
+}
+
+int WindowIndex::TopLevel(int element) const {
+    // Bounded walk: a malformed parent chain cannot loop forever
+    for (size_t steps = 0; element >= 0 && steps < m_elements.size(); steps++) {
+        int parent = m_elements[element].parent;
+        if (parent < 0 || parent >= (int)m_elements.size()) break;
+        element = parent;
+    }
+    return element;
+}
+
+} // namespace ScreenCapture
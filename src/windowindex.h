@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "overlaycompositor.h"
+
+namespace ScreenCapture {
+
+// A window or control on the frozen desktop, in overlay coordinates
+struct WindowElement {
+    PixelRect rect;  // Already clipped to its parent
+    int parent;      // Index of the enclosing element, -1 = top level
+};
+
+struct WindowIndexStats {
+    uint64_t elements;
+    uint64_t cells;
+    uint64_t entries;  // Element references stored in cells
+    uint64_t pruned;   // References dropped: the cell is covered by a winner
+    int cellSize;
+};
+
+// Point lookup over a snapshot of window and control rectangles for
+// hover-to-pick. Elements are given in hit-test priority order: the first
+// element containing a point is the answer (controls before the window
+// that holds them, windows front to back). A uniform grid over their
+// bounding box lists, per cell, the elements touching it in that order,
+// and stops listing once an element covers the whole cell, since nothing
+// after it can win there. A query reads one cell's short list. Contains
+// no Win32 code.
+class WindowIndex {
+public:
+    WindowIndex();
+
+    // cellSize 0 = pick from the element count and the covered area
+    void Build(const std::vector<WindowElement>& elements, int cellSize = 0);
+
+    void Clear();
+
+    // Highest-priority element containing (x, y), -1 = none
+    int HitTest(int x, int y) const;
+
+    // The top-level element 'element' belongs to
+    int TopLevel(int element) const;
+
+    size_t Size() const { return m_elements.size(); }
+    const WindowElement& Element(int element) const { return m_elements[element]; }
+
+    WindowIndexStats GetStats() const { return m_stats; }
+
+private:
+    std::vector<WindowElement> m_elements;
+    PixelRect m_bounds;
+    int m_cellSize;
+    int m_columns;
+    int m_rows;
+    std::vector<uint32_t> m_cellOffsets;  // Cells + 1
+    std::vector<uint32_t> m_cellElements;
+    WindowIndexStats m_stats;
+};
+
+} // namespace ScreenCapture
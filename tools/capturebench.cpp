@@ -0,0 +1,98 @@
+// Cold vs warm capture latency through a CaptureSession backend
+// Usage: capturebench [--gdi] [width height] [iterations]
+//   cold = new session per capture, frame pool trimmed (first hotkey after start)
+//   warm = one long-lived session (every later hotkey)
+//   --gdi uses the real screen (Windows only); default is the synthetic backend
+
+#include "../src/capturesession.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+using namespace ScreenCapture;
+
+static std::unique_ptr<CaptureBackend> MakeBackend(bool gdi, int width, int height) {
+#ifdef _WIN32
+    if (gdi) return CreateGdiBackend();
+#else
+    (void)gdi;
+#endif
+    return CreateSyntheticBackend(width, height);
+}
+
+static void Report(const char* name, std::vector<double>& samples) {
+    std::sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    printf("%-14s n=%-4zu min=%7.3fms  median=%7.3fms  p95=%7.3fms  max=%7.3fms\n", name, n,
+           samples[0], samples[n / 2], samples[std::min(n - 1, n * 95 / 100)], samples[n - 1]);
+}
+
+int main(int argc, char** argv) {
+    bool gdi = false;
+    std::vector<int> numbers;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--gdi") == 0) {
+            gdi = true;
+        } else {
+            numbers.push_back(atoi(argv[i]));
+        }
+    }
+    int width = numbers.size() >= 2 ? numbers[0] : 3840;
+    int height = numbers.size() >= 2 ? numbers[1] : 2160;
+    int iterations = numbers.size() == 1 ? numbers[0] : (numbers.size() >= 3 ? numbers[2] : 50);
+    if (width <= 0 || height <= 0 || iterations <= 0) {
+        fprintf(stderr, "usage: %s [--gdi] [width height] [iterations]\n", argv[0]);
+        return 2;
+    }
+
+    const char* backendName = MakeBackend(gdi, width, height)->Name();
+    printf("backend=%s desktop=%dx%d iterations=%d\n", backendName, width, height, iterations);
+
+    std::vector<double> cold, warm, warmRegion;
+    for (int i = 0; i < iterations; i++) {
+        FramePool::Instance().Trim(0);
+        auto start = std::chrono::steady_clock::now();
+        {
+            CaptureSession session(MakeBackend(gdi, width, height), width, height, 2);
+            FrameRef frame = session.Capture(0, 0, width, height);
+            if (!frame) {
+                fprintf(stderr, "cold capture failed\n");
+                return 1;
+            }
+        }
+        cold.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    CaptureSession session(MakeBackend(gdi, width, height), width, height, 2);
+    if (!session.Build()) {
+        fprintf(stderr, "session build failed\n");
+        return 1;
+    }
+    int regionW = width / 3, regionH = height / 3;
+    for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        FrameRef frame = session.Capture(0, 0, width, height);
+        warm.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        if (!frame) {
+            fprintf(stderr, "warm capture failed\n");
+            return 1;
+        }
+        frame = nullptr;
+
+        start = std::chrono::steady_clock::now();
+        frame = session.Capture(width / 3, height / 3, regionW, regionH);
+        warmRegion.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    Report("cold full", cold);
+    Report("warm full", warm);
+    Report("warm region", warmRegion);
+
+    CaptureSessionStats stats = session.GetStats();
+    printf("session: builds=%llu warm=%llu cold=%llu\n", (unsigned long long)stats.builds,
+           (unsigned long long)stats.warm, (unsigned long long)stats.cold);
+    return 0;
+}
@@ -0,0 +1,160 @@
+// Edge map for selection snapping: build time, index size, query cost
+// Usage: edgebench [width height] [windows]
+//   Draws a synthetic desktop (noisy wallpaper, overlapping windows with
+//   1px borders and title bars, text-like speckle), builds the EdgeMap,
+//   checks that the cursor snaps onto every visible window border (or a
+//   nearer edge) from a few pixels away, and times random snap queries. Exits 1 on a failed
+//   check.
+
+#include "../src/edgemap.h"
+#include "../src/framepool.h"
+#include "../src/taskscheduler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace ScreenCapture;
+
+struct Window {
+    int left, top, right, bottom;  // Half-open, border included
+};
+
+static void Fill(const FrameRef& frame, int left, int top, int right, int bottom, uint32_t color) {
+    for (int y = std::max(0, top); y < std::min(frame->Height(), bottom); y++) {
+        uint32_t* row = (uint32_t*)frame->Row(y);
+        for (int x = std::max(0, left); x < std::min(frame->Width(), right); x++) row[x] = color;
+    }
+}
+
+static double Ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    int width = argc >= 3 ? atoi(argv[1]) : 3840;
+    int height = argc >= 3 ? atoi(argv[2]) : 2160;
+    int count = argc == 2 ? atoi(argv[1]) : (argc >= 4 ? atoi(argv[3]) : 12);
+    if (width < 256 || height < 256 || width > 65535 || height > 65535 || count <= 0) {
+        fprintf(stderr, "usage: %s [width height] [windows]\n", argv[0]);
+        return 2;
+    }
+
+    std::mt19937 random(7);
+    FrameRef frame = FramePool::Instance().Acquire(width, height);
+    for (int y = 0; y < height; y++) {
+        uint32_t* row = (uint32_t*)frame->Row(y);
+        for (int x = 0; x < width; x++) {
+            uint32_t shade = 90 + (x + y) * 60 / (width + height) + (random() & 7);  // Wallpaper
+            row[x] = 0xFF000000u | shade << 16 | shade << 8 | (shade + 20);
+        }
+    }
+
+    // Back to front; later windows cover earlier ones
+    std::vector<Window> windows;
+    for (int i = 0; i < count; i++) {
+        int w = width / 8 + (int)(random() % (unsigned)(width / 3));
+        int h = height / 8 + (int)(random() % (unsigned)(height / 3));
+        int left = (int)(random() % (unsigned)(width - w));
+        int top = (int)(random() % (unsigned)(height - h));
+        Window window = { left, top, left + w, top + h };
+        windows.push_back(window);
+        Fill(frame, window.left, window.top, window.right, window.bottom, 0xFF202020);  // Border
+        Fill(frame, window.left + 1, window.top + 1, window.right - 1, window.top + 31, 0xFF2B579A);  // Title
+        Fill(frame, window.left + 1, window.top + 31, window.right - 1, window.bottom - 1, 0xFFF3F3F3);
+        // Text: short dark strokes, below the run length that counts as an edge
+        for (int line = window.top + 45; line + 10 < window.bottom - 4; line += 18) {
+            for (int x = window.left + 12; x + 8 < window.right - 12; x += 7) {
+                if (random() % 3 == 0) continue;
+                Fill(frame, x, line, x + 4, line + 1 + (int)(random() % 9), 0xFF202020);
+            }
+        }
+    }
+
+    printf("desktop=%dx%d windows=%d workers=%d\n", width, height, count, TaskScheduler::Instance().WorkerCount());
+
+    EdgeMap map;
+    std::vector<double> times;
+    for (int i = 0; i < 5; i++) {
+        auto start = std::chrono::steady_clock::now();
+        map.Build(frame->Bits(), frame->Stride(), width, height);
+        times.push_back(Ms(start));
+    }
+    std::sort(times.begin(), times.end());
+    EdgeMapStats stats = map.GetStats();
+    printf("build: median %.2fms (min %.2fms, max %.2fms)\n", times[2], times[0], times[4]);
+    printf("index: %llu vertical + %llu horizontal runs, %llu entries, %.1f KB\n",
+           (unsigned long long)stats.verticalRuns, (unsigned long long)stats.horizontalRuns,
+           (unsigned long long)stats.entries, stats.bytes / 1024.0);
+
+    // Every border side that is not covered by a later window must attract
+    // the cursor from 'offset' pixels on either side
+    const int radius = 8;
+    int checked = 0, failed = 0;
+    for (size_t i = 0; i < windows.size(); i++) {
+        const Window& w = windows[i];
+        auto visible = [&](int x, int y) {
+            for (size_t j = i + 1; j < windows.size(); j++) {
+                const Window& c = windows[j];
+                if (x >= c.left - radius && x < c.right + radius && y >= c.top - radius && y < c.bottom + radius) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        int midX = (w.left + w.right) / 2, midY = (w.top + w.bottom) / 2;
+        struct Probe { bool column; int x, y, expected; } probes[] = {
+            { true, w.left, midY, w.left }, { true, w.right, midY, w.right },
+            { false, midX, w.top, w.top }, { false, midX, w.bottom, w.bottom },
+        };
+        for (const Probe& probe : probes) {
+            if (!visible(probe.x, probe.y) || probe.expected <= 0 ||
+                probe.expected >= (probe.column ? width : height)) continue;
+            for (int offset = -3; offset <= 3; offset += 6) {
+                int from = (probe.column ? probe.x : probe.y) + offset;
+                int got = probe.column ? map.SnapColumn(from, probe.y, radius) : map.SnapRow(probe.x, from, radius);
+                // A 1px border has an edge on each side, and on a crowded
+                // desktop another window's edge may be nearer still
+                bool ok = got >= 0 && abs(got - from) <= abs(probe.expected - from) + 1;
+                checked++;
+                if (!ok) {
+                    failed++;
+                    fprintf(stderr, "window %zu: %s snap from %d got %d, expected %d\n", i,
+                            probe.column ? "column" : "row", from, got, probe.expected);
+                }
+            }
+        }
+    }
+
+    // Text must not attract the cursor
+    int textSnaps = 0, textProbes = 0;
+    if (!windows.empty()) {
+        const Window& top = windows.back();
+        for (int y = top.top + 50; y < top.bottom - 20; y += 37) {
+            for (int x = top.left + 40; x < top.right - 40; x += 53) {
+                textProbes++;
+                if (map.SnapColumn(x, y, 4) >= 0) textSnaps++;
+            }
+        }
+    }
+
+    const int queries = 2000000;
+    std::vector<int> xs(4096), ys(4096);
+    for (size_t i = 0; i < xs.size(); i++) {
+        xs[i] = (int)(random() % (unsigned)width);
+        ys[i] = (int)(random() % (unsigned)height);
+    }
+    long long sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < queries; i++) {
+        int x = xs[i & 4095], y = ys[(i * 7) & 4095];
+        sink += map.SnapColumn(x, y, radius) + map.SnapRow(x, y, radius);
+    }
+    double queryMs = Ms(start);
+
+    printf("snap: %.1fns per move (column + row)%s\n", queryMs * 1e6 / queries, sink == 42 ? " " : "");
+    printf("checks: %d border snaps, %d failed; text probes snapped %d/%d\n", checked, failed, textSnaps, textProbes);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,158 @@
+// Collision checks and timing for the duplicate-capture hashes
+// Usage: hashcheck [width height]
+//   Builds a synthetic screenshot and checks that small moves change both
+//   HashPixels and CheckPixels: a 1-px caret shifted by 1..64 px, two
+//   32-byte stripes of a row swapped, two rows or two bands swapped, single
+//   bit flips, a narrow odd-width frame. Row padding must not change them.
+//   Then times both hashes. Exits 1 on a failed check.
+
+#include "../src/framehash.h"
+#include "../src/taskscheduler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace ScreenCapture;
+
+static int g_failures = 0;
+
+static void Check(bool ok, const char* what) {
+    if (!ok) {
+        g_failures++;
+        printf("  FAIL %s\n", what);
+    }
+}
+
+struct Image {
+    int width, height, stride;  // Stride in pixels
+    std::vector<uint32_t> pixels;
+
+    uint32_t& At(int x, int y) { return pixels[(size_t)y * stride + x]; }
+    const uint8_t* Bits() const { return (const uint8_t*)pixels.data(); }
+    FrameHash Hash() const { return HashPixels(Bits(), width, height, stride * 4); }
+    uint64_t CheckHash() const { return CheckPixels(Bits(), width, height, stride * 4); }
+};
+
+// Flat window backgrounds with short runs of "text"
+static Image MakeScreen(int width, int height, int padding, unsigned seed) {
+    Image image = { width, height, width + padding, {} };
+    image.pixels.assign((size_t)image.stride * height, 0);
+    std::mt19937 random(seed);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < image.stride; x++) {
+            uint32_t background = (x / 200 + y / 150) % 2 ? 0xFFF0F0F0u : 0xFFFFFFFFu;
+            bool text = (y % 20) < 12 && (x % 300) < 220 && (random() % 5) == 0;
+            image.At(x, y) = x >= width ? (uint32_t)random() : (text ? 0xFF202020u : background);
+        }
+    }
+    return image;
+}
+
+// Both hashes of 'a' and 'b' differ
+static void CheckDiffer(const Image& a, const Image& b, const char* what) {
+    Check(!(a.Hash() == b.Hash()), what);
+    Check(a.CheckHash() != b.CheckHash(), what);
+}
+
+static void DrawCaret(Image& image, int x, int y) {
+    for (int i = 0; i < 16; i++) image.At(x, y + i) = 0xFF000000u;
+}
+
+static double Median(std::vector<double> times) {
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+int main(int argc, char** argv) {
+    int width = argc >= 3 ? atoi(argv[1]) : 1920;
+    int height = argc >= 3 ? atoi(argv[2]) : 1080;
+    if (width < 256 || height < 256) {
+        fprintf(stderr, "usage: %s [width height]  (at least 256x256)\n", argv[0]);
+        return 2;
+    }
+
+    Image base = MakeScreen(width, height, 0, 5);
+    Image padded = MakeScreen(width, height, 24, 6);
+    for (int y = 0; y < height; y++) memcpy(&padded.At(0, y), &base.At(0, y), (size_t)width * 4);
+    Check(base.Hash() == padded.Hash() && base.CheckHash() == padded.CheckHash(), "row padding changes the hash");
+
+    // The reported collision: a caret moved along its row
+    char what[128];
+    Image caret = base;
+    DrawCaret(caret, 100, 100);
+    for (int shift : { 1, 2, 3, 4, 7, 8, 16, 24, 32, 64 }) {
+        Image moved = base;
+        DrawCaret(moved, 100 + shift, 100);
+        snprintf(what, sizeof(what), "caret moved %d px", shift);
+        CheckDiffer(caret, moved, what);
+    }
+
+    // Two 32-byte stripes of one row swapped
+    Image stripes = base;
+    for (int x = 0; x < 8; x++) std::swap(stripes.At(16 + x, 40), stripes.At(64 + x, 40));
+    for (int x = 0; x < 8; x++) stripes.At(16 + x, 40) ^= 0x00010203u * (x + 1);
+    Image swapped = stripes;
+    for (int x = 0; x < 8; x++) std::swap(swapped.At(16 + x, 40), swapped.At(64 + x, 40));
+    CheckDiffer(stripes, swapped, "stripes swapped");
+
+    // Two rows, then two 64-row bands swapped
+    Image rows = caret;
+    for (int x = 0; x < width; x++) std::swap(rows.At(x, 101), rows.At(x, 140));
+    CheckDiffer(caret, rows, "rows swapped");
+    Image bands = caret;
+    for (int y = 64; y < 128; y++) {
+        for (int x = 0; x < width; x++) std::swap(bands.At(x, y), bands.At(x, y + 64));
+    }
+    CheckDiffer(caret, bands, "bands swapped");
+
+    // Single bit flips anywhere in the frame
+    std::mt19937 random(7);
+    int flips = 0;
+    for (int i = 0; i < 64; i++) {
+        Image flipped = caret;
+        int x = (int)(random() % (unsigned)width), y = (int)(random() % (unsigned)height);
+        flipped.At(x, y) ^= 1u << (random() % 32);
+        snprintf(what, sizeof(what), "bit flip at %d,%d", x, y);
+        int before = g_failures;
+        CheckDiffer(caret, flipped, what);
+        if (g_failures == before) flips++;
+    }
+
+    // Odd width: the per-pixel tail after the last full stripe
+    Image narrow = MakeScreen(37, 40, 3, 9);
+    Image narrowMoved = narrow;
+    std::swap(narrowMoved.At(33, 10), narrowMoved.At(35, 10));
+    narrowMoved.At(33, 10) ^= 0xFFu;
+    Image narrowBack = narrowMoved;
+    std::swap(narrowBack.At(33, 10), narrowBack.At(35, 10));
+    CheckDiffer(narrowMoved, narrowBack, "tail pixels swapped");
+
+    printf("checks: caret shifts, stripe/row/band swaps, %d/64 bit flips, tail; %d failed\n", flips, g_failures);
+
+    std::vector<double> hashTimes, checkTimes;
+    uint64_t sink = 0;
+    for (int i = 0; i < 7; i++) {
+        auto start = std::chrono::steady_clock::now();
+        sink ^= base.Hash().lo;
+        auto mid = std::chrono::steady_clock::now();
+        sink ^= base.CheckHash();
+        auto end = std::chrono::steady_clock::now();
+        hashTimes.push_back(std::chrono::duration<double, std::milli>(mid - start).count());
+        checkTimes.push_back(std::chrono::duration<double, std::milli>(end - mid).count());
+    }
+    double mb = (double)width * height * 4 / 1048576.0;
+    double hashMs = Median(hashTimes), checkMs = Median(checkTimes);
+    printf("frame=%dx%d (%.1fMB) workers=%d\n", width, height, mb, TaskScheduler::Instance().WorkerCount());
+    printf("HashPixels %.2fms (%.0fMB/s), CheckPixels %.2fms (%.0fMB/s), median of 7 [%016llx]\n", hashMs,
+           mb * 1000.0 / hashMs, checkMs, mb * 1000.0 / checkMs, (unsigned long long)sink);
+
+    if (g_failures) {
+        fprintf(stderr, "%d hash checks failed\n", g_failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,207 @@
+// Exact coverage checks for BuildMonitorLayout / FillDeadAreas
+// Usage: layoutcheck [-v] [random layouts]
+//   Stitches each layout the way CaptureMonitors does (every monitor copied
+//   into the bounding box, then the dead areas filled) into a padded frame
+//   and checks it pixel by pixel: bounds are the exact box of the non-empty
+//   monitors, every monitor pixel is copied exactly once with the desktop
+//   pixel it shows, every other pixel of the box is filled exactly once, no
+//   dead area touches a monitor, and the row padding is never written.
+//   Fixed layouts (offsets, negative origins, portrait monitors, gaps) and
+//   random non-overlapping ones. Exit code 1 if any check fails.
+
+#include "../src/monitorlayout.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ScreenCapture;
+
+static const uint32_t FILL = 0xFF000000u;
+static const uint32_t UNTOUCHED = 0x5A5A5A5Au;
+static const int PADDING = 7;  // Pixels of row padding past the box
+
+static int g_failures = 0;
+static bool g_verbose = false;
+
+struct Layout {
+    std::string name;
+    std::vector<ScreenRect> monitors;  // Desktop coordinates
+};
+
+// What the desktop shows at x, y; never FILL or UNTOUCHED
+static uint32_t DesktopPixel(int x, int y) {
+    return 0x01000000u | ((uint32_t)x & 0xFFF) << 12 | ((uint32_t)y & 0xFFF);
+}
+
+static bool Check(bool ok, const Layout& layout, const char* what) {
+    if (!ok) {
+        g_failures++;
+        printf("  FAIL %s: %s\n", layout.name.c_str(), what);
+    }
+    return ok;
+}
+
+static void CheckLayout(const Layout& input) {
+    MonitorLayout layout = BuildMonitorLayout(input.monitors);
+
+    // Bounds: the box of the non-empty monitors
+    std::vector<ScreenRect> screens;
+    for (const ScreenRect& r : input.monitors) {
+        if (r.width > 0 && r.height > 0) screens.push_back(r);
+    }
+    if (screens.empty()) {
+        Check(layout.monitors.empty() && layout.deadAreas.empty(), input, "empty input gives monitors");
+        return;
+    }
+    int left = screens[0].x, top = screens[0].y, right = left, bottom = top;
+    for (const ScreenRect& r : screens) {
+        left = std::min(left, r.x);
+        top = std::min(top, r.y);
+        right = std::max(right, r.x + r.width);
+        bottom = std::max(bottom, r.y + r.height);
+    }
+    const ScreenRect& b = layout.bounds;
+    if (!Check(b.x == left && b.y == top && b.width == right - left && b.height == bottom - top, input,
+               "bounds are not the box of the monitors")) {
+        return;
+    }
+    if (!Check(layout.monitors.size() == screens.size(), input, "monitor count")) return;
+    for (size_t i = 0; i < screens.size(); i++) {
+        const ScreenRect& m = layout.monitors[i];
+        Check(m.x == screens[i].x - left && m.y == screens[i].y - top && m.width == screens[i].width &&
+                  m.height == screens[i].height, input, "monitor not relative to bounds, or reordered");
+    }
+
+    // Dead areas: non-empty, inside the box, top to bottom
+    for (size_t i = 0; i < layout.deadAreas.size(); i++) {
+        const ScreenRect& r = layout.deadAreas[i];
+        if (!Check(r.width > 0 && r.height > 0 && r.x >= 0 && r.y >= 0 && r.x + r.width <= b.width &&
+                       r.y + r.height <= b.height, input, "dead area empty or outside the box")) {
+            return;
+        }
+        if (i > 0) {
+            const ScreenRect& p = layout.deadAreas[i - 1];
+            Check(p.y < r.y || (p.y == r.y && p.x < r.x), input, "dead areas not top to bottom");
+        }
+    }
+
+    // Stitch: copy every monitor, count the copies and fills per pixel
+    const int stride = b.width + PADDING;
+    std::vector<uint32_t> frame((size_t)stride * b.height, UNTOUCHED);
+    std::vector<uint8_t> copies((size_t)b.width * b.height, 0), fills((size_t)b.width * b.height, 0);
+    for (const ScreenRect& m : layout.monitors) {
+        for (int y = m.y; y < m.y + m.height; y++) {
+            for (int x = m.x; x < m.x + m.width; x++) {
+                frame[(size_t)y * stride + x] = DesktopPixel(b.x + x, b.y + y);
+                copies[(size_t)y * b.width + x]++;
+            }
+        }
+    }
+    for (const ScreenRect& r : layout.deadAreas) {
+        for (int y = r.y; y < r.y + r.height; y++) {
+            for (int x = r.x; x < r.x + r.width; x++) fills[(size_t)y * b.width + x]++;
+        }
+    }
+    FillDeadAreas((uint8_t*)frame.data(), stride * 4, layout.deadAreas, FILL);
+
+    size_t monitorPixels = 0, deadPixels = 0, wrongCopies = 0, wrongFills = 0, wrongPixels = 0, padding = 0;
+    for (int y = 0; y < b.height; y++) {
+        for (int x = 0; x < stride; x++) {
+            uint32_t value = frame[(size_t)y * stride + x];
+            if (x >= b.width) {
+                if (value != UNTOUCHED) padding++;
+                continue;
+            }
+            size_t i = (size_t)y * b.width + x;
+            if (copies[i]) {
+                monitorPixels++;
+                if (copies[i] != 1) wrongCopies++;
+                if (fills[i]) wrongFills++;  // A dead area over a monitor
+                if (value != DesktopPixel(b.x + x, b.y + y)) wrongPixels++;
+            } else {
+                deadPixels++;
+                if (fills[i] != 1) wrongFills++;
+                if (value != FILL) wrongPixels++;
+            }
+        }
+    }
+    size_t expectedMonitorPixels = 0;
+    for (const ScreenRect& m : screens) expectedMonitorPixels += (size_t)m.width * m.height;
+
+    Check(wrongCopies == 0 && monitorPixels == expectedMonitorPixels, input, "monitor pixels not copied exactly once");
+    Check(wrongFills == 0, input, "dead pixel not filled exactly once, or filled over a monitor");
+    Check(wrongPixels == 0, input, "stitched pixel has the wrong value");
+    Check(padding == 0, input, "row padding written");
+    Check(layout.DeadPixels() == deadPixels, input, "DeadPixels() disagrees with the coverage");
+    if (g_verbose) {
+        printf("  %-22s bounds %d,%d %dx%d, %zu monitors, %zu dead areas (%zu px)\n", input.name.c_str(), b.x, b.y,
+               b.width, b.height, layout.monitors.size(), layout.deadAreas.size(), deadPixels);
+    }
+}
+
+static bool Overlaps(const ScreenRect& a, const ScreenRect& b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+int main(int argc, char** argv) {
+    int randomLayouts = 300;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) g_verbose = true;
+        else if (atoi(argv[i]) > 0) randomLayouts = atoi(argv[i]);
+        else {
+            fprintf(stderr, "usage: %s [-v] [random layouts]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<Layout> layouts = {
+        { "single", { { 0, 0, 1920, 1080 } } },
+        { "side by side", { { 0, 0, 1920, 1080 }, { 1920, 0, 1920, 1080 } } },
+        { "different heights", { { 0, 0, 2560, 1440 }, { 2560, 0, 1920, 1080 } } },
+        { "vertical offset", { { 0, 0, 1920, 1080 }, { 1920, 300, 1920, 1080 } } },
+        { "negative origin", { { -1920, -200, 1920, 1080 }, { 0, 0, 2560, 1440 } } },
+        { "portrait both sides", { { -1080, -420, 1080, 1920 }, { 0, 0, 2560, 1440 }, { 2560, -240, 1080, 1920 } } },
+        { "stacked, offset", { { 0, 0, 2560, 1440 }, { 320, -1080, 1920, 1080 } } },
+        { "horizontal gap", { { 0, 0, 1920, 1080 }, { 2200, 500, 1280, 1024 } } },
+        { "vertical gap", { { 0, 0, 1920, 1080 }, { 400, -1300, 1280, 1024 } } },
+        { "L of three", { { 0, 0, 1920, 1080 }, { 1920, 0, 1920, 1080 }, { 0, 1080, 1920, 1080 } } },
+        { "grid with hole", { { 0, 0, 800, 600 }, { 800, 0, 800, 600 }, { 1600, 0, 800, 600 },
+                              { 0, 600, 800, 600 }, { 1600, 600, 800, 600 },
+                              { 0, 1200, 800, 600 }, { 800, 1200, 800, 600 }, { 1600, 1200, 800, 600 } } },
+        { "empty monitor dropped", { { 0, 0, 0, 1080 }, { -500, -500, 1920, 0 }, { 100, 50, 1280, 720 } } },
+        { "all empty", { { 0, 0, 0, 0 } } },
+    };
+
+    // Random non-overlapping monitors, possibly negative, touching or not
+    std::mt19937 random(3);
+    for (int n = 0; n < randomLayouts; n++) {
+        Layout layout = { "random " + std::to_string(n), {} };
+        int count = 1 + (int)(random() % 5);
+        for (int tries = 0; (int)layout.monitors.size() < count && tries < 200; tries++) {
+            ScreenRect r = { (int)(random() % 600) - 300, (int)(random() % 600) - 300, 10 + (int)(random() % 200),
+                             10 + (int)(random() % 200) };
+            // Snap next to an existing monitor half the time, like real arrangements
+            if (!layout.monitors.empty() && random() % 2) {
+                const ScreenRect& other = layout.monitors[random() % layout.monitors.size()];
+                switch (random() % 4) {
+                    case 0: r.x = other.x + other.width; break;
+                    case 1: r.x = other.x - r.width; break;
+                    case 2: r.y = other.y + other.height; break;
+                    default: r.y = other.y - r.height; break;
+                }
+            }
+            bool free = true;
+            for (const ScreenRect& other : layout.monitors) free = free && !Overlaps(r, other);
+            if (free) layout.monitors.push_back(r);
+        }
+        layouts.push_back(layout);
+    }
+
+    for (const Layout& layout : layouts) CheckLayout(layout);
+    printf("%zu layouts (%d random), %d failed checks\n", layouts.size(), randomLayouts, g_failures);
+    return g_failures ? 1 : 0;
+}
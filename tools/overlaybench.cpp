@@ -0,0 +1,128 @@
+// Region-selection overlay redraw cost: pixels touched per mouse move
+// Usage: overlaybench [width height] [moves] [--verify]
+//   legacy = restore InflateRect(old, 3, 30), redraw, blit the UnionRect of
+//            the inflated old and new rectangles (the GDI overlay before
+//            the compositor)
+//   damage = OverlayCompositor strips (changed border edges, pixels entering
+//            or leaving the undimmed selection, label; the last drag also
+//            moves the 8x magnifier loupe with the cursor)
+//   --verify compares the incremental buffer with a full render every move
+
+#include "../src/overlaycompositor.h"
+#include "../src/framepool.h"
+#include "../src/pixelconvert.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+using namespace ScreenCapture;
+
+static PixelRect Inflate(const PixelRect& rect, int dx, int dy) {
+    return { rect.left - dx, rect.top - dy, rect.right + dx, rect.bottom + dy };
+}
+
+static PixelRect Union(const PixelRect& a, const PixelRect& b) {
+    return { std::min(a.left, b.left), std::min(a.top, b.top), std::max(a.right, b.right), std::max(a.bottom, b.bottom) };
+}
+
+struct Drag {
+    const char* name;
+    int startX, startY;
+    int stepX, stepY;  // Per mouse move
+    bool loupe;        // Cursor at the moving corner, loupe shown
+};
+
+int main(int argc, char** argv) {
+    bool verify = false;
+    std::vector<int> numbers;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--verify") == 0) {
+            verify = true;
+        } else {
+            numbers.push_back(atoi(argv[i]));
+        }
+    }
+    int width = numbers.size() >= 2 ? numbers[0] : 3840;
+    int height = numbers.size() >= 2 ? numbers[1] : 2160;
+    int moves = numbers.size() == 1 ? numbers[0] : (numbers.size() >= 3 ? numbers[2] : 400);
+    if (width < 64 || height < 64 || moves <= 0) {
+        fprintf(stderr, "usage: %s [width height] [moves] [--verify]\n", argv[0]);
+        return 2;
+    }
+
+    FrameRef source = FramePool::Instance().Acquire(width, height);
+    FrameRef target = FramePool::Instance().Acquire(width, height);
+    FrameRef reference = verify ? FramePool::Instance().Acquire(width, height) : nullptr;
+    for (int y = 0; y < height; y++) {
+        uint32_t* row = (uint32_t*)source->Row(y);
+        for (int x = 0; x < width; x++) row[x] = 0xFF000000u | (uint32_t)(x * 2654435761u ^ y * 40503u);
+    }
+
+    // A large selection nudged a few pixels at a time, then grown quickly
+    Drag drags[] = {
+        { "small moves", width / 8, height / 8, 2, 1, false },
+        { "fast drag", width / 8, height / 8, 9, 5, false },
+        { "from origin", 0, 0, 3, 2, false },
+        { "with loupe", width / 8, height / 8, 2, 1, true },
+    };
+
+    printf("desktop=%dx%d moves=%d%s\n", width, height, moves, verify ? " (verified)" : "");
+    for (const Drag& drag : drags) {
+        OverlayCompositor compositor;
+        std::vector<PixelRect> damage;
+        auto attachStart = std::chrono::steady_clock::now();
+        compositor.Attach(source->Bits(), source->Stride(), target->Bits(), target->Stride(),
+                          width, height, OverlayStyle::Default(), &damage);
+        if (&drag == drags) {
+            printf("attach (dimmed backdrop, %s): %.2fms\n", PixelConvertIsa(),
+                   std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - attachStart).count());
+        }
+        CompositorStats base = compositor.GetStats();
+
+        uint64_t legacyPixels = 0;
+        PixelRect last = { 0, 0, 0, 0 };
+        double ms = 0;
+        int endX = width * 7 / 8, endY = height * 7 / 8;
+        for (int i = 0; i < moves; i++) {
+            int x = std::min(width - 1, endX - (moves - 1 - i) * drag.stepX);
+            int y = std::min(height - 1, endY - (moves - 1 - i) * drag.stepY);
+            PixelRect selection = { std::min(drag.startX, x), std::min(drag.startY, y),
+                                    std::max(drag.startX, x), std::max(drag.startY, y) };
+
+            PixelRect blit = Inflate(selection, 3, 30);
+            if (!last.Empty()) {
+                PixelRect restored = Inflate(last, 3, 30);
+                legacyPixels += (uint64_t)restored.Intersect({ 0, 0, width, height }).Area();
+                blit = Union(blit, restored);
+            }
+            legacyPixels += (uint64_t)blit.Intersect({ 0, 0, width, height }).Area();
+            last = selection;
+
+            auto start = std::chrono::steady_clock::now();
+            OverlayCursor cursor = { x, y, drag.loupe };
+            compositor.SetView(selection, cursor, &damage);
+            ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            if (verify) {
+                compositor.RenderFull(selection, cursor, reference->Bits(), reference->Stride());
+                for (int row = 0; row < height; row++) {
+                    if (memcmp(reference->Row(row), target->Row(row), (size_t)width * 4) != 0) {
+                        fprintf(stderr, "%s: move %d row %d differs from a full render\n", drag.name, i, row);
+                        return 1;
+                    }
+                }
+            }
+        }
+
+        CompositorStats stats = compositor.GetStats();
+        uint64_t touched = stats.pixelsTouched - base.pixelsTouched;
+        uint64_t strips = stats.strips - base.strips;
+        printf("%-12s legacy %9.0f px/move   damage %7.0f px/move in %5.1f strips (%.2f%%)  %.3fms/move\n",
+               drag.name, (double)legacyPixels / moves, (double)touched / moves, (double)strips / moves,
+               legacyPixels ? touched * 100.0 / legacyPixels : 0.0, ms / moves);
+    }
+    return 0;
+}
@@ -0,0 +1,235 @@
+// Overlay input-to-present delay, rendering on the input thread vs on a
+// dedicated render thread fed through a triple buffer
+// Usage: overlaylatency [width height] [--rate HZ] [--seconds S] [--fps N]
+//                       [--present-us N]
+//   Mouse moves arrive at --rate on a steady clock. Each frame composes the
+//   selection and the magnifier loupe (OverlayCompositor), copies the damage strips to a "window"
+//   buffer, spends --present-us more (standing in for GetDC/BitBlt) and
+//   writes the overlay's every-10th-frame log line to a file.
+//   inline   = the input thread renders whenever the pacer allows (the
+//              overlay before the render thread)
+//   threaded = the input thread publishes, OverlayRenderThread renders
+//   Reported per mode: input delay (arrival -> handled by the input thread)
+//   and input-to-present (arrival -> frame presented), p50/p90/p99/max.
+
+#include "../src/overlayrenderer.h"
+#include "../src/framepool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace ScreenCapture;
+
+struct Options {
+    int width = 3840;
+    int height = 2160;
+    int rateHz = 1000;
+    double seconds = 3;
+    int fps = 120;
+    int presentUs = 1500;
+};
+
+struct Result {
+    LatencyHistogram inputDelay;
+    LatencyHistogram inputToPresent;
+    uint64_t moves = 0;
+    uint64_t frames = 0;
+    bool finalDrawn = false;
+};
+
+// Everything one frame does, on whichever thread renders
+class FrameWork {
+public:
+    FrameWork(const Options& options, const FrameRef& source, const std::string& logPath)
+        : m_options(options), m_logPath(logPath), m_frames(0) {
+        m_target = FramePool::Instance().Acquire(options.width, options.height);
+        m_window = FramePool::Instance().Acquire(options.width, options.height);
+        m_compositor.Attach(source->Bits(), source->Stride(), m_target->Bits(), m_target->Stride(),
+                            options.width, options.height, OverlayStyle::Default(), &m_damage);
+    }
+
+    void Draw(const PixelRect& selection, const SteadyTimerClock& clock) {
+        int64_t start = clock.NowUs();
+        m_compositor.SetView(selection, { selection.right - 1, selection.bottom - 1, true }, &m_damage);
+        for (const PixelRect& strip : m_damage) {
+            for (int y = strip.top; y < strip.bottom; y++) {
+                memcpy(m_window->Row(y) + (size_t)strip.left * 4, m_target->Row(y) + (size_t)strip.left * 4,
+                       (size_t)strip.Width() * 4);
+            }
+        }
+        while (clock.NowUs() - start < m_options.presentUs) {
+        }
+        if (++m_frames % 10 == 0) {
+            FILE* f = fopen(m_logPath.c_str(), "a");
+            if (f) {
+                fprintf(f, "[PERF] Frame %d: Render=%.2fms Damage=%d strips\n", m_frames,
+                        (clock.NowUs() - start) / 1000.0, (int)m_damage.size());
+                fclose(f);
+            }
+        }
+    }
+
+private:
+    const Options& m_options;
+    std::string m_logPath;
+    FrameRef m_target;
+    FrameRef m_window;
+    OverlayCompositor m_compositor;
+    std::vector<PixelRect> m_damage;
+    int m_frames;
+};
+
+// Selection after move 'i': the corner sweeps a diagonal back and forth
+static PixelRect SelectionAt(const Options& options, uint64_t i) {
+    int span = options.width * 3 / 4;
+    int step = (int)((i * 3) % (uint64_t)(2 * span));
+    int offset = step < span ? step : 2 * span - step;
+    int x0 = options.width / 8, y0 = options.height / 8;
+    return { x0, y0, x0 + 1 + offset, y0 + 1 + offset * options.height / options.width };
+}
+
+static Result RunInline(const Options& options, const FrameRef& source, const std::string& logPath) {
+    Result result;
+    SteadyTimerClock clock;
+    FrameWork work(options, source, logPath);
+    FramePacer pacer(clock, 1000000 / options.fps);
+    const int64_t period = 1000000 / options.rateHz;
+    const uint64_t moves = (uint64_t)(options.seconds * options.rateHz);
+    const int64_t start = clock.NowUs() + 10000;
+    uint64_t latest = 0;
+
+    // The overlay's message loop: handle the next move when it is due, and
+    // draw a held-back one when its frame slot comes
+    uint64_t next = 0;
+    while (next < moves || pacer.NextDeadlineUs() >= 0) {
+        int64_t arrival = start + (int64_t)next * period;
+        int64_t deadline = pacer.NextDeadlineUs();
+        if (next < moves && (deadline < 0 || arrival <= deadline)) {
+            clock.SleepUntilUs(arrival);
+            result.inputDelay.Add(clock.NowUs() - arrival);
+            PixelRect selection = SelectionAt(options, next);
+            latest = next++;
+            pacer.Submit(selection.right, selection.bottom);
+        } else {
+            clock.SleepUntilUs(deadline);
+        }
+        int x, y;
+        if (pacer.BeginFrame(&x, &y)) {
+            work.Draw(SelectionAt(options, latest), clock);
+            result.inputToPresent.Add(clock.NowUs() - (start + (int64_t)latest * period));
+            result.frames++;
+            result.finalDrawn = latest == moves - 1;
+        }
+    }
+    result.moves = moves;
+    return result;
+}
+
+static Result RunThreaded(const Options& options, const FrameRef& source, const std::string& logPath,
+                          OverlayRenderStats* stats) {
+    Result result;
+    SteadyTimerClock clock;
+    FrameWork work(options, source, logPath);
+    const int64_t period = 1000000 / options.rateHz;
+    const uint64_t moves = (uint64_t)(options.seconds * options.rateHz);
+    const int64_t start = clock.NowUs() + 10000;
+
+    // Render-thread side; read by this thread only after Stop()
+    LatencyHistogram presented;
+    uint64_t lastDrawn = 0;
+    OverlayRenderThread renderer(clock, 1000000 / options.fps);
+    renderer.Start([&](const OverlayState& state) {
+        work.Draw(state.selection, clock);
+        presented.Add(clock.NowUs() - (start + (int64_t)(state.sequence - 1) * period));
+        lastDrawn = state.sequence;
+    });
+
+    for (uint64_t i = 0; i < moves; i++) {
+        int64_t arrival = start + (int64_t)i * period;
+        clock.SleepUntilUs(arrival);
+        result.inputDelay.Add(clock.NowUs() - arrival);
+        PixelRect selection = SelectionAt(options, i);
+        renderer.Publish(selection, { selection.right - 1, selection.bottom - 1, true });
+    }
+
+    // Let the trailing frame land
+    int64_t settle = clock.NowUs() + 4 * 1000000 / options.fps + 4 * options.presentUs + 50000;
+    clock.SleepUntilUs(settle);
+    renderer.Stop();
+
+    *stats = renderer.GetStats();
+    result.inputToPresent = presented;
+    result.moves = moves;
+    result.frames = stats->rendered;
+    result.finalDrawn = lastDrawn == moves;
+    return result;
+}
+
+static void PrintHistogram(const char* name, const LatencyHistogram& histogram) {
+    printf("  %-16s p50<=%7.2fms p90<=%7.2fms p99<=%7.2fms max=%7.2fms\n", name,
+           histogram.PercentileUs(0.50) / 1000.0, histogram.PercentileUs(0.90) / 1000.0,
+           histogram.PercentileUs(0.99) / 1000.0, histogram.Max() / 1000.0);
+}
+
+static void PrintResult(const char* mode, const Result& result, const Options& options) {
+    printf("%s: %llu moves, %llu frames (%.1f fps), final move %s\n", mode,
+           (unsigned long long)result.moves, (unsigned long long)result.frames, result.frames / options.seconds,
+           result.finalDrawn ? "drawn" : "LOST");
+    PrintHistogram("input delay", result.inputDelay);
+    PrintHistogram("input->present", result.inputToPresent);
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    std::vector<int> numbers;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            options.rateHz = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            options.seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            options.fps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--present-us") == 0 && i + 1 < argc) {
+            options.presentUs = atoi(argv[++i]);
+        } else {
+            numbers.push_back(atoi(argv[i]));
+        }
+    }
+    if (numbers.size() >= 2) {
+        options.width = numbers[0];
+        options.height = numbers[1];
+    }
+    if (options.width < 64 || options.height < 64 || options.rateHz <= 0 || options.rateHz > 100000 ||
+        options.seconds <= 0 || options.fps <= 0 || options.presentUs < 0) {
+        fprintf(stderr, "usage: %s [width height] [--rate HZ] [--seconds S] [--fps N] [--present-us N]\n", argv[0]);
+        return 2;
+    }
+
+    FrameRef source = FramePool::Instance().Acquire(options.width, options.height);
+    for (int y = 0; y < options.height; y++) {
+        uint32_t* row = (uint32_t*)source->Row(y);
+        for (int x = 0; x < options.width; x++) row[x] = 0xFF000000u | (uint32_t)(x * 2654435761u ^ y * 40503u);
+    }
+    std::string logPath = (std::filesystem::temp_directory_path() / "overlaylatency_log.txt").string();
+
+    printf("desktop=%dx%d input=%dHz fps cap=%d present=%dus %.1fs, %u hardware threads\n", options.width,
+           options.height, options.rateHz, options.fps, options.presentUs, options.seconds,
+           std::thread::hardware_concurrency());
+    Result inlineResult = RunInline(options, source, logPath);
+    PrintResult("inline", inlineResult, options);
+    OverlayRenderStats stats;
+    Result threadedResult = RunThreaded(options, source, logPath, &stats);
+    PrintResult("threaded", threadedResult, options);
+    printf("  render thread    published=%llu rendered=%llu superseded=%llu wakeups=%llu render p99<=%.2fms\n",
+           (unsigned long long)stats.published, (unsigned long long)stats.rendered,
+           (unsigned long long)stats.superseded, (unsigned long long)stats.wakeups,
+           stats.render.PercentileUs(0.99) / 1000.0);
+
+    std::error_code ignored;
+    std::filesystem::remove(logPath, ignored);
+    return inlineResult.finalDrawn && threadedResult.finalDrawn ? 0 : 1;
+}
@@ -0,0 +1,401 @@
+// Replay recorded region-selection sessions through the overlay's input
+// logic and renderer, headless
+// Usage: overlayreplay [--fps N] [--verify] [trace ...]
+//   Traces come from the overlay with [Overlay] RecordInput=1. Without any,
+//   built-in sessions are replayed (hover then click a control, Ctrl-click
+//   a window, a snapped drag between window corners, a slow Alt drag);
+//   they also check the trace format round trip and the chosen region.
+//
+//   The frozen frame is synthetic: wallpaper with the session's window
+//   snapshot drawn on it, so edges sit where the windows were. Events are
+//   applied at their recorded times on a simulated clock; frames follow
+//   FramePacer at the session's frame interval (--fps overrides), and each
+//   frame runs OverlayCompositor::SetView plus a copy of the damage strips
+//   (standing in for the BitBlt), timed for real. A frame that starts a
+//   whole interval or more after its slot, because the previous one was
+//   still rendering, counts the skipped slots as dropped.
+//   --verify compares the composed buffer with a full render every frame.
+//   Exits 1 on a failed check.
+
+#include "../src/overlayinput.h"
+#include "../src/framepacer.h"
+#include "../src/framepool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ScreenCapture;
+
+struct Session {
+    std::string name;
+    InputTrace trace;
+    bool checkResult;  // Built-in sessions know the region they end with
+    PixelRect expected;
+};
+
+struct ReplayResult {
+    uint64_t frames = 0;
+    uint64_t dropped = 0;
+    uint64_t pixels = 0;
+    uint64_t maxPixels = 0;
+    std::vector<int64_t> renderUs;
+    FramePacerStats pacing;
+    PixelRect result = { 0, 0, 0, 0 };
+    bool complete = false;
+    bool verified = true;
+};
+
+static void Fill(const FrameRef& frame, const PixelRect& rect, uint32_t color) {
+    PixelRect clipped = rect.Intersect({ 0, 0, frame->Width(), frame->Height() });
+    for (int y = clipped.top; y < clipped.bottom; y++) {
+        uint32_t* row = (uint32_t*)frame->Row(y);
+        for (int x = clipped.left; x < clipped.right; x++) row[x] = color;
+    }
+}
+
+// Wallpaper, then the snapshot back to front (a window before its
+// controls): 1px dark borders around light windows and grey controls
+static FrameRef DrawScene(const InputTrace& trace) {
+    FrameRef frame = FramePool::Instance().Acquire(trace.width, trace.height);
+    for (int y = 0; y < trace.height; y++) {
+        uint32_t* row = (uint32_t*)frame->Row(y);
+        for (int x = 0; x < trace.width; x++) {
+            uint32_t shade = 70 + (x + y) * 60 / (trace.width + trace.height);
+            row[x] = 0xFF000000u | shade << 16 | shade << 8 | (shade + 30);
+        }
+    }
+    for (size_t i = trace.windows.size(); i-- > 0;) {
+        const WindowElement& element = trace.windows[i];
+        const PixelRect& r = element.rect;
+        if (r.left <= 0 && r.top <= 0 && r.right >= trace.width && r.bottom >= trace.height) continue;  // Desktop
+        Fill(frame, r, 0xFF202020);
+        Fill(frame, { r.left + 1, r.top + 1, r.right - 1, r.bottom - 1 }, element.parent < 0 ? 0xFFF3F3F3 : 0xFFC8C8C8);
+    }
+    return frame;
+}
+
+static int64_t Percentile(const std::vector<int64_t>& sorted, double fraction) {
+    if (sorted.empty()) return 0;
+    return sorted[std::min(sorted.size() - 1, (size_t)(fraction * (sorted.size() - 1) + 0.5))];
+}
+
+static ReplayResult Replay(const InputTrace& trace, int64_t frameUs, bool verify) {
+    ReplayResult out;
+    FrameRef source = DrawScene(trace);
+    FrameRef target = FramePool::Instance().Acquire(trace.width, trace.height);
+    FrameRef window = FramePool::Instance().Acquire(trace.width, trace.height);
+    FrameRef reference = verify ? FramePool::Instance().Acquire(trace.width, trace.height) : nullptr;
+
+    EdgeMap edges;
+    if (trace.options.snapDistance > 0) edges.Build(source->Bits(), source->Stride(), trace.width, trace.height);
+    WindowIndex windows;
+    windows.Build(trace.windows);
+    OverlayInput input;
+    input.Reset(trace.options, &windows);
+
+    OverlayStyle style = OverlayStyle::Default();
+    style.loupeZoom = trace.loupeZoom;
+    OverlayCompositor compositor;
+    std::vector<PixelRect> damage;
+    compositor.Attach(source->Bits(), source->Stride(), target->Bits(), target->Stride(),
+                      trace.width, trace.height, style, &damage);
+
+    ManualTimerClock clock(trace.events.empty() ? 0 : trace.events.front().timeUs);
+    FramePacer pacer(clock, frameUs);
+    int64_t busyUntilUs = clock.NowUs();
+    size_t next = 0;
+    for (;;) {
+        int64_t eventUs = next < trace.events.size() ? trace.events[next].timeUs : INT64_MAX;
+        int64_t deadlineUs = pacer.NextDeadlineUs();
+        if (deadlineUs < 0 && eventUs == INT64_MAX) break;
+
+        if (deadlineUs >= 0 && deadlineUs <= eventUs) {
+            // The renderer starts the due frame once it is free; input
+            // keeps arriving while it draws
+            int64_t startUs = std::max(deadlineUs, busyUntilUs);
+            if (eventUs < startUs) {
+                clock.SleepUntilUs(eventUs);
+                input.Apply(trace.events[next++], &edges);
+                pacer.Submit(input.Cursor().x, input.Cursor().y);
+                continue;
+            }
+            clock.SleepUntilUs(startUs);
+            int x, y;
+            if (!pacer.BeginFrame(&x, &y)) continue;
+            out.dropped += (uint64_t)((startUs - deadlineUs) / frameUs);
+
+            auto start = std::chrono::steady_clock::now();
+            compositor.SetView(input.Selection(), input.Cursor(), &damage);
+            uint64_t touched = 0;
+            for (const PixelRect& strip : damage) {
+                for (int row = strip.top; row < strip.bottom; row++) {
+                    memcpy(window->Row(row) + (size_t)strip.left * 4, target->Row(row) + (size_t)strip.left * 4,
+                           (size_t)strip.Width() * 4);
+                }
+                touched += (uint64_t)strip.Area();
+            }
+            int64_t renderUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            busyUntilUs = startUs + renderUs;
+
+            out.frames++;
+            out.pixels += touched;
+            out.maxPixels = std::max(out.maxPixels, touched);
+            out.renderUs.push_back(renderUs);
+
+            if (verify) {
+                compositor.RenderFull(input.Selection(), input.Cursor(), reference->Bits(), reference->Stride());
+                for (int row = 0; row < trace.height && out.verified; row++) {
+                    if (memcmp(reference->Row(row), target->Row(row), (size_t)trace.width * 4) != 0) {
+                        fprintf(stderr, "frame %llu row %d differs from a full render\n",
+                                (unsigned long long)out.frames, row);
+                        out.verified = false;
+                    }
+                }
+            }
+        } else {
+            clock.SleepUntilUs(eventUs);
+            input.Apply(trace.events[next++], &edges);
+            pacer.Submit(input.Cursor().x, input.Cursor().y);
+        }
+    }
+
+    std::sort(out.renderUs.begin(), out.renderUs.end());
+    out.pacing = pacer.GetStats();
+    out.complete = input.Complete();
+    out.result = input.Result();
+    return out;
+}
+
+// Built-in sessions ----------------------------------------------------
+
+// Children first, then the element; returns its index (see WindowIndex)
+static int AddElement(InputTrace* trace, std::mt19937& random, const PixelRect& rect, int depth, int children) {
+    std::vector<int> kids;
+    for (int i = 0; i < children; i++) {
+        int w = std::max(8, rect.Width() / 3 - 8), h = std::max(8, rect.Height() / 3 - 8);
+        int left = rect.left + 4 + (int)(random() % (unsigned)std::max(1, rect.Width() - w - 8));
+        int top = rect.top + 4 + (int)(random() % (unsigned)std::max(1, rect.Height() - h - 8));
+        PixelRect child = PixelRect{ left, top, left + w, top + h }.Intersect(rect);
+        if (!child.Empty()) kids.push_back(AddElement(trace, random, child, depth + 1, depth < 2 ? 2 : 0));
+    }
+    int self = (int)trace->windows.size();
+    trace->windows.push_back({ rect, -1 });
+    for (int kid : kids) trace->windows[kid].parent = self;
+    return self;
+}
+
+static InputTrace SceneTrace(int width, int height) {
+    InputTrace trace;
+    trace.width = width;
+    trace.height = height;
+    trace.frameUs = 16667;
+    trace.loupeZoom = 8;
+    trace.options = OverlayInputOptions::Default();
+
+    // Front: a plain window to drag around; behind it windows with controls
+    std::mt19937 random(3);
+    AddElement(&trace, random, { width / 2, height / 2, width / 2 + width / 4, height / 2 + height / 4 }, 0, 0);
+    for (int i = 0; i < 10; i++) {
+        int w = width / 6 + (int)(random() % (unsigned)(width / 4));
+        int h = height / 6 + (int)(random() % (unsigned)(height / 4));
+        int left = (int)(random() % (unsigned)(width - w));
+        int top = (int)(random() % (unsigned)(height - h));
+        AddElement(&trace, random, { left, top, left + w, top + h }, 0, 4);
+    }
+    trace.windows.push_back({ { 0, 0, width, height }, -1 });  // The desktop
+    return trace;
+}
+
+static void Move(InputTrace* trace, int64_t* timeUs, int64_t stepUs, int x, int y, uint8_t modifiers = 0) {
+    *timeUs += stepUs;
+    trace->events.push_back({ *timeUs, InputEventType::Move, modifiers, x, y });
+}
+
+static void Path(InputTrace* trace, int64_t* timeUs, int64_t stepUs, int x0, int y0, int x1, int y1, int steps,
+                 uint8_t modifiers = 0) {
+    for (int i = 1; i <= steps; i++) {
+        Move(trace, timeUs, stepUs, x0 + (x1 - x0) * i / steps, y0 + (y1 - y0) * i / steps, modifiers);
+    }
+}
+
+static void Click(InputTrace* trace, int64_t* timeUs, int x, int y, uint8_t modifiers = 0) {
+    *timeUs += 90000;
+    trace->events.push_back({ *timeUs, InputEventType::ButtonDown, modifiers, x, y });
+    Move(trace, timeUs, 8000, x + 1, y, modifiers);  // A wobble, not a drag
+    *timeUs += 60000;
+    trace->events.push_back({ *timeUs, InputEventType::ButtonUp, modifiers, x + 1, y });
+}
+
+static int TopAt(const InputTrace& trace, int x, int y) {
+    for (size_t i = 0; i < trace.windows.size(); i++) {
+        const PixelRect& r = trace.windows[i].rect;
+        if (x >= r.left && x < r.right && y >= r.top && y < r.bottom) return (int)i;
+    }
+    return -1;
+}
+
+static std::vector<Session> BuiltInSessions(int width, int height) {
+    std::vector<Session> sessions;
+    const InputTrace scene = SceneTrace(width, height);
+    const PixelRect front = scene.windows[0].rect;
+
+    // The deepest control not covered by anything in front of it
+    int control = -1;
+    for (size_t i = 1; i < scene.windows.size() && control < 0; i++) {
+        const WindowElement& element = scene.windows[i];
+        int cx = (element.rect.left + element.rect.right) / 2, cy = (element.rect.top + element.rect.bottom) / 2;
+        if (element.parent >= 0 && TopAt(scene, cx, cy) == (int)i) control = (int)i;
+    }
+    const PixelRect& target = scene.windows[control].rect;
+    int cx = (target.left + target.right) / 2, cy = (target.top + target.bottom) / 2;
+    int top = control;
+    while (scene.windows[top].parent >= 0) top = scene.windows[top].parent;
+
+    // Mouse reports at 1 kHz while moving
+    Session hover = { "hover + click", scene, true, target };
+    int64_t t = 0;
+    Path(&hover.trace, &t, 1000, width / 10, height / 10, width * 9 / 10, height * 8 / 10, 1500);
+    Path(&hover.trace, &t, 1000, width * 9 / 10, height * 8 / 10, cx, cy, 800);
+    Click(&hover.trace, &t, cx, cy);
+    sessions.push_back(hover);
+
+    Session ctrl = { "ctrl + click", scene, true, scene.windows[top].rect };
+    t = 0;
+    Path(&ctrl.trace, &t, 1000, width / 3, height / 5, cx, cy, 700, INPUT_CTRL);
+    Click(&ctrl.trace, &t, cx, cy, INPUT_CTRL);
+    sessions.push_back(ctrl);
+
+    // From 3px inside one corner of the front window to 3px inside the
+    // opposite one: both corners snap onto the border
+    Session drag = { "snapped drag", scene, true, front };
+    t = 0;
+    Path(&drag.trace, &t, 1000, width / 8, height / 8, front.left + 3, front.top + 3, 600);
+    t += 120000;
+    drag.trace.events.push_back({ t, InputEventType::ButtonDown, 0, front.left + 3, front.top + 3 });
+    Path(&drag.trace, &t, 1000, front.left + 3, front.top + 3, front.right - 3, front.bottom - 3, 1200);
+    t += 50000;
+    drag.trace.events.push_back({ t, InputEventType::ButtonUp, 0, front.right - 3, front.bottom - 3 });
+    sessions.push_back(drag);
+
+    // Pixel-precise: Alt held, 1px steps at 125 Hz
+    Session precise = { "alt 1px drag", scene, true, { 0, 0, 0, 0 } };
+    t = 0;
+    int x0 = width / 5 + 3, y0 = height / 5 + 3;
+    precise.trace.events.push_back({ t, InputEventType::ButtonDown, INPUT_ALT, x0, y0 });
+    int x = x0, y = y0;
+    for (int i = 0; i < 400; i++) {
+        x += i % 3 != 0;
+        y += i % 2;
+        Move(&precise.trace, &t, 8000, x, y, INPUT_ALT);
+    }
+    t += 50000;
+    precise.trace.events.push_back({ t, InputEventType::ButtonUp, INPUT_ALT, x, y });
+    precise.expected = { x0, y0, x, y };
+    sessions.push_back(precise);
+    return sessions;
+}
+
+static bool SameTrace(const InputTrace& a, const InputTrace& b) {
+    if (a.width != b.width || a.height != b.height || a.frameUs != b.frameUs || a.loupeZoom != b.loupeZoom ||
+        a.options.snapDistance != b.options.snapDistance || a.options.pickWindows != b.options.pickWindows ||
+        a.options.dragX != b.options.dragX || a.options.dragY != b.options.dragY ||
+        a.windows.size() != b.windows.size() || a.events.size() != b.events.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.windows.size(); i++) {
+        if (a.windows[i].rect != b.windows[i].rect || a.windows[i].parent != b.windows[i].parent) return false;
+    }
+    for (size_t i = 0; i < a.events.size(); i++) {
+        const InputEvent& e = a.events[i];
+        const InputEvent& f = b.events[i];
+        if (e.timeUs != f.timeUs || e.type != f.type || e.modifiers != f.modifiers || e.x != f.x || e.y != f.y) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool verify = false;
+    int fps = 0;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--verify") == 0) {
+            verify = true;
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            fps = atoi(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: %s [--fps N] [--verify] [trace ...]\n", argv[0]);
+            return 2;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    int failed = 0;
+    std::vector<Session> sessions;
+    if (paths.empty()) {
+        sessions = BuiltInSessions(3840, 2160);
+        // What the overlay writes must read back unchanged
+        for (const Session& session : sessions) {
+            FILE* f = tmpfile();
+            InputTrace copy;
+            bool ok = f && session.trace.Write(f) && fseek(f, 0, SEEK_SET) == 0 && copy.Read(f) &&
+                      SameTrace(session.trace, copy);
+            if (f) fclose(f);
+            if (!ok) {
+                fprintf(stderr, "%s: trace does not survive a write/read round trip\n", session.name.c_str());
+                failed++;
+            }
+        }
+    }
+    for (const std::string& path : paths) {
+        Session session = { path, InputTrace(), false, { 0, 0, 0, 0 } };
+        FILE* f = fopen(path.c_str(), "r");
+        bool ok = f && session.trace.Read(f);
+        if (f) fclose(f);
+        if (!ok) {
+            fprintf(stderr, "%s: not a readable overlay input trace\n", path.c_str());
+            return 2;
+        }
+        sessions.push_back(session);
+    }
+
+    for (const Session& session : sessions) {
+        const InputTrace& trace = session.trace;
+        int64_t frameUs = fps > 0 ? 1000000 / fps : trace.frameUs;
+        int64_t spanUs = trace.events.empty() ? 0 : trace.events.back().timeUs - trace.events.front().timeUs;
+        ReplayResult r = Replay(trace, frameUs, verify);
+        const FramePacerStats& pacing = r.pacing;
+
+        printf("%s: %dx%d, %zu windows, %zu events over %.2fs, frame %.2fms\n", session.name.c_str(),
+               trace.width, trace.height, trace.windows.size(), trace.events.size(), spanUs / 1e6, frameUs / 1000.0);
+        printf("  frames=%llu dropped=%llu merged inputs=%llu/%llu  render p50=%.3fms p95=%.3fms p99=%.3fms max=%.3fms\n",
+               (unsigned long long)r.frames, (unsigned long long)r.dropped, (unsigned long long)pacing.merged,
+               (unsigned long long)pacing.inputs, Percentile(r.renderUs, 0.50) / 1000.0,
+               Percentile(r.renderUs, 0.95) / 1000.0, Percentile(r.renderUs, 0.99) / 1000.0,
+               Percentile(r.renderUs, 1.0) / 1000.0);
+        printf("  touched %.0f px/frame (max %llu)  input->frame p99<=%.2fms  result %s [%d,%d %dx%d]\n",
+               r.frames ? (double)r.pixels / r.frames : 0.0, (unsigned long long)r.maxPixels,
+               pacing.latency.PercentileUs(0.99) / 1000.0, r.complete ? "selected" : "open",
+               r.result.left, r.result.top, r.result.Width(), r.result.Height());
+
+        if (!r.verified) failed++;
+        if (session.checkResult) {
+            const PixelRect& e = session.expected;
+            bool ok = r.complete && abs(r.result.left - e.left) <= 1 && abs(r.result.top - e.top) <= 1 &&
+                      abs(r.result.right - e.right) <= 1 && abs(r.result.bottom - e.bottom) <= 1;
+            if (!ok) {
+                fprintf(stderr, "%s: expected [%d,%d %dx%d]\n", session.name.c_str(), e.left, e.top, e.Width(), e.Height());
+                failed++;
+            }
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,188 @@
+// Simulated-clock checks for FramePacer (overlay frame pacing)
+// Usage: pacersim [-v]
+//   Replays mouse input traces on a ManualTimerClock and checks the pacing
+//   rules: frames never closer than the interval, only the latest position
+//   drawn, the final position of every drag drawn, no catch-up bursts.
+//   Also replays each trace through the old GetTickCount (15.6 ms ticks) +
+//   8 ms throttle for comparison. Exit code 1 if any check fails.
+
+#include "../src/framepacer.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace ScreenCapture;
+
+struct Move {
+    int64_t timeUs;
+    int x, y;
+};
+
+struct SimResult {
+    int frames;
+    int64_t minIntervalUs;
+    int lastX, lastY;     // Last position drawn
+    int64_t lastFrameUs;  // When it was drawn
+    FramePacerStats stats;
+};
+
+static int g_failures = 0;
+static bool g_verbose = false;
+
+static void Check(bool ok, const char* scenario, const char* what) {
+    if (!ok) g_failures++;
+    if (!ok || g_verbose) printf("  %s %s: %s\n", ok ? "ok  " : "FAIL", scenario, what);
+}
+
+// Event loop: next input or the pacer's deadline, whichever comes first.
+// Each frame takes renderUs of (simulated) time.
+static SimResult RunPacer(const std::vector<Move>& moves, int64_t frameUs, int64_t renderUs) {
+    ManualTimerClock clock;
+    FramePacer pacer(clock, frameUs);
+    SimResult result = { 0, INT64_MAX, -1, -1, 0, FramePacerStats() };
+    int64_t lastStart = -1;
+
+    auto render = [&](int x, int y) {
+        int64_t now = clock.NowUs();
+        if (lastStart >= 0 && now - lastStart < result.minIntervalUs) result.minIntervalUs = now - lastStart;
+        lastStart = now;
+        result.frames++;
+        result.lastX = x;
+        result.lastY = y;
+        result.lastFrameUs = now;
+        clock.Advance(renderUs);
+    };
+
+    size_t next = 0;
+    for (;;) {
+        int64_t deadline = pacer.NextDeadlineUs();
+        bool haveInput = next < moves.size();
+        if (!haveInput && deadline < 0) break;
+
+        if (haveInput && (deadline < 0 || moves[next].timeUs <= deadline)) {
+            // Everything that queued up meanwhile (Windows also folds
+            // pending WM_MOUSEMOVEs into one)
+            clock.SleepUntilUs(moves[next].timeUs);
+            while (next < moves.size() && moves[next].timeUs <= clock.NowUs()) {
+                pacer.Submit(moves[next].x, moves[next].y);
+                next++;
+            }
+        } else {
+            clock.SleepUntilUs(deadline);
+        }
+        int x, y;
+        if (pacer.BeginFrame(&x, &y)) render(x, y);
+    }
+    result.stats = pacer.GetStats();
+    return result;
+}
+
+// The overlay before the pacer: GetTickCount() advances in 15.625 ms steps
+// and moves within 8 ms of the last frame are dropped
+static SimResult RunLegacy(const std::vector<Move>& moves) {
+    const int64_t tickUs = 15625;
+    SimResult result = { 0, INT64_MAX, -1, -1, 0, FramePacerStats() };
+    int64_t lastPaint = -1000000;  // OnLButtonDown clears it: the first move paints
+    int64_t lastStart = -1;
+    for (const Move& move : moves) {
+        int64_t now = move.timeUs / tickUs * tickUs;
+        if (now - lastPaint < 8000) continue;
+        lastPaint = now;
+        if (lastStart >= 0 && move.timeUs - lastStart < result.minIntervalUs) result.minIntervalUs = move.timeUs - lastStart;
+        lastStart = move.timeUs;
+        result.frames++;
+        result.lastX = move.x;
+        result.lastY = move.y;
+    }
+    return result;
+}
+
+static std::vector<Move> Drag(int64_t startUs, int64_t periodUs, int count, int dx, int dy) {
+    std::vector<Move> moves;
+    for (int i = 0; i < count; i++) moves.push_back({ startUs + i * periodUs, 100 + i * dx, 100 + i * dy });
+    return moves;
+}
+
+static void Report(const char* name, const std::vector<Move>& moves, const SimResult& paced, const SimResult& legacy) {
+    double seconds = (moves.back().timeUs - moves.front().timeUs) / 1e6;
+    if (seconds <= 0) seconds = 1e-6;
+    printf("%-22s pacer %4d frames (%5.1f fps, p99 interval %6.2fms, merged %llu, deferred %llu)  "
+           "legacy %4d frames (%5.1f fps), final move %s\n",
+           name, paced.frames, paced.frames / seconds, paced.stats.interval.PercentileUs(0.99) / 1000.0,
+           (unsigned long long)paced.stats.merged, (unsigned long long)paced.stats.deferred,
+           legacy.frames, legacy.frames / seconds,
+           legacy.lastX == moves.back().x && legacy.lastY == moves.back().y ? "drawn" : "LOST");
+}
+
+static void CheckCommon(const char* name, const std::vector<Move>& moves, const SimResult& r, int64_t frameUs) {
+    Check(r.lastX == moves.back().x && r.lastY == moves.back().y, name, "final position drawn");
+    Check(r.frames <= 1 || r.minIntervalUs >= frameUs, name, "frames at least one interval apart");
+    Check(r.stats.inputs == moves.size(), name, "every input submitted");
+    Check(r.stats.frames + r.stats.merged == r.stats.inputs, name, "every input drawn or merged");
+}
+
+int main(int argc, char** argv) {
+    g_verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+    const int64_t frameUs = FramePacer::IntervalForRefresh(240, 120);
+
+    // 1000 Hz mouse for one second
+    {
+        const char* name = "1000Hz drag 1s";
+        std::vector<Move> moves = Drag(0, 1000, 1000, 1, 1);
+        SimResult r = RunPacer(moves, frameUs, 500);
+        CheckCommon(name, moves, r, frameUs);
+        Check(r.frames >= 118 && r.frames <= 122, name, "about 120 frames");
+        Report(name, moves, r, RunLegacy(moves));
+    }
+
+    // 125 Hz mouse (8 ms) against a 8.33 ms interval: every other move
+    // lands early and has to be drawn on the deadline
+    {
+        const char* name = "125Hz drag";
+        std::vector<Move> moves = Drag(0, 8000, 250, 3, 2);
+        SimResult r = RunPacer(moves, frameUs, 500);
+        CheckCommon(name, moves, r, frameUs);
+        Check(r.stats.deferred > 0, name, "early moves deferred to the deadline");
+        Report(name, moves, r, RunLegacy(moves));
+    }
+
+    // A short flick that stops just after a frame: the trailing frame
+    // must show where the mouse stopped
+    {
+        const char* name = "flick then stop";
+        std::vector<Move> moves = Drag(0, 2000, 7, 10, 0);
+        SimResult r = RunPacer(moves, frameUs, 500);
+        CheckCommon(name, moves, r, frameUs);
+        Check(r.lastFrameUs <= moves.back().timeUs + frameUs, name, "trailing frame within one interval");
+        Report(name, moves, r, RunLegacy(moves));
+    }
+
+    // Slow moves: each one is drawn at once
+    {
+        const char* name = "slow moves";
+        std::vector<Move> moves = Drag(0, 50000, 40, 1, 0);
+        SimResult r = RunPacer(moves, frameUs, 500);
+        CheckCommon(name, moves, r, frameUs);
+        Check(r.stats.latency.Max() == 0, name, "no added latency");
+        Report(name, moves, r, RunLegacy(moves));
+    }
+
+    // Frames slower than the interval: no catch-up bursts afterwards
+    {
+        const char* name = "slow renderer";
+        std::vector<Move> moves = Drag(0, 1000, 500, 1, 1);
+        SimResult r = RunPacer(moves, frameUs, 20000);
+        CheckCommon(name, moves, r, frameUs);
+        Check(r.minIntervalUs >= 20000, name, "no frames closer than the render time");
+        Report(name, moves, r, RunLegacy(moves));
+    }
+
+    // Refresh alignment
+    Check(FramePacer::IntervalForRefresh(60, 120) == 16666, "refresh", "60 Hz -> every refresh");
+    Check(FramePacer::IntervalForRefresh(144, 120) == 13888, "refresh", "144 Hz -> every 2nd refresh");
+    Check(FramePacer::IntervalForRefresh(240, 120) == 8333, "refresh", "240 Hz -> every 2nd refresh");
+    Check(FramePacer::IntervalForRefresh(0, 120) == 8333, "refresh", "unknown -> max fps");
+
+    printf("%s (%d failed)\n", g_failures ? "FAILED" : "all checks passed", g_failures);
+    return g_failures ? 1 : 0;
+}
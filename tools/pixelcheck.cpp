@@ -0,0 +1,169 @@
+// SIMD pixel kernels against their scalar templates
+// Usage: pixelcheck
+//   For every kernel set this CPU has (avx2, ssse3, scalar), compares
+//   bit for bit with the scalar path: every source/destination format pair
+//   (row kernels and ConvertPixels with padded strides), the backdrop
+//   scaler (row kernel and ScalePixels) at edge levels, and the loupe
+//   zoomer at every zoom. Widths cover 1..80 plus vector-boundary and odd
+//   sizes, so every tail length runs; unaligned source and destination
+//   offsets too. Guard bytes after each row catch writes past the end.
+//   Exit code 1 if any check fails.
+
+#include "../src/pixelconvert.h"
+#include <stdio.h>
+#include <string.h>
+#include <random>
+#include <vector>
+
+using namespace ScreenCapture;
+
+static int g_failures = 0;
+static std::mt19937 g_random(21);
+
+static const uint8_t GUARD = 0xA5;
+static const int GUARD_BYTES = 64;
+
+static const PixelFormat FORMATS[] = {
+    PixelFormat::BGRA, PixelFormat::BGRX, PixelFormat::RGBA, PixelFormat::RGB,
+    PixelFormat::Gray8, PixelFormat::RGB565, PixelFormat::RGBAPremul,
+};
+static const char* FORMAT_NAMES[] = { "BGRA", "BGRX", "RGBA", "RGB", "Gray8", "RGB565", "RGBAPremul" };
+
+static std::vector<int> Widths() {
+    std::vector<int> widths;
+    for (int w = 1; w <= 80; w++) widths.push_back(w);
+    for (int w : { 95, 96, 97, 127, 128, 129, 255, 256, 257, 1001, 1919, 1920 }) widths.push_back(w);
+    return widths;
+}
+
+static void Fill(std::vector<uint8_t>& bytes) {
+    for (uint8_t& b : bytes) b = (uint8_t)g_random();
+    // Alpha extremes show up in premultiply and swap kernels
+    for (size_t i = 3; i < bytes.size(); i += 4 * 7) bytes[i] = (i / 4) % 2 ? 0 : 255;
+}
+
+static bool Check(bool ok, const char* isa, const char* what, int width, int extra) {
+    if (!ok) {
+        g_failures++;
+        printf("  FAIL %s %s: width %d (%d)\n", isa, what, width, extra);
+    }
+    return ok;
+}
+
+// A row kernel's output and the guard after it
+static bool SameRow(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b, size_t offset, size_t bytes) {
+    if (memcmp(&a[offset], &b[offset], bytes) != 0) return false;
+    for (size_t i = offset + bytes; i < offset + bytes + GUARD_BYTES; i++) {
+        if (a[i] != GUARD) return false;
+    }
+    return true;
+}
+
+static int CheckConverters(const char* isa) {
+    int checks = 0;
+    for (int s = 0; s < 2; s++) {
+        for (int d = 0; d < 7; d++) {
+            RowConverter fast = GetRowConverter(FORMATS[s], FORMATS[d]);
+            RowConverter scalar = GetScalarRowConverter(FORMATS[s], FORMATS[d]);
+            char what[64];
+            snprintf(what, sizeof(what), "%s -> %s", FORMAT_NAMES[s], FORMAT_NAMES[d]);
+            if (!Check(fast && scalar, isa, what, 0, 0)) continue;
+            int bpp = BytesPerPixel(FORMATS[d]);
+            for (int width : Widths()) {
+                for (int misalign = 0; misalign < 4; misalign++) {
+                    std::vector<uint8_t> src((size_t)width * 4 + 4);
+                    Fill(src);
+                    size_t bytes = (size_t)width * bpp;
+                    std::vector<uint8_t> got(bytes + misalign + GUARD_BYTES, GUARD), want = got;
+                    fast(&src[misalign], &got[misalign], width);
+                    scalar(&src[misalign], &want[misalign], width);
+                    Check(SameRow(got, want, misalign, bytes), isa, what, width, misalign);
+                    checks++;
+                }
+            }
+
+            // Whole image, both strides padded (odd width, odd padding)
+            const int width = 77, height = 9;
+            int srcStride = width * 4 + 12, dstStride = width * bpp + 5;
+            std::vector<uint8_t> src((size_t)srcStride * height);
+            Fill(src);
+            std::vector<uint8_t> got((size_t)dstStride * height + GUARD_BYTES, GUARD), want = got;
+            bool ok = ConvertPixels(src.data(), srcStride, FORMATS[s], got.data(), dstStride, FORMATS[d], width, height);
+            for (int y = 0; y < height; y++) scalar(&src[(size_t)y * srcStride], &want[(size_t)y * dstStride], width);
+            Check(ok && got == want, isa, "ConvertPixels", width, d);
+            checks++;
+        }
+    }
+    return checks;
+}
+
+static int CheckScaler(const char* isa) {
+    int checks = 0;
+    RowScaler fast = GetRowScaler();
+    for (int level : { 0, 1, 127, 128, 200, 255, 256 }) {
+        for (int width : Widths()) {
+            std::vector<uint8_t> src((size_t)width * 4 + 4);
+            Fill(src);
+            int misalign = width % 4;
+            std::vector<uint8_t> got((size_t)width * 4 + misalign + GUARD_BYTES, GUARD), want = got;
+            fast(&src[misalign], &got[misalign], width, level);
+            ScaleRowScalar(&src[misalign], &want[misalign], width, level);
+            Check(SameRow(got, want, misalign, (size_t)width * 4), isa, "scale row", width, level);
+            checks++;
+        }
+
+        const int width = 131, height = 5, srcStride = width * 4 + 20, dstStride = width * 4 + 8;
+        std::vector<uint8_t> src((size_t)srcStride * height);
+        Fill(src);
+        std::vector<uint8_t> got((size_t)dstStride * height + GUARD_BYTES, GUARD), want = got;
+        bool ok = ScalePixels(src.data(), srcStride, got.data(), dstStride, width, height, level);
+        for (int y = 0; y < height; y++) {
+            ScaleRowScalar(&src[(size_t)y * srcStride], &want[(size_t)y * dstStride], width, level);
+        }
+        Check(ok && got == want, isa, "ScalePixels", width, level);
+        checks++;
+    }
+    return checks;
+}
+
+static int CheckZoomer(const char* isa) {
+    int checks = 0;
+    RowZoomer fast = GetRowZoomer();
+    for (int zoom = 1; zoom <= 64; zoom++) {
+        for (int width = 1; width <= 40; width++) {
+            std::vector<uint8_t> src((size_t)width * 4);
+            Fill(src);
+            size_t bytes = (size_t)width * zoom * 4;
+            std::vector<uint8_t> got(bytes + GUARD_BYTES, GUARD), want = got;
+            fast(src.data(), got.data(), width, zoom);
+            ZoomRowScalar(src.data(), want.data(), width, zoom);
+            Check(SameRow(got, want, 0, bytes), isa, "zoom row", width, zoom);
+            checks++;
+        }
+    }
+    return checks;
+}
+
+int main() {
+    struct Level {
+        PixelIsa isa;
+        const char* name;
+    };
+    const Level levels[] = { { PixelIsa::AVX2, "avx2" }, { PixelIsa::SSSE3, "ssse3" }, { PixelIsa::Scalar, "scalar" } };
+    int tested = 0;
+    for (const Level& level : levels) {
+        LimitPixelIsa(level.isa);
+        if (strcmp(PixelConvertIsa(), level.name) != 0) {
+            printf("%-6s: not available on this CPU\n", level.name);
+            continue;
+        }
+        int before = g_failures;
+        int checks = CheckConverters(level.name) + CheckScaler(level.name) + CheckZoomer(level.name);
+        printf("%-6s: %d rows/images compared, %d failed\n", level.name, checks, g_failures - before);
+        tested++;
+    }
+    LimitPixelIsa(PixelIsa::AVX2);
+
+    printf("%d kernel sets, %s (%d failed)\n", tested, g_failures ? "FAILED" : "all match scalar", g_failures);
+    return g_failures ? 1 : 0;
+}
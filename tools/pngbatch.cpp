@@ -0,0 +1,468 @@
+// Re-encode captures and raw dumps with the capture encoder, in parallel
+// Usage: pngbatch [options] <input>... -o <output dir>
+//   input        file or directory (walked recursively); .bmp, .png, .raw/.bgra
+//   -o dir       output root; each input keeps its path relative to the
+//                input root, with a .png extension (inputs that would share
+//                an output, e.g. foo.bmp and foo.png, keep their source
+//                extension: foo.bmp.png, foo.png.png; inputs with the same
+//                name are refused after the first and counted as failed)
+//   -j N         files encoded at once (default: cores)
+//   --fast       EncodeOptions::Fast() instead of Default()
+//   --level N    deflate level (5..9) with the default adaptive filter
+//   --raw WxH    size of raw dumps without a _<W>x<H> name suffix
+//                (raw = top-down 32bpp BGRX, rows packed)
+//
+// Every output is written to <name>.png.<n>.tmp and renamed into place when
+// complete, so an interrupted batch leaves no truncated PNGs; existing
+// outputs are replaced only by finished files. The encoder writes opaque
+// RGB, so PNGs with any transparent pixel (alpha channel or tRNS) are
+// skipped and reported instead of losing their alpha.
+
+#include "../src/encoder.h"
+#include "../src/framepool.h"
+#include "../src/inflate.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ScreenCapture;
+namespace fs = std::filesystem;
+
+struct BatchItem {
+    fs::path input;
+    fs::path output;
+};
+
+struct BatchOptions {
+    EncodeOptions encode;
+    int rawWidth;
+    int rawHeight;
+};
+
+static std::mutex g_printMutex;
+
+// Error for inputs left alone on purpose (counted as skipped, not failed)
+static const char SKIPPED_TRANSPARENT[] = "skipped: has transparent pixels (the RGB output would drop alpha)";
+
+static bool ReadFile(const fs::path& path, std::vector<uint8_t>& data) {
+    FILE* f = fopen(path.string().c_str(), "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    bool ok = size >= 0;
+    if (ok) {
+        data.resize((size_t)size);
+        ok = fread(data.data(), 1, data.size(), f) == data.size();
+    }
+    fclose(f);
+    return ok;
+}
+
+static uint32_t Le32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static uint16_t Le16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t Be32(const uint8_t* p) { return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]; }
+
+// Sizes the pool can hold and the encoder accepts (its RGB image data must
+// stay under 2 GB); checked before anything is allocated from a header
+static bool CheckSize(int64_t width, int64_t height, const char** error) {
+    if (width <= 0 || height <= 0) { *error = "bad image size"; return false; }
+    if (width > 0x7fffffff / 4 || (width * 3 + 1) * height > 0x7fffffff) {
+        *error = "image too large to encode";
+        return false;
+    }
+    return true;
+}
+
+// Uncompressed 24/32bpp BMP (BI_RGB or BI_BITFIELDS with the usual masks)
+static FrameRef DecodeBMP(const std::vector<uint8_t>& data, const char** error) {
+    if (data.size() < 54 || data[0] != 'B' || data[1] != 'M') { *error = "not a BMP"; return nullptr; }
+    uint32_t offset = Le32(&data[10]);
+    int32_t width = (int32_t)Le32(&data[18]);
+    int32_t height = (int32_t)Le32(&data[22]);
+    int bpp = Le16(&data[28]);
+    uint32_t compression = Le32(&data[30]);
+    if ((bpp != 24 && bpp != 32) || (compression != 0 && compression != 3)) {
+        *error = "unsupported BMP (only 24/32bpp uncompressed)";
+        return nullptr;
+    }
+    bool bottomUp = height > 0;
+    if (height < 0) height = -height;
+    if (!CheckSize(width, height, error)) return nullptr;
+
+    size_t rowBytes = ((size_t)width * bpp / 8 + 3) & ~(size_t)3;
+    if (offset > data.size() || (data.size() - offset) / rowBytes < (size_t)height) {
+        *error = "truncated BMP";
+        return nullptr;
+    }
+
+    FrameRef frame = FramePool::Instance().Acquire(width, height);
+    if (!frame) { *error = "out of memory"; return nullptr; }
+    for (int y = 0; y < height; y++) {
+        const uint8_t* src = &data[offset + rowBytes * (bottomUp ? height - 1 - y : y)];
+        uint8_t* dst = frame->Bits() + (size_t)y * frame->Stride();
+        if (bpp == 32) {
+            memcpy(dst, src, (size_t)width * 4);
+        } else {
+            for (int x = 0; x < width; x++) {
+                dst[x * 4 + 0] = src[x * 3 + 0];
+                dst[x * 4 + 1] = src[x * 3 + 1];
+                dst[x * 4 + 2] = src[x * 3 + 2];
+                dst[x * 4 + 3] = 255;
+            }
+        }
+    }
+    return frame;
+}
+
+static int Paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    return pb <= pc ? b : c;
+}
+
+// 8-bit, non-interlaced gray / RGB / palette / gray+alpha / RGBA PNG
+static FrameRef DecodePNG(const std::vector<uint8_t>& data, const char** error) {
+    static const uint8_t SIGNATURE[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    if (data.size() < 8 || memcmp(data.data(), SIGNATURE, 8) != 0) { *error = "not a PNG"; return nullptr; }
+
+    int64_t width = 0, height = 0;
+    int colorType = -1;
+    std::vector<uint8_t> idat, palette, transparency;
+    for (size_t pos = 8; pos + 12 <= data.size();) {
+        uint32_t length = Be32(&data[pos]);
+        if (length > data.size() - pos - 12) { *error = "truncated PNG"; return nullptr; }
+        const uint8_t* type = &data[pos + 4];
+        const uint8_t* body = &data[pos + 8];
+        if (memcmp(type, "IHDR", 4) == 0 && length >= 13) {
+            width = Be32(body);
+            height = Be32(body + 4);
+            colorType = body[9];
+            if (body[8] != 8 || body[12] != 0) {
+                *error = "unsupported PNG (only 8-bit, non-interlaced)";
+                return nullptr;
+            }
+        } else if (memcmp(type, "PLTE", 4) == 0) {
+            palette.assign(body, body + length);
+        } else if (memcmp(type, "tRNS", 4) == 0) {
+            transparency.assign(body, body + length);
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            idat.insert(idat.end(), body, body + length);
+        } else if (memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+        pos += 12 + length;
+    }
+
+    int channels;
+    switch (colorType) {
+        case 0: channels = 1; break;
+        case 2: channels = 3; break;
+        case 3: channels = 1; break;
+        case 4: channels = 2; break;
+        case 6: channels = 4; break;
+        default: *error = "bad PNG header"; return nullptr;
+    }
+    if (colorType == 3 && palette.empty()) { *error = "bad PNG header"; return nullptr; }
+    if (!CheckSize(width, height, error)) return nullptr;
+
+    // tRNS: alpha per palette entry, or one 16-bit gray / RGB color key
+    int keyGray = -1, keyR = -1, keyG = -1, keyB = -1;
+    if (colorType == 0 && transparency.size() >= 2) {
+        keyGray = (transparency[0] << 8) | transparency[1];
+    } else if (colorType == 2 && transparency.size() >= 6) {
+        keyR = (transparency[0] << 8) | transparency[1];
+        keyG = (transparency[2] << 8) | transparency[3];
+        keyB = (transparency[4] << 8) | transparency[5];
+    }
+
+    // Deflate expands at most ~1032:1, so a header bigger than the data
+    // can hold is not trusted with the reservation
+    std::vector<uint8_t> raw;
+    size_t rowBytes = (size_t)width * channels;
+    size_t expected = (rowBytes + 1) * (size_t)height;
+    if (expected / 1032 > idat.size()) { *error = "corrupt PNG (image data too short for the header)"; return nullptr; }
+    raw.reserve(expected);
+    if (!ZlibDecompress(idat.data(), idat.size(), raw) || raw.size() < expected) {
+        *error = "corrupt PNG image data";
+        return nullptr;
+    }
+
+    FrameRef frame = FramePool::Instance().Acquire((int)width, (int)height);
+    if (!frame) { *error = "out of memory"; return nullptr; }
+
+    // Unfilter in place: each row becomes the reconstructed bytes
+    const uint8_t* prior = nullptr;
+    for (int y = 0; y < height; y++) {
+        uint8_t* row = &raw[(rowBytes + 1) * y + 1];
+        int filter = row[-1];
+        for (size_t i = 0; i < rowBytes; i++) {
+            int a = i >= (size_t)channels ? row[i - channels] : 0;
+            int b = prior ? prior[i] : 0;
+            int c = prior && i >= (size_t)channels ? prior[i - channels] : 0;
+            switch (filter) {
+                case 0: break;
+                case 1: row[i] = (uint8_t)(row[i] + a); break;
+                case 2: row[i] = (uint8_t)(row[i] + b); break;
+                case 3: row[i] = (uint8_t)(row[i] + ((a + b) >> 1)); break;
+                case 4: row[i] = (uint8_t)(row[i] + Paeth(a, b, c)); break;
+                default: *error = "bad PNG filter"; return nullptr;
+            }
+        }
+        prior = row;
+
+        uint8_t* dst = frame->Bits() + (size_t)y * frame->Stride();
+        for (int x = 0; x < width; x++) {
+            const uint8_t* px = row + (size_t)x * channels;
+            uint8_t r, g, b;
+            bool opaque;
+            if (colorType == 3) {
+                size_t entry = (size_t)px[0] * 3;
+                if (entry + 2 >= palette.size()) { *error = "bad PNG palette index"; return nullptr; }
+                r = palette[entry]; g = palette[entry + 1]; b = palette[entry + 2];
+                opaque = px[0] >= transparency.size() || transparency[px[0]] == 255;
+            } else if (channels <= 2) {
+                r = g = b = px[0];
+                opaque = channels == 2 ? px[1] == 255 : px[0] != keyGray;
+            } else {
+                r = px[0]; g = px[1]; b = px[2];
+                opaque = channels == 4 ? px[3] == 255 : !(r == keyR && g == keyG && b == keyB);
+            }
+            if (!opaque) { *error = SKIPPED_TRANSPARENT; return nullptr; }
+            dst[x * 4 + 0] = b;
+            dst[x * 4 + 1] = g;
+            dst[x * 4 + 2] = r;
+            dst[x * 4 + 3] = 255;
+        }
+    }
+    return frame;
+}
+
+// Raw BGRX dump; size from a "_<W>x<H>" name suffix or --raw
+static FrameRef DecodeRaw(const std::vector<uint8_t>& data, const fs::path& path,
+                          const BatchOptions& options, const char** error) {
+    int width = options.rawWidth, height = options.rawHeight;
+    std::string stem = path.stem().string();
+    size_t underscore = stem.rfind('_');
+    if (underscore != std::string::npos) {
+        int w = 0, h = 0;
+        char tail = 0;
+        if (sscanf(stem.c_str() + underscore + 1, "%dx%d%c", &w, &h, &tail) == 2 && w > 0 && h > 0) {
+            width = w;
+            height = h;
+        }
+    }
+    if (width <= 0 || height <= 0) { *error = "raw size unknown (name it *_WxH.raw or pass --raw WxH)"; return nullptr; }
+    if (!CheckSize(width, height, error)) return nullptr;
+    if (data.size() != (size_t)width * height * 4) { *error = "raw size does not match WxHx4"; return nullptr; }
+
+    FrameRef frame = FramePool::Instance().Acquire(width, height);
+    if (!frame) { *error = "out of memory"; return nullptr; }
+    for (int y = 0; y < height; y++) {
+        memcpy(frame->Bits() + (size_t)y * frame->Stride(), &data[(size_t)y * width * 4], (size_t)width * 4);
+    }
+    return frame;
+}
+
+static std::string Extension(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char)tolower(c); });
+    return ext;
+}
+
+static bool IsInput(const fs::path& path) {
+    std::string ext = Extension(path);
+    return ext == ".bmp" || ext == ".png" || ext == ".raw" || ext == ".bgra";
+}
+
+// Output paths compared the way Windows does: foo.PNG and foo.png are one file
+static std::string OutputKey(const fs::path& path) {
+    std::string key = path.lexically_normal().generic_string();
+    std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return (char)tolower(c); });
+    return key;
+}
+
+// Encode to <output>.<index>.tmp, then rename over <output>. The index
+// keeps the temp name unique to the item even if two outputs ever clash.
+static bool WriteAtomic(const FrameRef& frame, const fs::path& output, size_t index, const EncodeOptions& options,
+                        uint64_t* written, const char** error) {
+    std::error_code ec;
+    fs::create_directories(output.parent_path(), ec);
+
+    fs::path temp = output;
+    temp += "." + std::to_string(index) + ".tmp";
+    FILE* f = fopen(temp.string().c_str(), "wb");
+    if (!f) { *error = "cannot create output"; return false; }
+
+    uint64_t bytes = 0;
+    bool ok = EncodePNGStream(frame->Bits(), frame->Width(), frame->Height(), frame->Stride(), options,
+                              [f, &bytes](const void* data, size_t size) {
+                                  bytes += size;
+                                  return fwrite(data, 1, size, f) == size;
+                              });
+    ok = (fclose(f) == 0) && ok;
+    if (ok) {
+        fs::rename(temp, output, ec);
+        ok = !ec;
+    }
+    if (!ok) {
+        fs::remove(temp, ec);
+        *error = "encode / write failed";
+        return false;
+    }
+    *written = bytes;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BatchOptions options = { EncodeOptions::Default(), 0, 0 };
+    int threads = (int)std::thread::hardware_concurrency();
+    std::vector<fs::path> inputs;
+    fs::path outputRoot;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "-o") == 0 && i + 1 < argc) {
+            outputRoot = argv[++i];
+        } else if (strcmp(arg, "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(arg, "--fast") == 0) {
+            options.encode = EncodeOptions::Fast();
+        } else if (strcmp(arg, "--level") == 0 && i + 1 < argc) {
+            options.encode.compressionLevel = std::min(9, std::max(5, atoi(argv[++i])));
+        } else if (strcmp(arg, "--raw") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &options.rawWidth, &options.rawHeight) != 2) {
+                fprintf(stderr, "--raw expects WxH\n");
+                return 2;
+            }
+        } else if (arg[0] == '-') {
+            fprintf(stderr, "unknown option %s\n", arg);
+            return 2;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    if (inputs.empty() || outputRoot.empty()) {
+        fprintf(stderr, "usage: %s [-j N] [--fast | --level N] [--raw WxH] <input>... -o <output dir>\n", argv[0]);
+        return 2;
+    }
+    if (threads < 1) threads = 1;
+
+    std::vector<BatchItem> items;
+    for (const fs::path& input : inputs) {
+        std::error_code ec;
+        if (fs::is_directory(input, ec)) {
+            for (fs::recursive_directory_iterator it(input, ec), end; !ec && it != end; it.increment(ec)) {
+                if (it->is_regular_file(ec) && IsInput(it->path())) {
+                    fs::path relative = it->path().lexically_relative(input);
+                    items.push_back({ it->path(), (outputRoot / relative).replace_extension(".png") });
+                }
+            }
+        } else if (fs::is_regular_file(input, ec)) {
+            items.push_back({ input, (outputRoot / input.filename()).replace_extension(".png") });
+        } else {
+            fprintf(stderr, "%s: not found\n", input.string().c_str());
+        }
+    }
+    std::sort(items.begin(), items.end(), [](const BatchItem& a, const BatchItem& b) { return a.input < b.input; });
+
+    // Inputs that map to one output would overwrite each other. When their
+    // extensions tell them apart they keep them; otherwise (same file name
+    // from two places) the output goes to the first only
+    std::map<std::string, std::vector<size_t>> uses;
+    for (size_t i = 0; i < items.size(); i++) uses[OutputKey(items[i].output)].push_back(i);
+    for (const auto& use : uses) {
+        if (use.second.size() < 2) continue;
+        std::map<std::string, int> extensions;
+        for (size_t i : use.second) extensions[Extension(items[i].input)]++;
+        if (extensions.size() < use.second.size()) continue;
+        for (size_t i : use.second) {
+            items[i].output.replace_extension(items[i].input.extension());
+            items[i].output += ".png";
+        }
+    }
+    uint64_t refused = 0;
+    std::map<std::string, fs::path> owners;
+    std::vector<BatchItem> unique;
+    for (const BatchItem& item : items) {
+        auto owner = owners.emplace(OutputKey(item.output), item.input);
+        if (owner.second) {
+            unique.push_back(item);
+        } else {
+            fprintf(stderr, "%s: refused, %s is the output of %s\n", item.input.string().c_str(),
+                    item.output.string().c_str(), owner.first->second.string().c_str());
+            refused++;
+        }
+    }
+    items.swap(unique);
+    printf("%zu files, %d threads, level=%d filter=%d -> %s\n", items.size(), threads,
+           options.encode.compressionLevel, options.encode.filter, outputRoot.string().c_str());
+
+    std::atomic<size_t> next(0);
+    std::atomic<uint64_t> done(0), failed(refused), skipped(0), bytesIn(0), bytesOut(0), pixels(0);
+    auto start = std::chrono::steady_clock::now();
+
+    auto worker = [&]() {
+        std::vector<uint8_t> data;
+        for (size_t index; (index = next++) < items.size();) {
+            const BatchItem& item = items[index];
+            const char* error = nullptr;
+            FrameRef frame;
+            uint64_t written = 0;
+            bool ok = false;
+            // One oversized file fails on its own instead of ending the batch
+            try {
+                if (!ReadFile(item.input, data)) {
+                    error = "cannot read";
+                } else {
+                    std::string ext = Extension(item.input);
+                    if (ext == ".bmp") frame = DecodeBMP(data, &error);
+                    else if (ext == ".png") frame = DecodePNG(data, &error);
+                    else frame = DecodeRaw(data, item.input, options, &error);
+                }
+                ok = frame && WriteAtomic(frame, item.output, index, options.encode, &written, &error);
+            } catch (const std::bad_alloc&) {
+                error = "out of memory";
+                data = std::vector<uint8_t>();
+            }
+
+            if (ok) {
+                done++;
+                bytesIn += data.size();
+                bytesOut += written;
+                pixels += (uint64_t)frame->Width() * frame->Height();
+            } else {
+                if (error == SKIPPED_TRANSPARENT) skipped++;
+                else failed++;
+                std::lock_guard<std::mutex> lock(g_printMutex);
+                fprintf(stderr, "%s: %s\n", item.input.string().c_str(), error ? error : "failed");
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++) pool.emplace_back(worker);
+    worker();
+    for (std::thread& t : pool) t.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (seconds <= 0) seconds = 1e-9;
+    printf("encoded %llu, failed %llu, skipped %llu (transparent) in %.2fs: %.1f files/s, %.1f Mpix/s\n",
+           (unsigned long long)done.load(), (unsigned long long)failed.load(), (unsigned long long)skipped.load(),
+           seconds,
+           done / seconds, pixels / seconds / 1e6);
+    printf("input %.1fMB -> output %.1fMB (%.1f%%)\n", bytesIn / 1048576.0, bytesOut / 1048576.0,
+           bytesIn ? bytesOut * 100.0 / bytesIn : 0.0);
+    return failed || skipped ? 1 : 0;
+}
@@ -0,0 +1,122 @@
+// Selection statistics: summed-area tables against summing the pixels
+// Usage: regionstatsbench [width height] [moves]
+//   Builds the tables over a synthetic screenshot (parallel), checks the
+//   sums of random rectangles (edges, single pixels, the whole frame)
+//   against a direct sum, then times a drag that grows the selection across
+//   the screen: four lookups per table per move against summing every pixel
+//   of the selection. Exits 1 on a failed check.
+
+#include "../src/summedarea.h"
+#include "../src/framepool.h"
+#include "../src/taskscheduler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace ScreenCapture;
+
+static double Ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static RegionSums Direct(const FrameRef& frame, const PixelRect& rect) {
+    RegionSums sums = {};
+    for (int y = rect.top; y < rect.bottom; y++) {
+        const uint8_t* p = frame->Row(y) + (size_t)rect.left * 4;
+        for (int x = rect.left; x < rect.right; x++, p += 4) {
+            uint64_t luma = 77u * p[2] + 150u * p[1] + 29u * p[0];
+            sums.blue += p[0];
+            sums.green += p[1];
+            sums.red += p[2];
+            sums.luma += luma;
+            sums.lumaSquares += luma * luma;
+        }
+    }
+    sums.pixels = (uint64_t)rect.Area();
+    return sums;
+}
+
+static bool Same(const RegionSums& a, const RegionSums& b) {
+    return a.pixels == b.pixels && a.blue == b.blue && a.green == b.green && a.red == b.red &&
+           a.luma == b.luma && a.lumaSquares == b.lumaSquares;
+}
+
+int main(int argc, char** argv) {
+    int width = argc >= 3 ? atoi(argv[1]) : 3840;
+    int height = argc >= 3 ? atoi(argv[2]) : 2160;
+    int moves = argc == 2 ? atoi(argv[1]) : (argc >= 4 ? atoi(argv[3]) : 200);
+    if (width < 16 || height < 16 || moves <= 0 || (size_t)width * height > SummedAreaTable::MAX_PIXELS) {
+        fprintf(stderr, "usage: %s [width height] [moves]\n", argv[0]);
+        return 2;
+    }
+
+    // White blocks push the channel sums toward their 32-bit limit
+    std::mt19937 random(11);
+    FrameRef frame = FramePool::Instance().Acquire(width, height);
+    for (int y = 0; y < height; y++) {
+        uint32_t* row = (uint32_t*)frame->Row(y);
+        for (int x = 0; x < width; x++) {
+            row[x] = (x / 64 + y / 64) % 3 == 0 ? 0xFFFFFFFFu : 0xFF000000u | (uint32_t)(random() & 0xFFFFFF);
+        }
+    }
+
+    SummedAreaTable table;
+    std::vector<double> times;
+    for (int i = 0; i < 5; i++) {
+        auto start = std::chrono::steady_clock::now();
+        if (!table.Build(frame->Bits(), frame->Stride(), width, height)) {
+            fprintf(stderr, "build failed\n");
+            return 1;
+        }
+        times.push_back(Ms(start));
+    }
+    std::sort(times.begin(), times.end());
+    printf("desktop=%dx%d workers=%d\n", width, height, TaskScheduler::Instance().WorkerCount());
+    printf("build: %.1fms (median of 5), %.1fMB (%.0f bytes/pixel)\n", times[2], table.Bytes() / 1048576.0,
+           (double)table.Bytes() / ((double)width * height));
+
+    std::vector<PixelRect> checks = {
+        { 0, 0, width, height },
+        { 0, 0, 1, 1 },
+        { width - 1, height - 1, width, height },
+        { 0, height / 3, width, height / 3 + 1 },
+        { width / 2, 0, width / 2 + 1, height },
+        { -50, -50, 100, 100 },  // Clipped to the frame
+    };
+    for (int i = 0; i < 200; i++) {
+        int x0 = (int)(random() % (unsigned)width), x1 = (int)(random() % (unsigned)width);
+        int y0 = (int)(random() % (unsigned)height), y1 = (int)(random() % (unsigned)height);
+        checks.push_back({ std::min(x0, x1), std::min(y0, y1), std::max(x0, x1) + 1, std::max(y0, y1) + 1 });
+    }
+    int failed = 0;
+    for (const PixelRect& rect : checks) {
+        if (!Same(table.Sum(rect), Direct(frame, rect.Intersect({ 0, 0, width, height })))) failed++;
+    }
+    RegionSums all = table.Sum({ 0, 0, width, height });
+    printf("checks: %d rectangles, %d failed; whole frame mean #%06X luma %.1f deviation %.1f\n",
+           (int)checks.size(), failed, all.MeanColor() & 0xFFFFFF, all.MeanLuma(), all.LumaDeviation());
+
+    // A drag from the top-left corner to the bottom-right one
+    double tableMs = 0, directMs = 0;
+    for (int i = 0; i < moves; i++) {
+        PixelRect selection = { width / 16, height / 16, width / 16 + (width * 7 / 8) * (i + 1) / moves,
+                                height / 16 + (height * 7 / 8) * (i + 1) / moves };
+        auto start = std::chrono::steady_clock::now();
+        RegionSums fast = table.Sum(selection);
+        tableMs += Ms(start);
+        start = std::chrono::steady_clock::now();
+        RegionSums slow = Direct(frame, selection);
+        directMs += Ms(start);
+        if (!Same(fast, slow)) failed++;
+    }
+    printf("drag: tables %.4fms/move, direct sum %.3fms/move (%.0fx) over %d moves\n", tableMs / moves,
+           directMs / moves, tableMs > 0 ? directMs / tableMs : 0.0, moves);
+    if (failed) {
+        fprintf(stderr, "%d sums differ from a direct sum\n", failed);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,240 @@
+// Simulated-clock checks for RequestScheduler (capture request queue)
+// Usage: schedulersim [-v]
+//   Drives the scheduler from a ManualClock and checks its rules:
+//   coalescing (same kind within the window, priority raised, window
+//   boundary), dispatch order (priority, FIFO within a level), eviction when
+//   full (oldest lowest-priority request, never for a lower-ranked one),
+//   expiry at dispatch, cancellation, submissions handled late (stamped with
+//   the input time, as hotkeys queued behind a region selection are), and
+//   that over a random trace every submission is accounted for exactly
+//   once. Exit code 1 if any check fails.
+
+#include "../src/requestscheduler.h"
+#include <stdio.h>
+#include <string.h>
+#include <random>
+#include <set>
+
+using namespace ScreenCapture;
+
+static int g_failures = 0;
+static bool g_verbose = false;
+
+static void Check(bool ok, const char* scenario, const char* what) {
+    if (!ok) g_failures++;
+    if (!ok || g_verbose) printf("  %s %s: %s\n", ok ? "ok  " : "FAIL", scenario, what);
+}
+
+static RequestPolicy Policy(uint64_t coalesceMs, uint64_t maxAgeMs, size_t capacity) {
+    RequestPolicy policy = { coalesceMs, maxAgeMs, capacity };
+    return policy;
+}
+
+static void Coalescing() {
+    const char* name = "coalesce";
+    ManualClock clock(1000);
+    RequestScheduler scheduler(clock, Policy(250, 3000, 8));
+
+    SubmitResult first = scheduler.Submit(CaptureKind::FullScreen, RequestPriority::Background);
+    clock.Advance(100);
+    SubmitResult repeat = scheduler.Submit(CaptureKind::FullScreen, RequestPriority::Normal);
+    Check(!first.merged && first.id != 0, name, "first request queued");
+    Check(repeat.merged && repeat.id == first.id, name, "repeat within the window merged");
+    SubmitResult other = scheduler.Submit(CaptureKind::ActiveWindow, RequestPriority::Normal);
+    Check(!other.merged && other.id != first.id, name, "other kind not merged");
+
+    // The window counts from the queued request, not the last repeat:
+    // 250 ms after it still merges, 251 ms does not
+    clock.Advance(150);
+    Check(scheduler.Submit(CaptureKind::FullScreen, RequestPriority::Normal).merged, name, "merged at the window edge");
+    clock.Advance(1);
+    SubmitResult late = scheduler.Submit(CaptureKind::FullScreen, RequestPriority::Normal);
+    Check(!late.merged && late.id != first.id, name, "new request past the window");
+
+    CaptureRequest request;
+    Check(scheduler.Next(&request) && request.id == first.id, name, "merged request dispatched first");
+    Check(request.priority == RequestPriority::Normal, name, "merge raised the priority to the higher one");
+    Check(request.merged == 2, name, "merged count");
+    Check(request.submittedMs == 1000, name, "merging keeps the original submit time");
+}
+
+static void Priorities() {
+    const char* name = "priority";
+    ManualClock clock;
+    RequestScheduler scheduler(clock, Policy(0, 3000, 8));
+
+    SubmitResult background = scheduler.Submit(CaptureKind::FullScreen, RequestPriority::Background);
+    clock.Advance(10);
+    SubmitResult normal1 = scheduler.Submit(CaptureKind::ActiveWindow, RequestPriority::Normal);
+    clock.Advance(10);
+    SubmitResult interactive = scheduler.Submit(CaptureKind::Region, RequestPriority::Interactive);
+    clock.Advance(10);
+    SubmitResult normal2 = scheduler.Submit(CaptureKind::FullScreen, RequestPriority::Normal);
+    Check(!background.preempt && !normal1.preempt && interactive.preempt, name, "only interactive preempts");
+    Check(!normal2.merged, name, "coalescing off with a zero window once time moved");
+
+    uint64_t expected[] = { interactive.id, normal1.id, normal2.id, background.id };
+    CaptureRequest request;
+    bool order = true;
+    for (uint64_t id : expected) order = order && scheduler.Next(&request) && request.id == id;
+    Check(order, name, "highest priority first, FIFO within a level");
+    Check(!scheduler.Next(&request) && scheduler.Empty(), name, "empty after dispatch");
+    Check(RequestScheduler::DefaultPriority(CaptureKind::Region) == RequestPriority::Interactive &&
+              RequestScheduler::DefaultPriority(CaptureKind::FullScreen) == RequestPriority::Normal,
+          name, "default priorities");
+}
+
+static void Eviction() {
+    const char* name = "evict";
+    ManualClock clock;
+    RequestScheduler scheduler(clock, Policy(0, 100000, 3));
+    CaptureKind kinds[] = { CaptureKind::FullScreen, CaptureKind::ActiveWindow, CaptureKind::Region };
+
+    SubmitResult queued[3];
+    for (int i = 0; i < 3; i++) {
+        clock.Advance(10);
+        queued[i] = scheduler.Submit(kinds[i], i == 1 ? RequestPriority::Normal : RequestPriority::Background);
+    }
+    // Full: a Normal request evicts the oldest Background one
+    clock.Advance(10);
+    SubmitResult normal = scheduler.Submit(CaptureKind::FullScreen, RequestPriority::Normal);
+    Check(normal.id != 0, name, "normal request admitted into a full queue");
+    Check(!scheduler.Cancel(queued[0].id), name, "oldest lowest-priority request evicted");
+    Check(scheduler.Cancel(queued[2].id), name, "newer background request kept");
+
+    // Refill with Normal only: a Background request is the one dropped
+    clock.Advance(10);
+    scheduler.Submit(CaptureKind::Region, RequestPriority::Normal);
+    clock.Advance(10);
+    SubmitResult dropped = scheduler.Submit(CaptureKind::ActiveWindow, RequestPriority::Background);
+    Check(dropped.id == 0 && !dropped.merged, name, "lower-ranked request dropped, queue untouched");
+
+    // Equal priority: the oldest of the level makes room
+    clock.Advance(10);
+    SubmitResult equal = scheduler.Submit(CaptureKind::ActiveWindow, RequestPriority::Normal);
+    Check(equal.id != 0 && !scheduler.Cancel(queued[1].id), name, "same level evicts its oldest");
+
+    RequestSchedulerStats stats = scheduler.GetStats();
+    Check(stats.evicted == 3 && stats.queued == 3, name, "evictions counted, capacity held");
+}
+
+static void Expiry() {
+    const char* name = "expire";
+    ManualClock clock;
+    RequestScheduler scheduler(clock, Policy(250, 3000, 8));
+    CaptureRequest request;
+
+    SubmitResult old = scheduler.Submit(CaptureKind::FullScreen, RequestPriority::Interactive);
+    clock.Advance(3000);
+    Check(scheduler.Next(&request) && request.id == old.id, name, "dispatched at exactly the max age");
+
+    scheduler.Submit(CaptureKind::FullScreen, RequestPriority::Interactive);
+    clock.Advance(2000);
+    SubmitResult fresh = scheduler.Submit(CaptureKind::ActiveWindow, RequestPriority::Background);
+    clock.Advance(1001);
+    Check(scheduler.Next(&request) && request.id == fresh.id, name,
+          "expired request skipped even at a higher priority");
+    RequestSchedulerStats stats = scheduler.GetStats();
+    Check(stats.expired == 1 && stats.queued == 0, name, "expiry counted");
+
+    scheduler.Submit(CaptureKind::Region, RequestPriority::Interactive);
+    clock.Advance(5000);
+    Check(!scheduler.Next(&request) && scheduler.Empty(), name, "nothing dispatched when all expired");
+}
+
+static void Cancellation() {
+    const char* name = "cancel";
+    ManualClock clock;
+    RequestScheduler scheduler(clock, Policy(250, 3000, 8));
+    SubmitResult a = scheduler.Submit(CaptureKind::FullScreen, RequestPriority::Normal);
+    scheduler.Submit(CaptureKind::ActiveWindow, RequestPriority::Normal);
+    scheduler.Submit(CaptureKind::Region, RequestPriority::Interactive);
+    Check(scheduler.Cancel(a.id) && !scheduler.Cancel(a.id), name, "cancel once");
+    CaptureRequest request;
+    Check(scheduler.Next(&request) && !scheduler.Cancel(request.id), name, "dispatched request not cancellable");
+    Check(scheduler.CancelAll() == 1 && scheduler.Empty(), name, "cancel all");
+    Check(scheduler.GetStats().cancelled == 2, name, "cancellations counted");
+}
+
+// Key presses queued behind a region selection, submitted afterwards with
+// their message times
+static void LateSubmission() {
+    const char* name = "late";
+    ManualClock clock(10000);
+    RequestScheduler scheduler(clock, Policy(250, 3000, 8));
+
+    // Two presses 100 ms apart, handled 2 s later in one go: still one request
+    clock.Advance(2000);
+    SubmitResult first = scheduler.Submit(CaptureKind::FullScreen, RequestPriority::Normal, 10000);
+    SubmitResult repeat = scheduler.Submit(CaptureKind::FullScreen, RequestPriority::Normal, 10100);
+    Check(repeat.merged && repeat.id == first.id, name, "presses close in input time merged");
+    // Pressed 1 s apart but handled together: not a double press
+    SubmitResult apart = scheduler.Submit(CaptureKind::FullScreen, RequestPriority::Normal, 11100);
+    Check(!apart.merged, name, "presses far apart in input time not merged");
+
+    CaptureRequest request;
+    Check(scheduler.Next(&request) && request.id == first.id && request.submittedMs == 10000, name,
+          "request keeps the input time");
+    clock.Advance(1001);
+    Check(scheduler.Next(&request) && request.id == apart.id, name, "late press within max age dispatched");
+
+    // Handled after more than the max age: expired at dispatch
+    scheduler.Submit(CaptureKind::Region, RequestPriority::Interactive, clock.NowMs() - 3001);
+    Check(!scheduler.Next(&request) && scheduler.GetStats().expired == 1, name, "press older than max age expired");
+
+    // An input time ahead of the clock counts as now
+    SubmitResult ahead = scheduler.Submit(CaptureKind::ActiveWindow, RequestPriority::Normal, clock.NowMs() + 500);
+    Check(scheduler.Next(&request) && request.id == ahead.id && request.submittedMs == clock.NowMs(), name,
+          "future input time clamped to now");
+}
+
+// Random submit / advance / dispatch / cancel trace
+static void RandomTrace() {
+    const char* name = "trace";
+    const uint64_t maxAgeMs = 3000;
+    ManualClock clock;
+    RequestScheduler scheduler(clock, Policy(250, maxAgeMs, 8));
+    std::mt19937 random(17);
+    std::set<uint64_t> dispatched;
+    bool tooOld = false, twice = false;
+    for (int step = 0; step < 20000; step++) {
+        int action = (int)(random() % 10);
+        if (action < 5) {
+            scheduler.Submit((CaptureKind)(random() % 3), (RequestPriority)(random() % 3));
+        } else if (action < 8) {
+            CaptureRequest request;
+            if (scheduler.Next(&request)) {
+                tooOld = tooOld || clock.NowMs() - request.submittedMs > maxAgeMs;
+                twice = twice || !dispatched.insert(request.id).second;
+            }
+        } else if (action == 8) {
+            scheduler.Cancel(1 + random() % (step + 1));
+        }
+        clock.Advance(random() % 400);
+    }
+    RequestSchedulerStats stats = scheduler.GetStats();
+    Check(!tooOld, name, "no request dispatched past its max age");
+    Check(!twice, name, "no request dispatched twice");
+    Check(stats.submitted ==
+              stats.merged + stats.dispatched + stats.cancelled + stats.expired + stats.evicted + stats.queued,
+          name, "every submission merged, dispatched, cancelled, expired, evicted or queued");
+    printf("trace: %llu submitted, %llu dispatched, %llu merged, %llu cancelled, %llu expired, %llu evicted\n",
+           (unsigned long long)stats.submitted, (unsigned long long)stats.dispatched,
+           (unsigned long long)stats.merged, (unsigned long long)stats.cancelled,
+           (unsigned long long)stats.expired, (unsigned long long)stats.evicted);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "-v") == 0) g_verbose = true;
+
+    Coalescing();
+    Priorities();
+    Eviction();
+    Expiry();
+    Cancellation();
+    LateSubmission();
+    RandomTrace();
+
+    printf("%s (%d failed)\n", g_failures ? "FAILED" : "all checks passed", g_failures);
+    return g_failures ? 1 : 0;
+}
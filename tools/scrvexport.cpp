@@ -0,0 +1,82 @@
+// Export frames of a .scrv screen recording to PNG
+// Usage: scrvexport <recording.scrv> [frame] [output.png | output_prefix]
+//   no frame      -> info only (size, frame count, duration)
+//   frame         -> writes output.png (default: frame_<N>.png)
+//   frame = all   -> writes <prefix>_<N>.png for every frame
+
+#include "../src/recording.h"
+#include "../src/encoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+using namespace ScreenCapture;
+
+static bool WritePNG(const FrameRef& frame, const std::string& path) {
+    int size = 0;
+    unsigned char* png = EncodePNG(frame->Bits(), frame->Width(), frame->Height(), frame->Stride(),
+                                   EncodeOptions::Default(), &size);
+    if (!png) return false;
+    FILE* f = fopen(path.c_str(), "wb");
+    bool ok = f && fwrite(png, 1, size, f) == (size_t)size;
+    if (f) ok = (fclose(f) == 0) && ok;
+    FreeEncodedImage(png);
+    return ok;
+}
+
+static bool ExportFrame(RecordingReader& reader, const FrameRef& frame, int index, const std::string& path) {
+    if (!reader.DecodeFrame(index, frame->Bits(), frame->Stride())) {
+        fprintf(stderr, "frame %d: decode failed\n", index);
+        return false;
+    }
+    if (!WritePNG(frame, path)) {
+        fprintf(stderr, "frame %d: cannot write %s\n", index, path.c_str());
+        return false;
+    }
+    printf("frame %d (%.3fs) -> %s\n", index, reader.FrameTimestamp(index) / 1e6, path.c_str());
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <recording.scrv> [frame|all] [output]\n", argv[0]);
+        return 2;
+    }
+
+    RecordingReader reader;
+    if (!reader.Open(fopen(argv[1], "rb"))) {
+        fprintf(stderr, "%s: not a complete .scrv recording\n", argv[1]);
+        return 1;
+    }
+
+    int count = reader.FrameCount();
+    double duration = count ? reader.FrameTimestamp(count - 1) / 1e6 : 0.0;
+    printf("%s: %dx%d, %d frames, %.2fs\n", argv[1], reader.Width(), reader.Height(), count, duration);
+    if (argc < 3) return 0;
+
+    FrameRef frame = FramePool::Instance().Acquire(reader.Width(), reader.Height());
+    if (!frame) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    if (strcmp(argv[2], "all") == 0) {
+        std::string prefix = argc > 3 ? argv[3] : "frame";
+        for (int i = 0; i < count; i++) {
+            char suffix[32];
+            snprintf(suffix, sizeof(suffix), "_%05d.png", i);
+            if (!ExportFrame(reader, frame, i, prefix + suffix)) return 1;
+        }
+        return 0;
+    }
+
+    char* end = nullptr;
+    long index = strtol(argv[2], &end, 10);
+    if (*end != '\0' || index < 0 || index >= count) {
+        fprintf(stderr, "frame must be 0..%d or 'all'\n", count - 1);
+        return 2;
+    }
+    std::string path = argc > 3 ? argv[3] : "frame_" + std::to_string(index) + ".png";
+    return ExportFrame(reader, frame, (int)index, path) ? 0 : 1;
+}
@@ -0,0 +1,263 @@
+// Per-monitor overlay tiles against one bounding-box surface
+// Usage: tilebench [moves] [--verify]
+//   Mixed layout: 2560x1440 | 3840x2160 (primary, cursor) | 1080x1920
+//   portrait, bottom-aligned, so a third of the bounding box is dead area.
+//   single = screenshot + backbuffer over the bounding box, one Attach
+//   tiles  = OverlayTiles: time until the cursor's monitor is ready and
+//            until it snaps (its edges are built before the other monitors),
+//            time for all monitors, memory allocated against the bounding box
+//   Checks that Crop matches a crop of the bounding-box screenshot (inside
+//   one monitor, across monitors and dead areas), that snap edges come back
+//   in screen coordinates, that selection statistics add up across
+//   monitors (dead areas left out), and with --verify that every tile's
+//   incremental backbuffer matches the bounding-box full render after every
+//   move (the cursor's tile against its own full render, for the loupe).
+//   Exits 1 on a failed check.
+
+#include "../src/overlaytiles.h"
+#include "../src/framepool.h"
+#include "../src/monitorlayout.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+using namespace ScreenCapture;
+
+static double Ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Screen content at a bounding-box pixel: noise plus one bordered window
+// per monitor, so edges exist away from the monitor boundaries
+static uint32_t Pixel(const std::vector<PixelRect>& windows, int x, int y) {
+    for (const PixelRect& w : windows) {
+        if (x < w.left || x >= w.right || y < w.top || y >= w.bottom) continue;
+        bool border = x == w.left || x == w.right - 1 || y == w.top || y == w.bottom - 1;
+        return border ? 0xFF202020u : 0xFFF3F3F3u;
+    }
+    return 0xFF000000u | ((uint32_t)(x * 2654435761u ^ y * 40503u) & 0x3F3F3F) | 0x404060u;
+}
+
+static void FillTile(const FrameRef& frame, const PixelRect& bounds, const std::vector<PixelRect>& windows) {
+    for (int y = 0; y < bounds.Height(); y++) {
+        uint32_t* row = (uint32_t*)frame->Row(y);
+        for (int x = 0; x < bounds.Width(); x++) row[x] = Pixel(windows, bounds.left + x, bounds.top + y);
+    }
+}
+
+static bool SameRows(const FrameRef& a, int ax, int ay, const FrameRef& b, int bx, int by, int width, int height) {
+    for (int y = 0; y < height; y++) {
+        if (memcmp(a->Row(ay + y) + (size_t)ax * 4, b->Row(by + y) + (size_t)bx * 4, (size_t)width * 4) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool verify = false;
+    int moves = 120;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--verify") == 0) {
+            verify = true;
+        } else {
+            moves = atoi(argv[i]);
+        }
+    }
+    if (moves <= 0) {
+        fprintf(stderr, "usage: %s [moves] [--verify]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<ScreenRect> desktop = {
+        { 0, 0, 3840, 2160 },
+        { -2560, 720, 2560, 1440 },
+        { 3840, 240, 1080, 1920 },
+    };
+    MonitorLayout layout = BuildMonitorLayout(desktop);
+    const int width = layout.bounds.width, height = layout.bounds.height;
+    std::vector<PixelRect> monitors;
+    std::vector<PixelRect> windows;
+    for (const ScreenRect& m : layout.monitors) {
+        monitors.push_back({ m.x, m.y, m.x + m.width, m.y + m.height });
+        windows.push_back({ m.x + m.width / 4, m.y + m.height / 4, m.x + m.width * 3 / 4, m.y + m.height * 3 / 4 });
+    }
+    const PixelRect& primary = monitors[0];
+    int cursorX = primary.left + primary.Width() / 2, cursorY = primary.top + primary.Height() / 2;
+    printf("bounding box=%dx%d monitors=%d dead=%.1f%%\n", width, height, (int)monitors.size(),
+           layout.DeadPixels() * 100.0 / ((double)width * height));
+
+    // Single surface over the bounding box, as before the tiles
+    std::vector<PixelRect> damage;
+    auto singleStart = std::chrono::steady_clock::now();
+    FrameRef screenshot = FramePool::Instance().Acquire(width, height);
+    FrameRef backbuffer = FramePool::Instance().Acquire(width, height);
+    FrameRef reference = FramePool::Instance().Acquire(width, height);
+    for (int y = 0; y < height; y++) {
+        uint32_t* row = (uint32_t*)screenshot->Row(y);
+        std::fill(row, row + width, 0xFF000000u);
+    }
+    for (const PixelRect& m : monitors) {
+        FillTile(FramePool::SubView(screenshot, m.left, m.top, m.Width(), m.Height()), m, windows);
+    }
+    OverlayCompositor single;
+    single.Attach(screenshot->Bits(), screenshot->Stride(), backbuffer->Bits(), backbuffer->Stride(),
+                  width, height, OverlayStyle::Default(), &damage);
+    double singleMs = Ms(singleStart);
+
+    // Tiles: the cursor's monitor first, then the rest
+    OverlayTiles tiles;
+    auto tileStart = std::chrono::steady_clock::now();
+    tiles.Reset(monitors, width, height, OverlayStyle::Default());
+    std::vector<int> order = tiles.OrderFrom(cursorX, cursorY);
+    FillTile(tiles.Screenshot(order[0]), tiles.Bounds(order[0]), windows);
+    tiles.Prepare(order[0]);
+    double firstMs = Ms(tileStart);
+    OverlayTilesStats first = tiles.GetStats();
+    // Snap edges of the cursor's monitor before the other monitors, as the
+    // overlay's tile thread does
+    tiles.BuildEdges(order[0]);
+    double firstEdgesMs = Ms(tileStart);
+    bool snapFirst = tiles.EdgesAt(cursorX, cursorY) != nullptr;
+    for (size_t i = 1; i < order.size(); i++) {
+        FillTile(tiles.Screenshot(order[i]), tiles.Bounds(order[i]), windows);
+        tiles.Prepare(order[i]);
+    }
+    double allMs = Ms(tileStart);
+    auto edgeStart = std::chrono::steady_clock::now();
+    for (size_t i = 1; i < order.size(); i++) tiles.BuildEdges(order[i]);
+    double edgeMs = Ms(edgeStart);
+    OverlayTilesStats stats = tiles.GetStats();
+
+    printf("single: %.1fms to first frame, %.1fMB\n", singleMs, stats.boundingBytes / 1048576.0);
+    printf("tiles:  %.1fms to first frame (%.1fMB), snap edges there at %.1fms, %.1fms all monitors, %.1fMB (%.0f%%), "
+           "other edges %.1fms\n", firstMs, first.bytes / 1048576.0, firstEdgesMs, allMs, stats.bytes / 1048576.0,
+           stats.bytes * 100.0 / stats.boundingBytes, edgeMs);
+    if (order[0] != 0 || !snapFirst || stats.ready != stats.tiles || stats.bytes >= stats.boundingBytes) {
+        fprintf(stderr, "tile order or allocation wrong\n");
+        return 1;
+    }
+
+    // Crops: inside the primary, across the primary and the portrait
+    // monitor (through dead area), and over the whole box
+    PixelRect crops[] = {
+        { primary.left + 100, primary.top + 50, primary.left + 900, primary.top + 650 },
+        { primary.right - 400, primary.top + 10, primary.right + 300, primary.top + 700 },
+        { 0, 0, width, height },
+    };
+    for (const PixelRect& rect : crops) {
+        FrameRef crop = tiles.Crop(rect);
+        if (!crop || !SameRows(crop, 0, 0, screenshot, rect.left, rect.top, rect.Width(), rect.Height())) {
+            fprintf(stderr, "crop (%d,%d)-(%d,%d) differs from the bounding box\n", rect.left, rect.top,
+                    rect.right, rect.bottom);
+            return 1;
+        }
+    }
+
+    // Edges: every window border snaps to the same column and row as an
+    // edge map of the whole box
+    EdgeMap whole;
+    whole.Build(screenshot->Bits(), screenshot->Stride(), width, height);
+    for (const PixelRect& w : windows) {
+        int x = w.left + 3, y = (w.top + w.bottom) / 2;
+        const EdgeMap* edges = tiles.EdgesAt(x, y);
+        if (!edges || edges->SnapColumn(x, y, 8) != whole.SnapColumn(x, y, 8) ||
+            edges->SnapRow(x, w.top + 3, 8) != whole.SnapRow(x, w.top + 3, 8) || edges->SnapColumn(x, y, 8) < 0) {
+            fprintf(stderr, "edges of the window at (%d,%d) differ from the bounding box\n", w.left, w.top);
+            return 1;
+        }
+    }
+
+    // A drag from the 1440p monitor across the primary onto the portrait one
+    uint64_t tilePixels = 0, singlePixels = 0;
+    double tileMoveMs = 0, singleMoveMs = 0;
+    int startX = monitors[1].left + 300, startY = monitors[1].top + 200;
+    for (int i = 0; i < moves; i++) {
+        int x = primary.left + (monitors[2].right - 50 - primary.left) * (i + 1) / moves;
+        int y = primary.top + 100 + (primary.Height() - 400) * (i + 1) / moves;
+        PixelRect selection = { std::min(startX, x), std::min(startY, y), std::max(startX, x), std::max(startY, y) };
+        OverlayCursor cursor = { x, y, true };
+
+        auto start = std::chrono::steady_clock::now();
+        tiles.SetView(selection, cursor, &damage);
+        tileMoveMs += Ms(start);
+        for (const PixelRect& strip : damage) {
+            tilePixels += strip.Area();
+            int tile = tiles.TileAt(strip.left, strip.top);
+            if (tile < 0 || strip.Intersect(tiles.Bounds(tile)) != strip) {
+                fprintf(stderr, "move %d: damage strip crosses a monitor\n", i);
+                return 1;
+            }
+        }
+        start = std::chrono::steady_clock::now();
+        single.SetView(selection, { x, y, false }, &damage);
+        singleMoveMs += Ms(start);
+        for (const PixelRect& strip : damage) singlePixels += strip.Area();
+
+        if (!verify) continue;
+        // Without the loupe every tile is a window onto the single surface;
+        // the cursor's tile must also match its own full render
+        int cursorTile = tiles.TileAt(x, y);
+        for (int t = 0; t < tiles.Count(); t++) {
+            const PixelRect& b = tiles.Bounds(t);
+            FrameRef tileBuffer = tiles.Backbuffer(t);
+            if (t == cursorTile) {
+                OverlayCompositor own;
+                std::vector<PixelRect> ownDamage;
+                FrameRef ownTarget = FramePool::Instance().Acquire(b.Width(), b.Height());
+                FrameRef tileShot = tiles.Crop(b);
+                own.Attach(tileShot->Bits(), tileShot->Stride(), ownTarget->Bits(), ownTarget->Stride(),
+                           b.Width(), b.Height(), OverlayStyle::Default(), &ownDamage);
+                own.SetScreenArea({ -b.left, -b.top, width - b.left, height - b.top });
+                own.RenderFull({ selection.left - b.left, selection.top - b.top, selection.right - b.left,
+                                 selection.bottom - b.top }, { x - b.left, y - b.top, true },
+                               ownTarget->Bits(), ownTarget->Stride());
+                if (!SameRows(tileBuffer, 0, 0, ownTarget, 0, 0, b.Width(), b.Height())) {
+                    fprintf(stderr, "move %d: cursor tile %d differs from its full render\n", i, t);
+                    return 1;
+                }
+                continue;
+            }
+            single.RenderFull(selection, { x, y, false }, reference->Bits(), reference->Stride());
+            if (!SameRows(tileBuffer, 0, 0, reference, b.left, b.top, b.Width(), b.Height())) {
+                fprintf(stderr, "move %d: tile %d differs from the bounding-box render\n", i, t);
+                return 1;
+            }
+        }
+    }
+    printf("drag:   tiles %.0f px/move %.3fms/move, single %.0f px/move %.3fms/move (no loupe)%s\n",
+           (double)tilePixels / moves, tileMoveMs / moves, (double)singlePixels / moves, singleMoveMs / moves,
+           verify ? " (verified)" : "");
+
+    // Statistics across the primary and the portrait monitor (after the
+    // drag, which compares labels without them): the dead area between
+    // them is black in the bounding box, so only the pixel count differs
+    auto statsStart = std::chrono::steady_clock::now();
+    for (int tile : order) tiles.BuildStats(tile);
+    double statsMs = Ms(statsStart);
+    RegionSums sums, expected = {};
+    const PixelRect& across = crops[1];
+    for (int y = across.top; y < across.bottom; y++) {
+        for (int x = across.left; x < across.right; x++) {
+            const uint8_t* p = screenshot->Row(y) + (size_t)x * 4;
+            uint64_t luma = 77u * p[2] + 150u * p[1] + 29u * p[0];
+            expected.blue += p[0];
+            expected.green += p[1];
+            expected.red += p[2];
+            expected.luma += luma;
+            expected.lumaSquares += luma * luma;
+            if (tiles.TileAt(x, y) >= 0) expected.pixels++;
+        }
+    }
+    if (!tiles.SumRegion(across, &sums) || sums.pixels != expected.pixels || sums.blue != expected.blue ||
+        sums.green != expected.green || sums.red != expected.red || sums.luma != expected.luma ||
+        sums.lumaSquares != expected.lumaSquares) {
+        fprintf(stderr, "selection statistics across monitors differ from the bounding box\n");
+        return 1;
+    }
+    printf("stats:  %.1fms all monitors, %.1fMB\n", statsMs, tiles.GetStats().statsBytes / 1048576.0);
+    return 0;
+}
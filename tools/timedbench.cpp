@@ -0,0 +1,72 @@
+// Interval capture accuracy through CaptureTimer on the synthetic backend
+// Usage: timedbench [intervalMs] [seconds] [encodeMs] [skip|merge] [width height]
+//   encodeMs simulates the per-frame save cost; above intervalMs the
+//   consumer falls behind and the skip/merge policy kicks in
+
+#include "../src/capturetimer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+
+using namespace ScreenCapture;
+
+static void Report(const char* name, const LatencyHistogram& histogram) {
+    printf("%-9s n=%-5llu mean=%8.3fms  p50<=%8.3fms  p95<=%8.3fms  p99<=%8.3fms  max=%8.3fms\n", name,
+           (unsigned long long)histogram.Count(), histogram.MeanUs() / 1000.0,
+           histogram.PercentileUs(0.50) / 1000.0, histogram.PercentileUs(0.95) / 1000.0,
+           histogram.PercentileUs(0.99) / 1000.0, histogram.Max() / 1000.0);
+    for (int i = 0; i < LatencyHistogram::BUCKETS; i++) {
+        if (histogram.Bucket(i)) {
+            printf("          <%8lldus %6llu\n", (long long)LatencyHistogram::BucketUpperUs(i),
+                   (unsigned long long)histogram.Bucket(i));
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    int intervalMs = argc > 1 ? atoi(argv[1]) : 50;
+    double seconds = argc > 2 ? atof(argv[2]) : 5.0;
+    int encodeMs = argc > 3 ? atoi(argv[3]) : 0;
+    BehindPolicy behind = argc > 4 && strcmp(argv[4], "merge") == 0 ? BehindPolicy::Merge : BehindPolicy::Skip;
+    int width = argc > 6 ? atoi(argv[5]) : 1920;
+    int height = argc > 6 ? atoi(argv[6]) : 1080;
+    if (intervalMs <= 0 || seconds <= 0 || encodeMs < 0 || width <= 0 || height <= 0) {
+        fprintf(stderr, "usage: %s [intervalMs] [seconds] [encodeMs] [skip|merge] [width height]\n", argv[0]);
+        return 2;
+    }
+
+    CaptureSession session(CreateSyntheticBackend(width, height), width, height, 3);
+    if (!session.Build()) {
+        fprintf(stderr, "session build failed\n");
+        return 1;
+    }
+    SteadyTimerClock clock;
+    CaptureTimer timer(session, clock);
+
+    TimedCaptureOptions options = { 0, 0, width, height, (int64_t)intervalMs * 1000,
+                                    (int64_t)(seconds * 1000000.0), behind };
+    printf("backend=%s %dx%d every %dms for %.1fs, encode=%dms, when behind=%s\n", session.BackendName(),
+           width, height, intervalMs, seconds, encodeMs, behind == BehindPolicy::Merge ? "merge" : "skip");
+
+    auto consumer = [encodeMs](TimedFrame&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(encodeMs));
+    };
+    if (!timer.Start(options, consumer)) {
+        fprintf(stderr, "start failed\n");
+        return 1;
+    }
+    timer.Wait();
+    timer.Stop();
+
+    CaptureTimerStats stats = timer.GetStats();
+    printf("ticks=%llu captured=%llu delivered=%llu missed=%llu skippedBusy=%llu merged=%llu failed=%llu\n",
+           (unsigned long long)stats.ticks, (unsigned long long)stats.captured,
+           (unsigned long long)stats.delivered, (unsigned long long)stats.missed,
+           (unsigned long long)stats.skippedBusy, (unsigned long long)stats.merged,
+           (unsigned long long)stats.failed);
+    Report("lateness", stats.lateness);
+    Report("jitter", stats.jitter);
+    return 0;
+}
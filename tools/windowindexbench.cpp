@@ -0,0 +1,149 @@
+// Window hit-test index for hover-to-pick: build time, size, query cost
+// Usage: windowindexbench [width height] [windows]
+//   Lays out synthetic desktops of overlapping windows, each holding a
+//   nested tree of controls (toolbars, panels, buttons), emitted in the
+//   overlay's priority order (controls before their window, windows front
+//   to back). Checks WindowIndex::HitTest and TopLevel against a linear
+//   scan at random points, then times both. Exits 1 on a mismatch.
+
+#include "../src/windowindex.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace ScreenCapture;
+
+struct Desktop {
+    std::vector<WindowElement> elements;
+    std::vector<int> topLevel;  // Per element, as built
+};
+
+static double Ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static PixelRect RandomRect(std::mt19937& random, const PixelRect& area, int minSize, int maxFraction) {
+    int w = std::max(1, std::min(area.Width(), minSize + (int)(random() % (unsigned)std::max(1, area.Width() / maxFraction))));
+    int h = std::max(1, std::min(area.Height(), minSize + (int)(random() % (unsigned)std::max(1, area.Height() / maxFraction))));
+    int left = area.left + (int)(random() % (unsigned)(area.Width() - w + 1));
+    int top = area.top + (int)(random() % (unsigned)(area.Height() - h + 1));
+    return { left, top, left + w, top + h };
+}
+
+// Children first (front sibling first), then the element itself; returns
+// its index. Children are clipped to the parent like real child windows.
+static int Emit(Desktop* desktop, std::mt19937& random, const PixelRect& rect, int depth, int children) {
+    std::vector<int> kids;
+    for (int i = 0; i < children; i++) {
+        PixelRect child = RandomRect(random, rect, 12, 2).Intersect(rect);
+        if (child.Empty()) continue;
+        int grandchildren = depth < 3 ? (int)(random() % 5) : 0;
+        kids.push_back(Emit(desktop, random, child, depth + 1, grandchildren));
+    }
+    int self = (int)desktop->elements.size();
+    desktop->elements.push_back({ rect, -1 });
+    desktop->topLevel.push_back(-1);
+    for (int kid : kids) desktop->elements[kid].parent = self;
+    return self;
+}
+
+static Desktop MakeDesktop(int width, int height, int windows, int controls, unsigned seed) {
+    std::mt19937 random(seed);
+    Desktop desktop;
+    PixelRect screen = { 0, 0, width, height };
+    for (int i = 0; i < windows; i++) {
+        PixelRect window = RandomRect(random, screen, 160, 2);
+        // The window's index is only known after its controls
+        size_t first = desktop.elements.size();
+        int self = Emit(&desktop, random, window, 0, (int)(random() % (unsigned)(controls + 1)));
+        for (size_t e = first; e < desktop.elements.size(); e++) desktop.topLevel[e] = self;
+    }
+    // The desktop itself, behind everything
+    desktop.elements.push_back({ screen, -1 });
+    desktop.topLevel.push_back((int)desktop.elements.size() - 1);
+    return desktop;
+}
+
+static int Linear(const std::vector<WindowElement>& elements, int x, int y) {
+    for (size_t i = 0; i < elements.size(); i++) {
+        const PixelRect& r = elements[i].rect;
+        if (x >= r.left && x < r.right && y >= r.top && y < r.bottom) return (int)i;
+    }
+    return -1;
+}
+
+int main(int argc, char** argv) {
+    int width = argc >= 3 ? atoi(argv[1]) : 3840;
+    int height = argc >= 3 ? atoi(argv[2]) : 2160;
+    int windows = argc == 2 ? atoi(argv[1]) : (argc >= 4 ? atoi(argv[3]) : 40);
+    if (width < 256 || height < 256 || windows <= 0) {
+        fprintf(stderr, "usage: %s [width height] [windows]\n", argv[0]);
+        return 2;
+    }
+
+    struct Case { const char* name; int windows, controls; } cases[] = {
+        { "few windows", std::max(1, windows / 4), 4 },
+        { "typical", windows, 12 },
+        { "crowded", windows * 4, 24 },
+    };
+
+    int failed = 0;
+    std::mt19937 random(11);
+    for (const Case& c : cases) {
+        Desktop desktop = MakeDesktop(width, height, c.windows, c.controls, 5 + c.windows);
+
+        WindowIndex index;
+        std::vector<double> times;
+        for (int i = 0; i < 5; i++) {
+            auto start = std::chrono::steady_clock::now();
+            index.Build(desktop.elements);
+            times.push_back(Ms(start));
+        }
+        std::sort(times.begin(), times.end());
+        WindowIndexStats stats = index.GetStats();
+
+        // Correctness at random points, including just outside the desktop
+        int mismatches = 0;
+        for (int i = 0; i < 200000; i++) {
+            int x = (int)(random() % (unsigned)(width + 64)) - 32;
+            int y = (int)(random() % (unsigned)(height + 64)) - 32;
+            int expected = Linear(desktop.elements, x, y);
+            int got = index.HitTest(x, y);
+            bool ok = got == expected && (got < 0 || index.TopLevel(got) == desktop.topLevel[expected]);
+            if (!ok && mismatches++ < 5) {
+                fprintf(stderr, "%s: (%d,%d) got %d (top %d), expected %d (top %d)\n", c.name, x, y, got,
+                        got < 0 ? -1 : index.TopLevel(got), expected, expected < 0 ? -1 : desktop.topLevel[expected]);
+            }
+        }
+        failed += mismatches;
+
+        // Query cost: a cursor path of small steps, like WM_MOUSEMOVE
+        const int queries = 1000000;
+        std::vector<int> xs(queries), ys(queries);
+        int x = width / 2, y = height / 2;
+        for (int i = 0; i < queries; i++) {
+            x = std::max(0, std::min(width - 1, x + (int)(random() % 33) - 16));
+            y = std::max(0, std::min(height - 1, y + (int)(random() % 33) - 16));
+            xs[i] = x;
+            ys[i] = y;
+        }
+        long long sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < queries; i++) sink += index.HitTest(xs[i], ys[i]);
+        double gridMs = Ms(start);
+        const int linearQueries = queries / 10;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < linearQueries; i++) sink += Linear(desktop.elements, xs[i], ys[i]);
+        double linearMs = Ms(start) * 10;
+
+        printf("%-12s elements=%-5llu cell=%dpx cells=%llu entries=%llu (pruned %llu) build=%.3fms\n",
+               c.name, (unsigned long long)stats.elements, stats.cellSize, (unsigned long long)stats.cells,
+               (unsigned long long)stats.entries, (unsigned long long)stats.pruned, times[2]);
+        printf("             hit test: grid %.1fns, linear %.1fns per move; %d mismatches%s\n",
+               gridMs * 1e6 / queries, linearMs * 1e6 / queries, mismatches, sink == 42 ? " " : "");
+    }
+    return failed ? 1 : 0;
+}